@@ -26,6 +26,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <csignal>
 #include <boost/lexical_cast.hpp>
 #include <boost/variant/static_visitor.hpp>
 #include <boost/any.hpp>
@@ -69,6 +70,21 @@ namespace {
 
 namespace {
 
+#ifdef SIGUSR2
+/// Have the garbage collector statistics and the frame profile written
+/// after the next frame.
+void
+requestDumps(int /*signo*/)
+{
+    movie_root::requestGCStatsDump();
+    movie_root::requestProfileDump();
+}
+#endif
+
+}
+
+namespace {
+
 class MessageHandler : public boost::static_visitor<boost::any>
 {
 public:
@@ -389,6 +405,10 @@ Player::run(int argc, char* argv[], const std::string& infile,
     // a cache of setting some parameter before calling us...
     // (example: setDoSound(), setWindowId() etc.. ) 
     init_logfile();
+
+#ifdef SIGUSR2
+    std::signal(SIGUSR2, requestDumps);
+#endif
    
     // gnash.cpp should check that a filename is supplied.
     assert (!infile.empty());
@@ -0,0 +1,80 @@
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010,
+//   2011 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "RenderThread.h"
+
+#include <cassert>
+
+#include "RenderCommands.h"
+#include "Renderer.h"
+
+namespace gnash {
+
+RenderThread::RenderThread(Renderer& renderer)
+    :
+    _renderer(renderer),
+    _quit(false),
+    _thread(&RenderThread::run, this)
+{
+}
+
+RenderThread::~RenderThread()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _quit = true;
+    lock.unlock();
+    _wakeup.notify_one();
+    _thread.join();
+}
+
+void
+RenderThread::draw(std::unique_ptr<RenderFrame> frame)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    assert(!_frame);
+    _frame = std::move(frame);
+    lock.unlock();
+    _wakeup.notify_one();
+}
+
+void
+RenderThread::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this] { return !_frame; });
+}
+
+void
+RenderThread::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        _wakeup.wait(lock, [this] { return _frame || _quit; });
+        if (!_frame) return;
+
+        // The frame isn't touched by anyone else until it is reset.
+        lock.unlock();
+        _frame->draw(_renderer);
+        lock.lock();
+
+        _frame.reset();
+        _done.notify_all();
+    }
+}
+
+} // namespace gnash
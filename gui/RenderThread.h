@@ -0,0 +1,81 @@
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010,
+//   2011 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_RENDERTHREAD_H
+#define GNASH_RENDERTHREAD_H
+
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <boost/noncopyable.hpp>
+
+namespace gnash {
+    class Renderer;
+    struct RenderFrame;
+}
+
+namespace gnash {
+
+/// Draws recorded frames in a thread of its own.
+//
+/// One frame is drawn at a time, and there is no queue: draw() may only
+/// be called once the last frame is finished. Nothing else may use the
+/// renderer between draw() and wait().
+class RenderThread : boost::noncopyable
+{
+public:
+
+    explicit RenderThread(Renderer& renderer);
+
+    /// Stop the thread once the frame being drawn is finished.
+    ~RenderThread();
+
+    /// Start drawing a frame.
+    //
+    /// The last frame must be finished, see wait().
+    void draw(std::unique_ptr<RenderFrame> frame);
+
+    /// Wait until the frame being drawn, if any, is finished.
+    void wait();
+
+private:
+
+    void run();
+
+    Renderer& _renderer;
+
+    /// The frame to draw, null when there is none.
+    std::unique_ptr<RenderFrame> _frame;
+
+    bool _quit;
+
+    std::mutex _mutex;
+
+    /// Signalled when there is a frame to draw, or on quitting.
+    std::condition_variable _wakeup;
+
+    /// Signalled when a frame is finished.
+    std::condition_variable _done;
+
+    std::thread _thread;
+};
+
+} // namespace gnash
+
+#endif
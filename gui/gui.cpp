@@ -38,6 +38,9 @@
 #include "RunResources.h"
 #include "StreamProvider.h"
 #include "ScreenShotter.h"
+#include "RenderThread.h"
+#include "RenderCommands.h"
+#include "rc.h"
 #include "Movie.h"
 
 #ifdef GNASH_FPS_DEBUG
@@ -121,6 +124,8 @@ Gui::Gui(RunResources& r) :
     //       before and destroyed after _virtualClock !
     ,_systemClock()
     ,_virtualClock(_systemClock)
+    ,_rendering(false)
+    ,_advancing(false)
 #ifdef ENABLE_KEYBOARD_MOUSE_MOVEMENTS 
     ,_xpointer(0)
     ,_ypointer(0)
@@ -165,6 +170,8 @@ Gui::Gui(unsigned long xid, float scale, bool loop, RunResources& r)
     //       before and destroyed after _virtualClock !
     ,_systemClock()
     ,_virtualClock(_systemClock)
+    ,_rendering(false)
+    ,_advancing(false)
 #ifdef ENABLE_KEYBOARD_MOUSE_MOVEMENTS 
     ,_xpointer(0)
     ,_ypointer(0)
@@ -285,6 +292,9 @@ Gui::updateStageMatrix()
     }
     
     assert(_stage); // when VM is initialized this should hold
+
+    // The render thread mustn't draw while the renderer changes.
+    finishRendering();
     
     float swfwidth = _movieDef->get_width_pixels();
     float swfheight = _movieDef->get_height_pixels();
@@ -767,6 +777,19 @@ Gui::display(movie_root* m)
     
     // Avoid drawing of stopped movies
     if ( ! changed_ranges.isNull() ) { // use 'else'?
+
+        if (_renderThread.get()) {
+            queueFrame(*m, changed_ranges);
+
+            // Frames displayed on advance are drawn while the next one
+            // advances, others at once.
+            if (!_advancing) {
+                startRendering();
+                finishRendering();
+            }
+            return true;
+        }
+
         // Tell the GUI(!) that we only need to update this
         // region. Note the GUI can do whatever it wants with
         // this information. It may simply ignore the bounds
@@ -827,6 +850,77 @@ Gui::display(movie_root* m)
     return true;
 }
 
+void
+Gui::queueFrame(movie_root& m, const InvalidatedRanges& ranges)
+{
+    std::unique_ptr<RenderFrame> frame = m.recordFrame();
+    if (!frame.get()) return;
+
+    // Each frame is drawn in full, so a newer one can replace a frame
+    // not drawn yet if it updates the regions of both.
+    if (_queuedFrame.get()) {
+        _queuedRanges.add(ranges);
+    }
+    else {
+        _queuedRanges = ranges;
+    }
+
+#ifdef REGION_UPDATES_DEBUGGING_FULL_REDRAW
+    _queuedRanges.setWorld();
+#endif
+
+    IF_DEBUG_REGION_UPDATES (
+        if (!ranges.isWorld()) {
+            for (size_t rno = 0; rno < ranges.size(); rno++) {
+                const geometry::Range2d<int>& bounds = ranges.getRange(rno);
+
+                float xmin = bounds.getMinX();
+                float xmax = bounds.getMaxX();
+                float ymin = bounds.getMinY();
+                float ymax = bounds.getMaxY();
+
+                const std::vector<point> box = {
+                    point(xmin, ymin),
+                    point(xmax, ymin),
+                    point(xmax, ymax),
+                    point(xmin, ymax)
+                };
+
+                frame->commands.drawPoly(box, rgba(0,0,0,0),
+                        rgba(255,0,0,255), SWFMatrix(), false);
+            }
+        }
+    );
+
+    _queuedFrame = std::move(frame);
+}
+
+void
+Gui::startRendering()
+{
+    if (!_queuedFrame.get()) return;
+
+    assert(!_rendering);
+
+    setInvalidatedRegions(_queuedRanges);
+    beforeRendering();
+
+    _renderThread->draw(std::move(_queuedFrame));
+    _rendering = true;
+}
+
+void
+Gui::finishRendering()
+{
+    if (!_rendering) return;
+
+    _renderThread->wait();
+    _rendering = false;
+
+    // show frame on screen
+    renderBuffer();
+}
+
 void
 Gui::play()
 {
@@ -869,6 +963,12 @@ Gui::stop()
     // log_debug("Pausing virtual clock");
     _virtualClock.pause();
 
+    // Show the last frame displayed, as there may be no more advances.
+    if (!_advancing) {
+        startRendering();
+        finishRendering();
+    }
+
     stopHook();
 }
 
@@ -893,6 +993,12 @@ Gui::pause()
     // log_debug("Pausing virtual clock");
     _virtualClock.pause();
 
+    // Show the last frame displayed, as there may be no more advances.
+    if (!_advancing) {
+        startRendering();
+        finishRendering();
+    }
+
     stopHook();
 }
 
@@ -914,6 +1020,19 @@ Gui::start()
     // to properly update stageMatrix if scaling is given  
     resize_view(_width, _height); 
 
+    const RcInitFile& rcfile = RcInitFile::getDefaultInstance();
+    if (rcfile.renderPipeline() && _renderer.get() && !_screenShotter.get()
+            && !_renderThread.get()) {
+        // Other renderers draw through a context bound to this thread.
+        if (_renderer->description() == "AGG") {
+            _renderThread.reset(new RenderThread(*_renderer));
+        }
+        else {
+            log_error(_("renderPipeline is not supported by the %s "
+                        "renderer"), _renderer->description());
+        }
+    }
+
     // @todo since we registered the sound handler, shouldn't we know
     //       already what it is ?!
 #ifdef USE_SOUND
@@ -945,6 +1064,11 @@ Gui::advanceMovie(bool doDisplay)
 
     Display dis(*this, *_stage);
     gnash::movie_root* m = _stage;
+
+    // With a render thread, the frame last displayed is drawn while
+    // this one advances.
+    _advancing = true;
+    startRendering();
     
     // Define REVIEW_ALL_FRAMES to have *all* frames
     // consequentially displayed. Useful for debugging.
@@ -963,6 +1087,8 @@ Gui::advanceMovie(bool doDisplay)
     m->getRootMovie().setPlayState(gnash::MovieClip::PLAYSTATE_PLAY);
     // log_debug("Frame %d", m->getRootMovie().get_current_frame());
 #endif
+
+    finishRendering();
     
 #ifdef GNASH_FPS_DEBUG
     // will be a no-op if fps_timer_interval is zero
@@ -974,6 +1100,14 @@ Gui::advanceMovie(bool doDisplay)
     if (doDisplay && visible()) {
         display(m);
     }
+
+    _advancing = false;
+
+    // Nothing may advance after this to draw the frame.
+    if (isStopped()) {
+        startRendering();
+        finishRendering();
+    }
     
     if (!loops()) {
         // can be 0 on malformed SWF
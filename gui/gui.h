@@ -65,6 +65,7 @@
 namespace gnash {
     class SWFRect;
     class ScreenShotter;
+    class RenderThread;
     class RunResources;
     class movie_root;
     class movie_definition;
@@ -552,6 +553,18 @@ private:
     std::int32_t _yoffset;
 
     bool display(movie_root* m);
+
+    /// Record a frame for _renderThread to draw.
+    //
+    /// A frame that wasn't drawn yet is dropped, and its regions are
+    /// updated with the new one.
+    void queueFrame(movie_root& m, const InvalidatedRanges& ranges);
+
+    /// Have _renderThread start drawing the queued frame, if any.
+    void startRendering();
+
+    /// Wait for _renderThread to finish drawing, and show the frame.
+    void finishRendering();
     
 #ifdef GNASH_FPS_DEBUG
     unsigned int fps_counter;
@@ -605,6 +618,26 @@ private:
     /// Checked on each advance for screenshot activity if it exists.
     std::unique_ptr<ScreenShotter> _screenShotter;
 
+    /// Draws each frame while the next one advances, if enabled.
+    //
+    /// The pipeline is one frame deep. There is one frame buffer, and
+    /// the GUI uses the renderer between advances, so advanceMovie()
+    /// waits for the frame to be drawn before returning. A frame slower
+    /// to draw than an advance delays the next advance, as it would
+    /// without the thread, rather than being skipped. The only frames
+    /// dropped are those replaced before they start, see queueFrame().
+    std::unique_ptr<RenderThread> _renderThread;
+
+    /// The frame waiting to be drawn, and the regions it updates.
+    std::unique_ptr<RenderFrame> _queuedFrame;
+    InvalidatedRanges _queuedRanges;
+
+    /// Whether _renderThread is drawing a frame.
+    bool _rendering;
+
+    /// Whether advanceMovie() is running.
+    bool _advancing;
+
 #ifdef ENABLE_KEYBOARD_MOUSE_MOVEMENTS 
     int _xpointer;
     int _ypointer;
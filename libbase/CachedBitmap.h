@@ -20,6 +20,8 @@
 #ifndef GNASH_BITMAP_INFO_H
 #define GNASH_BITMAP_INFO_H
 
+#include <cstddef>
+
 #include "ref_counted.h"
 #include "dsodefs.h"
 
@@ -38,7 +40,7 @@ class DSOEXPORT CachedBitmap : public ref_counted
 {
 public:
 
-    CachedBitmap() {}
+    CachedBitmap() : _changing(false), _revision(0) {}
 
     virtual ~CachedBitmap() {}
 
@@ -57,6 +59,35 @@ public:
     /// A disposed CachedBitmap has no data and should not be rendered.
     virtual bool disposed() const = 0;
 
+    /// Note that ActionScript may change the image() from now on.
+    //
+    /// Frames drawn in another thread draw a copy of such a bitmap,
+    /// taken again only after it has changed().
+    void setChanging() {
+        _changing = true;
+    }
+
+    /// Whether ActionScript may change the image().
+    bool changing() const {
+        return _changing;
+    }
+
+    /// Note that the image() was changed.
+    void changed() {
+        ++_revision;
+    }
+
+    /// How many times the image() was changed.
+    size_t revision() const {
+        return _revision;
+    }
+
+private:
+
+    bool _changing;
+
+    size_t _revision;
+
 };
 	
 } // namespace gnash
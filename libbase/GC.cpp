@@ -20,9 +20,11 @@
 #include "GC.h"
 
 #include <cstdlib>
+#include <chrono>
 
 #include "utility.h" // for typeName()
 #include "GnashAlgorithm.h"
+#include "rc.h"
 
 #ifdef GNASH_GC_DEBUG
 # include "log.h"
@@ -31,13 +33,120 @@
 
 namespace gnash {
 
+namespace {
+
+/// Decides when an incremental GC step has done enough.
+//
+/// A step always does at least the given amount of work, so that a
+/// cycle finishes even if the program creates resources faster than
+/// the time budget allows to process them. A budget of 0 is unlimited.
+class StepBudget
+{
+public:
+
+    typedef std::chrono::steady_clock Clock;
+
+    StepBudget(double ms, size_t minWork)
+        :
+        _end(Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double, std::milli>(ms))),
+        _unlimited(ms <= 0),
+        _minWork(minWork),
+        _work(0)
+    {}
+
+    /// Count one unit of work and return true if the step should stop.
+    bool exhausted() {
+        ++_work;
+        if (_unlimited || _work < _minWork) return false;
+
+        // Reading the clock costs more than scanning most objects.
+        if (_work % 64) return false;
+        return Clock::now() >= _end;
+    }
+
+private:
+    const Clock::time_point _end;
+    const bool _unlimited;
+    const size_t _minWork;
+    size_t _work;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+/// Milliseconds in a Clock duration.
+double
+toMs(Clock::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+} // anonymous namespace
+
+TimeHistogram::TimeHistogram()
+    :
+    _counts(),
+    _total(0),
+    _max(0),
+    _sum(0)
+{
+}
+
+void
+TimeHistogram::add(double ms)
+{
+    size_t i = 0;
+    while (i < Buckets - 1 && ms >= bound(i)) ++i;
+    ++_counts[i];
+    ++_total;
+    _sum += ms;
+    if (ms > _max) _max = ms;
+}
+
+double
+TimeHistogram::bound(size_t bucket)
+{
+    if (bucket >= Buckets - 1) return 0;
+    return 0.125 * (1 << bucket);
+}
+
+GcStats::GcStats()
+    :
+    cycles(0),
+    survived(0),
+    freed(0),
+    allocated(0),
+    scanned(0),
+    lastSurvived(0),
+    lastFreed(0),
+    lastScanned(0),
+    lastMarkTime(0),
+    lastSweepTime(0),
+    allocationRate(0)
+{
+}
+
+GC* GC::_marking = nullptr;
+size_t GC::_instances = 0;
+
 GC::GC(GcRoot& root)
     :
     // might raise the default ...
     _maxNewCollectablesCount(64),
     _resListSize(0),
     _root(root),
-    _lastResCount(0)
+    _lastResCount(0),
+    _frameBudget(RcInitFile::getDefaultInstance().getGCFrameBudget()),
+    _phase(PHASE_IDLE),
+    _sweepPos(_sweepList.before_begin()),
+    _newSinceStep(0),
+    _markTime(0),
+    _sweepTime(0),
+    _cycleSurvived(0),
+    _cycleFreed(0),
+    _cycleScanned(0),
+    _lastCycleEnd(Clock::now()),
+    _lastCycleAllocated(0)
 #ifdef GNASH_GC_DEBUG 
     , _collectorRuns(0)
 #endif
@@ -50,6 +159,11 @@ GC::GC(GcRoot& root)
         const size_t gap = std::strtoul(gcgap, nullptr, 0);
         _maxNewCollectablesCount = gap;
     }
+
+    // Resources of this collector must not end up in the other one's
+    // scan list.
+    if (_marking) _marking->finishMarking();
+    ++_instances;
 }
 
 GC::~GC()
@@ -57,10 +171,17 @@ GC::~GC()
 #ifdef GNASH_GC_DEBUG 
     log_debug("GC deleted, deleting all managed resources - collector run %d times", _collectorRuns);
 #endif
+    if (_marking == this) _marking = nullptr;
+    --_instances;
+
     for (ResList::const_iterator i = _resList.begin(), e = _resList.end();
             i != e; ++i) {
         delete *i;
     }
+    for (ResList::const_iterator i = _sweepList.begin(),
+            e = _sweepList.end(); i != e; ++i) {
+        delete *i;
+    }
 }
 
 size_t
@@ -117,14 +238,213 @@ GC::runCycle()
             _lastResCount, _resListSize);
 #endif // GNASH_GC_DEBUG
 
+    finishCycle();
+
+    const Clock::time_point start = Clock::now();
+
     // Mark all resources as reachable
     markReachable();
 
+    const Clock::time_point marked = Clock::now();
+
     // clean unreachable resources, and mark the others as reachable again
-    cleanUnreachable();
+    const size_t deleted = cleanUnreachable();
+
+    const Clock::time_point end = Clock::now();
 
     _lastResCount = _resListSize;
 
+    _markTime = toMs(marked - start);
+    _sweepTime = toMs(end - marked);
+    _stats.pauses.add(toMs(end - start));
+    cycleDone(_resListSize, deleted);
+}
+
+void
+GC::cycleDone(size_t survived, size_t freed)
+{
+    ++_stats.cycles;
+    _stats.survived += survived;
+    _stats.freed += freed;
+    _stats.lastSurvived = survived;
+    _stats.lastFreed = freed;
+    _stats.scanned += _cycleScanned;
+    _stats.lastScanned = _cycleScanned;
+    _stats.lastMarkTime = _markTime;
+    _stats.lastSweepTime = _sweepTime;
+    _stats.markTimes.add(_markTime);
+    _stats.sweepTimes.add(_sweepTime);
+
+    const Clock::time_point now = Clock::now();
+    const double seconds = toMs(now - _lastCycleEnd) / 1000;
+    if (seconds > 0) {
+        _stats.allocationRate =
+            (_stats.allocated - _lastCycleAllocated) / seconds;
+    }
+    _lastCycleEnd = now;
+    _lastCycleAllocated = _stats.allocated;
+
+    _markTime = 0;
+    _sweepTime = 0;
+    _cycleSurvived = 0;
+    _cycleFreed = 0;
+    _cycleScanned = 0;
+}
+
+void
+GC::startCycle()
+{
+    assert(_phase == PHASE_IDLE);
+    assert(!_marking);
+    assert(_gray.empty());
+
+#ifdef GNASH_GC_DEBUG 
+    ++_collectorRuns;
+    log_debug("GC: incremental collection cycle started - %d/%d new "
+            "resources allocated since last run (from %d to %d)",
+            _resListSize - _lastResCount, _maxNewCollectablesCount,
+            _lastResCount, _resListSize);
+#endif
+
+    _phase = PHASE_MARK;
+    _marking = this;
+    _newSinceStep = 0;
+
+    // This only queues the resources held by the root.
+    markReachable();
+}
+
+void
+GC::step()
+{
+    // Keep ahead of the program: each resource created since the last
+    // step will have to be scanned or swept.
+    StepBudget budget(_frameBudget, _newSinceStep * 2);
+    _newSinceStep = 0;
+
+    const Clock::time_point start = Clock::now();
+
+    bool done = false;
+
+    if (_phase == PHASE_MARK) {
+        while (!_gray.empty() && !done) {
+            const GcResource* res = _gray.back();
+            _gray.pop_back();
+            scan(res);
+            done = budget.exhausted();
+        }
+        if (!done) finishMarking();
+    }
+
+    const Clock::time_point marked = Clock::now();
+
+    if (_phase == PHASE_SWEEP && !done) {
+        size_t deleted = 0;
+        for (ResList::iterator next = std::next(_sweepPos);
+                next != _sweepList.end() && !done;
+                next = std::next(_sweepPos)) {
+
+            const GcResource* res = *next;
+            if (!res->isReachable()) {
+#if GNASH_GC_DEBUG > 1
+                log_debug("GC: recycling object %p (%s)", res,
+                        typeName(*res));
+#endif
+                _sweepList.erase_after(_sweepPos);
+                ++deleted;
+                delete res;
+            }
+            else {
+                res->clearReachable();
+                ++_sweepPos;
+                ++_cycleSurvived;
+            }
+            done = budget.exhausted();
+        }
+        _resListSize -= deleted;
+        _cycleFreed += deleted;
+
+        if (std::next(_sweepPos) == _sweepList.end()) finishSweep();
+    }
+
+    const Clock::time_point end = Clock::now();
+
+    _markTime += toMs(marked - start);
+    _sweepTime += toMs(end - marked);
+    _stats.pauses.add(toMs(end - start));
+
+    if (_phase == PHASE_IDLE) cycleDone(_cycleSurvived, _cycleFreed);
+}
+
+void
+GC::finishSweep()
+{
+    assert(_phase == PHASE_SWEEP);
+
+    // The survivors are older than anything created during the sweep,
+    // so they go to the end of the list.
+    ResList::iterator last = _resList.before_begin();
+    while (std::next(last) != _resList.end()) ++last;
+    _resList.splice_after(last, _sweepList);
+
+    _sweepPos = _sweepList.before_begin();
+    _phase = PHASE_IDLE;
+    _lastResCount = _resListSize;
+
+#ifdef GNASH_GC_DEBUG 
+    log_debug("GC: incremental collection cycle finished - %d resources "
+            "left", _resListSize);
+#endif
+}
+
+void
+GC::finishMarking()
+{
+    assert(_phase == PHASE_MARK);
+    assert(_marking == this);
+
+    while (!_gray.empty()) {
+        const GcResource* res = _gray.back();
+        _gray.pop_back();
+        scan(res);
+    }
+
+    // From here on setReachable() scans immediately.
+    _marking = nullptr;
+
+    // Roots and resources without write barriers may have been given
+    // references to unmarked resources since they were scanned.
+    markReachable();
+    for (const GcResource* res : _rescan) {
+        res->markReachableResources();
+    }
+    _rescan.clear();
+
+    // Anything created from now on is not part of this cycle.
+    _sweepList.swap(_resList);
+    _sweepPos = _sweepList.before_begin();
+    _phase = PHASE_SWEEP;
+}
+
+void
+GC::scan(const GcResource* res)
+{
+    res->markReachableResources();
+    if (!res->writeBarriered()) _rescan.push_back(res);
+    ++_cycleScanned;
+}
+
+void
+GC::finishCycle()
+{
+    if (_phase == PHASE_IDLE) return;
+
+    const double budget = _frameBudget;
+    _frameBudget = 0;
+    step();
+    _frameBudget = budget;
+
+    assert(_phase == PHASE_IDLE);
 }
 
 void
@@ -133,6 +453,9 @@ GC::countCollectables(CollectablesCount& count) const
     for (const GcResource* resource : _resList) {
         ++count[typeName(*resource)];
     }
+    for (const GcResource* resource : _sweepList) {
+        ++count[typeName(*resource)];
+    }
 }
 
 } // end of namespace gnash
@@ -31,10 +31,14 @@
 
 #include <forward_list>
 #include <map>
+#include <vector>
 #include <string>
 #include <cassert>
+#include <cstdint>
+#include <chrono>
 
 #include "dsodefs.h"
+#include "MemoryPool.h"
 #ifdef GNASH_GC_DEBUG
 # include "log.h"
 # include "utility.h"
@@ -88,28 +92,9 @@ public:
     /// object.
     //
     /// If the object wasn't reachable before, this call triggers
-    /// scan of all contained objects too.
-    void setReachable() const {
-
-        if (_reachable) {
-
-#if GNASH_GC_DEBUG > 2
-            log_debug(_("Instance %p of class %s already reachable, "
-                    "setReachable doing nothing"), (void*)this,
-                    typeName(*this));
-#endif
-            return;
-        }
-
-#if GNASH_GC_DEBUG  > 2
-        log_debug(_("Instance %p of class %s set to reachable, scanning "
-                "reachable resources from it"), (void*)this,
-                typeName(*this));
-#endif
-
-        _reachable = true;
-        markReachableResources();
-    }
+    /// scan of all contained objects too. During an incremental
+    /// collection the scan is deferred to a later GC step.
+    void setReachable() const;
 
     /// Return true if this object is marked as reachable
     bool isReachable() const { return _reachable; }
@@ -117,6 +102,31 @@ public:
     /// Clear the reachable flag
     void clearReachable() const { _reachable = false; }
 
+    /// Whether all references held by this resource are updated with
+    /// a write barrier.
+    //
+    /// An incremental collection lets the program run between marking
+    /// steps. References stored into a resource that was already scanned
+    /// are only seen if the store calls setReachable() on the new value
+    /// while GC::incrementalMarking() is true. Resources returning false
+    /// here are scanned again when marking completes, all in one pause,
+    /// so the pause is only short if most resources return true.
+    ///
+    /// The default implementation returns false.
+    virtual bool writeBarriered() const { return false; }
+
+    /// Resources come from a MemoryPool, as most of them are small.
+    //
+    /// They may only be created and deleted on the thread running
+    /// ActionScript.
+    static void* operator new(size_t size) {
+        return MemoryPool::allocate(size);
+    }
+
+    static void operator delete(void* p, size_t size) {
+        MemoryPool::deallocate(p, size);
+    }
+
 protected:
 
     /// Scan all GC resources reachable by this instance.
@@ -154,6 +164,98 @@ private:
 
 };
 
+/// A histogram of durations, in milliseconds.
+//
+/// Bucket 0 counts durations below 1/8 ms, each further bucket
+/// durations up to twice as long as the previous one. The last bucket
+/// has no upper bound.
+class DSOEXPORT TimeHistogram
+{
+public:
+
+    static const size_t Buckets = 12;
+
+    TimeHistogram();
+
+    void add(double ms);
+
+    /// Number of durations in a bucket.
+    size_t count(size_t bucket) const { return _counts[bucket]; }
+
+    /// The exclusive upper bound of a bucket, in milliseconds.
+    //
+    /// @return     The bound, or 0 for the last bucket.
+    static double bound(size_t bucket);
+
+    /// Number of durations added.
+    size_t total() const { return _total; }
+
+    /// The longest duration added.
+    double max() const { return _max; }
+
+    /// The sum of all durations added.
+    double sum() const { return _sum; }
+
+private:
+    size_t _counts[Buckets];
+    size_t _total;
+    double _max;
+    double _sum;
+};
+
+/// Statistics about the work done by a GC.
+//
+/// Times are in milliseconds. An incremental cycle's mark and sweep
+/// times are the sum of its steps; each step is a separate pause.
+struct GcStats
+{
+    GcStats();
+
+    /// Completed collection cycles.
+    size_t cycles;
+
+    /// Resources kept by a cycle, summed over all cycles.
+    std::uint64_t survived;
+
+    /// Resources deleted, over all cycles.
+    std::uint64_t freed;
+
+    /// Resources registered since the GC was created.
+    std::uint64_t allocated;
+
+    /// Resources scanned by incremental marking, over all cycles.
+    //
+    /// Cycles run at once mark recursively and don't count here.
+    std::uint64_t scanned;
+
+    /// Resources kept by the last cycle.
+    size_t lastSurvived;
+
+    /// Resources deleted by the last cycle.
+    size_t lastFreed;
+
+    /// Resources scanned by incremental marking in the last cycle.
+    size_t lastScanned;
+
+    /// Mark time of the last cycle.
+    double lastMarkTime;
+
+    /// Sweep time of the last cycle.
+    double lastSweepTime;
+
+    /// Resources registered per second between the last two cycles.
+    double allocationRate;
+
+    /// Mark time of each cycle.
+    TimeHistogram markTimes;
+
+    /// Sweep time of each cycle.
+    TimeHistogram sweepTimes;
+
+    /// Duration of each interruption of the program by the GC.
+    TimeHistogram pauses;
+};
+
 /// Garbage collector singleton
 //
 /// Instances of this class manage a list of heap pointers (collectables),
@@ -199,6 +301,13 @@ public:
 #endif
 
         _resList.emplace_front(item); ++_resListSize;
+        ++_newSinceStep;
+        ++_stats.allocated;
+
+        // Anything created while marking is in progress survives this
+        // cycle. It is scanned like any other marked resource, as
+        // references may have been stored into it without a barrier.
+        if (_marking == this) item->setReachable();
 
 #if GNASH_GC_DEBUG > 1
         log_debug(_("GC: collectable %p added, num collectables: %d"), item, 
@@ -237,6 +346,15 @@ public:
         //  - Adapt X (maxNewCollectablesCount) based on cost/advantage
         //    runtime analisys
         //
+        // With a frame budget (gcFrameBudget in gnashrc) a cycle is
+        // spread over as many calls as needed, each doing about as much
+        // work as fits in the budget.
+        //
+
+        if (_phase != PHASE_IDLE) {
+            step();
+            return;
+        }
 
         if (_resListSize <  _lastResCount + _maxNewCollectablesCount) {
 #if GNASH_GC_DEBUG  > 1
@@ -248,24 +366,99 @@ public:
             return;
         }
 
+        // Only one collector can mark incrementally, as resources
+        // don't know which collector they belong to.
+        if (_frameBudget > 0 && _instances == 1) {
+            startCycle();
+            step();
+            return;
+        }
+
         runCycle();
     }
 
     /// Run the collection cycle
     //
     /// Find all reachable collectables, destroy all the others.
+    /// An incremental cycle in progress is completed first.
     ///
     void runCycle();
 
+    /// Set the time an incremental collection may take per call to
+    /// fuzzyCollect(), in milliseconds.
+    //
+    /// 0 runs each collection cycle at once.
+    void setFrameBudget(double ms) { _frameBudget = ms; }
+
+    /// Whether a collector is marking incrementally.
+    //
+    /// While this is true, code storing a reference to a resource into
+    /// a resource that returns true from writeBarriered() must call
+    /// setReachable() on the stored resource.
+    static bool incrementalMarking() { return _marking; }
+
+    /// Scan a resource again when marking completes.
+    //
+    /// A resource whose writeBarriered() becomes false must be passed
+    /// here, as it may have been scanned already and references stored
+    /// into it from now on are not marked. This does nothing unless a
+    /// collector is marking incrementally.
+    static void rescan(const GcResource* res) {
+        if (_marking && res->isReachable()) _marking->_rescan.push_back(res);
+    }
+
     typedef std::map<std::string, unsigned int> CollectablesCount;
 
     /// Count collectables
     void countCollectables(CollectablesCount& count) const;
 
+    /// Statistics about the work done so far.
+    const GcStats& stats() const { return _stats; }
+
+    /// Number of resources currently managed.
+    size_t collectables() const { return _resListSize; }
+
 private:
 
+    friend class GcResource;
+
     /// List of collectables
-    typedef std::forward_list<const GcResource*> ResList;
+    typedef std::forward_list<const GcResource*,
+            PoolAllocator<const GcResource*> > ResList;
+
+    enum Phase
+    {
+        PHASE_IDLE,
+        PHASE_MARK,
+        PHASE_SWEEP
+    };
+
+    /// Start an incremental collection cycle.
+    void startCycle();
+
+    /// Advance an incremental collection cycle by one frame budget.
+    void step();
+
+    /// Move the survivors of a finished incremental sweep back to the
+    /// list of collectables.
+    void finishSweep();
+
+    /// Scan a marked resource during an incremental cycle.
+    void scan(const GcResource* res);
+
+    /// Mark all reachable resources not found by incremental marking.
+    //
+    /// Called when there is nothing left to scan. This rescans the root
+    /// and the marked resources not using write barriers, then prepares
+    /// the sweep. These are all rescanned in the same pause, so its
+    /// length grows with their number.
+    void finishMarking();
+
+    /// Complete an incremental cycle in progress, if any.
+    void finishCycle();
+
+    /// Record a completed cycle in the statistics.
+    void cycleDone(size_t survived, size_t freed);
 
     /// Mark all reachable resources
     void markReachable() {
@@ -297,6 +490,55 @@ private:
     /// collect() call.
     ResList::size_type _lastResCount;
 
+    /// Milliseconds an incremental step may take, 0 for none.
+    double _frameBudget;
+
+    /// The current phase of an incremental cycle.
+    Phase _phase;
+
+    /// Marked resources whose references haven't been scanned yet.
+    std::vector<const GcResource*> _gray;
+
+    /// Scanned resources without write barriers, to scan again when
+    /// marking completes.
+    std::vector<const GcResource*> _rescan;
+
+    /// The resources being swept by an incremental cycle.
+    //
+    /// Resources created during the sweep go to _resList.
+    ResList _sweepList;
+
+    /// The element before the next one to sweep in _sweepList.
+    ResList::iterator _sweepPos;
+
+    /// Number of resources created since the last incremental step.
+    size_t _newSinceStep;
+
+    GcStats _stats;
+
+    /// Time spent marking and sweeping in the current cycle.
+    double _markTime;
+    double _sweepTime;
+
+    /// Resources kept and deleted so far by the current cycle.
+    size_t _cycleSurvived;
+    size_t _cycleFreed;
+
+    /// Resources scanned so far by the current cycle.
+    size_t _cycleScanned;
+
+    /// When the last cycle finished.
+    std::chrono::steady_clock::time_point _lastCycleEnd;
+
+    /// _stats.allocated when the last cycle finished.
+    std::uint64_t _lastCycleAllocated;
+
+    /// The collector doing incremental marking, if any.
+    static GC* _marking;
+
+    /// Number of collectors in existence.
+    static size_t _instances;
+
 #ifdef GNASH_GC_DEBUG 
     /// Number of times the collector runs (stats/profiling)
     size_t _collectorRuns;
@@ -311,6 +553,35 @@ inline GcResource::GcResource(GC& gc)
     gc.addCollectable(this);
 }
 
+inline void
+GcResource::setReachable() const
+{
+    if (_reachable) {
+
+#if GNASH_GC_DEBUG > 2
+        log_debug(_("Instance %p of class %s already reachable, "
+                "setReachable doing nothing"), (void*)this,
+                typeName(*this));
+#endif
+        return;
+    }
+
+#if GNASH_GC_DEBUG  > 2
+    log_debug(_("Instance %p of class %s set to reachable, scanning "
+            "reachable resources from it"), (void*)this,
+            typeName(*this));
+#endif
+
+    _reachable = true;
+
+    if (GC::_marking) {
+        GC::_marking->_gray.push_back(this);
+        return;
+    }
+
+    markReachableResources();
+}
+
 } // namespace gnash
 
 #endif // GNASH_GC_H
@@ -153,7 +153,18 @@ public:
     /// @return unreliable input size, (size_t)-1 if not known. 
     ///
     virtual size_t size() const { return static_cast<size_t>(-1); }
-   
+
+    /// Map the whole stream into memory, if it can be.
+    //
+    /// Only channels with all their data at hand, such as local files,
+    /// can do this. Readers can then use the data directly instead of
+    /// going through read(). Reading from the channel is not affected.
+    ///
+    /// @return the first of size() bytes, valid as long as the channel,
+    ///         or 0 if the stream can't be mapped.
+    ///
+    virtual const std::uint8_t* map() { return nullptr; }
+
 };
 
 } // namespace gnash
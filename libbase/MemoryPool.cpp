@@ -0,0 +1,135 @@
+// MemoryPool.cpp: pooled allocation of small objects, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "MemoryPool.h"
+
+#include <cassert>
+#include <thread>
+
+namespace gnash {
+
+namespace {
+
+/// The size classes are multiples of this, which also gives the
+/// alignment of blocks.
+const size_t Granularity = 16;
+
+const size_t Classes = MemoryPool::MaxSize / Granularity;
+
+/// The size of the chunks carved into blocks.
+const size_t ChunkSize = 16384;
+
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+// These are zero-initialized before any constructor runs, so the pool
+// can be used during static initialization.
+FreeBlock* freeLists[Classes];
+MemoryPool::Stats poolStats;
+
+#ifndef NDEBUG
+/// The thread that first used the pool.
+std::thread::id owner;
+
+/// Whether the calling thread is the one using the pool.
+bool
+ownerThread()
+{
+    const std::thread::id self = std::this_thread::get_id();
+    if (owner == std::thread::id()) owner = self;
+    return owner == self;
+}
+#endif
+
+inline size_t
+sizeClass(size_t size)
+{
+    return (size - 1) / Granularity;
+}
+
+/// Allocate a chunk for a size class and return its first block.
+FreeBlock*
+refill(size_t cls)
+{
+    const size_t blockSize = (cls + 1) * Granularity;
+    char* chunk = static_cast<char*>(::operator new(ChunkSize));
+
+    for (size_t i = ChunkSize / blockSize - 1; i > 0; --i) {
+        FreeBlock* b = reinterpret_cast<FreeBlock*>(chunk + i * blockSize);
+        b->next = freeLists[cls];
+        freeLists[cls] = b;
+    }
+
+    ++poolStats.chunks;
+    return reinterpret_cast<FreeBlock*>(chunk);
+}
+
+} // anonymous namespace
+
+void*
+MemoryPool::allocate(size_t size)
+{
+    assert(ownerThread());
+
+    if (!size) size = 1;
+
+    if (size > MaxSize) {
+        ++poolStats.oversized;
+        return ::operator new(size);
+    }
+
+    const size_t cls = sizeClass(size);
+    FreeBlock* b = freeLists[cls];
+    if (b) freeLists[cls] = b->next;
+    else b = refill(cls);
+
+    ++poolStats.allocations;
+    ++poolStats.inUse;
+    return b;
+}
+
+void
+MemoryPool::deallocate(void* p, size_t size)
+{
+    if (!p) return;
+    assert(ownerThread());
+    if (!size) size = 1;
+
+    if (size > MaxSize) {
+        ::operator delete(p);
+        return;
+    }
+
+    const size_t cls = sizeClass(size);
+    FreeBlock* b = static_cast<FreeBlock*>(p);
+    b->next = freeLists[cls];
+    freeLists[cls] = b;
+
+    --poolStats.inUse;
+}
+
+const MemoryPool::Stats&
+MemoryPool::stats()
+{
+    return poolStats;
+}
+
+} // namespace gnash
@@ -0,0 +1,113 @@
+// MemoryPool.h: pooled allocation of small objects, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_MEMORYPOOL_H
+#define GNASH_MEMORYPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "dsodefs.h"
+
+namespace gnash {
+
+/// Fixed size blocks for small objects that are created and destroyed
+/// in large numbers.
+//
+/// Blocks are grouped in size classes of 16 bytes. Each class keeps a
+/// list of free blocks, refilled by carving up larger chunks, so most
+/// allocations and deallocations just pop or push a list element.
+/// Chunks are kept for reuse until the program ends. Larger sizes are
+/// passed on to the global allocator.
+//
+/// Like the GC, the pool is not thread-safe: only the thread running
+/// ActionScript may use it. This means GcResources, Properties and
+/// containers using a PoolAllocator may only be created and destroyed
+/// on that thread. Debug builds assert that the pool is always used by
+/// the thread that used it first.
+class DSOEXPORT MemoryPool
+{
+public:
+
+    /// The largest size served from a pool.
+    static const size_t MaxSize = 256;
+
+    struct Stats
+    {
+        /// Blocks handed out from pools.
+        std::uint64_t allocations;
+
+        /// Chunks obtained from the global allocator.
+        std::uint64_t chunks;
+
+        /// Requests too large for a pool.
+        std::uint64_t oversized;
+
+        /// Blocks currently in use.
+        std::uint64_t inUse;
+    };
+
+    /// Allocate memory for an object of the given size.
+    static void* allocate(size_t size);
+
+    /// Release memory obtained from allocate().
+    //
+    /// @param size     The size passed to allocate().
+    static void deallocate(void* p, size_t size);
+
+    static const Stats& stats();
+};
+
+/// A standard allocator using MemoryPool, for node based containers.
+template<typename T>
+class PoolAllocator
+{
+public:
+    typedef T value_type;
+
+    PoolAllocator() {}
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(MemoryPool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        MemoryPool::deallocate(p, n * sizeof(T));
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&)
+{
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&)
+{
+    return false;
+}
+
+} // namespace gnash
+
+#endif
@@ -121,7 +121,18 @@ RcInitFile::RcInitFile()
     _ignoreShowMenu(true),
     _scriptsTimeout(15),
     _scriptsRecursionLimit(256),
-    _lockScriptLimits(false)
+    _lockScriptLimits(false),
+    _predecodeActions(false),
+    _gcFrameBudget(0),
+    _profileFrames(0),
+    _renderThreads(1),
+    _rendererCaches(true),
+    _renderPipeline(false),
+    _retainCommands(true),
+    _bitmapCacheSize(64),
+    _decodeThreads(0),
+    _bitmapLibrarySize(64),
+    _swfCacheSize(256)
 {
     expandPath(_solsandbox);
     loadFiles();
@@ -461,6 +472,24 @@ RcInitFile::parseFile(const std::string& filespec)
                 continue;
             }
 
+            if (noCaseCompare(variable, "gcStatsFile")) {
+                expandPath(value);
+                _gcStatsFile = value;
+                continue;
+            }
+
+            if (noCaseCompare(variable, "profileFile")) {
+                expandPath(value);
+                _profileFile = value;
+                continue;
+            }
+
+            if (noCaseCompare(variable, "swfCacheDir")) {
+                expandPath(value);
+                _swfCacheDir = value;
+                continue;
+            }
+
             if (noCaseCompare(variable, "mediaDir") ) {
                 expandPath(value);
                 _mediaCacheDir = value;
@@ -620,6 +649,39 @@ RcInitFile::parseFile(const std::string& filespec)
 			||
                  extractSetting(_lockScriptLimits, "lockScriptLimits", variable,
                            value)
+			||
+                 extractSetting(_predecodeActions, "predecodeActions", variable,
+                           value)
+			||
+                 extractDouble(_gcFrameBudget, "gcFrameBudget", variable,
+                           value)
+			||
+                 extractNumber(_profileFrames, "profileFrames", variable,
+                           value)
+			||
+                 extractNumber(_renderThreads, "renderThreads", variable,
+                           value)
+			||
+                 extractSetting(_rendererCaches, "rendererCaches", variable,
+                           value)
+			||
+                 extractSetting(_renderPipeline, "renderPipeline", variable,
+                           value)
+			||
+                 extractSetting(_retainCommands, "retainCommands", variable,
+                           value)
+			||
+                 extractNumber(_bitmapCacheSize, "bitmapCacheSize", variable,
+                           value)
+			||
+                 extractNumber(_decodeThreads, "decodeThreads", variable,
+                           value)
+			||
+                 extractNumber(_bitmapLibrarySize, "bitmapLibrarySize",
+                           variable, value)
+			||
+                 extractNumber(_swfCacheSize, "swfCacheSize", variable,
+                           value)
             ||
                  cerr << boost::format(_("Warning: unrecognized directive "
                              "\"%s\" in rcfile %s line %d")) 
@@ -785,6 +847,17 @@ RcInitFile::updateFile(const std::string& filespec)
     cmd << "scriptsTimeout " << _scriptsTimeout << endl <<
     cmd << "scriptsRecursionLimit " << _scriptsRecursionLimit << endl <<
     cmd << "lockScriptLimits " << _lockScriptLimits << endl <<
+    cmd << "predecodeActions " << _predecodeActions << endl <<
+    cmd << "gcFrameBudget " << _gcFrameBudget << endl <<
+    cmd << "profileFrames " << _profileFrames << endl <<
+    cmd << "renderThreads " << _renderThreads << endl <<
+    cmd << "rendererCaches " << _rendererCaches << endl <<
+    cmd << "renderPipeline " << _renderPipeline << endl <<
+    cmd << "retainCommands " << _retainCommands << endl <<
+    cmd << "bitmapCacheSize " << _bitmapCacheSize << endl <<
+    cmd << "decodeThreads " << _decodeThreads << endl <<
+    cmd << "bitmapLibrarySize " << _bitmapLibrarySize << endl <<
+    cmd << "swfCacheSize " << _swfCacheSize << endl <<
    
     // Strings.
 
@@ -801,6 +874,9 @@ RcInitFile::updateFile(const std::string& filespec)
     cmd << "flashSystemOS " << _flashSystemOS << endl <<
     cmd << "flashVersionString " << _flashVersionString << endl <<
     cmd << "urlOpenerFormat " << _urlOpenerFormat << endl <<
+    cmd << "gcStatsFile " << _gcStatsFile << endl <<
+    cmd << "profileFile " << _profileFile << endl <<
+    cmd << "swfCacheDir " << _swfCacheDir << endl <<
     cmd << "GSTAudioSink " << _gstaudiosink << endl;
 
     // Lists. These can't be handled very well at the moment. The main
@@ -358,6 +358,76 @@ public:
 
     bool lockScriptLimits() const { return _lockScriptLimits; }
 
+    bool predecodeActions() const { return _predecodeActions; }
+
+    void predecodeActions(bool x) { _predecodeActions = x; }
+
+    /// The milliseconds the garbage collector may take per frame
+    double getGCFrameBudget() const { return _gcFrameBudget; }
+
+    /// Set the milliseconds the garbage collector may take per frame
+    void setGCFrameBudget(double x) { _gcFrameBudget = x; }
+
+    /// The file garbage collector statistics are written to on request
+    const std::string& getGCStatsFile() const { return _gcStatsFile; }
+
+    void setGCStatsFile(const std::string& x) { _gcStatsFile = x; }
+
+    /// The number of frames the frame profiler keeps, 0 if disabled
+    unsigned int getProfileFrames() const { return _profileFrames; }
+
+    void setProfileFrames(unsigned int x) { _profileFrames = x; }
+
+    /// The file frame profiles are written to
+    const std::string& getProfileFile() const { return _profileFile; }
+
+    void setProfileFile(const std::string& x) { _profileFile = x; }
+
+    /// The number of threads the AGG renderer draws with
+    unsigned int getRenderThreads() const { return _renderThreads; }
+
+    void setRenderThreads(unsigned int x) { _renderThreads = x; }
+
+    /// Whether the AGG renderer keeps converted shapes and glyphs
+    bool rendererCaches() const { return _rendererCaches; }
+
+    void rendererCaches(bool x) { _rendererCaches = x; }
+
+    /// Whether frames are drawn by a thread while the next one advances
+    bool renderPipeline() const { return _renderPipeline; }
+
+    void renderPipeline(bool x) { _renderPipeline = x; }
+
+    /// Whether the drawing calls of unchanged clips are used again
+    bool retainCommands() const { return _retainCommands; }
+
+    void retainCommands(bool x) { _retainCommands = x; }
+
+    /// The most memory cached DisplayObject images take, in megabytes
+    unsigned int getBitmapCacheSize() const { return _bitmapCacheSize; }
+
+    void setBitmapCacheSize(unsigned int x) { _bitmapCacheSize = x; }
+
+    /// The number of threads decoding definitions while a movie loads
+    unsigned int getDecodeThreads() const { return _decodeThreads; }
+
+    void setDecodeThreads(unsigned int x) { _decodeThreads = x; }
+
+    /// The most memory decoded library bitmaps take, in megabytes
+    unsigned int getBitmapLibrarySize() const { return _bitmapLibrarySize; }
+
+    void setBitmapLibrarySize(unsigned int x) { _bitmapLibrarySize = x; }
+
+    /// The directory inflated SWF files are kept in, empty if disabled
+    const std::string& getSWFCacheDir() const { return _swfCacheDir; }
+
+    void setSWFCacheDir(const std::string& x) { _swfCacheDir = x; }
+
+    /// The most disk space the SWF cache takes, in megabytes
+    unsigned int getSWFCacheSize() const { return _swfCacheSize; }
+
+    void setSWFCacheSize(unsigned int x) { _swfCacheSize = x; }
+
     void dump();    
 
 protected:
@@ -624,6 +694,48 @@ protected:
 
     /// Whether to ignore SWF ScriptLimits tags 
     bool _lockScriptLimits;
+
+    /// Whether to execute AVM1 code from a pre-decoded action stream
+    bool _predecodeActions;
+
+    /// Milliseconds of garbage collection per frame, 0 for no limit
+    double _gcFrameBudget;
+
+    /// Where to write garbage collector statistics, empty for stderr
+    std::string _gcStatsFile;
+
+    /// Frames kept by the frame profiler, 0 to disable it
+    unsigned int _profileFrames;
+
+    /// Where to write frame profiles, empty for stderr
+    std::string _profileFile;
+
+    /// Threads the AGG renderer draws with, 1 to draw on the calling thread
+    unsigned int _renderThreads;
+
+    /// Whether to keep shapes and glyphs converted for drawing
+    bool _rendererCaches;
+
+    /// Whether to draw frames in a thread while the next one advances
+    bool _renderPipeline;
+
+    /// Whether to record unchanged clips by copying their last commands
+    bool _retainCommands;
+
+    /// Megabytes of images kept for cacheAsBitmap and filters
+    unsigned int _bitmapCacheSize;
+
+    /// Threads decoding shapes and fonts, 0 for the loading thread
+    unsigned int _decodeThreads;
+
+    /// Megabytes of decoded bitmaps not used in the last frame
+    unsigned int _bitmapLibrarySize;
+
+    /// Where to keep inflated SWF files between runs, empty for nowhere
+    std::string _swfCacheDir;
+
+    /// Megabytes of disk the SWF cache takes, 0 for no limit
+    unsigned int _swfCacheSize;
 };
 
 // End of gnash namespace 
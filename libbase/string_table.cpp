@@ -23,6 +23,8 @@
 #endif
 
 #include <boost/algorithm/string/case_conv.hpp>
+#include <functional>
+#include <cassert>
 
 //#define DEBUG_STRING_TABLE 1
 //#define GNASH_STATS_STRING_TABLE_NOCASE 1
@@ -36,30 +38,121 @@ namespace gnash {
 
 const std::string string_table::_empty;
 
+namespace {
+
+inline std::size_t
+hashString(const std::string& s)
+{
+    return std::hash<std::string>()(s);
+}
+
+}
+
+string_table::Index::Index(std::size_t size)
+    :
+    mask(size - 1),
+    slots(new Slot[size]()),
+    used(0)
+{
+}
+
+string_table::string_table()
+    :
+    _index(nullptr),
+    _highestKey(0),
+    _highestKnownLowercase(0)
+{
+    _indices.emplace_back(new Index(1024));
+    _index.store(_indices.back().get(), std::memory_order_release);
+    for (std::atomic<Slot*>& seg : _byKey) seg.store(nullptr);
+}
+
+string_table::~string_table()
+{
+    for (std::atomic<Slot*>& seg : _byKey) delete[] seg.load();
+}
+
+const string_table::Entry*
+string_table::lookup(const std::string& s, std::size_t hash) const
+{
+    const Index* index = _index.load(std::memory_order_acquire);
+
+    for (std::size_t i = hash & index->mask; ; i = (i + 1) & index->mask) {
+        const Entry* e = index->slots[i].load(std::memory_order_acquire);
+        if (!e) return nullptr;
+        if (e->hash == hash && e->value == s) return e;
+    }
+}
+
+const string_table::Entry*
+string_table::add(const std::string& s, std::size_t hash, key k, key nocase)
+{
+    _entries.emplace_back(s, k, hash, nocase);
+    const Entry* e = &_entries.back();
+
+    Index* index = _index.load(std::memory_order_relaxed);
+
+    // Keep the index at most half full, so probe sequences stay short
+    // and always end at an empty slot.
+    if ((index->used + 1) * 2 > index->mask + 1) {
+        Index* bigger = new Index((index->mask + 1) * 2);
+        _indices.emplace_back(bigger);
+        for (std::size_t i = 0; i <= index->mask; ++i) {
+            const Entry* old = index->slots[i].load(std::memory_order_relaxed);
+            if (!old) continue;
+            std::size_t j = old->hash & bigger->mask;
+            while (bigger->slots[j].load(std::memory_order_relaxed)) {
+                j = (j + 1) & bigger->mask;
+            }
+            bigger->slots[j].store(old, std::memory_order_relaxed);
+        }
+        bigger->used = index->used;
+        _index.store(bigger, std::memory_order_release);
+        index = bigger;
+    }
+
+    // The entry is found by key before it can be found by value, so
+    // that a key returned by find() always has a value.
+    std::size_t offset;
+    const std::size_t seg = segment(k, offset);
+    assert(seg < Segments);
+    Slot* slots = _byKey[seg].load(std::memory_order_relaxed);
+    if (!slots) {
+        slots = new Slot[SegmentBase << seg]();
+        _byKey[seg].store(slots, std::memory_order_release);
+    }
+    slots[offset].store(e, std::memory_order_release);
+
+    std::size_t i = hash & index->mask;
+    while (index->slots[i].load(std::memory_order_relaxed)) {
+        i = (i + 1) & index->mask;
+    }
+    index->slots[i].store(e, std::memory_order_release);
+    ++index->used;
+
+    return e;
+}
+
 string_table::key
 string_table::find(const std::string& t_f, bool insert_unfound)
 {
     if (t_f.empty()) return 0;
 
-	table::index<StringValue>::type::iterator i = 
-        _table.get<StringValue>().find(t_f);
+    const std::size_t hash = hashString(t_f);
 
-	if (i == _table.get<StringValue>().end()) {
+    const Entry* e = lookup(t_f, hash);
+    if (e) return e->id;
 
-		if (insert_unfound) {
-			// First we lock.
-			std::lock_guard<std::mutex> lock(_lock);
-			// Then we see if someone else managed to sneak past us.
-			i = _table.get<StringValue>().find(t_f);
-			// If they did, use that value.
-			if (i != _table.end()) return i->id;
+    if (!insert_unfound) return 0;
 
-            return already_locked_insert(t_f);
-		}
-        return 0;
-	}
+    // First we lock.
+    std::lock_guard<std::mutex> lock(_lock);
+    // Then we see if someone else managed to sneak past us.
+    e = lookup(t_f, hash);
+    // If they did, use that value.
+    if (e) return e->id;
 
-	return i->id;
+    return already_locked_insert(t_f);
 }
 
 string_table::key
@@ -74,25 +167,30 @@ string_table::insert_group(const svt* l, std::size_t size)
 {
     std::lock_guard<std::mutex> lock(_lock);
     for (std::size_t i = 0; i < size; ++i) {
-        // Copy to avoid changing the original table.
-        const svt s = l[i];
+        const svt& s = l[i];
 
         // The keys don't have to be consecutive, so any time we find a key
         // that is too big, jump a few keys to avoid rewriting this on every
         // item.
-       if (s.id > _highestKey) _highestKey = s.id + 256;
-       _table.insert(s);
+        if (s.id > _highestKey) _highestKey = s.id + 256;
+
+        const std::size_t hash = hashString(s.value);
+        if (!lookup(s.value, hash) && !getEntry(s.id)) {
+            add(s.value, hash, s.id, 0);
+        }
     }
     
     for (std::size_t i = 0; i < size; ++i) {
-        const svt s = l[i];
+        const svt& s = l[i];
         const std::string& t = boost::to_lower_copy(s.value);
         if (t != s.value) {
-            _caseTable[s.id] = already_locked_insert(t);
+            const key nocase = already_locked_insert(t);
+            const Entry* e = getEntry(s.id);
+            if (e) e->nocase.store(nocase);
         }
     }
 #ifdef DEBUG_STRING_TABLE
-    std::cerr << "string_table group insert end -- size is " << _table.size() << " _caseTable size is " << _caseTable.size() << std::endl; 
+    std::cerr << "string_table group insert end -- size is " << _entries.size() << std::endl; 
 #endif
 
 
@@ -101,37 +199,34 @@ string_table::insert_group(const svt* l, std::size_t size)
 string_table::key
 string_table::already_locked_insert(const std::string& to_insert)
 {
-	const key ret = _table.insert(svt(to_insert, ++_highestKey)).first->id;
-
-#ifdef DEBUG_STRING_TABLE
-    int tscp = 100; // table size checkpoint
-    size_t ts = _table.size();
-    if ( ! (ts % tscp) ) { std::cerr << "string_table size grew to " << ts << std::endl; }
-#endif
+    const std::size_t hash = hashString(to_insert);
+    const Entry* e = lookup(to_insert, hash);
+    const key id = ++_highestKey;
 
     const std::string lower = boost::to_lower_copy(to_insert);
 
-    // Insert the caseless equivalent if it's not there. We're locked for
-    // the whole of this function, so we can do what we like.
+    // Find or insert the caseless equivalent, so that it is known before
+    // the new entry can be seen. We're locked for the whole of this
+    // function, so we can do what we like.
+    key nocase = 0;
     if (lower != to_insert) {
+        const std::size_t lhash = hashString(lower);
+        const Entry* l = lookup(lower, lhash);
+        nocase = l ? l->id : add(lower, lhash, ++_highestKey, 0)->id;
+    }
 
-        // Find the caseless value in the table
-        table::index<StringValue>::type::iterator it = 
-            _table.get<StringValue>().find(lower);
-
-        const key nocase = (it == _table.end()) ? 
-            _table.insert(svt(lower, ++_highestKey)).first->id : it->id;
+    if (e) {
+        if (nocase) e->nocase.store(nocase);
+        return e->id;
+    }
 
 #ifdef DEBUG_STRING_TABLE
-        ++ts;
-        if ( ! (ts % tscp) ) { std::cerr << "string_table size grew to " << ts << std::endl; }
-#endif // DEBUG_STRING_TABLE
-
-        _caseTable[ret] = nocase;
-
-    }
+    int tscp = 100; // table size checkpoint
+    size_t ts = _entries.size();
+    if ( ! (ts % tscp) ) { std::cerr << "string_table size grew to " << ts << std::endl; }
+#endif
 
-    return ret;
+    return add(to_insert, hash, id, nocase)->id;
 }
 
 void
@@ -150,7 +245,7 @@ string_table::noCase(key a) const
     // Avoid checking keys known to be lowercase
     if ( a <= _highestKnownLowercase ) {
 #if GNASH_PARANOIA_LEVEL > 2
-        assert(_caseTable.find(a) == _caseTable.end());
+        assert(!getEntry(a) || !getEntry(a)->nocase.load());
 #endif
         return a;
     }
@@ -164,8 +259,11 @@ string_table::noCase(key a) const
     //       would speed things up even for unknown 
     //       strings.
 
-    std::map<key, key>::const_iterator i = _caseTable.find(a);
-    if ( i != _caseTable.end() ) return i->second;
+    const Entry* e = getEntry(a);
+    if (e) {
+        const key nocase = e->nocase.load(std::memory_order_acquire);
+        if (nocase) return nocase;
+    }
 
     return a;
 }
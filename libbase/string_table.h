@@ -23,13 +23,16 @@
 // Thread Status: SAFE, except for group functions.
 // The group functions may have strange behavior when trying to automatically
 // lowercase the additions.
+//
+// Lookups of strings and keys already in the table take no lock, so the
+// parser and loader threads don't contend with the ActionScript thread.
+// Only additions are serialized.
 
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/identity.hpp>
-#include <boost/multi_index/member.hpp>
 #include <string>
-#include <map>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <atomic>
 #include <mutex>
 #include "dsodefs.h"
 
@@ -54,31 +57,6 @@ public:
 		std::string value;
 		std::size_t id;
 	};
-    
-    /// A tag to identify the key index.   
-    struct StringID {};
-
-    /// A tag to identify the string index.
-    struct StringValue {};
-
-    /// The container for indexing the strings
-    //
-    /// This contains two indices with no duplicate values:
-    /// 1. An index of unique, case-sensitive strings.
-    /// 2. An index of unique numeric keys.
-	typedef boost::multi_index_container<svt,
-		boost::multi_index::indexed_by<
-
-			boost::multi_index::hashed_unique<
-                boost::multi_index::tag<StringValue>,
-				boost::multi_index::member<svt, std::string, &svt::value> >,
-
-			boost::multi_index::hashed_unique<
-                boost::multi_index::tag<StringID>,
-				boost::multi_index::member<svt, std::size_t, &svt::id>
-
-        > 
-	> > table;
 
 	typedef std::size_t key;
 
@@ -101,11 +79,8 @@ public:
     ///             given.
 	const std::string& value(key to_find) const
 	{
-		if (_table.empty() || !to_find) return _empty;
-
-		table::index<StringID>::type::iterator r =
-            _table.get<StringID>().find(to_find);
-		return (r == _table.get<StringID>().end()) ? _empty : r->value;
+		const Entry* e = getEntry(to_find);
+		return e ? e->value : _empty;
 	}
 
 	/// Insert a string with auto-assigned id. 
@@ -128,11 +103,9 @@ public:
 	key already_locked_insert(const std::string& to_insert);
 
 	/// Construct the empty string_table
-	string_table()
-        :
-		_highestKey(0),
-		_highestKnownLowercase(0)
-	{}
+	string_table();
+
+	~string_table();
 
     /// Return a caseless equivalent of the passed key.
     //
@@ -147,12 +120,84 @@ public:
 
 private:
 
-	table _table;
+    /// A string in the table. Entries are never changed or removed
+    /// once other threads can see them, except for their caseless key.
+    struct Entry
+    {
+        Entry(std::string v, key k, std::size_t h, key n)
+            :
+            value(std::move(v)),
+            id(k),
+            hash(h),
+            nocase(n)
+        {}
+
+        const std::string value;
+        const key id;
+        const std::size_t hash;
+
+        /// The caseless equivalent, or 0 if this is its own.
+        mutable std::atomic<key> nocase;
+    };
+
+    typedef std::atomic<const Entry*> Slot;
+
+    /// An open addressing hash table of entries by value.
+    //
+    /// Slots are only ever filled, so a reader probing without the lock
+    /// can at worst miss an entry being added. When it fills up, a
+    /// larger copy replaces it; the old one is kept for readers that
+    /// may still be using it.
+    struct Index
+    {
+        explicit Index(std::size_t size);
+
+        const std::size_t mask;
+        std::unique_ptr<Slot[]> slots;
+        std::size_t used;
+    };
+
+    /// Entries by key are stored in segments of doubling size, so that
+    /// they never move.
+    static const std::size_t SegmentBase = 256;
+    static const std::size_t Segments = 48;
+
+    static std::size_t segment(key k, std::size_t& offset) {
+        const std::size_t n = k / SegmentBase + 1;
+        std::size_t s = 0;
+        while (n >> (s + 1)) ++s;
+        offset = k - SegmentBase * ((std::size_t(1) << s) - 1);
+        return s;
+    }
+
+    const Entry* getEntry(key k) const {
+        std::size_t offset;
+        const std::size_t s = segment(k, offset);
+        if (!k || s >= Segments) return nullptr;
+        const Slot* seg = _byKey[s].load(std::memory_order_acquire);
+        return seg ? seg[offset].load(std::memory_order_acquire) : nullptr;
+    }
+
+    /// Find an entry by value without locking.
+    const Entry* lookup(const std::string& s, std::size_t hash) const;
+
+    /// Add a new entry. The lock must be held.
+    const Entry* add(const std::string& s, std::size_t hash, key k,
+            key nocase);
+
+    std::deque<Entry> _entries;
+
+    std::atomic<Index*> _index;
+
+    /// The current index and the ones it replaced.
+    std::vector<std::unique_ptr<Index> > _indices;
+
+    std::atomic<Slot*> _byKey[Segments];
+
 	static const std::string _empty;
 	std::mutex _lock;
 	std::size_t _highestKey;
 
-    std::map<key, key> _caseTable;
     key _highestKnownLowercase;
 };
 
@@ -5,11 +5,19 @@
 
 // A file class that can be customized with callbacks.
 
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
 #include "tu_file.h"
 
 #include <cstdio>
 #include <boost/format.hpp>
 #include <cerrno>
+#include <cstring>
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+#endif
 
 #include "GnashFileUtilities.h"
 #include "utility.h"
@@ -123,6 +131,9 @@ public:
     
     /// Get the size of the stream
     size_t size() const;
+
+    /// Map a regular file into memory.
+    const std::uint8_t* map();
     
 private:
     
@@ -132,6 +143,12 @@ private:
 
     bool _autoclose;
 
+    /// The file mapped into memory, or 0.
+    void* _map;
+
+    /// The size of the mapping.
+    size_t _mapSize;
+
 };
 
 
@@ -139,12 +156,17 @@ private:
 tu_file::tu_file(FILE* fp, bool autoclose = false)
     :
     _data(fp),
-    _autoclose(autoclose)
+    _autoclose(autoclose),
+    _map(nullptr),
+    _mapSize(0)
 {
 }
 
 tu_file::~tu_file()
 {
+#ifdef HAVE_MMAP
+    if (_map) munmap(_map, _mapSize);
+#endif
     // Close this file when destroyed unless not requested.
     if (_autoclose) close();
 }
@@ -223,6 +245,9 @@ tu_file::size() const
 {
     assert(_data);
 
+    // The mapping doesn't change if the file does.
+    if (_map) return _mapSize;
+
     struct stat statbuf;
     if (fstat(fileno(_data), &statbuf) < 0)
     {
@@ -232,6 +257,34 @@ tu_file::size() const
     return statbuf.st_size;
 }
 
+const std::uint8_t*
+tu_file::map()
+{
+#ifdef HAVE_MMAP
+    if (_map) return static_cast<const std::uint8_t*>(_map);
+
+    // Pipes and devices can't be mapped, and an empty file
+    // has nothing to map.
+    struct stat statbuf;
+    if (fstat(fileno(_data), &statbuf) < 0 || !S_ISREG(statbuf.st_mode) ||
+            statbuf.st_size <= 0) {
+        return nullptr;
+    }
+
+    const size_t size = statbuf.st_size;
+    void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileno(_data), 0);
+    if (p == MAP_FAILED) {
+        log_debug("Could not map file: %s", std::strerror(errno));
+        return nullptr;
+    }
+
+    _map = p;
+    _mapSize = size;
+    return static_cast<const std::uint8_t*>(_map);
+#else
+    return nullptr;
+#endif
+}
 
 void
 tu_file::close()
@@ -28,6 +28,11 @@ namespace zlib_adapter
     std::unique_ptr<IOChannel> make_inflater(std::unique_ptr<IOChannel> /*in*/) {
         std::abort(); 
     }
+
+    bool inflate_all(const std::uint8_t* /*in*/, size_t /*size*/,
+            std::vector<std::uint8_t>& /*out*/) {
+        std::abort();
+    }
 }
 
 #else // HAVE_ZLIB_H
@@ -316,6 +321,46 @@ std::unique_ptr<IOChannel> make_inflater(std::unique_ptr<IOChannel> in)
     return std::unique_ptr<IOChannel>(new InflaterIOChannel(std::move(in)));
 }
 
+bool
+inflate_all(const std::uint8_t* in, size_t size, std::vector<std::uint8_t>& out)
+{
+    z_stream zstream = z_stream();
+    zstream.next_in = const_cast<Bytef*>(in);
+    zstream.avail_in = size;
+
+    if (inflateInit(&zstream) != Z_OK) {
+        log_error("inflateInit() failed: %s",
+                zstream.msg ? zstream.msg : "");
+        return false;
+    }
+
+    const size_t start = out.size();
+    out.resize(std::max<size_t>(out.capacity(), start + 65536));
+
+    int status = Z_OK;
+    while (status == Z_OK) {
+
+        if (zstream.total_out == out.size() - start) {
+            out.resize(out.size() * 2);
+        }
+        zstream.next_out = &out[start + zstream.total_out];
+        zstream.avail_out = out.size() - start - zstream.total_out;
+
+        // Without Z_SYNC_FLUSH zlib inflates as much as it can at once.
+        status = inflate(&zstream, Z_NO_FLUSH);
+    }
+
+    out.resize(start + zstream.total_out);
+    inflateEnd(&zstream);
+
+    if (status != Z_STREAM_END) {
+        log_error("inflate() returned %d: %s", status,
+                zstream.msg ? zstream.msg : "");
+        return false;
+    }
+    return true;
+}
+
 }
 
 #endif // HAVE_ZLIB_H
@@ -11,6 +11,9 @@
 #include "dsodefs.h"
 
 #include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
 
 namespace gnash {
 
@@ -32,6 +35,21 @@ namespace zlib_adapter
     DSOEXPORT std::unique_ptr<IOChannel>
         make_inflater(std::unique_ptr<IOChannel> in);
 
+    /// \brief
+    /// Inflates a whole compressed stream held in memory at once.
+    //
+    /// @param in    The compressed data.
+    /// @param size  The number of bytes of compressed data.
+    /// @param out   Receives the inflated data after anything it
+    ///              already holds. Its capacity is used as a guess
+    ///              of the inflated size.
+    ///
+    /// @return false if the data is corrupt or truncated, in which
+    ///         case out holds as much as could be inflated.
+    ///
+    DSOEXPORT bool inflate_all(const std::uint8_t* in, size_t size,
+        std::vector<std::uint8_t>& out);
+
 } // namespace gnash.zlib_adapter
 } // namespace gnash
 
@@ -0,0 +1,260 @@
+// BitmapCache.cpp: the cached image of a DisplayObject, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "BitmapCache.h"
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+#include <cmath>
+
+#include "DisplayObject.h"
+#include "Renderer.h"
+#include "RecordingRenderer.h"
+#include "RenderCommands.h"
+#include "CachedBitmap.h"
+#include "GnashImage.h"
+#include "FillStyle.h"
+#include "Geometry.h"
+#include "Filters.h"
+#include "log.h"
+
+namespace gnash {
+
+namespace {
+
+/// The largest image drawn, in pixels in each direction.
+//
+/// Bigger objects are displayed directly, without filters, as in the
+/// reference player.
+const int maxImageSize = 2880;
+
+} // anonymous namespace
+
+BitmapCacheList::BitmapCacheList(std::size_t limit)
+    :
+    _limit(limit),
+    _usedBytes(0)
+{
+}
+
+void
+BitmapCacheList::expire()
+{
+    _dropped.clear();
+
+    std::vector<BitmapCache*> caches;
+    caches.swap(_evicted);
+    for (BitmapCache* c : caches) c->_owner.set_invalidated();
+}
+
+BitmapCache::BitmapCache(DisplayObject& owner, BitmapCacheList& list)
+    :
+    _owner(owner),
+    _list(list),
+    _valid(false),
+    _volatile(false),
+    _quality(QUALITY_HIGH),
+    _bytes(0)
+{
+}
+
+BitmapCache::~BitmapCache()
+{
+    clear();
+    std::vector<BitmapCache*>& evicted = _list._evicted;
+    evicted.erase(std::remove(evicted.begin(), evicted.end(), this),
+            evicted.end());
+}
+
+void
+BitmapCache::evict()
+{
+    if (_shape) _list._dropped.push_back(std::move(_shape));
+    clear();
+    _list._evicted.push_back(this);
+}
+
+void
+BitmapCache::clear()
+{
+    _valid = false;
+    _shape.reset();
+    if (!_bytes) return;
+
+    _list._used.erase(_used);
+    _list._usedBytes -= _bytes;
+    _bytes = 0;
+}
+
+void
+BitmapCache::use()
+{
+    if (_bytes) _list._used.splice(_list._used.end(), _list._used, _used);
+}
+
+void
+BitmapCache::keep(std::size_t bytes)
+{
+    assert(!_bytes);
+    _bytes = bytes;
+    _list._usedBytes += _bytes;
+    _used = _list._used.insert(_list._used.end(), this);
+
+    // The image just drawn is kept even if it is too big on its own.
+    while (_list._usedBytes > _list._limit && _list._used.front() != this) {
+        _list._used.front()->evict();
+    }
+}
+
+bool
+BitmapCache::reusable(const DisplayObject& obj, const Transform& xform,
+        const SWFMatrix& stage, Quality quality) const
+{
+    if (!_valid || _volatile) return false;
+    if (obj.contentInvalidated() || obj.childInvalidated()) return false;
+    if (!(_stage == stage) || _quality != quality) return false;
+    if (!(_xform.colorTransform == xform.colorTransform)) return false;
+
+    // Anything but moving changes the pixels.
+    const SWFMatrix& m = xform.matrix;
+    const SWFMatrix& old = _xform.matrix;
+    return m.a() == old.a() && m.b() == old.b() && m.c() == old.c() &&
+        m.d() == old.d();
+}
+
+void
+BitmapCache::display(DisplayObject& obj, Renderer& renderer,
+        const Transform& base)
+{
+    const Transform xform = base * obj.transform();
+    const SWFMatrix stage = RecordingRenderer::stageMatrix(renderer);
+
+    if (!reusable(obj, xform, stage, renderer.quality())) {
+        clear();
+        _xform = xform;
+        _stage = stage;
+        _quality = renderer.quality();
+        _valid = draw(obj, renderer, base);
+        if (!_valid) {
+            if (obj.boundsInClippingArea(renderer)) obj.display(renderer, base);
+            else obj.omit_display();
+            return;
+        }
+    }
+    else {
+        obj.omit_display();
+        use();
+    }
+
+    if (_volatile) RecordingRenderer::markVolatile(renderer);
+    if (!_shape) return;
+
+    // The image is moved by whole pixels, so that it looks the same.
+    const double xscale = _stage.get_x_scale();
+    const double yscale = _stage.get_y_scale();
+    const long dx = std::lround((xform.matrix.tx() - _xform.matrix.tx()) *
+            xscale);
+    const long dy = std::lround((xform.matrix.ty() - _xform.matrix.ty()) *
+            yscale);
+
+    SWFMatrix offset;
+    offset.set_translation(std::lround(dx / xscale), std::lround(dy / yscale));
+    renderer.drawShape(*_shape, Transform(offset));
+}
+
+bool
+BitmapCache::draw(DisplayObject& obj, Renderer& renderer,
+        const Transform& base)
+{
+    SWFRect bounds = obj.getBounds();
+    _xform.matrix.transform(bounds);
+
+    _volatile = false;
+
+    // Nothing is drawn, so there is nothing to keep.
+    if (bounds.is_null()) {
+        obj.omit_display();
+        return true;
+    }
+    geometry::Range2d<int> pixels = renderer.world_to_pixel(bounds);
+    if (!pixels.isFinite()) return false;
+    pixels.growBy(margin(obj.filters()));
+
+    const int left = pixels.getMinX();
+    const int top = pixels.getMinY();
+    const int width = pixels.width() + 1;
+    const int height = pixels.height() + 1;
+    if (width > maxImageSize || height > maxImageSize) return false;
+
+    std::unique_ptr<image::GnashImage> im(new image::ImageRGBA(width, height));
+    std::fill(im->begin(), im->end(), 0);
+
+    // The object is recorded before it is drawn, to know whether it
+    // draws anything volatile.
+    {
+        Renderer::Internal in(renderer, *im);
+        Renderer* internal = in.renderer();
+        if (!internal) return false;
+        internal->setQuality(_quality);
+
+        internal->set_scale(_stage.get_x_scale() * 20,
+                _stage.get_y_scale() * 20);
+        internal->set_translation(_stage.tx() - left, _stage.ty() - top);
+
+        RenderCommands commands;
+        RecordingRenderer rec(*internal, commands);
+        obj.display(rec, base);
+        commands.replay(*internal);
+        _volatile = rec.drewVolatile();
+    }
+
+    for (const auto& f : obj.filters()) f->apply(*im);
+    const std::size_t bytes = im->size();
+
+    // The image is mapped from the stage as the pixels it was drawn from.
+    SWFMatrix mat = _stage;
+    mat.set_translation(_stage.tx() - left, _stage.ty() - top);
+
+    const CachedBitmap* bitmap = renderer.createCachedBitmap(std::move(im));
+
+    const point tl = renderer.pixel_to_world(left, top);
+    const point br = renderer.pixel_to_world(left + width, top + height);
+
+    SWF::Subshape subshape;
+    subshape.addFillStyle(BitmapFill(BitmapFill::CLIPPED, bitmap, mat,
+                BitmapFill::SMOOTHING_OFF));
+
+    Path path(br.x, br.y, 1, 0, 0);
+    path.drawLineTo(br.x, tl.y);
+    path.drawLineTo(tl.x, tl.y);
+    path.drawLineTo(tl.x, br.y);
+    path.drawLineTo(br.x, br.y);
+    subshape.addPath(path);
+
+    _shape.reset(new SWF::ShapeRecord);
+    _shape->addSubshape(subshape);
+    _shape->setBounds(SWFRect(tl.x, tl.y, br.x, br.y));
+
+    keep(bytes);
+    return true;
+}
+
+} // namespace gnash
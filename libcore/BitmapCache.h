@@ -0,0 +1,168 @@
+// BitmapCache.h: the cached image of a DisplayObject, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_BITMAPCACHE_H
+#define GNASH_BITMAPCACHE_H
+
+#include <list>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <boost/noncopyable.hpp>
+
+#include "ShapeRecord.h"
+#include "Transform.h"
+#include "SWFMatrix.h"
+#include "GnashEnums.h"
+
+namespace gnash {
+    class BitmapCache;
+    class DisplayObject;
+    class Renderer;
+}
+
+namespace gnash {
+
+/// The images of the BitmapCaches of one movie_root.
+//
+/// All images together take at most the given memory; the least recently
+/// displayed are dropped to stay under it. Commands recorded for the
+/// frame may still draw a dropped image, so it is only deleted by
+/// expire().
+class BitmapCacheList : boost::noncopyable
+{
+public:
+
+    /// @param limit    The memory the images may take, in bytes.
+    explicit BitmapCacheList(std::size_t limit);
+
+    /// Delete the images dropped since the last call, and invalidate
+    /// their DisplayObjects.
+    //
+    /// Images are dropped while a frame is recorded, and its commands may
+    /// still draw them. Call this once the commands have been replayed,
+    /// or detached so that they draw copies.
+    void expire();
+
+private:
+
+    friend class BitmapCache;
+
+    const std::size_t _limit;
+
+    /// The caches holding images, the least recently used first.
+    std::list<BitmapCache*> _used;
+
+    /// The memory all cached images take.
+    std::size_t _usedBytes;
+
+    /// Images dropped to stay under the limit since the last expire().
+    std::vector<std::unique_ptr<SWF::ShapeRecord> > _dropped;
+
+    /// The caches they were dropped from.
+    std::vector<BitmapCache*> _evicted;
+};
+
+/// The image of a DisplayObject, kept until it changes.
+//
+/// This is used for objects with filters or cacheAsBitmap set. The object
+/// is drawn to an image in pixels of the stage, any filters are applied
+/// to the image, and the image is drawn in place of the object.
+///
+/// The image is drawn again when the object or its children change, or
+/// when it is scaled, rotated, skewed or color transformed. When it is
+/// only moved, the image is moved with it by whole pixels.
+///
+/// The image may be dropped to make room for others in its
+/// BitmapCacheList, whose expire() then invalidates the DisplayObject.
+/// Parents display it again rather than reuse their commands.
+class BitmapCache : boost::noncopyable
+{
+public:
+
+    /// @param owner    The DisplayObject whose image this keeps.
+    /// @param list     The images of its movie_root.
+    BitmapCache(DisplayObject& owner, BitmapCacheList& list);
+
+    ~BitmapCache();
+
+    /// Display a DisplayObject from its image.
+    //
+    /// The object is displayed directly if the renderer can't draw to
+    /// images, or the image would be too big.
+    void display(DisplayObject& obj, Renderer& renderer, const Transform& base);
+
+    /// Drop the image, so that it is drawn again when next displayed.
+    void clear();
+
+private:
+
+    friend class BitmapCacheList;
+
+    /// Draw the object to a new image and apply its filters.
+    //
+    /// @return     false if the image can't be drawn.
+    bool draw(DisplayObject& obj, Renderer& renderer, const Transform& base);
+
+    /// Whether the image can be drawn for the object as it is now.
+    bool reusable(const DisplayObject& obj, const Transform& xform,
+            const SWFMatrix& stage, Quality quality) const;
+
+    /// Count the image as the most recently used.
+    void use();
+
+    /// Count a new image's memory, dropping the least recently used
+    /// images if there is too much.
+    void keep(std::size_t bytes);
+
+    /// Drop the image to make room for another, keeping it until expire().
+    void evict();
+
+    DisplayObject& _owner;
+
+    BitmapCacheList& _list;
+
+    /// A rectangle filled with the image, in world coordinates, or null.
+    std::unique_ptr<SWF::ShapeRecord> _shape;
+
+    /// Whether _shape holds an image of the object.
+    bool _valid;
+
+    /// Whether the image shows something changing without invalidation.
+    bool _volatile;
+
+    /// The world transform of the object when it was drawn.
+    Transform _xform;
+
+    /// How the stage was mapped to pixels when it was drawn.
+    SWFMatrix _stage;
+
+    /// The quality it was drawn with.
+    Quality _quality;
+
+    /// The memory the image takes, 0 when there is none.
+    std::size_t _bytes;
+
+    /// Where this is in the list of caches holding images.
+    std::list<BitmapCache*>::iterator _used;
+};
+
+} // namespace gnash
+
+#endif
@@ -993,8 +993,14 @@ as_value
 button_cacheAsBitmap(const fn_call& fn)
 {
     Button* obj = ensure<IsDisplayObject<Button> >(fn);
-    LOG_ONCE(log_unimpl(_("Button.cacheAsBitmap")));
-    UNUSED(obj);
+
+    if (!fn.nargs) {
+        // Getter
+        return as_value(obj->cacheAsBitmap());
+    }
+
+    // Setter
+    obj->setCacheAsBitmap(toBool(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
@@ -54,6 +54,11 @@ namespace {
     /// 65535 (-16384).
     DisplayList::iterator dlistTagsEffectiveZoneEnd(
             DisplayList::container_type& c);
+
+    /// Add a DisplayObject's invalidated bounds, including what its
+    /// filters or cached image draw outside them.
+    void addInvalidatedBounds(DisplayObject& o, InvalidatedRanges& ranges,
+            bool force);
 	
 }
 
@@ -292,7 +297,8 @@ DisplayList::replaceDisplayObject(DisplayObject* ch, int depth,
 // the specified depth.
 void
 DisplayList::moveDisplayObject(int depth, const SWFCxForm* color_xform,
-        const SWFMatrix* mat, std::uint16_t* ratio)
+        const SWFMatrix* mat, std::uint16_t* ratio,
+        const BitmapFilters* filters, const bool* cacheAsBitmap)
 {
     testInvariant();
 
@@ -321,6 +327,8 @@ DisplayList::moveDisplayObject(int depth, const SWFCxForm* color_xform,
     if (color_xform) ch->setCxForm(*color_xform);
     if (mat) ch->setMatrix(*mat, true);
     if (ratio) ch->set_ratio(*ratio);
+    if (filters) ch->setFilters(*filters);
+    if (cacheAsBitmap) ch->setCacheAsBitmap(*cacheAsBitmap);
 
     testInvariant();
 }
@@ -589,7 +597,11 @@ DisplayList::display(Renderer& renderer, const Transform& base)
             renderer.begin_submit_mask();
         }
         
-        if (ch->boundsInClippingArea(renderer)) {
+        // Cached DisplayObjects may draw outside their bounds.
+        if (!renderAsMask && ch->bitmapCached()) {
+            ch->displayCached(renderer, base);
+        }
+        else if (ch->boundsInClippingArea(renderer)) {
             ch->display(renderer, base);
         }
         else ch->omit_display();
@@ -700,7 +712,7 @@ DisplayList::add_invalidated_bounds(InvalidatedRanges& ranges, bool force)
             
             if (rangesStack.empty()) {
                 // --> normal case for unmasked DisplayObjects
-                dobj->add_invalidated_bounds(ranges, force);
+                addInvalidatedBounds(*dobj, ranges, force);
             }
             else {
                 // --> DisplayObject is masked, so intersect with "mask"
@@ -709,7 +721,7 @@ DisplayList::add_invalidated_bounds(InvalidatedRanges& ranges, bool force)
                 InvalidatedRanges childRanges;
                 childRanges.inheritConfig(ranges);
                 
-                dobj->add_invalidated_bounds(childRanges, force);
+                addInvalidatedBounds(*dobj, childRanges, force);
                 
                 // then intersect ranges with topmost "mask"
                 childRanges.intersect(rangesStack.top());
@@ -968,6 +980,22 @@ dlistTagsEffectiveZoneEnd(DisplayList::container_type& c)
                 0xffff + DisplayObject::staticDepthOffset));
 }
 
+void
+addInvalidatedBounds(DisplayObject& o, InvalidatedRanges& ranges, bool force)
+{
+    const std::int32_t margin = o.drawMargin();
+    if (!margin) {
+        o.add_invalidated_bounds(ranges, force);
+        return;
+    }
+
+    InvalidatedRanges own;
+    own.inheritConfig(ranges);
+    o.add_invalidated_bounds(own, force);
+    own.growBy(margin);
+    ranges.add(own);
+}
+
 } // anonymous namespace
 
 
@@ -30,6 +30,7 @@
 #endif
 
 #include "snappingrange.h"
+#include "Filters.h" // for BitmapFilters
 #include "dsodefs.h" // for DSOTEXPORT
 
 
@@ -160,8 +161,17 @@ public:
 	/// @param ratio
 	/// The new ratio value to assign to the DisplayObject at the given depth.
 	/// If NULL the original ratio will be kept.
+	///
+	/// @param filters
+	/// The bitmap filters to assign to the DisplayObject at the given depth.
+	/// If NULL the original filters will be kept.
+	///
+	/// @param cacheAsBitmap
+	/// Whether the DisplayObject at the given depth is drawn from a cached
+	/// image. If NULL this is not changed.
 	void moveDisplayObject(int depth, const SWFCxForm* color_xform,
-            const SWFMatrix* mat, std::uint16_t* ratio);
+            const SWFMatrix* mat, std::uint16_t* ratio,
+            const BitmapFilters* filters, const bool* cacheAsBitmap);
 
 	/// Removes the object at the specified depth.
 	//
@@ -26,7 +26,10 @@
 
 #include <utility>
 #include <functional>
+#include <algorithm>
+#include <cmath>
 #include <boost/logic/tribool.hpp>
+#include <boost/tuple/tuple.hpp>
 
 #include "movie_root.h"
 #include "MovieClip.h"
@@ -42,6 +45,9 @@
 #include "GnashNumeric.h"
 #include "Global_as.h"
 #include "Renderer.h"
+#include "RecordingRenderer.h"
+#include "BitmapCache.h"
+#include "RunResources.h"
 #include "GnashAlgorithm.h"
 #ifdef USE_SWFTREE
 # include "tree.hh"
@@ -103,19 +109,25 @@ DisplayObject::DisplayObject(movie_root& mr, as_object* object,
     _mask(nullptr),
     _maskee(nullptr),
     _blendMode(BLENDMODE_NORMAL),
+    _cacheAsBitmap(false),
     _visible(true),
     _scriptTransformed(false),
     _dynamicallyCreated(false),
     _unloaded(false),
     _destroyed(false),
     _invalidated(true),
-    _child_invalidated(true)
+    _child_invalidated(true),
+    _matrixOnly(false)
 {
     assert(m_old_invalidated_ranges.isNull());
 
     // This informs the core that the object is a DisplayObject.
     if (_object) _object->setDisplayObject(this);
 }
+
+DisplayObject::~DisplayObject()
+{
+}
     
 void
 DisplayObject::getLoadedMovie(Movie* extern_movie)
@@ -192,6 +204,8 @@ DisplayObject::set_invalidated(const char* debug_file, int debug_line)
     // the parent must re-draw itself, it just means that one of it's childs
     // needs to be re-drawn.
     if ( _parent ) _parent->set_child_invalidated(); 
+
+    _matrixOnly = false;
   
     // Ok, at this point the instance will change it's
     // visual aspect after the
@@ -220,6 +234,30 @@ DisplayObject::set_invalidated(const char* debug_file, int debug_line)
         m_old_invalidated_ranges.setNull();
         add_invalidated_bounds(m_old_invalidated_ranges, true);
     }
+    else if (!_invalidatedArea.is_null()) {
+        // Only part of the DisplayObject was invalidated so far; now
+        // the rest of it is too.
+        _invalidatedArea.set_null();
+        add_invalidated_bounds(m_old_invalidated_ranges, true);
+    }
+}
+
+void
+DisplayObject::set_area_invalidated(const SWFRect& area)
+{
+    if (!_invalidated) {
+        _invalidatedArea = area;
+        set_invalidated(__FILE__, __LINE__);
+        return;
+    }
+
+    _matrixOnly = false;
+
+    // All of the DisplayObject is invalidated already.
+    if (_invalidatedArea.is_null()) return;
+
+    _invalidatedArea.expand_to_rect(area);
+    add_invalidated_bounds(m_old_invalidated_ranges, true);
 }
 
 void
@@ -397,7 +435,10 @@ DisplayObject::setMatrix(const SWFMatrix& m, bool updateCache)
 
     if (m == _transform.matrix) return;
 
+    // A cached image can be moved, but not changed otherwise.
+    const bool wasInvalidated = _invalidated;
     set_invalidated(__FILE__, __LINE__);
+    if (!wasInvalidated) _matrixOnly = true;
     _transform.matrix = m;
 
     // don't update caches if SWFMatrix wasn't updated too
@@ -780,6 +821,65 @@ DisplayObject::setMaskee(DisplayObject* maskee)
 }
 
 
+void
+DisplayObject::setBitmapCaching(BitmapFilters filters, bool cache)
+{
+    // The old image may have drawn further than the new one does.
+    if (_bitmapCache) {
+        InvalidatedRanges old;
+        add_invalidated_bounds(old, true);
+        old.growBy(drawMargin());
+        extend_invalidated_bounds(old);
+    }
+    else set_invalidated();
+
+    _filters = std::move(filters);
+    _cacheAsBitmap = cache;
+
+    if (_filters.empty() && !_cacheAsBitmap) _bitmapCache.reset();
+    else _bitmapCache.reset(new BitmapCache(*this, stage().bitmapCaches()));
+}
+
+void
+DisplayObject::setFilters(BitmapFilters filters)
+{
+    if (_filters.empty() && filters.empty()) return;
+    setBitmapCaching(std::move(filters), _cacheAsBitmap);
+}
+
+void
+DisplayObject::setCacheAsBitmap(bool cache)
+{
+    if (cache == _cacheAsBitmap) return;
+    setBitmapCaching(_filters, cache);
+}
+
+std::int32_t
+DisplayObject::drawMargin() const
+{
+    if (!_bitmapCache) return 0;
+
+    // The cached image is moved by whole pixels, so it may be up to a
+    // pixel away from the bounds.
+    const int pixels = margin(_filters) + 1;
+
+    // Filters work in pixels of the stage.
+    const Renderer* renderer = stage().runResources().renderer();
+    if (!renderer) return pixelsToTwips(pixels);
+
+    const point o = renderer->pixel_to_world(0, 0);
+    const point p = renderer->pixel_to_world(1, 1);
+    const double size = std::max(std::abs(p.x - o.x), std::abs(p.y - o.y));
+    return std::ceil(pixels * size);
+}
+
+void
+DisplayObject::displayCached(Renderer& renderer, const Transform& base)
+{
+    assert(_bitmapCache);
+    _bitmapCache->display(*this, renderer, base);
+}
+
 bool 
 DisplayObject::boundsInClippingArea(Renderer& renderer) const 
 {
@@ -973,6 +1073,9 @@ DisplayObject::MaskRenderer::MaskRenderer(Renderer& r, const DisplayObject& o)
 {
     if (!_mask) return;
 
+    // The mask can change without invalidating what it masks.
+    RecordingRenderer::markVolatile(_renderer);
+
     _renderer.begin_submit_mask();
     DisplayObject* p = _mask->parent();
     const Transform tr = p ?
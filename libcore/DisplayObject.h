@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <map>
+#include <memory>
 #include <string>
 #include <cassert>
 #include <cstdint> // For C99 int types
@@ -41,6 +42,7 @@
 #include "SWFCxForm.h"
 #include "dsodefs.h" 
 #include "snappingrange.h"
+#include "Filters.h"
 #ifdef USE_SWFTREE
 # include "tree.hh"
 #endif
@@ -65,6 +67,7 @@ namespace gnash {
     class as_environment;
     class DisplayObject;
     class KeyVisitor;
+    class BitmapCache;
     namespace SWF {
         class TextRecord;
     }
@@ -181,7 +184,7 @@ public:
     /// @param parent   The parent of the new DisplayObject. This may be null.
     DisplayObject(movie_root& mr, as_object* object, DisplayObject* parent);
 
-    virtual ~DisplayObject() {}
+    virtual ~DisplayObject();
 
     /// The lowest placeable and accessible depth for a DisplayObject.
     /// Macromedia Flash help says: depth starts at -16383 (0x3FFF)
@@ -467,6 +470,18 @@ public:
     /// All DisplayObjects must have a display() function.
 	virtual void display(Renderer& renderer, const Transform& xform) = 0;
 
+    /// Render the DisplayObject from its cached image.
+    //
+    /// This is for DisplayObjects with filters or cacheAsBitmap. The
+    /// image, with the filters applied, is kept until the DisplayObject
+    /// changes; see BitmapCache.
+    void displayCached(Renderer& renderer, const Transform& base);
+
+    /// Whether the DisplayObject is displayed from a cached image.
+    bool bitmapCached() const {
+        return _bitmapCache.get();
+    }
+
     /// Search for StaticText objects
     //
     /// If this is a StaticText object and contains SWF::TextRecords, these
@@ -663,6 +678,12 @@ public:
         return _child_invalidated;
     }
 
+    /// Whether this DisplayObject was invalidated for anything but a
+    /// change of its SWFMatrix.
+    bool contentInvalidated() const {
+        return _invalidated && !_matrixOnly;
+    }
+
     /// Notify a change in the DisplayObject's appearance.
     virtual void update() {
         set_invalidated();
@@ -697,6 +718,17 @@ public:
     /// given value so that also this area gets re-rendered (used when
     /// replacing DisplayObjects).    
     void extend_invalidated_bounds(const InvalidatedRanges& ranges);
+
+    /// Like set_invalidated(), but only part of the DisplayObject changes.
+    //
+    /// Only the area is redrawn, unless the rest of the DisplayObject is
+    /// invalidated too before it is next displayed. DisplayObjects that
+    /// support this use invalidatedArea() in add_invalidated_bounds();
+    /// others are redrawn completely.
+    ///
+    /// @param area     The area that changes, in the DisplayObject's
+    ///                 coordinates.
+    void set_area_invalidated(const SWFRect& area);
     
     
     /// Called by a child to signalize it has changed visibily. The
@@ -719,7 +751,9 @@ public:
     /// child) is invalidated again (see set_invalidated() recursion).
     void clear_invalidated() {
         _invalidated = false;
-        _child_invalidated = false;        
+        _child_invalidated = false;
+        _matrixOnly = false;
+        _invalidatedArea.set_null();
         m_old_invalidated_ranges.setNull();
     }
     
@@ -895,6 +929,30 @@ public:
         _blendMode = bm;
     }
 
+    /// The bitmap filters applied to this DisplayObject.
+    const BitmapFilters& filters() const {
+        return _filters;
+    }
+
+    /// Set the bitmap filters applied to this DisplayObject.
+    void setFilters(BitmapFilters filters);
+
+    /// How far the DisplayObject may draw outside its bounds.
+    //
+    /// This is how far the filters reach, and a pixel for moving the
+    /// cached image by whole pixels.
+    ///
+    /// @return     The distance in world coordinates (TWIPS).
+    std::int32_t drawMargin() const;
+
+    /// Whether the DisplayObject is drawn from a cached image.
+    bool cacheAsBitmap() const {
+        return _cacheAsBitmap;
+    }
+
+    /// Set whether the DisplayObject is drawn from a cached image.
+    void setCacheAsBitmap(bool cache);
+
     // action_buffer is externally owned
     typedef std::vector<const action_buffer*> BufferList;
     typedef std::map<event_id, BufferList> Events;
@@ -1028,11 +1086,21 @@ protected:
     /// get_invalidated_bounds().
     InvalidatedRanges m_old_invalidated_ranges;
 
+    /// The area invalidated with set_area_invalidated().
+    //
+    /// This is null if all of the DisplayObject is invalidated.
+    const SWFRect& invalidatedArea() const {
+        return _invalidatedArea;
+    }
+
 private:
 
     /// Register a DisplayObject masked by this instance
     void setMaskee(DisplayObject* maskee);
 
+    /// Set the filters and cacheAsBitmap, starting a new cached image.
+    void setBitmapCaching(BitmapFilters filters, bool cache);
+
     /// The as_object to which this DisplayObject is attached.
     as_object* _object;
 
@@ -1077,6 +1145,14 @@ private:
 
     BlendMode _blendMode;
 
+    BitmapFilters _filters;
+
+    bool _cacheAsBitmap;
+
+    /// The image drawn with the filters or for cacheAsBitmap, if either
+    /// is set.
+    std::unique_ptr<BitmapCache> _bitmapCache;
+
     bool _visible;
 
     /// Whether this DisplayObject has been transformed by ActionScript code
@@ -1111,6 +1187,13 @@ private:
     /// can be set at the same time. 
     bool _child_invalidated;
 
+    /// Whether the SWFMatrix is all that changed since the last
+    /// clear_invalidated(), if _invalidated is set.
+    bool _matrixOnly;
+
+    /// The only part of the DisplayObject that changed, if _invalidated is
+    /// set and it isn't null.
+    SWFRect _invalidatedArea;
 
 };
 
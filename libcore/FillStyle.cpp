@@ -108,7 +108,9 @@ BitmapFill::BitmapFill(Type t, const CachedBitmap* bi, SWFMatrix m,
     _matrix(std::move(m)),
     _bitmapInfo(bi),
     _md(nullptr),
-    _id(0)
+    _id(0),
+    _found(nullptr),
+    _foundRevision(0)
 {
 }
     
@@ -120,7 +122,9 @@ BitmapFill::BitmapFill(SWF::FillType t, movie_definition* md,
     _matrix(std::move(m)),
     _bitmapInfo(nullptr),
     _md(md),
-    _id(id)
+    _id(id),
+    _found(nullptr),
+    _foundRevision(0)
 {
     assert(md);
 
@@ -158,7 +162,9 @@ BitmapFill::BitmapFill(const BitmapFill& other)
     _matrix(other._matrix),
     _bitmapInfo(other._bitmapInfo),
     _md(other._md),
-    _id(other._id)
+    _id(other._id),
+    _found(nullptr),
+    _foundRevision(0)
 {
 }
 
@@ -175,6 +181,7 @@ BitmapFill::operator=(const BitmapFill& other)
     _bitmapInfo = other._bitmapInfo;
     _md = other._md;
     _id = other._id;
+    _found = nullptr;
     return *this;
 }
 
@@ -187,10 +194,34 @@ BitmapFill::bitmap() const
     if (!_md) {
         return nullptr;
     }
-    _bitmapInfo = _md->getBitmap(_id);
+
+    // The library is only locked for the first lookup after bitmaps
+    // may have been dropped. The revision is stored after the bitmap, so
+    // a thread that reads the current revision also reads its bitmap.
+    const size_t revision = _md->bitmapRevision();
+    if (_foundRevision.load(std::memory_order_acquire) == revision) {
+        const CachedBitmap* found = _found.load(std::memory_order_relaxed);
+        if (found) return found;
+    }
 
     // May still be 0!
-    return _bitmapInfo.get();
+    const CachedBitmap* found = _md->getBitmap(_id);
+    _found.store(found, std::memory_order_relaxed);
+    _foundRevision.store(revision, std::memory_order_release);
+    return found;
+}
+
+void
+BitmapFill::keepBitmap() const
+{
+    if (_bitmapInfo || !_md) return;
+    _bitmapInfo = bitmap();
+}
+
+void
+BitmapFill::keepBitmap(const CachedBitmap* bitmap) const
+{
+    _bitmapInfo = bitmap;
 }
     
 void
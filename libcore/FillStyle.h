@@ -25,6 +25,7 @@
 #include <iosfwd> 
 #include <boost/intrusive_ptr.hpp>
 #include <cassert>
+#include <atomic>
 
 #include "SWFMatrix.h"
 #include "SWF.h"
@@ -124,8 +125,22 @@ public:
     }
 
     /// Get the actual Bitmap data.
+    //
+    /// Bitmaps from a movie_definition may be dropped and decoded again
+    /// between frames, so they are looked up again when the definition's
+    /// bitmapRevision() changes, unless kept.
     const CachedBitmap* bitmap() const;
 
+    /// Hold on to the bitmap from the movie_definition.
+    //
+    /// This keeps it from being dropped while this fill is alive, and
+    /// lets it be drawn after the movie_definition is gone.
+    void keepBitmap() const;
+
+    /// Hold on to another bitmap, such as a copy of this one, and draw
+    /// it instead.
+    void keepBitmap(const CachedBitmap* bitmap) const;
+
     /// Get the matrix of this BitmapFill.
     const SWFMatrix& matrix() const {
         return _matrix;
@@ -139,7 +154,7 @@ private:
 
     SWFMatrix _matrix;
     
-    /// A Bitmap, used for dynamic fills and to cache parsed bitmaps.
+    /// A Bitmap, used for dynamic fills and to keep parsed bitmaps.
     mutable boost::intrusive_ptr<const CachedBitmap> _bitmapInfo;
 
     /// The movie definition containing the bitmap
@@ -147,6 +162,12 @@ private:
 
     // The id of the tag containing the bitmap
     std::uint16_t _id;
+
+    /// The last bitmap looked up in the movie definition, if any.
+    mutable std::atomic<const CachedBitmap*> _found;
+
+    /// The bitmapRevision() of the movie definition _found is from.
+    mutable std::atomic<size_t> _foundRevision;
 };
 
 /// A GradientFill
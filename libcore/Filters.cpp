@@ -0,0 +1,592 @@
+// Filters.cpp: rendering of bitmap filters, for Gnash.
+//
+//   Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "Filters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#elif defined(__ARM_NEON)
+# include <arm_neon.h>
+#endif
+
+#include "GnashImage.h"
+#include "log.h"
+#include "utility.h"
+
+// Blurs are done as repeated box blurs, one pass along the rows and one
+// along the columns for each level of quality. A pass keeps a running sum
+// of the pixels under the box, so it costs the same whatever the size of
+// the blur. The sums of the four channels of a pixel, or of sixteen bytes
+// of a row, are kept in vector registers where SSE2 or NEON is available.
+
+namespace gnash {
+
+namespace {
+
+/// Whether to use the SSE2 or NEON code, see setFilterVectorCode().
+bool vectorCode = true;
+
+/// The largest box radius; Flash limits blurs to 255 pixels.
+const int maxRadius = 127;
+
+/// The radius of a box blur approximating a blur of the given size.
+int
+blurRadius(float blur)
+{
+    if (!(blur >= 2)) return 0;
+    return std::min(static_cast<int>(blur / 2), maxRadius);
+}
+
+/// The number of passes of a blur of the given quality.
+int
+blurPasses(std::uint8_t quality)
+{
+    return std::min<int>(quality, 15);
+}
+
+#if defined(__SSE2__)
+
+inline __m128i
+loadPixel(const std::uint8_t* p)
+{
+    std::int32_t v;
+    std::memcpy(&v, p, 4);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i x = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero);
+    return _mm_unpacklo_epi16(x, zero);
+}
+
+inline void
+storePixel(std::uint8_t* p, __m128i sum, __m128 scale)
+{
+    __m128i x = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sum), scale));
+    x = _mm_packs_epi32(x, x);
+    x = _mm_packus_epi16(x, x);
+    const std::int32_t v = _mm_cvtsi128_si32(x);
+    std::memcpy(p, &v, 4);
+}
+
+#elif defined(__ARM_NEON)
+
+inline uint32x4_t
+loadPixel(const std::uint8_t* p)
+{
+    std::uint32_t v;
+    std::memcpy(&v, p, 4);
+    const uint8x8_t x = vreinterpret_u8_u32(vdup_n_u32(v));
+    return vmovl_u16(vget_low_u16(vmovl_u8(x)));
+}
+
+inline void
+storePixel(std::uint8_t* p, uint32x4_t sum, float32x4_t scale)
+{
+    const float32x4_t f = vmlaq_f32(vdupq_n_f32(0.5f),
+            vcvtq_f32_u32(sum), scale);
+    const uint16x4_t h = vmovn_u32(vcvtq_u32_f32(f));
+    const uint8x8_t x = vmovn_u16(vcombine_u16(h, h));
+    const std::uint32_t v = vget_lane_u32(vreinterpret_u32_u8(x), 0);
+    std::memcpy(p, &v, 4);
+}
+
+#endif
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+
+/// How many bytes of a row of n the vector code takes, sixteen at a time.
+inline size_t
+vectorBytes(size_t n)
+{
+    return vectorCode ? n / 16 * 16 : 0;
+}
+
+#endif
+
+/// Blur each row of an image with a box of 2r+1 pixels.
+//
+/// Pixels outside the image count as zero.
+void
+blurRows(std::uint8_t* data, size_t width, size_t height, size_t channels,
+        int r, std::vector<std::uint8_t>& row)
+{
+    const size_t rowBytes = width * channels;
+    const int w = width;
+    row.resize(rowBytes);
+    const float scale = 1.0f / (2 * r + 1);
+
+    for (size_t y = 0; y < height; ++y) {
+
+        std::uint8_t* out = data + y * rowBytes;
+        std::copy(out, out + rowBytes, row.begin());
+        const std::uint8_t* in = &row.front();
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+        if (vectorCode && channels == 4) {
+# if defined(__SSE2__)
+            const __m128 s = _mm_set1_ps(scale);
+            __m128i sum = _mm_setzero_si128();
+            for (int x = 0; x < r && x < w; ++x) {
+                sum = _mm_add_epi32(sum, loadPixel(in + x * 4));
+            }
+            for (int x = 0; x < w; ++x) {
+                if (x + r < w) {
+                    sum = _mm_add_epi32(sum, loadPixel(in + (x + r) * 4));
+                }
+                storePixel(out + x * 4, sum, s);
+                if (x - r >= 0) {
+                    sum = _mm_sub_epi32(sum, loadPixel(in + (x - r) * 4));
+                }
+            }
+# else
+            const float32x4_t s = vdupq_n_f32(scale);
+            uint32x4_t sum = vdupq_n_u32(0);
+            for (int x = 0; x < r && x < w; ++x) {
+                sum = vaddq_u32(sum, loadPixel(in + x * 4));
+            }
+            for (int x = 0; x < w; ++x) {
+                if (x + r < w) {
+                    sum = vaddq_u32(sum, loadPixel(in + (x + r) * 4));
+                }
+                storePixel(out + x * 4, sum, s);
+                if (x - r >= 0) {
+                    sum = vsubq_u32(sum, loadPixel(in + (x - r) * 4));
+                }
+            }
+# endif
+            continue;
+        }
+#endif
+
+        for (size_t c = 0; c < channels; ++c) {
+            int sum = 0;
+            for (int x = 0; x < r && x < w; ++x) {
+                sum += in[x * channels + c];
+            }
+            for (int x = 0; x < w; ++x) {
+                if (x + r < w) sum += in[(x + r) * channels + c];
+                out[x * channels + c] = sum * scale + 0.5f;
+                if (x - r >= 0) sum -= in[(x - r) * channels + c];
+            }
+        }
+    }
+}
+
+/// Add a row of bytes to the running sums of the columns.
+void
+addRow(std::uint32_t* sums, const std::uint8_t* row, size_t n)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (const size_t e = vectorBytes(n); i != e; i += 16) {
+        const __m128i b = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(row + i));
+        const __m128i lo = _mm_unpacklo_epi8(b, zero);
+        const __m128i hi = _mm_unpackhi_epi8(b, zero);
+        __m128i* s = reinterpret_cast<__m128i*>(sums + i);
+        _mm_storeu_si128(s, _mm_add_epi32(_mm_loadu_si128(s),
+                    _mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_si128(s + 1, _mm_add_epi32(_mm_loadu_si128(s + 1),
+                    _mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_si128(s + 2, _mm_add_epi32(_mm_loadu_si128(s + 2),
+                    _mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_si128(s + 3, _mm_add_epi32(_mm_loadu_si128(s + 3),
+                    _mm_unpackhi_epi16(hi, zero)));
+    }
+#elif defined(__ARM_NEON)
+    for (const size_t e = vectorBytes(n); i != e; i += 16) {
+        const uint8x16_t b = vld1q_u8(row + i);
+        const uint16x8_t lo = vmovl_u8(vget_low_u8(b));
+        const uint16x8_t hi = vmovl_u8(vget_high_u8(b));
+        std::uint32_t* s = sums + i;
+        vst1q_u32(s, vaddw_u16(vld1q_u32(s), vget_low_u16(lo)));
+        vst1q_u32(s + 4, vaddw_u16(vld1q_u32(s + 4), vget_high_u16(lo)));
+        vst1q_u32(s + 8, vaddw_u16(vld1q_u32(s + 8), vget_low_u16(hi)));
+        vst1q_u32(s + 12, vaddw_u16(vld1q_u32(s + 12), vget_high_u16(hi)));
+    }
+#endif
+    for (; i < n; ++i) sums[i] += row[i];
+}
+
+/// Take a row of bytes from the running sums of the columns.
+void
+subtractRow(std::uint32_t* sums, const std::uint8_t* row, size_t n)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (const size_t e = vectorBytes(n); i != e; i += 16) {
+        const __m128i b = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(row + i));
+        const __m128i lo = _mm_unpacklo_epi8(b, zero);
+        const __m128i hi = _mm_unpackhi_epi8(b, zero);
+        __m128i* s = reinterpret_cast<__m128i*>(sums + i);
+        _mm_storeu_si128(s, _mm_sub_epi32(_mm_loadu_si128(s),
+                    _mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_si128(s + 1, _mm_sub_epi32(_mm_loadu_si128(s + 1),
+                    _mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_si128(s + 2, _mm_sub_epi32(_mm_loadu_si128(s + 2),
+                    _mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_si128(s + 3, _mm_sub_epi32(_mm_loadu_si128(s + 3),
+                    _mm_unpackhi_epi16(hi, zero)));
+    }
+#elif defined(__ARM_NEON)
+    for (const size_t e = vectorBytes(n); i != e; i += 16) {
+        const uint8x16_t b = vld1q_u8(row + i);
+        const uint16x8_t lo = vmovl_u8(vget_low_u8(b));
+        const uint16x8_t hi = vmovl_u8(vget_high_u8(b));
+        std::uint32_t* s = sums + i;
+        vst1q_u32(s, vsubw_u16(vld1q_u32(s), vget_low_u16(lo)));
+        vst1q_u32(s + 4, vsubw_u16(vld1q_u32(s + 4), vget_high_u16(lo)));
+        vst1q_u32(s + 8, vsubw_u16(vld1q_u32(s + 8), vget_low_u16(hi)));
+        vst1q_u32(s + 12, vsubw_u16(vld1q_u32(s + 12), vget_high_u16(hi)));
+    }
+#endif
+    for (; i < n; ++i) sums[i] -= row[i];
+}
+
+/// Write the running sums of the columns, scaled, to a row of bytes.
+void
+storeRow(std::uint8_t* row, const std::uint32_t* sums, size_t n, float scale)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 s = _mm_set1_ps(scale);
+    for (const size_t e = vectorBytes(n); i != e; i += 16) {
+        const __m128i* in = reinterpret_cast<const __m128i*>(sums + i);
+        __m128i v[4];
+        for (size_t k = 0; k < 4; ++k) {
+            v[k] = _mm_cvtps_epi32(_mm_mul_ps(
+                        _mm_cvtepi32_ps(_mm_loadu_si128(in + k)), s));
+        }
+        const __m128i lo = _mm_packs_epi32(v[0], v[1]);
+        const __m128i hi = _mm_packs_epi32(v[2], v[3]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i),
+                _mm_packus_epi16(lo, hi));
+    }
+#elif defined(__ARM_NEON)
+    const float32x4_t s = vdupq_n_f32(scale);
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    for (const size_t e = vectorBytes(n); i != e; i += 16) {
+        uint16x4_t v[4];
+        for (size_t k = 0; k < 4; ++k) {
+            const float32x4_t f = vmlaq_f32(half,
+                    vcvtq_f32_u32(vld1q_u32(sums + i + k * 4)), s);
+            v[k] = vmovn_u32(vcvtq_u32_f32(f));
+        }
+        const uint8x8_t lo = vmovn_u16(vcombine_u16(v[0], v[1]));
+        const uint8x8_t hi = vmovn_u16(vcombine_u16(v[2], v[3]));
+        vst1q_u8(row + i, vcombine_u8(lo, hi));
+    }
+#endif
+    for (; i < n; ++i) row[i] = sums[i] * scale + 0.5f;
+}
+
+/// Blur each column of an image with a box of 2r+1 pixels.
+//
+/// The columns of every byte are summed separately, so this works for
+/// any number of channels.
+void
+blurColumns(std::uint8_t* data, size_t width, size_t height,
+        size_t channels, int r, std::vector<std::uint8_t>& copy,
+        std::vector<std::uint32_t>& sums)
+{
+    const size_t n = width * channels;
+    const int h = height;
+    copy.assign(data, data + n * height);
+    sums.assign(n, 0);
+    const float scale = 1.0f / (2 * r + 1);
+
+    const std::uint8_t* in = &copy.front();
+    for (int y = 0; y < r && y < h; ++y) addRow(&sums.front(), in + y * n, n);
+
+    for (int y = 0; y < h; ++y) {
+        if (y + r < h) addRow(&sums.front(), in + (y + r) * n, n);
+        storeRow(data + y * n, &sums.front(), n, scale);
+        if (y - r >= 0) subtractRow(&sums.front(), in + (y - r) * n, n);
+    }
+}
+
+/// Blur an image as Flash does for the given filter parameters.
+//
+/// @param data     Tightly packed pixels of any number of channels.
+void
+blur(std::uint8_t* data, size_t width, size_t height, size_t channels,
+        float blurX, float blurY, std::uint8_t quality)
+{
+    const int rx = blurRadius(blurX);
+    const int ry = blurRadius(blurY);
+    if (!rx && !ry) return;
+
+    std::vector<std::uint8_t> buffer;
+    std::vector<std::uint32_t> sums;
+
+    for (int i = 0, e = blurPasses(quality); i < e; ++i) {
+        if (rx) blurRows(data, width, height, channels, rx, buffer);
+        if (ry) blurColumns(data, width, height, channels, ry, buffer, sums);
+    }
+}
+
+/// How far in pixels a blur reaches.
+int
+blurMargin(float blurX, float blurY, std::uint8_t quality)
+{
+    return std::max(blurRadius(blurX), blurRadius(blurY)) *
+        blurPasses(quality);
+}
+
+/// Draw a shadow or glow of an image.
+//
+/// This is a blurred copy of the alpha channel of the image in a single
+/// colour, offset by (dx, dy). An inner shadow is cast by everything
+/// outside the image's opaque parts, and falls only inside them.
+void
+shadow(image::GnashImage& im, std::uint32_t color, std::uint8_t alpha,
+        float blurX, float blurY, float strength, std::uint8_t quality,
+        int dx, int dy, bool inner, bool knockout, bool hideObject)
+{
+    const int w = im.width();
+    const int h = im.height();
+    std::uint8_t* data = im.begin();
+
+    // The alpha channel the shadow is cast from, offset.
+    std::vector<std::uint8_t> a(w * h, inner ? 0xff : 0);
+    for (int y = std::max(0, dy), ey = std::min(h, h + dy); y < ey; ++y) {
+        const std::uint8_t* in = data + ((y - dy) * w - dx) * 4 + 3;
+        std::uint8_t* out = &a[y * w];
+        for (int x = std::max(0, dx), ex = std::min(w, w + dx); x < ex; ++x) {
+            out[x] = inner ? 0xff - in[x * 4] : in[x * 4];
+        }
+    }
+
+    blur(&a.front(), w, h, 1, blurX, blurY, quality);
+
+    const int red = (color >> 16) & 0xff;
+    const int green = (color >> 8) & 0xff;
+    const int blue = color & 0xff;
+
+    // Strength scales the shadow's alpha before it is clamped.
+    const float scale = std::max(strength, 0.0f) * alpha / 255;
+
+    for (int i = 0, e = w * h; i < e; ++i) {
+
+        std::uint8_t* p = data + i * 4;
+        const int srcAlpha = p[3];
+
+        int sa = std::min(255, static_cast<int>(a[i] * scale + 0.5f));
+
+        // An inner shadow only falls on the object.
+        if (inner) sa = sa * srcAlpha / 255;
+
+        // What is left of the object: inner shadows are drawn over it,
+        // outer ones under it.
+        int keep;
+        if (knockout || (hideObject && !inner)) keep = 0;
+        else if (inner) keep = 255 - sa;
+        else keep = 255;
+
+        // Outer shadows are hidden by the object unless it is hidden
+        // itself.
+        if (!inner && !hideObject) sa = sa * (255 - srcAlpha) / 255;
+
+        p[0] = (p[0] * keep + red * sa) / 255;
+        p[1] = (p[1] * keep + green * sa) / 255;
+        p[2] = (p[2] * keep + blue * sa) / 255;
+        p[3] = std::min(255, (srcAlpha * keep) / 255 + sa);
+    }
+}
+
+/// Apply a 4x5 colour matrix to a pixel of straight RGBA in [0, 255].
+//
+/// @param m    The matrix in columns, so that m[0] holds the factors of
+///             red for each output channel and m[4] the offsets.
+inline void
+transformColor(float* c, const float (&m)[5][4])
+{
+    float out[4];
+    for (size_t k = 0; k < 4; ++k) {
+        const float v = m[0][k] * c[0] + m[1][k] * c[1] + m[2][k] * c[2] +
+            m[3][k] * c[3] + m[4][k];
+        out[k] = std::min(255.0f, std::max(0.0f, v));
+    }
+    std::copy(out, out + 4, c);
+}
+
+} // anonymous namespace
+
+void
+setFilterVectorCode(bool use)
+{
+    vectorCode = use;
+}
+
+int
+margin(const BitmapFilters& filters)
+{
+    int m = 0;
+    for (const auto& f : filters) m += f->margin();
+    return m;
+}
+
+void
+BitmapFilter::apply(image::GnashImage& /*im*/) const
+{
+    LOG_ONCE(log_unimpl(_("Rendering of %s"), typeName(*this)));
+}
+
+int
+BlurFilter::margin() const
+{
+    return blurMargin(m_blurX, m_blurY, m_quality);
+}
+
+void
+BlurFilter::apply(image::GnashImage& im) const
+{
+    assert(im.type() == image::TYPE_RGBA);
+    blur(im.begin(), im.width(), im.height(), 4, m_blurX, m_blurY,
+            m_quality);
+}
+
+int
+GlowFilter::margin() const
+{
+    return m_inner ? 0 : blurMargin(m_blurX, m_blurY, m_quality);
+}
+
+void
+GlowFilter::apply(image::GnashImage& im) const
+{
+    assert(im.type() == image::TYPE_RGBA);
+    shadow(im, m_color, m_alpha, m_blurX, m_blurY, m_strength, m_quality,
+            0, 0, m_inner, m_knockout, false);
+}
+
+int
+DropShadowFilter::margin() const
+{
+    if (m_inner) return 0;
+    return blurMargin(m_blurX, m_blurY, m_quality) +
+        std::ceil(std::abs(m_distance));
+}
+
+void
+DropShadowFilter::apply(image::GnashImage& im) const
+{
+    assert(im.type() == image::TYPE_RGBA);
+
+    // The angle is in degrees.
+    const double angle = m_angle * M_PI / 180;
+    const int dx = std::lround(m_distance * std::cos(angle));
+    const int dy = std::lround(m_distance * std::sin(angle));
+
+    shadow(im, m_color, m_alpha, m_blurX, m_blurY, m_strength, m_quality,
+            dx, dy, m_inner, m_knockout, m_hideObject);
+}
+
+void
+ColorMatrixFilter::apply(image::GnashImage& im) const
+{
+    assert(im.type() == image::TYPE_RGBA);
+    if (m_matrix.size() != 20) return;
+
+    // Each row of the matrix gives one output channel; keep it by columns
+    // so that a pixel is transformed with four multiply-adds of vectors.
+    float m[5][4];
+    for (size_t row = 0; row < 4; ++row) {
+        for (size_t col = 0; col < 5; ++col) {
+            m[col][row] = m_matrix[row * 5 + col];
+        }
+    }
+
+    std::uint8_t* p = im.begin();
+    std::uint8_t* const end = p + im.size();
+
+#if defined(__SSE2__)
+    if (vectorCode) {
+        const __m128 col0 = _mm_loadu_ps(m[0]);
+        const __m128 col1 = _mm_loadu_ps(m[1]);
+        const __m128 col2 = _mm_loadu_ps(m[2]);
+        const __m128 col3 = _mm_loadu_ps(m[3]);
+        const __m128 offset = _mm_loadu_ps(m[4]);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 max = _mm_set1_ps(255.0f);
+
+        for (; p != end; p += 4) {
+            const int a = p[3];
+            if (!a && !m[4][3]) continue;
+
+            // Unpremultiply.
+            __m128 c = _mm_cvtepi32_ps(loadPixel(p));
+            if (a) {
+                const __m128 u = _mm_set_ps(1.0f, 255.0f / a, 255.0f / a,
+                        255.0f / a);
+                c = _mm_min_ps(_mm_mul_ps(c, u), max);
+            }
+
+            __m128 v = _mm_add_ps(offset, _mm_mul_ps(col0,
+                        _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 0, 0, 0))));
+            v = _mm_add_ps(v, _mm_mul_ps(col1,
+                        _mm_shuffle_ps(c, c, _MM_SHUFFLE(1, 1, 1, 1))));
+            v = _mm_add_ps(v, _mm_mul_ps(col2,
+                        _mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 2, 2, 2))));
+            v = _mm_add_ps(v, _mm_mul_ps(col3,
+                        _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 3, 3))));
+            v = _mm_min_ps(_mm_max_ps(v, zero), max);
+
+            // Premultiply the colour by the new alpha.
+            const float na = _mm_cvtss_f32(_mm_shuffle_ps(v, v,
+                        _MM_SHUFFLE(3, 3, 3, 3))) / 255;
+            v = _mm_mul_ps(v, _mm_set_ps(1.0f, na, na, na));
+
+            __m128i x = _mm_cvtps_epi32(v);
+            x = _mm_packs_epi32(x, x);
+            x = _mm_packus_epi16(x, x);
+            const std::int32_t out = _mm_cvtsi128_si32(x);
+            std::memcpy(p, &out, 4);
+        }
+        return;
+    }
+#endif
+
+    for (; p != end; p += 4) {
+        const int a = p[3];
+        if (!a && !m[4][3]) continue;
+
+        float c[4] = { float(p[0]), float(p[1]), float(p[2]), float(a) };
+        if (a) {
+            for (size_t k = 0; k < 3; ++k) {
+                c[k] = std::min(255.0f, c[k] * 255 / a);
+            }
+        }
+
+        transformColor(c, m);
+
+        const float alpha = c[3] / 255;
+        for (size_t k = 0; k < 3; ++k) {
+            p[k] = c[k] * alpha + 0.5f;
+        }
+        p[3] = c[3] + 0.5f;
+    }
+}
+
+} // namespace gnash
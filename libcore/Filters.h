@@ -22,27 +22,63 @@
 
 #include <cstdint>
 #include <vector>
+#include <memory>
 #include <utility>
 
+#include "dsodefs.h"
+
 namespace gnash {
     class SWFStream;
+    namespace image {
+        class GnashImage;
+    }
 }
 
 namespace gnash {
 
 // The common base class for AS display filters.
-class BitmapFilter
+class DSOEXPORT BitmapFilter
 {
 public:
     virtual bool read(SWFStream& /*in*/) {
         return true;
     }
+
+    /// Apply the filter to an image of premultiplied RGBA pixels.
+    //
+    /// The effect is cut off at the edges of the image, so it should
+    /// leave margin() pixels around what is filtered.
+    /// See Filters.cpp for the implementations.
+    virtual void apply(image::GnashImage& im) const;
+
+    /// How far in pixels the effect may reach outside what is filtered.
+    virtual int margin() const {
+        return 0;
+    }
+
+    /// Copy the filter, without anything a subclass adds to it.
+    virtual std::unique_ptr<BitmapFilter> clone() const {
+        return std::unique_ptr<BitmapFilter>(new BitmapFilter(*this));
+    }
+
     BitmapFilter() {}
     virtual ~BitmapFilter() {}
 };
 
+/// The filters of a DisplayObject, applied in order.
+typedef std::vector<std::shared_ptr<const BitmapFilter> > BitmapFilters;
+
+/// How far in pixels a list of filters may draw outside what is filtered.
+int margin(const BitmapFilters& filters);
+
+/// Whether filters use their SSE2 or NEON code, where it is compiled in.
+//
+/// The scalar code is used otherwise, so that tests can compare the two.
+/// This must not be changed while filters are applied.
+DSOEXPORT void setFilterVectorCode(bool use);
+
 // A bevel effect filter.
-class BevelFilter : public BitmapFilter
+class DSOEXPORT BevelFilter : public BitmapFilter
 {
 public:
     enum bevel_type
@@ -57,6 +93,10 @@ public:
 
     virtual ~BevelFilter() {}
 
+    virtual std::unique_ptr<BitmapFilter> clone() const {
+        return std::unique_ptr<BitmapFilter>(new BevelFilter(*this));
+    }
+
     BevelFilter()
         : 
         m_distance(0.0f),
@@ -98,7 +138,7 @@ public:
 };
 
 // A blur effect filter.
-class BlurFilter : public BitmapFilter
+class DSOEXPORT BlurFilter : public BitmapFilter
 {
 public:
     // Fill from a SWFStream. See parser/filter_factory.cpp for the implementations.
@@ -106,6 +146,14 @@ public:
 
     virtual ~BlurFilter() {}
 
+    virtual void apply(image::GnashImage& im) const;
+
+    virtual int margin() const;
+
+    virtual std::unique_ptr<BitmapFilter> clone() const {
+        return std::unique_ptr<BitmapFilter>(new BlurFilter(*this));
+    }
+
     BlurFilter() : 
         m_blurX(0.0f), m_blurY(0.0f), m_quality(0)
     {}
@@ -120,7 +168,7 @@ public:
 };
 
 // A color SWFMatrix effect filter.
-class ColorMatrixFilter : public BitmapFilter
+class DSOEXPORT ColorMatrixFilter : public BitmapFilter
 {
 public:
     // Fill from a SWFStream. See parser/filter_factory.cpp for the implementations.
@@ -128,6 +176,12 @@ public:
 
     virtual ~ColorMatrixFilter() {}
 
+    virtual void apply(image::GnashImage& im) const;
+
+    virtual std::unique_ptr<BitmapFilter> clone() const {
+        return std::unique_ptr<BitmapFilter>(new ColorMatrixFilter(*this));
+    }
+
     ColorMatrixFilter() : 
         m_matrix()
     {}
@@ -141,7 +195,7 @@ protected:
 };
 
 // A convolution effect filter.
-class ConvolutionFilter : public BitmapFilter
+class DSOEXPORT ConvolutionFilter : public BitmapFilter
 {
 public:
     // Fill from a SWFStream. See parser/filter_factory.cpp for
@@ -150,6 +204,10 @@ public:
 
     virtual ~ConvolutionFilter() {}
 
+    virtual std::unique_ptr<BitmapFilter> clone() const {
+        return std::unique_ptr<BitmapFilter>(new ConvolutionFilter(*this));
+    }
+
     ConvolutionFilter()
         :
         _matrixX(),
@@ -192,7 +250,7 @@ protected:
 };
 
 // A drop shadow effect filter.
-class DropShadowFilter : public BitmapFilter
+class DSOEXPORT DropShadowFilter : public BitmapFilter
 {
 public:
     // Fill from a SWFStream. See parser/filter_factory.cpp for the implementations.
@@ -200,6 +258,14 @@ public:
 
     virtual ~DropShadowFilter() {}
 
+    virtual void apply(image::GnashImage& im) const;
+
+    virtual int margin() const;
+
+    virtual std::unique_ptr<BitmapFilter> clone() const {
+        return std::unique_ptr<BitmapFilter>(new DropShadowFilter(*this));
+    }
+
     DropShadowFilter() : 
         m_distance(0.0f), m_angle(0.0f), m_color(0), m_alpha(0),
         m_blurX(0.0f), m_blurY(0.0f),  m_strength(0.0f), m_quality(0),
@@ -230,7 +296,7 @@ public:
 
 
 // A glow effect filter.
-class GlowFilter : public BitmapFilter
+class DSOEXPORT GlowFilter : public BitmapFilter
 {
 public:
     // Fill from a SWFStream. See parser/filter_factory.cpp for the implementations.
@@ -238,6 +304,14 @@ public:
 
     virtual ~GlowFilter() {}
 
+    virtual void apply(image::GnashImage& im) const;
+
+    virtual int margin() const;
+
+    virtual std::unique_ptr<BitmapFilter> clone() const {
+        return std::unique_ptr<BitmapFilter>(new GlowFilter(*this));
+    }
+
     GlowFilter() : 
         m_color(0), m_alpha(0),
         m_blurX(0.0f), m_blurY(0.0f),  m_strength(0.0f), m_quality(0),
@@ -264,7 +338,7 @@ public:
 
 
 // A gradient bevel effect filter.
-class GradientBevelFilter : public BitmapFilter
+class DSOEXPORT GradientBevelFilter : public BitmapFilter
 {
 public:
     enum glow_types
@@ -279,6 +353,10 @@ public:
 
     virtual ~GradientBevelFilter() {}
 
+    virtual std::unique_ptr<BitmapFilter> clone() const {
+        return std::unique_ptr<BitmapFilter>(new GradientBevelFilter(*this));
+    }
+
     GradientBevelFilter() : 
         m_distance(0.0f), m_angle(0.0f), m_colors(), m_alphas(), m_ratios(),
         m_blurX(0.0f), m_blurY(0.0f),  m_strength(0.0f), m_quality(0),
@@ -311,7 +389,7 @@ public:
 };
 
 // A gradient glow effect filter.
-class GradientGlowFilter : public BitmapFilter
+class DSOEXPORT GradientGlowFilter : public BitmapFilter
 {
 public:
     enum glow_types
@@ -326,6 +404,10 @@ public:
 
     virtual ~GradientGlowFilter() {}
 
+    virtual std::unique_ptr<BitmapFilter> clone() const {
+        return std::unique_ptr<BitmapFilter>(new GradientGlowFilter(*this));
+    }
+
     GradientGlowFilter() : 
         m_distance(0.0f), m_angle(0.0f), m_colors(), m_alphas(), m_ratios(),
         m_blurX(0.0f), m_blurY(0.0f),  m_strength(0.0f), m_quality(0),
@@ -0,0 +1,199 @@
+// FrameProfiler.cpp: where the time of each frame goes, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <ostream>
+#include <iomanip>
+#include <bitset>
+#include <cassert>
+
+#include "SWF.h"
+
+namespace gnash {
+
+namespace {
+
+/// Collect the nonzero counters.
+void
+collectActions(const std::uint32_t* counts,
+        std::vector<std::pair<std::uint8_t, std::uint32_t> >& actions)
+{
+    actions.clear();
+    for (size_t i = 0; i < 256; ++i) {
+        if (counts[i]) actions.push_back(std::make_pair(i, counts[i]));
+    }
+}
+
+}
+
+FrameProfiler::FrameProfiler(size_t frames)
+    :
+    _origin(Clock::now()),
+    _frames(frames),
+    _current(0),
+    _started(1),
+    _depth(0)
+{
+    std::fill_n(_actions, 256, 0);
+    if (enabled()) _frames[0].start = 0;
+}
+
+const char*
+FrameProfiler::name(Section s)
+{
+    switch (s) {
+        case ADVANCE:
+            return "advance";
+        case ADVANCE_MOVIE:
+            return "advanceMovie";
+        case PROCESS_ACTION_QUEUE:
+            return "processActionQueue";
+        case EXECUTE_TIMERS:
+            return "executeTimers";
+        case CLEANUP_DISPLAY_LIST:
+            return "cleanupDisplayList";
+        case DISPLAY:
+            return "display";
+        default:
+            return "unknown";
+    }
+}
+
+double
+FrameProfiler::now() const
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - _origin)
+        .count();
+}
+
+void
+FrameProfiler::startFrame()
+{
+    if (!enabled()) return;
+    assert(!_depth);
+
+    collectActions(_actions, _frames[_current].actions);
+    std::fill_n(_actions, 256, 0);
+
+    _current = (_current + 1) % _frames.size();
+    ++_started;
+
+    // Reuse the storage of the oldest frame.
+    Frame& f = _frames[_current];
+    f.start = now();
+    f.events.clear();
+    f.actions.clear();
+}
+
+void
+FrameProfiler::leave(Section s, double start)
+{
+    assert(_depth);
+    --_depth;
+    const Event e = { s, start, now() - start };
+    _frames[_current].events.push_back(e);
+}
+
+double
+FrameProfiler::total(Section s, size_t ago) const
+{
+    if (ago >= std::min(_started, _frames.size())) return 0;
+
+    const Frame& f = _frames[(_current + _frames.size() - ago) %
+        _frames.size()];
+
+    double t = 0;
+    for (const Event& e : f.events) {
+        if (e.section == s) t += e.duration;
+    }
+    return t;
+}
+
+void
+FrameProfiler::writeTrace(std::ostream& os) const
+{
+    const std::ios::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(3);
+
+    os << "{\"traceEvents\":[";
+
+    const size_t frames = std::min(_started, _frames.size());
+
+    // The counters of the current frame are still being collected.
+    std::vector<std::pair<std::uint8_t, std::uint32_t> > currentActions;
+    collectActions(_actions, currentActions);
+
+    // A counter keeps its value until it is next set, so every frame
+    // sets all the actions seen.
+    std::bitset<256> seen;
+    for (size_t i = 0; i < frames; ++i) {
+        for (const auto& a : _frames[i].actions) seen.set(a.first);
+    }
+    for (const auto& a : currentActions) seen.set(a.first);
+
+    for (size_t i = 0; i < frames; ++i) {
+
+        const size_t idx = (_current + _frames.size() - frames + 1 + i) %
+            _frames.size();
+        const Frame& f = _frames[idx];
+
+        const bool current = (idx == _current);
+        const double end = current ? now() :
+            _frames[(idx + 1) % _frames.size()].start;
+
+        if (i) os << ",";
+        os << "\n{\"name\":\"frame " << (_started - frames + i)
+           << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+           << "\"ts\":" << f.start << ",\"dur\":" << (end - f.start) << "}";
+
+        for (const Event& e : f.events) {
+            os << ",\n{\"name\":\"" << name(e.section)
+               << "\",\"cat\":\"movie_root\",\"ph\":\"X\",\"pid\":1,"
+               << "\"tid\":1,\"ts\":" << e.start << ",\"dur\":"
+               << e.duration << "}";
+        }
+
+        std::uint32_t counts[256] = {};
+        for (const auto& a : current ? currentActions : f.actions) {
+            counts[a.first] = a.second;
+        }
+
+        os << ",\n{\"name\":\"actions\",\"ph\":\"C\",\"pid\":1,\"tid\":1,"
+           << "\"ts\":" << f.start << ",\"args\":{";
+        bool first = true;
+        for (size_t a = 0; a < 256; ++a) {
+            if (!seen.test(a)) continue;
+            if (!first) os << ",";
+            first = false;
+            os << "\"" << static_cast<SWF::ActionType>(a) << "\":"
+               << counts[a];
+        }
+        os << "}}";
+    }
+
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+} // namespace gnash
@@ -0,0 +1,173 @@
+// FrameProfiler.h: where the time of each frame goes, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_FRAMEPROFILER_H
+#define GNASH_FRAMEPROFILER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <iosfwd>
+#include <utility>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace gnash {
+
+/// Records where the time of each frame goes.
+//
+/// movie_root times its main stages with a FrameProfiler::Scope, and
+/// ActionExec counts the actions it executes. The records of the last
+/// few frames are kept in a ring buffer, and can be written out in the
+/// Chrome trace event format.
+//
+/// A disabled profiler records nothing: a Scope only tests a flag, and
+/// ActionExec doesn't count.
+class FrameProfiler : boost::noncopyable
+{
+public:
+
+    /// The stages timed.
+    enum Section
+    {
+        ADVANCE,
+        ADVANCE_MOVIE,
+        PROCESS_ACTION_QUEUE,
+        EXECUTE_TIMERS,
+        CLEANUP_DISPLAY_LIST,
+        DISPLAY,
+        SECTIONS
+    };
+
+    /// Times a section from construction to destruction.
+    class Scope
+    {
+    public:
+        Scope(FrameProfiler& p, Section s)
+            :
+            _profiler(p.enabled() ? &p : nullptr),
+            _section(s),
+            _start(_profiler ? _profiler->enter() : 0)
+        {}
+
+        ~Scope() {
+            if (_profiler) _profiler->leave(_section, _start);
+        }
+
+    private:
+        FrameProfiler* _profiler;
+        const Section _section;
+        const double _start;
+    };
+
+    /// @param frames   The number of frames to keep, 0 to disable
+    ///                 profiling.
+    explicit FrameProfiler(size_t frames);
+
+    bool enabled() const {
+        return !_frames.empty();
+    }
+
+    /// Start recording a new frame, dropping the oldest if necessary.
+    //
+    /// No Scope may be open, as its section would end up in a frame it
+    /// didn't start in.
+    void startFrame();
+
+    /// Microseconds spent in a section during a recorded frame.
+    //
+    /// @param s    The section, summed over all its Scopes in the frame.
+    /// @param ago  0 for the current frame, 1 for the one before, and so on.
+    /// @return     The time, or 0 if the frame isn't recorded.
+    double total(Section s, size_t ago = 0) const;
+
+    /// Counters for the current frame, indexed by action id.
+    //
+    /// @return     The counters, or null when disabled.
+    std::uint32_t* actionCounts() {
+        return enabled() ? _actions : nullptr;
+    }
+
+    /// Write the frames recorded as a Chrome trace.
+    //
+    /// Each section is a complete event, nested as they were run,
+    /// under an event for its frame. The actions executed in a frame
+    /// are a counter event.
+    void writeTrace(std::ostream& os) const;
+
+    /// The name of a section in traces.
+    static const char* name(Section s);
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Event
+    {
+        Section section;
+
+        /// Microseconds since the profiler was created.
+        double start;
+
+        double duration;
+    };
+
+    struct Frame
+    {
+        /// Microseconds since the profiler was created.
+        double start;
+
+        std::vector<Event> events;
+
+        /// Nonzero action counts.
+        std::vector<std::pair<std::uint8_t, std::uint32_t> > actions;
+    };
+
+    /// Microseconds since the profiler was created.
+    double now() const;
+
+    double enter() {
+        ++_depth;
+        return now();
+    }
+
+    void leave(Section s, double start);
+
+    /// Write a frame's events, ending at the given time.
+    void writeFrame(std::ostream& os, const Frame& f, double end) const;
+
+    const Clock::time_point _origin;
+
+    std::vector<Frame> _frames;
+
+    /// The frame being recorded.
+    size_t _current;
+
+    /// The number of frames started, including the current one.
+    size_t _started;
+
+    /// The number of Scopes open.
+    size_t _depth;
+
+    std::uint32_t _actions[256];
+};
+
+} // namespace gnash
+
+#endif
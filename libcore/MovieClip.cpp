@@ -64,6 +64,7 @@
 #include "RunResources.h"
 #include "Transform.h"
 #include "ConstantPool.h" // for PoolGuard
+#include "RecordingRenderer.h"
 
 namespace gnash {
 
@@ -1212,7 +1213,26 @@ MovieClip::display(Renderer& renderer, const Transform& base)
     
     // Draw everything with our own transform.
     const Transform xform = base * transform();
+
+    RecordingRenderer* rec = dynamic_cast<RecordingRenderer*>(&renderer);
+    if (!rec) {
+        // Whatever was drawn here is not in the recording.
+        _retained.retainable = false;
+        draw(renderer, xform);
+        clear_invalidated();
+        return;
+    }
+
+    // Nothing here changed since the last frame, so neither did what
+    // we drew.
+    if (!invalidated() && !childInvalidated() && rec->reuse(_retained, base)) {
+        clear_invalidated();
+        return;
+    }
+
+    rec->beginSubtree(_retained, base);
     draw(renderer, xform);
+    rec->endSubtree(_retained);
     clear_invalidated();
 }
 
@@ -1269,6 +1289,9 @@ MovieClip::add_display_object(const SWF::PlaceObject2Tag* tag,
         ch->setBlendMode(static_cast<DisplayObject::BlendMode>(bm));
     }
 
+    if (tag->hasFilters()) ch->setFilters(tag->getFilters());
+    if (tag->hasBitmapCaching()) ch->setCacheAsBitmap(tag->getBitmapCaching());
+
     // Attach event handlers (if any).
     const SWF::PlaceObject2Tag::EventHandlers& event_handlers =
         tag->getEventHandlers();
@@ -1293,12 +1316,15 @@ void
 MovieClip::move_display_object(const SWF::PlaceObject2Tag* tag, DisplayList& dlist)
 {    
     std::uint16_t ratio = tag->getRatio();
+    const bool cacheAsBitmap = tag->getBitmapCaching();
     // clip_depth is not used in MOVE tag(at least no related tests). 
     dlist.moveDisplayObject(
         tag->getDepth(), 
         tag->hasCxform() ? &tag->getCxform() : nullptr,
         tag->hasMatrix() ? &tag->getMatrix() : nullptr,
-        tag->hasRatio() ? &ratio : nullptr);
+        tag->hasRatio() ? &ratio : nullptr,
+        tag->hasFilters() ? &tag->getFilters() : nullptr,
+        tag->hasBitmapCaching() ? &cacheAsBitmap : nullptr);
 }
 
 void
@@ -1357,6 +1383,12 @@ MovieClip::replace_display_object(const SWF::PlaceObject2Tag* tag,
     if (tag->hasMatrix()) {
         ch->setMatrix(tag->getMatrix(), true); 
     }
+    if (tag->hasFilters()) {
+        ch->setFilters(tag->getFilters());
+    }
+    if (tag->hasBitmapCaching()) {
+        ch->setCacheAsBitmap(tag->getBitmapCaching());
+    }
 
     // use SWFMatrix from the old DisplayObject if tag doesn't provide one.
     dlist.replaceDisplayObject(ch, tag->getDepth(), 
@@ -37,6 +37,7 @@
 #include "DisplayObjectContainer.h"
 #include "as_environment.h" // for composition
 #include "DynamicShape.h" // for composition
+#include "RenderCommands.h" // for composition
 #include "dsodefs.h" // for DSOEXPORT
 
 // Forward declarations
@@ -741,6 +742,9 @@ private:
     /// The canvas for dynamic drawing
     DynamicShape _drawable;
 
+    /// What was drawn in the last frame, to draw it again if unchanged.
+    RetainedCommands _retained;
+
     PlayState _playState;
 
     /// This timeline's variable scope
@@ -25,6 +25,9 @@
 #include "as_function.h"
 #include "as_environment.h"
 #include "fn_call.h"
+#include "namedStrings.h"
+#include "PropertyList.h"
+#include "GC.h"
 
 namespace gnash {
 
@@ -114,6 +117,7 @@ Property::getValue(const as_object& this_ptr) const
                 if (_destructive) {
                     _bound = ret;
                     _destructive = false;
+                    if (GC::incrementalMarking()) setReachable();
                 }
                 return ret;
             }
@@ -132,6 +136,12 @@ Property::getCache() const
 bool
 Property::setValue(as_object& this_ptr, const as_value& value) const
 {
+    if (_uri.name == NSV::PROP_uuPROTOuu) PropertyList::prototypeChanged();
+
+    // A setter may store the value anywhere, so the barrier is
+    // applied to the value rather than to this Property.
+    if (GC::incrementalMarking()) value.setReachable();
+
     if (readOnly(*this)) {
         if (_destructive) {
             _destructive = false;
@@ -171,6 +181,10 @@ Property::setValue(as_object& this_ptr, const as_value& value) const
 void
 Property::setCache(const as_value& value)
 {
+    if (_uri.name == NSV::PROP_uuPROTOuu) PropertyList::prototypeChanged();
+
+    if (GC::incrementalMarking()) value.setReachable();
+
     boost::apply_visitor(std::bind(SetCache(), std::placeholders::_1, value),
                          _bound);
 }
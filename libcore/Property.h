@@ -21,6 +21,7 @@
 #define GNASH_PROPERTY_H
 
 #include <boost/variant.hpp>
+#include <boost/noncopyable.hpp>
 #include <cassert>
 #include <functional>
 #include <typeinfo>
@@ -28,6 +29,7 @@
 #include "PropFlags.h"
 #include "as_value.h"
 #include "ObjectURI.h"
+#include "MemoryPool.h"
 #include "dsodefs.h" // for DSOTEXPORT
 
 namespace gnash {
@@ -318,6 +320,18 @@ public:
         _destructive(destroy)
 	{}
 
+    /// PropertyList allocates each of its Properties separately.
+    //
+    /// They come from a MemoryPool, so they may only be created and
+    /// deleted on the thread running ActionScript.
+    static void* operator new(size_t size) {
+        return MemoryPool::allocate(size);
+    }
+
+    static void operator delete(void* p, size_t size) {
+        MemoryPool::deallocate(p, size);
+    }
+
 	/// accessor to the properties flags
 	const PropFlags& getFlags() const { return _flags; }
 
@@ -26,7 +26,6 @@
 
 #include <utility> 
 #include <functional> 
-#include <boost/tuple/tuple.hpp>
 
 #include "Property.h" 
 #include "as_environment.h"
@@ -36,6 +35,7 @@
 #include "VM.h" 
 #include "string_table.h"
 #include "GnashAlgorithm.h"
+#include "GC.h"
 
 // Define the following to enable printing address of each property added
 //#define DEBUG_PROPERTY_ALLOC
@@ -55,52 +55,170 @@ namespace gnash {
 
 namespace {
 
-inline
-PropertyList::const_iterator
-iterator_find(const PropertyList::container& p, const ObjectURI& uri, VM& vm)
-{
-    const bool caseless = vm.getSWFVersion() < 7;
+/// The last layout assigned to a PropertyList.
+std::uint64_t lastLayout = 0;
 
-    if (!caseless) {
-        return p.project<PropertyList::CreationOrder>(
-                p.get<PropertyList::Case>().find(uri));
-    }
-        
-    return p.project<PropertyList::CreationOrder>(
-            p.get<PropertyList::NoCase>().find(uri));
+/// Return the first bucket for a key.
+//
+/// Keys are mostly small consecutive integers, so they are spread with
+/// a multiplicative (Fibonacci) hash.
+inline size_t
+bucket(string_table::key k, size_t mask)
+{
+    return static_cast<size_t>(
+            (static_cast<std::uint64_t>(k) * 0x9e3779b97f4a7c15ULL) >> 32)
+        & mask;
 }
 
 }
+
+std::uint64_t PropertyList::_prototypeEpoch = 0;
     
 PropertyList::PropertyList(as_object& obj)
     :
-    _props(boost::make_tuple(
-                boost::tuple<>(),
-                boost::make_tuple(
-                    KeyExtractor(),
-                    ObjectURI::LessThan()
-                ),
-                boost::make_tuple(
-                    KeyExtractor(),
-                    ObjectURI::CaseLessThan(getStringTable(obj), true)
-                )
-            )
-        ),
-    _owner(obj)
+    _dead(0),
+    _nextOrder(0),
+    _noCaseIndexed(false),
+    _owner(obj),
+    _layout(++lastLayout)
+{
+}
+
+void
+PropertyList::changed()
+{
+    _layout = ++lastLayout;
+}
+
+size_t
+PropertyList::find(const ObjectURI& uri) const
+{
+    const bool caseless = getVM(_owner).getSWFVersion() < 7;
+
+    if (!caseless) return findKey(uri.name, false);
+
+    return findKey(uri.noCase(getStringTable(_owner)), true);
+}
+
+size_t
+PropertyList::findKey(string_table::key k, bool noCase) const
+{
+    if (_index.empty()) {
+        // Creation order, so that a caseless lookup finds the first
+        // matching property.
+        for (size_t i = 0, e = _slots.size(); i != e; ++i) {
+            const Slot& s = _slots[i];
+            if ((noCase ? s.nameNoCase : s.name) == k && s.prop) return i;
+        }
+        return npos;
+    }
+
+    if (noCase && !_noCaseIndexed) {
+        _noCaseIndexed = true;
+        reindex();
+    }
+
+    // Equal keys are probed in the order they were added, so this
+    // also finds the first matching property.
+    const Index& index = noCase ? _noCaseIndex : _index;
+    const size_t mask = index.size() - 1;
+
+    for (size_t b = bucket(k, mask); ; b = (b + 1) & mask) {
+        const std::uint32_t e = index[b];
+        if (!e) return npos;
+        const Slot& s = _slots[e - 1];
+        if ((noCase ? s.nameNoCase : s.name) == k && s.prop) return e - 1;
+    }
+}
+
+void
+PropertyList::addToIndex(Index& index, size_t i, bool noCase) const
 {
+    const Slot& s = _slots[i];
+    const size_t mask = index.size() - 1;
+    size_t b = bucket(noCase ? s.nameNoCase : s.name, mask);
+    while (index[b]) b = (b + 1) & mask;
+    index[b] = i + 1;
+}
+
+void
+PropertyList::reindex() const
+{
+    if (_slots.size() <= SmallSize) {
+        Index().swap(_index);
+        Index().swap(_noCaseIndex);
+        _noCaseIndexed = false;
+        return;
+    }
+
+    // Keep the load factor between 1/4 and 1/2 (deleted properties
+    // stay in the index until the slots are compacted).
+    size_t capacity = SmallSize * 2;
+    while (capacity < _slots.size() * 4) capacity *= 2;
+
+    _index.assign(capacity, 0);
+    if (_noCaseIndexed) _noCaseIndex.assign(capacity, 0);
+
+    for (size_t i = 0, e = _slots.size(); i != e; ++i) {
+        if (!_slots[i].prop) continue;
+        addToIndex(_index, i, false);
+        if (_noCaseIndexed) addToIndex(_noCaseIndex, i, true);
+    }
+}
+
+void
+PropertyList::insert(const Property& p)
+{
+    std::unique_ptr<Property> prop(new Property(p));
+    if (GC::incrementalMarking()) prop->setReachable();
+    const ObjectURI& uri = prop->uri();
+    const string_table::key noCase = uri.noCase(getStringTable(_owner));
+    const string_table::key name = uri.name;
+
+    _slots.emplace_back(std::move(prop), name, noCase, _nextOrder++);
+
+    const size_t i = _slots.size() - 1;
+
+    if (i < SmallSize) return;
+
+    if (_index.empty() || _slots.size() * 2 > _index.size()) {
+        reindex();
+        return;
+    }
+
+    addToIndex(_index, i, false);
+    if (_noCaseIndexed) addToIndex(_noCaseIndex, i, true);
+}
+
+void
+PropertyList::replace(size_t i, const Property& p)
+{
+    Slot& s = _slots[i];
+
+    // The Property is assigned in place to keep pointers to it valid.
+    *s.prop = p;
+    if (GC::incrementalMarking()) p.setReachable();
+
+    // A caseless match may have a different name.
+    const ObjectURI& uri = s.prop->uri();
+    if (uri.name == s.name) return;
+
+    s.name = uri.name;
+    s.nameNoCase = uri.noCase(getStringTable(_owner));
+    if (!_index.empty()) reindex();
 }
 
 bool
 PropertyList::setValue(const ObjectURI& uri, const as_value& val,
         const PropFlags& flagsIfMissing)
 {
-	const_iterator found = iterator_find(_props, uri, getVM(_owner));
+	const size_t found = find(uri);
 	
-	if (found == _props.end()) {
+	if (found == npos) {
 		// create a new member
 		Property a(uri, val, flagsIfMissing);
-		// Non slot properties are negative ordering in insertion order
-		_props.push_back(a);
+		insert(a);
+        changed();
 #ifdef GNASH_DEBUG_PROPERTY
         ObjectURI::Logger l(getStringTable(_owner));
         log_debug("Simple AS property %s inserted with flags %s",
@@ -109,7 +227,7 @@ PropertyList::setValue(const ObjectURI& uri, const as_value& val,
 		return true;
 	}
 
-	const Property& prop = *found;
+	const Property& prop = *_slots[found].prop;
 	return prop.setValue(_owner, val);
 
 }
@@ -117,22 +235,26 @@ PropertyList::setValue(const ObjectURI& uri, const as_value& val,
 void
 PropertyList::setFlags(const ObjectURI& uri, int setFlags, int clearFlags)
 {
-	iterator found = iterator_find(_props, uri, getVM(_owner));
-	if (found == _props.end()) return;
-    PropFlags f = found->getFlags();
+	const size_t found = find(uri);
+	if (found == npos) return;
+    const Property& prop = *_slots[found].prop;
+    PropFlags f = prop.getFlags();
     f.set_flags(setFlags, clearFlags);
-	found->setFlags(f);
+	prop.setFlags(f);
+    changed();
 
 }
 
 void
 PropertyList::setFlagsAll(int setFlags, int clearFlags)
 {
-    for (const auto& prop: _props) {
-        PropFlags f = prop.getFlags();
+    for (const Slot& s : _slots) {
+        if (!s.prop) continue;
+        PropFlags f = s.prop->getFlags();
         f.set_flags(setFlags, clearFlags);
-        prop.setFlags(f);
+        s.prop->setFlags(f);
     }
+    changed();
 }
 
 Property*
@@ -145,39 +267,93 @@ PropertyList::getProperty(const ObjectURI& uri) const
         getStringTable(_owner), 10000000, NSV::PROP_uuPROTOuu, 10);
     kcl.check(uri.name);
 #endif // GNASH_STATS_PROPERTY_LOOKUPS
-	iterator found = iterator_find(_props, uri, getVM(_owner));
-	if (found == _props.end()) return nullptr;
-	return const_cast<Property*>(&(*found));
+	const size_t found = find(uri);
+	if (found == npos) return nullptr;
+	return _slots[found].prop.get();
 }
 
 std::pair<bool,bool>
 PropertyList::delProperty(const ObjectURI& uri)
 {
 	//GNASH_REPORT_FUNCTION;
-	iterator found = iterator_find(_props, uri, getVM(_owner));
-	if (found == _props.end()) {
+	const size_t found = find(uri);
+	if (found == npos) {
 		return std::make_pair(false, false);
 	}
 
 	// check if member is protected from deletion
-	if (found->getFlags().test<PropFlags::dontDelete>()) {
+	if (_slots[found].prop->getFlags().test<PropFlags::dontDelete>()) {
 		return std::make_pair(true, false);
 	}
 
-	_props.erase(found);
+    if (_index.empty()) {
+        _slots.erase(_slots.begin() + found);
+    }
+    else {
+        // Indexed slots can't move without a reindex, so leave a hole
+        // and compact once half of them are holes.
+        _slots[found].prop.reset();
+        ++_dead;
+        if (_dead * 2 > _slots.size()) {
+            _slots.erase(std::remove_if(_slots.begin(), _slots.end(),
+                        [](const Slot& s) { return !s.prop; }),
+                    _slots.end());
+            _dead = 0;
+            reindex();
+        }
+    }
+    changed();
 	return std::make_pair(true, true);
 }
 
+std::uint32_t
+PropertyList::order(const ObjectURI& uri) const
+{
+    const size_t found = find(uri);
+    return found == npos ? _nextOrder : _slots[found].order;
+}
+
+void
+PropertyList::restoreOrder(
+        const std::vector<std::pair<ObjectURI, std::uint32_t> >& orders)
+{
+    for (const auto& o : orders) {
+        const size_t found = find(o.first);
+        if (found != npos) _slots[found].order = o.second;
+    }
+
+    _slots.erase(std::remove_if(_slots.begin(), _slots.end(),
+                [](const Slot& s) { return !s.prop; }), _slots.end());
+    _dead = 0;
+    std::stable_sort(_slots.begin(), _slots.end(),
+            [](const Slot& a, const Slot& b) { return a.order < b.order; });
+    reindex();
+    changed();
+}
+
+void
+PropertyList::orderedKeys(
+        std::vector<std::pair<std::uint32_t, ObjectURI> >& keys) const
+{
+    for (const Slot& s : _slots) {
+        if (!s.prop) continue;
+        if (s.prop->getFlags().test<PropFlags::dontEnum>()) continue;
+        keys.emplace_back(s.order, s.prop->uri());
+    }
+}
+
 void
 PropertyList::visitKeys(KeyVisitor& visitor, PropertyTracker& donelist)
     const
 {
     // We should enumerate in order of creation, not lexicographically.
-	for (const auto& prop : _props) {
+	for (const Slot& s : _slots) {
 
-		if (prop.getFlags().test<PropFlags::dontEnum>()) continue;
+        if (!s.prop) continue;
 
-        const ObjectURI& uri = prop.uri();
+		if (s.prop->getFlags().test<PropFlags::dontEnum>()) continue;
+
+        const ObjectURI& uri = s.prop->uri();
 
 		if (donelist.insert(uri).second) {
 			visitor(uri);
@@ -189,8 +365,9 @@ void
 PropertyList::dump()
 {
     ObjectURI::Logger l(getStringTable(_owner));
-	for (const auto& prop : _props) {
-            log_debug("  %s: %s", l(prop.uri()), prop.getValue(_owner));
+	for (const Slot& s : _slots) {
+        if (!s.prop) continue;
+        log_debug("  %s: %s", l(s.prop->uri()), s.prop->getValue(_owner));
 	}
 }
 
@@ -200,13 +377,15 @@ PropertyList::addGetterSetter(const ObjectURI& uri, as_function& getter,
 	const PropFlags& flagsIfMissing)
 {
 	Property a(uri, &getter, setter, flagsIfMissing);
-	iterator found = iterator_find(_props, uri, getVM(_owner));
+	const size_t found = find(uri);
     
-	if (found != _props.end()) {
+	if (found != npos) {
+        const Property& prop = *_slots[found].prop;
 		// copy flags from previous member (even if it's a normal member ?)
-		a.setFlags(found->getFlags());
-		a.setCache(found->getCache());
-		_props.replace(found, a);
+		a.setFlags(prop.getFlags());
+		a.setCache(prop.getCache());
+		replace(found, a);
+        changed();
 
 #ifdef GNASH_DEBUG_PROPERTY
         ObjectURI::Logger l(getStringTable(_owner));
@@ -217,7 +396,8 @@ PropertyList::addGetterSetter(const ObjectURI& uri, as_function& getter,
 	}
 	else {
 		a.setCache(cacheVal);
-		_props.push_back(a);
+		insert(a);
+        changed();
 #ifdef GNASH_DEBUG_PROPERTY
         ObjectURI::Logger l(getStringTable(_owner));
         log_debug("AS GetterSetter %s inserted with flags %s", l(uri),
@@ -234,12 +414,13 @@ PropertyList::addGetterSetter(const ObjectURI& uri, as_c_function_ptr getter,
 {
 	Property a(uri, getter, setter, flagsIfMissing);
 
-	const_iterator found = iterator_find(_props, uri, getVM(_owner));
-	if (found != _props.end())
+	const size_t found = find(uri);
+	if (found != npos)
 	{
 		// copy flags from previous member (even if it's a normal member ?)
-		a.setFlags(found->getFlags());
-		_props.replace(found, a);
+		a.setFlags(_slots[found].prop->getFlags());
+		replace(found, a);
+        changed();
 
 #ifdef GNASH_DEBUG_PROPERTY
         ObjectURI::Logger l(getStringTable(_owner));
@@ -250,7 +431,8 @@ PropertyList::addGetterSetter(const ObjectURI& uri, as_c_function_ptr getter,
 	}
 	else
 	{
-		_props.push_back(a);
+		insert(a);
+        changed();
 #ifdef GNASH_DEBUG_PROPERTY
 		string_table& st = getStringTable(_owner);
 		log_debug("Native GetterSetter %s in namespace %s inserted with "
@@ -265,8 +447,7 @@ bool
 PropertyList::addDestructiveGetter(const ObjectURI& uri, as_function& getter, 
 	const PropFlags& flagsIfMissing)
 {
-	const_iterator found = iterator_find(_props, uri, getVM(_owner));
-	if (found != _props.end())
+	if (find(uri) != npos)
 	{
         ObjectURI::Logger l(getStringTable(_owner));
         log_error(_("Property %s already exists, can't addDestructiveGetter"),
@@ -277,7 +458,8 @@ PropertyList::addDestructiveGetter(const ObjectURI& uri, as_function& getter,
 	// destructive getter doesn't need a setter
 	Property a(uri, &getter, nullptr, flagsIfMissing, true);
 
-	_props.push_back(a);
+	insert(a);
+    changed();
 
 #ifdef GNASH_DEBUG_PROPERTY
     ObjectURI::Logger l(getStringTable(_owner));
@@ -292,12 +474,12 @@ bool
 PropertyList::addDestructiveGetter(const ObjectURI& uri,
 	as_c_function_ptr getter, const PropFlags& flagsIfMissing)
 {
-	iterator found = iterator_find(_props, uri, getVM(_owner));
-	if (found != _props.end()) return false; 
+	if (find(uri) != npos) return false; 
 
 	// destructive getter doesn't need a setter
 	Property a(uri, getter, nullptr, flagsIfMissing, true);
-	_props.push_back(a);
+	insert(a);
+    changed();
 
 #ifdef GNASH_DEBUG_PROPERTY
     ObjectURI::Logger l(getStringTable(_owner));
@@ -310,8 +492,10 @@ PropertyList::addDestructiveGetter(const ObjectURI& uri,
 void
 PropertyList::clear()
 {
-	_props.clear();
+	_slots.clear();
+    _dead = 0;
+    reindex();
+    changed();
 }
 
 } // namespace gnash
-
@@ -24,10 +24,8 @@
 #include <cassert> // for inlines
 #include <utility> // for std::pair
 #include <cstdint>
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/ordered_index.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index/key_extractors.hpp>
+#include <vector>
+#include <memory>
 #include <boost/noncopyable.hpp>
 #include <functional>
 #include <algorithm>
@@ -85,47 +83,12 @@ public:
     typedef std::set<ObjectURI, ObjectURI::LessThan> PropertyTracker;
     typedef Property value_type;
 
-    /// Identifier for the sequenced index
-    struct CreationOrder {};
-
-    /// The sequenced index in creation order.
-    typedef boost::multi_index::sequenced<
-        boost::multi_index::tag<CreationOrder> > SequencedIndex;
-    
-    struct KeyExtractor
-    {
-        typedef const ObjectURI& result_type;
-        result_type operator()(const Property& p) const {
-            return p.uri();
-        }
-    };
-
-    /// Identifier for the case-sensitive index
-    struct Case {};
-    
-    /// The case-sensitive index
-    typedef boost::multi_index::ordered_unique<
-        boost::multi_index::tag<Case>,
-        KeyExtractor,
-        ObjectURI::LessThan> CaseIndex;
-
-    /// Identifier for the case-insensitive index
-    struct NoCase {};
-    
-    /// The case-insensitive index
-    typedef boost::multi_index::ordered_non_unique<
-        boost::multi_index::tag<NoCase>,
-        KeyExtractor,
-        ObjectURI::CaseLessThan> NoCaseIndex;
-
-    /// The container of the Properties.
-    typedef boost::multi_index_container<
-        value_type,
-        boost::multi_index::indexed_by<SequencedIndex, CaseIndex, NoCaseIndex>
-        > container;
-
-    typedef container::iterator iterator;
-    typedef container::const_iterator const_iterator;
+    /// Up to this many properties are found by a linear scan.
+    //
+    /// Most objects have fewer properties than this, and for them a
+    /// scan of a contiguous array beats any index. Larger lists are
+    /// indexed with open addressing hash tables.
+    static const size_t SmallSize = 8;
 
     /// Construct the PropertyList 
     //
@@ -150,11 +113,13 @@ public:
     template <class U, class V>
     void visitValues(V& visitor, U cmp = U()) const {
 
-        for (const auto& prop : _props) {
+        // Getters may add properties, so don't hold on to iterators.
+        for (size_t i = 0; i < _slots.size(); ++i) {
 
-            if (!cmp(prop)) continue;
-            as_value val = prop.getValue(_owner);
-            if (!visitor.accept(prop.uri(), val)) return;
+            const Property* prop = _slots[i].prop.get();
+            if (!prop || !cmp(*prop)) continue;
+            as_value val = prop->getValue(_owner);
+            if (!visitor.accept(prop->uri(), val)) return;
         }
     }
 
@@ -277,9 +242,38 @@ public:
     /// Remove all entries in the container
     void clear();
 
+    /// Take the next place in the creation order.
+    //
+    /// This is for values an as_object keeps outside the list, such as
+    /// Array elements, so that they are enumerated where they were
+    /// created.
+    std::uint32_t nextOrder() {
+        return _nextOrder++;
+    }
+
+    /// The place of a property in the creation order.
+    //
+    /// @return     The place, or nextOrder() if there is no such property.
+    std::uint32_t order(const ObjectURI& uri) const;
+
+    /// Give properties back the places they were created in.
+    //
+    /// The properties are moved to their places, so enumeration follows
+    /// creation order again.
+    ///
+    /// @param orders   The properties to move, with their places. These
+    ///                 must be places taken by nextOrder().
+    void restoreOrder(
+            const std::vector<std::pair<ObjectURI, std::uint32_t> >& orders);
+
+    /// The keys of all non-hidden properties, with their places in the
+    /// creation order.
+    void orderedKeys(
+            std::vector<std::pair<std::uint32_t, ObjectURI> >& keys) const;
+
     /// Return number of properties in this list
     size_t size() const {
-        return _props.size();
+        return _slots.size() - _dead;
     }
 
     /// Dump all members (using log_debug)
@@ -293,16 +287,126 @@ public:
     /// This can be called very frequently, so is inlined to allow the
     /// compiler to optimize it.
     void setReachable() const {
-        std::for_each(_props.begin(), _props.end(),
-                std::mem_fn(&Property::setReachable));
+        for (const Slot& s : _slots) {
+            if (s.prop) s.prop->setReachable();
+        }
+    }
+
+    /// An identifier of the current set of properties and their flags.
+    //
+    /// Layouts are never reused: a new one is assigned, unique among all
+    /// PropertyLists, whenever a property is added, removed or replaced
+    /// or the flags of any property are changed through this list.
+    /// Changing a property's value does not change the layout.
+    //
+    /// This allows lookup results to be cached (see MemberCache).
+    std::uint64_t layout() const {
+        return _layout;
+    }
+
+    /// A counter bumped whenever any __proto__ property changes value.
+    //
+    /// Prototype chains cached alongside a layout must be discarded
+    /// when this changes.
+    static std::uint64_t prototypeEpoch() {
+        return _prototypeEpoch;
+    }
+
+    /// Notify that the value of a __proto__ property changed.
+    static void prototypeChanged() {
+        ++_prototypeEpoch;
     }
 
 private:
 
-    container _props;
+    /// A property in creation order.
+    //
+    /// The keys are kept here rather than only in the Property, so that
+    /// scans and probes don't need to touch the Property itself.
+    struct Slot
+    {
+        Slot(std::unique_ptr<Property> p, string_table::key n,
+                string_table::key nc, std::uint32_t o)
+            :
+            prop(std::move(p)),
+            name(n),
+            nameNoCase(nc),
+            order(o)
+        {}
+
+        /// The Property, or null if it was deleted.
+        //
+        /// Properties are allocated separately so that pointers to them
+        /// stay valid for as long as they are not deleted.
+        std::unique_ptr<Property> prop;
+
+        string_table::key name;
+
+        string_table::key nameNoCase;
+
+        /// The place in the creation order, which _slots follows.
+        std::uint32_t order;
+    };
+
+    typedef std::vector<Slot> Slots;
+
+    /// An open addressing hash table of indices into _slots plus one.
+    typedef std::vector<std::uint32_t> Index;
+
+    /// Marks a property that isn't there.
+    static const size_t npos = static_cast<size_t>(-1);
+
+    /// Return the index of the property in _slots, or npos.
+    //
+    /// Lookups are caseless for SWF6 and below.
+    size_t find(const ObjectURI& uri) const;
+
+    /// Scan or probe for a key.
+    //
+    /// @param noCase   Whether k is a caseless key, to be compared with
+    ///                 Slot::nameNoCase.
+    size_t findKey(string_table::key k, bool noCase) const;
+
+    /// Append a new property.
+    void insert(const Property& p);
+
+    /// Replace the property at _slots[i].
+    void replace(size_t i, const Property& p);
+
+    /// Add _slots[i] to an index.
+    void addToIndex(Index& index, size_t i, bool noCase) const;
+
+    /// Rebuild the indices after the slots have moved or grown.
+    void reindex() const;
+
+    /// Assign a new layout after a structural change.
+    void changed();
+
+    /// The properties, in creation order.
+    Slots _slots;
+
+    /// Number of deleted properties still in _slots.
+    size_t _dead;
+
+    /// The next place in the creation order.
+    std::uint32_t _nextOrder;
+
+    /// Case-sensitive index, used above SmallSize.
+    mutable Index _index;
+
+    /// Caseless index, used above SmallSize once a caseless lookup is
+    /// done.
+    mutable Index _noCaseIndex;
+
+    /// Whether _noCaseIndex is maintained.
+    mutable bool _noCaseIndexed;
 
     as_object& _owner;
 
+    std::uint64_t _layout;
+
+    static std::uint64_t _prototypeEpoch;
+
 };
 
 
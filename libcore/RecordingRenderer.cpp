@@ -0,0 +1,228 @@
+// RecordingRenderer.cpp: a Renderer recording the display list, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "RecordingRenderer.h"
+
+#include "GnashImage.h"
+#include "CachedBitmap.h"
+
+namespace gnash {
+
+RecordingRenderer::RecordingRenderer(Renderer& target,
+        RenderCommands& commands, const RenderCommands& previous,
+        size_t frame, bool retain)
+    :
+    _target(target),
+    _commands(commands),
+    _previous(previous),
+    _frame(frame),
+    _stage(stageMatrix(target)),
+    _retain(retain),
+    _volatile(0)
+{
+    setQuality(target.quality());
+}
+
+RecordingRenderer::RecordingRenderer(Renderer& target,
+        RenderCommands& commands)
+    :
+    _target(target),
+    _commands(commands),
+    _previous(commands),
+    _frame(0),
+    _stage(stageMatrix(target)),
+    _retain(false),
+    _volatile(0)
+{
+    setQuality(target.quality());
+}
+
+SWFMatrix
+RecordingRenderer::stageMatrix(const Renderer& r)
+{
+    const point o = r.pixel_to_world(0, 0);
+    const point x = r.pixel_to_world(1, 0);
+    const point y = r.pixel_to_world(0, 1);
+
+    const double xscale = 1.0 / (x.x - o.x);
+    const double yscale = 1.0 / (y.y - o.y);
+
+    SWFMatrix m;
+    m.set_scale(xscale, yscale);
+    m.set_translation(-o.x * xscale, -o.y * yscale);
+    return m;
+}
+
+void
+RecordingRenderer::markVolatile(Renderer& r)
+{
+    RecordingRenderer* rec = dynamic_cast<RecordingRenderer*>(&r);
+    if (rec) ++rec->_volatile;
+}
+
+bool
+RecordingRenderer::reuse(RetainedCommands& r, const Transform& base)
+{
+    if (!_retain || !r.retainable || r.frame + 1 != _frame) return false;
+
+    if (!(r.base.matrix == base.matrix) ||
+            !(r.base.colorTransform == base.colorTransform)) {
+        return false;
+    }
+    if (!(r.stage == _stage) || r.quality != quality()) return false;
+
+    const size_t begin = _commands.size();
+    _commands.append(_previous, r.begin, r.end);
+
+    r.frame = _frame;
+    r.begin = begin;
+    r.end = _commands.size();
+    return true;
+}
+
+void
+RecordingRenderer::beginSubtree(RetainedCommands& r, const Transform& base)
+{
+    r.frame = _frame;
+    r.begin = _commands.size();
+    r.base = base;
+    r.stage = _stage;
+    r.quality = quality();
+    r.mark = _volatile;
+}
+
+void
+RecordingRenderer::endSubtree(RetainedCommands& r)
+{
+    r.end = _commands.size();
+    r.retainable = _retain && (r.mark == _volatile);
+}
+
+std::string
+RecordingRenderer::description() const
+{
+    return _target.description();
+}
+
+CachedBitmap*
+RecordingRenderer::createCachedBitmap(std::unique_ptr<image::GnashImage> im)
+{
+    return _target.createCachedBitmap(std::move(im));
+}
+
+void
+RecordingRenderer::drawVideoFrame(image::GnashImage* frame,
+        const Transform& xform, const SWFRect* bounds, bool smooth)
+{
+    _commands.drawVideoFrame(frame, xform, bounds, smooth);
+}
+
+void
+RecordingRenderer::drawLine(const std::vector<point>& coords,
+        const rgba& color, const SWFMatrix& mat)
+{
+    _commands.drawLine(coords, color, mat);
+}
+
+void
+RecordingRenderer::draw_poly(const std::vector<point>& corners,
+        const rgba& fill, const rgba& outline, const SWFMatrix& mat,
+        bool masked)
+{
+    _commands.drawPoly(corners, fill, outline, mat, masked);
+}
+
+void
+RecordingRenderer::drawShape(const SWF::ShapeRecord& shape,
+        const Transform& xform)
+{
+    _commands.drawShape(shape, xform);
+}
+
+void
+RecordingRenderer::drawGlyph(const SWF::ShapeRecord& rec, const rgba& color,
+        const SWFMatrix& mat)
+{
+    _commands.drawGlyph(rec, color, mat);
+}
+
+void
+RecordingRenderer::begin_submit_mask()
+{
+    _commands.mask(RenderCommands::Mask::BEGIN_SUBMIT);
+}
+
+void
+RecordingRenderer::end_submit_mask()
+{
+    _commands.mask(RenderCommands::Mask::END_SUBMIT);
+}
+
+void
+RecordingRenderer::disable_mask()
+{
+    _commands.mask(RenderCommands::Mask::DISABLE);
+}
+
+geometry::Range2d<int>
+RecordingRenderer::world_to_pixel(const SWFRect& worldbounds) const
+{
+    return _target.world_to_pixel(worldbounds);
+}
+
+point
+RecordingRenderer::pixel_to_world(int x, int y) const
+{
+    return _target.pixel_to_world(x, y);
+}
+
+bool
+RecordingRenderer::bounds_in_clipping_area(
+        const geometry::Range2d<int>& /*b*/) const
+{
+    return true;
+}
+
+void
+RecordingRenderer::begin_display(const rgba& /*background_color*/,
+        int /*viewport_width*/, int /*viewport_height*/,
+        float /*x0*/, float /*x1*/, float /*y0*/, float /*y1*/)
+{
+}
+
+void
+RecordingRenderer::end_display()
+{
+}
+
+// Drawing to an image isn't recorded, but done on the target at once.
+Renderer*
+RecordingRenderer::startInternalRender(image::GnashImage& buffer)
+{
+    _internal.reset(new Renderer::Internal(_target, buffer));
+    return _internal->renderer();
+}
+
+void
+RecordingRenderer::endInternalRender()
+{
+    _internal.reset();
+}
+
+} // namespace gnash
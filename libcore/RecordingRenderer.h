@@ -0,0 +1,159 @@
+// RecordingRenderer.h: a Renderer recording the display list, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_RECORDINGRENDERER_H
+#define GNASH_RECORDINGRENDERER_H
+
+#include <string>
+#include <memory>
+
+#include "Renderer.h"
+#include "RenderCommands.h"
+#include "Transform.h"
+
+namespace gnash {
+
+/// Records the drawing calls of a frame to be replayed on another Renderer.
+//
+/// movie_root::display() displays the stage on a RecordingRenderer, then
+/// replays the commands on the real renderer. Commands recorded for a
+/// subtree in the previous frame can be copied instead of displaying the
+/// subtree again; see RetainedCommands.
+//
+/// Everything is recorded, whether it is in the clipping area or not, so
+/// that commands recorded in one frame are complete in the next. The
+/// renderer skips what it doesn't need to draw.
+class RecordingRenderer : public Renderer
+{
+public:
+
+    /// @param target   The renderer queries are passed to.
+    /// @param commands Where to record this frame's commands.
+    /// @param previous The commands recorded in the previous frame.
+    /// @param frame    The number of this frame.
+    /// @param retain   Whether subtrees' commands may be used again.
+    RecordingRenderer(Renderer& target, RenderCommands& commands,
+            const RenderCommands& previous, size_t frame,
+            bool retain = true);
+
+    /// Record without using or retaining the commands of any subtree.
+    //
+    /// This is for drawing to an image, see BitmapCache.
+    RecordingRenderer(Renderer& target, RenderCommands& commands);
+
+    /// Note that something drawn depends on more than its display list.
+    //
+    /// This is for video frames and anything else that may change without
+    /// being invalidated. Subtrees drawing it are not retained.
+    ///
+    /// @param r    The renderer being drawn to. Nothing is done unless it
+    ///             is a RecordingRenderer.
+    static void markVolatile(Renderer& r);
+
+    /// The matrix a renderer maps world coordinates to pixels with.
+    //
+    /// The stage is only ever scaled and translated.
+    static SWFMatrix stageMatrix(const Renderer& r);
+
+    /// Whether anything volatile was drawn.
+    bool drewVolatile() const {
+        return _volatile;
+    }
+
+    /// Use the commands a subtree gave in the last frame again.
+    //
+    /// The caller must check that the subtree hasn't changed since. The
+    /// commands are not used if the stage was resized or the quality
+    /// changed, as they may draw images made for the old ones.
+    ///
+    /// @return     false if the commands can't be used, and the subtree
+    ///             should be displayed.
+    bool reuse(RetainedCommands& r, const Transform& base);
+
+    /// Start recording a subtree's commands.
+    void beginSubtree(RetainedCommands& r, const Transform& base);
+
+    /// Finish recording a subtree's commands.
+    void endSubtree(RetainedCommands& r);
+
+    std::string description() const;
+
+    CachedBitmap* createCachedBitmap(std::unique_ptr<image::GnashImage> im);
+
+    void drawVideoFrame(image::GnashImage* frame, const Transform& xform,
+            const SWFRect* bounds, bool smooth);
+
+    void drawLine(const std::vector<point>& coords, const rgba& color,
+            const SWFMatrix& mat);
+
+    void draw_poly(const std::vector<point>& corners, const rgba& fill,
+            const rgba& outline, const SWFMatrix& mat, bool masked);
+
+    void drawShape(const SWF::ShapeRecord& shape, const Transform& xform);
+
+    void drawGlyph(const SWF::ShapeRecord& rec, const rgba& color,
+            const SWFMatrix& mat);
+
+    void begin_submit_mask();
+    void end_submit_mask();
+    void disable_mask();
+
+    geometry::Range2d<int> world_to_pixel(const SWFRect& worldbounds) const;
+
+    point pixel_to_world(int x, int y) const;
+
+    /// Always true, see the class description.
+    bool bounds_in_clipping_area(const geometry::Range2d<int>& b) const;
+
+private:
+
+    void begin_display(const rgba& background_color,
+            int viewport_width, int viewport_height,
+            float x0, float x1, float y0, float y1);
+
+    void end_display();
+
+    Renderer* startInternalRender(image::GnashImage& buffer);
+
+    void endInternalRender();
+
+    Renderer& _target;
+
+    RenderCommands& _commands;
+
+    const RenderCommands& _previous;
+
+    const size_t _frame;
+
+    /// How the target maps the stage to pixels.
+    const SWFMatrix _stage;
+
+    /// Whether subtrees' commands may be used again.
+    const bool _retain;
+
+    /// The number of volatile things drawn so far.
+    size_t _volatile;
+
+    /// Drawing to an image on the target, if any.
+    std::unique_ptr<Renderer::Internal> _internal;
+};
+
+} // namespace gnash
+
+#endif
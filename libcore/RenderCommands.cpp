@@ -0,0 +1,217 @@
+// RenderCommands.cpp: recorded drawing calls, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "RenderCommands.h"
+
+#include <cstdlib>
+
+#include "Renderer.h"
+#include "ShapeRecord.h"
+#include "FillStyle.h"
+#include "GnashImage.h"
+
+namespace gnash {
+
+namespace {
+
+/// Make the call a command records.
+class Replay : public boost::static_visitor<>
+{
+public:
+    explicit Replay(Renderer& r) : _renderer(r) {}
+
+    void operator()(const RenderCommands::DrawShape& c) const {
+        _renderer.drawShape(*c.shape, c.xform);
+    }
+
+    void operator()(const RenderCommands::DrawGlyph& c) const {
+        _renderer.drawGlyph(*c.glyph, c.color, c.mat);
+    }
+
+    void operator()(const RenderCommands::DrawLine& c) const {
+        _renderer.drawLine(c.coords, c.color, c.mat);
+    }
+
+    void operator()(const RenderCommands::DrawPoly& c) const {
+        _renderer.draw_poly(c.corners, c.fill, c.outline, c.mat, c.masked);
+    }
+
+    void operator()(const RenderCommands::DrawVideoFrame& c) const {
+        _renderer.drawVideoFrame(c.frame, c.xform, &c.bounds, c.smooth);
+    }
+
+    void operator()(const RenderCommands::Mask& c) const {
+        switch (c.type) {
+            case RenderCommands::Mask::BEGIN_SUBMIT:
+                _renderer.begin_submit_mask();
+                break;
+            case RenderCommands::Mask::END_SUBMIT:
+                _renderer.end_submit_mask();
+                break;
+            case RenderCommands::Mask::DISABLE:
+                _renderer.disable_mask();
+                break;
+        }
+    }
+
+private:
+    Renderer& _renderer;
+};
+
+std::unique_ptr<image::GnashImage>
+copyImage(const image::GnashImage& im)
+{
+    std::unique_ptr<image::GnashImage> copy;
+    switch (im.type()) {
+        case image::TYPE_RGB:
+            copy.reset(new image::ImageRGB(im.width(), im.height()));
+            break;
+        case image::TYPE_RGBA:
+            copy.reset(new image::ImageRGBA(im.width(), im.height()));
+            break;
+        default:
+            std::abort();
+    }
+    copy->update(im);
+    return copy;
+}
+
+} // anonymous namespace
+
+std::shared_ptr<const SWF::ShapeRecord>
+ShapeCopies::copy(const SWF::ShapeRecord& s, Renderer& renderer)
+{
+    Copy& c = _copies[s.revision()];
+    if (c.shape && !current(c)) c.shape.reset();
+
+    if (!c.shape) {
+        std::shared_ptr<SWF::ShapeRecord> shape =
+            std::make_shared<SWF::ShapeRecord>(s);
+        c.bitmaps.clear();
+
+        // Bitmaps are looked up in their movie_definition when drawn,
+        // which may be gone or have dropped them by then. Those
+        // ActionScript changes are copied, as they may change while
+        // drawn.
+        for (const SWF::Subshape& sub : shape->subshapes()) {
+            for (const FillStyle& f : sub.fillStyles()) {
+                const BitmapFill* b = boost::get<BitmapFill>(&f.fill);
+                if (!b) continue;
+                b->keepBitmap();
+                const CachedBitmap* bm = b->bitmap();
+                if (!bm || !bm->changing() || bm->disposed()) continue;
+                c.bitmaps.push_back(BitmapRevision(bm, bm->revision()));
+                b->keepBitmap(copyBitmap(*bm, renderer));
+            }
+        }
+        c.shape = shape;
+    }
+    else {
+        for (const BitmapRevision& b : c.bitmaps) {
+            auto it = _bitmaps.find(b.first);
+            if (it != _bitmaps.end()) it->second.used = true;
+        }
+    }
+    c.used = true;
+    return c.shape;
+}
+
+bool
+ShapeCopies::current(const Copy& c)
+{
+    for (const BitmapRevision& b : c.bitmaps) {
+        if (b.first->disposed() || b.first->revision() != b.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const CachedBitmap*
+ShapeCopies::copyBitmap(const CachedBitmap& b, Renderer& renderer)
+{
+    BitmapCopy& c = _bitmaps[&b];
+    if (!c.bitmap || c.revision != b.revision()) {
+        // Only BitmapData changes bitmaps, through image().
+        CachedBitmap& source = const_cast<CachedBitmap&>(b);
+        c.bitmap = renderer.createCachedBitmap(copyImage(source.image()));
+        c.revision = b.revision();
+    }
+    c.used = true;
+    return c.bitmap.get();
+}
+
+void
+ShapeCopies::expire()
+{
+    for (auto i = _copies.begin(); i != _copies.end(); ) {
+        if (!i->second.used) {
+            i = _copies.erase(i);
+            continue;
+        }
+        i->second.used = false;
+        ++i;
+    }
+    for (auto i = _bitmaps.begin(); i != _bitmaps.end(); ) {
+        if (!i->second.used) {
+            i = _bitmaps.erase(i);
+            continue;
+        }
+        i->second.used = false;
+        ++i;
+    }
+}
+
+void
+RenderCommands::detach(ShapeCopies& copies, Renderer& renderer)
+{
+    for (Command& c : _commands) {
+        if (DrawShape* d = boost::get<DrawShape>(&c)) {
+            _shapes.push_back(copies.copy(*d->shape, renderer));
+            d->shape = _shapes.back().get();
+        }
+        else if (DrawGlyph* d = boost::get<DrawGlyph>(&c)) {
+            _shapes.push_back(copies.copy(*d->glyph, renderer));
+            d->glyph = _shapes.back().get();
+        }
+        else if (DrawVideoFrame* d = boost::get<DrawVideoFrame>(&c)) {
+            _frames.push_back(copyImage(*d->frame));
+            d->frame = _frames.back().get();
+        }
+    }
+}
+
+void
+RenderCommands::replay(Renderer& renderer) const
+{
+    const Replay r(renderer);
+    for (const Command& c : _commands) boost::apply_visitor(r, c);
+}
+
+void
+RenderFrame::draw(Renderer& renderer) const
+{
+    Renderer::External ex(renderer, background, width, height,
+            bounds.get_x_min(), bounds.get_x_max(),
+            bounds.get_y_min(), bounds.get_y_max());
+
+    commands.replay(renderer);
+}
+
+} // namespace gnash
@@ -0,0 +1,327 @@
+// RenderCommands.h: recorded drawing calls, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_RENDERCOMMANDS_H
+#define GNASH_RENDERCOMMANDS_H
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+#include <boost/variant.hpp>
+#include <boost/intrusive_ptr.hpp>
+
+#include "dsodefs.h"
+#include "GnashEnums.h"
+#include "CachedBitmap.h"
+#include "Transform.h"
+#include "SWFMatrix.h"
+#include "SWFRect.h"
+#include "RGBA.h"
+#include "Point2d.h"
+
+namespace gnash {
+    class Renderer;
+    namespace SWF {
+        class ShapeRecord;
+    }
+    namespace image {
+        class GnashImage;
+    }
+}
+
+namespace gnash {
+
+/// Copies of shapes, kept for as long as they are drawn.
+//
+/// Shapes are copied once for each revision, so one that doesn't change
+/// is only copied the first time it is drawn.
+///
+/// Bitmaps ActionScript changes are copied too, so that they can be
+/// changed while an earlier frame draws them. A shape filled with such
+/// a bitmap is copied again whenever the bitmap has changed.
+class DSOEXPORT ShapeCopies
+{
+public:
+
+    /// Return a copy of a shape.
+    //
+    /// @param s        The shape to copy.
+    /// @param renderer The Renderer to make bitmap copies with.
+    std::shared_ptr<const SWF::ShapeRecord> copy(const SWF::ShapeRecord& s,
+            Renderer& renderer);
+
+    /// Forget the copies not asked for since the last call.
+    void expire();
+
+private:
+
+    /// A bitmap and its revision when it was copied.
+    typedef std::pair<boost::intrusive_ptr<const CachedBitmap>, size_t>
+        BitmapRevision;
+
+    struct Copy
+    {
+        std::shared_ptr<const SWF::ShapeRecord> shape;
+        std::vector<BitmapRevision> bitmaps;
+        bool used;
+    };
+
+    struct BitmapCopy
+    {
+        boost::intrusive_ptr<const CachedBitmap> bitmap;
+        size_t revision;
+        bool used;
+    };
+
+    /// Whether none of the bitmaps a copy draws has changed since.
+    static bool current(const Copy& c);
+
+    /// Return a copy of a bitmap as it is now.
+    const CachedBitmap* copyBitmap(const CachedBitmap& b, Renderer& renderer);
+
+    std::map<std::uint64_t, Copy> _copies;
+
+    /// The bitmap copies, by the bitmap they are copies of.
+    std::map<boost::intrusive_ptr<const CachedBitmap>, BitmapCopy> _bitmaps;
+};
+
+/// A sequence of drawing calls, recorded to be replayed on a Renderer.
+//
+/// Shapes, glyphs and video frames are referred to, not copied, so they
+/// must not change or go away until the commands have been replayed,
+/// unless detach() has been called.
+class DSOEXPORT RenderCommands
+{
+public:
+
+    struct DrawShape
+    {
+        const SWF::ShapeRecord* shape;
+        Transform xform;
+    };
+
+    struct DrawGlyph
+    {
+        const SWF::ShapeRecord* glyph;
+        rgba color;
+        SWFMatrix mat;
+    };
+
+    struct DrawLine
+    {
+        std::vector<point> coords;
+        rgba color;
+        SWFMatrix mat;
+    };
+
+    struct DrawPoly
+    {
+        std::vector<point> corners;
+        rgba fill;
+        rgba outline;
+        SWFMatrix mat;
+        bool masked;
+    };
+
+    struct DrawVideoFrame
+    {
+        image::GnashImage* frame;
+        Transform xform;
+        SWFRect bounds;
+        bool smooth;
+    };
+
+    /// The mask calls of a Renderer.
+    struct Mask
+    {
+        enum Type
+        {
+            BEGIN_SUBMIT,
+            END_SUBMIT,
+            DISABLE
+        };
+        Type type;
+    };
+
+    typedef boost::variant<DrawShape, DrawGlyph, DrawLine, DrawPoly,
+            DrawVideoFrame, Mask> Command;
+
+    typedef std::vector<Command> Commands;
+
+    void drawShape(const SWF::ShapeRecord& shape, const Transform& xform) {
+        const DrawShape c = { &shape, xform };
+        _commands.push_back(c);
+    }
+
+    void drawGlyph(const SWF::ShapeRecord& glyph, const rgba& color,
+            const SWFMatrix& mat) {
+        const DrawGlyph c = { &glyph, color, mat };
+        _commands.push_back(c);
+    }
+
+    void drawLine(const std::vector<point>& coords, const rgba& color,
+            const SWFMatrix& mat) {
+        const DrawLine c = { coords, color, mat };
+        _commands.push_back(c);
+    }
+
+    void drawPoly(const std::vector<point>& corners, const rgba& fill,
+            const rgba& outline, const SWFMatrix& mat, bool masked) {
+        const DrawPoly c = { corners, fill, outline, mat, masked };
+        _commands.push_back(c);
+    }
+
+    void drawVideoFrame(image::GnashImage* frame, const Transform& xform,
+            const SWFRect* bounds, bool smooth) {
+        const DrawVideoFrame c = { frame, xform, *bounds, smooth };
+        _commands.push_back(c);
+    }
+
+    void mask(Mask::Type type) {
+        const Mask c = { type };
+        _commands.push_back(c);
+    }
+
+    /// Append commands recorded in another list.
+    //
+    /// The other list must not have been detached.
+    ///
+    /// @param begin    The index of the first command to append.
+    /// @param end      The index after the last command to append.
+    void append(const RenderCommands& other, size_t begin, size_t end) {
+        _commands.insert(_commands.end(), other._commands.begin() + begin,
+                other._commands.begin() + end);
+    }
+
+    /// Refer to copies of what the commands draw instead of the originals.
+    //
+    /// After this the commands can be replayed while the display list
+    /// changes, even in another thread. Bitmaps are shared unless
+    /// ActionScript may change them.
+    ///
+    /// @param copies   Where to find or keep shape and glyph copies.
+    /// @param renderer The Renderer to make bitmap copies with.
+    void detach(ShapeCopies& copies, Renderer& renderer);
+
+    /// Make the same calls on a Renderer, in the same order.
+    void replay(Renderer& renderer) const;
+
+    const Commands& commands() const {
+        return _commands;
+    }
+
+    bool empty() const {
+        return _commands.empty();
+    }
+
+    size_t size() const {
+        return _commands.size();
+    }
+
+    /// Forget all commands, keeping the storage for the next ones.
+    void clear() {
+        _commands.clear();
+        _shapes.clear();
+        _frames.clear();
+    }
+
+    void swap(RenderCommands& other) {
+        _commands.swap(other._commands);
+        _shapes.swap(other._shapes);
+        _frames.swap(other._frames);
+    }
+
+private:
+    Commands _commands;
+
+    /// The copies detached commands draw.
+    std::vector<std::shared_ptr<const SWF::ShapeRecord> > _shapes;
+    std::vector<std::shared_ptr<image::GnashImage> > _frames;
+};
+
+/// A recorded frame of the stage, with what is needed to draw it.
+struct DSOEXPORT RenderFrame
+{
+    RenderFrame(const rgba& background, int width, int height,
+            const SWFRect& bounds)
+        :
+        background(background),
+        width(width),
+        height(height),
+        bounds(bounds)
+    {}
+
+    /// Draw the frame, as movie_root::display() would.
+    void draw(Renderer& renderer) const;
+
+    rgba background;
+
+    /// The size of the stage in pixels.
+    int width;
+    int height;
+
+    /// The frame size of the root movie.
+    SWFRect bounds;
+
+    RenderCommands commands;
+};
+
+/// Where the commands of a subtree of the display list were recorded.
+//
+/// Each MovieClip keeps one, so that when neither it nor its children
+/// changed, the commands it gave in the last frame can be used again
+/// without displaying it.
+struct RetainedCommands
+{
+    RetainedCommands()
+        :
+        frame(0),
+        begin(0),
+        end(0),
+        quality(QUALITY_HIGH),
+        mark(0),
+        retainable(false)
+    {}
+
+    /// The frame the commands were recorded in.
+    size_t frame;
+
+    /// The range of the commands in that frame's list.
+    size_t begin;
+    size_t end;
+
+    /// The transform the subtree was displayed with.
+    Transform base;
+
+    /// How the stage was mapped to pixels, and the quality it was drawn
+    /// with. Images drawn for the subtree depend on these.
+    SWFMatrix stage;
+    Quality quality;
+
+    /// The number of volatile things drawn when recording began.
+    size_t mark;
+
+    /// Whether the commands depend only on the state of the subtree.
+    bool retainable;
+};
+
+} // namespace gnash
+
+#endif
@@ -79,6 +79,10 @@ SWFMovie::advance()
 		);
 	}
 
+    // The last frame is drawn, or its bitmaps are held by the copies
+    // being drawn.
+    _def->expireBitmaps();
+
     MovieClip::advance(); 
 }
     
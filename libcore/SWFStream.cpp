@@ -28,6 +28,7 @@
 
 #include <cstring>
 #include <climits>
+#include <algorithm>
 
 //#define USE_TU_FILE_BYTESWAPPING 1
 
@@ -37,10 +38,27 @@ SWFStream::SWFStream(IOChannel* input)
     :
     m_input(input),
     m_current_byte(0),
-    m_unused_bits(0)
+    m_unused_bits(0),
+    _data(nullptr),
+    _size(0),
+    _pos(0)
 {
 }
 
+SWFStream::SWFStream(const std::uint8_t* data, unsigned long size,
+        unsigned long pos)
+    :
+    m_input(nullptr),
+    m_current_byte(0),
+    m_unused_bits(0),
+    _data(data),
+    _size(size),
+    _pos(pos)
+{
+    assert(_data);
+    assert(_pos <= _size);
+}
+
 
 SWFStream::~SWFStream()
 {
@@ -82,14 +100,73 @@ unsigned SWFStream::read(char *buf, unsigned count)
 
     if ( ! count ) return 0;
 
+    if (_data) {
+        count = std::min<unsigned long>(count, _size - _pos);
+        std::memcpy(buf, _data + _pos, count);
+        _pos += count;
+        return count;
+    }
+
     return m_input->read(buf, count);
 }
 
+std::uint8_t
+SWFStream::next_byte()
+{
+    if (!_data) {
+        std::uint8_t b;
+        if (m_input->read(&b, 1) < 1) {
+            throw ParserException(_("Unexpected end of stream while reading"));
+        }
+        return b;
+    }
+
+    if (_pos >= _size) {
+        throw ParserException(_("Unexpected end of stream while reading"));
+    }
+    return _data[_pos++];
+}
+
+unsigned
+SWFStream::read_memory_bits(unsigned short bitcount)
+{
+    assert(bitcount > m_unused_bits);
+    assert(bitcount <= 32);
+
+    // The bits still needed after those left in the current byte, and
+    // the bytes they come from.
+    const unsigned needed = bitcount - m_unused_bits;
+    const unsigned long bytes = (needed + 7) / 8;
+
+    if (_size - _pos < bytes) {
+        throw ParserException(_("Unexpected end of stream while reading"));
+    }
+
+    // Fill a bit buffer with as many as 8 bytes at once, most
+    // significant first.
+    const std::uint8_t* p = _data + _pos;
+    const unsigned long avail = std::min<unsigned long>(_size - _pos, 8);
+    std::uint64_t buffer = 0;
+    for (unsigned long i = 0; i < avail; ++i) {
+        buffer = (buffer << 8) | p[i];
+    }
+    buffer <<= 8 * (8 - avail);
+
+    const std::uint64_t unused = m_current_byte & ((1 << m_unused_bits) - 1);
+    const std::uint32_t value = (unused << needed) | (buffer >> (64 - needed));
+
+    _pos += bytes;
+    m_current_byte = p[bytes - 1];
+    m_unused_bits = bytes * 8 - needed;
+
+    return value;
+}
+
 bool SWFStream::read_bit()
 {
     if (!m_unused_bits)
     {
-        m_current_byte = m_input->read_byte(); // don't want to align here
+        m_current_byte = next_byte(); // don't want to align here
         m_unused_bits = 7;
         return (m_current_byte&0x80);
     }
@@ -112,6 +189,8 @@ unsigned SWFStream::read_uint(unsigned short bitcount)
         throw ParserException("Unexpectedly long value advertised.");
     }
 
+    if (_data && bitcount > m_unused_bits) return read_memory_bits(bitcount);
+
     // Optimization for multibyte read
     if ( bitcount > m_unused_bits )
     {
@@ -134,8 +213,10 @@ unsigned SWFStream::read_uint(unsigned short bitcount)
         assert (bytesToRead <= 4);
         byte cache[5]; // at most 4 bytes in the cache + eventual spare bits
 
-        if ( spareBits ) m_input->read(&cache, bytesToRead+1);
-        else m_input->read(&cache, bytesToRead);
+        const int cacheSize = spareBits ? bytesToRead + 1 : bytesToRead;
+        if (m_input->read(&cache, cacheSize) < cacheSize) {
+            throw ParserException(_("Unexpected end of stream while reading"));
+        }
 
         for (int i=0; i<bytesToRead; ++i)
         {
@@ -161,7 +242,7 @@ unsigned SWFStream::read_uint(unsigned short bitcount)
 
     if (!m_unused_bits)
     {
-        m_current_byte = m_input->read_byte();
+        m_current_byte = next_byte();
         m_unused_bits = 8;
     }
 
@@ -194,8 +275,8 @@ SWFStream::read_sint(unsigned short bitcount)
 
     std::int32_t value = std::int32_t(read_uint(bitcount));
 
-    // Sign extend...
-    if (value & (1 << (bitcount - 1))) {
+    // Sign extend, unless all 32 bits were read.
+    if (bitcount < 32 && (value & (1 << (bitcount - 1)))) {
         value |= static_cast<std::uint32_t>(-1) << bitcount;
     }
 
@@ -319,7 +400,7 @@ double SWFStream::read_d64()
 std::uint8_t    SWFStream::read_u8()
 {
     align();
-    return m_input->read_byte();
+    return next_byte();
 }
 
 std::int8_t
@@ -446,6 +527,8 @@ void SWFStream::read_string_with_length(unsigned len, std::string& to)
 unsigned long
 SWFStream::tell()
 {
+    if (_data) return _pos;
+
     int pos = m_input->tell();
     // TODO: check return value? Could be negative.
     return static_cast<unsigned long>(pos);
@@ -479,6 +562,15 @@ SWFStream::seek(unsigned long pos)
         }
     }
 
+    if (_data) {
+        if (pos > _size) {
+            log_swferror(_("Unexpected end of stream"));
+            return false;
+        }
+        _pos = pos;
+        return true;
+    }
+
     // Do the seek.
     if (!m_input->seek(pos))
     {
@@ -500,6 +592,13 @@ SWFStream::get_tag_end_position()
     return _tagBoundsStack.back().second;
 }
 
+unsigned long
+SWFStream::get_tag_start_position()
+{
+    assert(!_tagBoundsStack.empty());
+    return _tagBoundsStack.back().first;
+}
+
 
 SWF::TagType
 SWFStream::open_tag()
@@ -587,7 +686,13 @@ SWFStream::close_tag()
 
     //log_debug("Close tag called at %d, stream size: %d", endPos);
 
-    if (!m_input->seek(endPos))
+    if (_data) {
+        if (static_cast<unsigned long>(endPos) > _size) {
+            throw ParserException(_("Could not seek to reported end of tag"));
+        }
+        _pos = endPos;
+    }
+    else if (!m_input->seek(endPos))
     {
         // We'll go on reading right past the end of the stream
         // if we don't throw an exception.
@@ -600,6 +705,9 @@ SWFStream::close_tag()
 void
 SWFStream::consumeInput()
 {
+	// There are no writers to a stream in memory.
+	if (_data) return;
+
 	// IOChannel::go_to_end is documented
 	// to possibly throw an exception (!)
 	try {
@@ -59,6 +59,19 @@ class DSOEXPORT SWFStream
 {
 public:
 	SWFStream(IOChannel* input);
+
+	/// Read a SWF stream that is all in memory.
+	//
+	/// This is much faster than reading through an IOChannel, as
+	/// bytes and bits are taken straight from the buffer.
+	///
+	/// @param data	The stream. Positions are offsets into it. It
+	///		must be kept as long as the SWFStream.
+	/// @param size	The number of bytes of data.
+	/// @param pos	The position to start reading at.
+	SWFStream(const std::uint8_t* data, unsigned long size,
+			unsigned long pos);
+
 	~SWFStream();
 
 	/// \brief
@@ -195,19 +208,19 @@ public:
 		if (!(res & 0x00000080)) return res;
         
         ensureBytes(1);
-		res = (res & 0x0000007F) | read_u8() << 7;
+		res = (res & 0x0000007F) | static_cast<std::uint32_t>(read_u8()) << 7;
 		if (!(res & 0x00004000)) return res;
         
         ensureBytes(1);
-		res = (res & 0x00003FFF) | read_u8() << 14;
+		res = (res & 0x00003FFF) | static_cast<std::uint32_t>(read_u8()) << 14;
 		if (!(res & 0x00200000)) return res;
         
         ensureBytes(1);
-		res = (res & 0x001FFFFF) | read_u8() << 21;
+		res = (res & 0x001FFFFF) | static_cast<std::uint32_t>(read_u8()) << 21;
 		if (!(res & 0x10000000)) return res;
         
         ensureBytes(1);
-		res = (res & 0x0FFFFFFF) | read_u8() << 28;
+		res = (res & 0x0FFFFFFF) | static_cast<std::uint32_t>(read_u8()) << 28;
 		return res;
 	}
 
@@ -319,6 +332,9 @@ public:
 	/// Return the file position of the end of the current tag.
 	unsigned long get_tag_end_position();
 
+	/// Return the file position of the header of the current tag.
+	unsigned long get_tag_start_position();
+
 	/// Open an SWF tag and return it's type.
 	//
 	/// aligned read
@@ -414,10 +430,25 @@ public:
 
 private:
 
+	/// Read the next byte, for bitwise reads.
+	std::uint8_t next_byte();
+
+	/// Read more bits than are left in m_current_byte from memory.
+	unsigned read_memory_bits(unsigned short bitcount);
+
 	IOChannel*	m_input;
 	std::uint8_t	m_current_byte;
 	std::uint8_t	m_unused_bits;
 
+	/// The stream when it is in memory, or 0.
+	const std::uint8_t* _data;
+
+	/// The size of _data.
+	unsigned long _size;
+
+	/// The position of the next byte in _data.
+	unsigned long _pos;
+
 	typedef std::pair<unsigned long,unsigned long> TagBoundaries;
 	// position of start and end of tag
 	std::vector<TagBoundaries> _tagBoundsStack;
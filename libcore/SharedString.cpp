@@ -0,0 +1,145 @@
+// SharedString.cpp: immutable, shared ActionScript strings, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "SharedString.h"
+
+#include <vector>
+
+namespace gnash {
+
+namespace {
+
+/// Concatenations up to this length are joined straight away, as a
+/// rope node would cost more than copying.
+const size_t MaxFlat = 256;
+
+}
+
+SharedString::Rep::Rep(std::string s)
+    :
+    refs(1),
+    length(s.size()),
+    flat(std::move(s)),
+    left(nullptr),
+    right(nullptr)
+{
+}
+
+SharedString::Rep::Rep(Rep* l, Rep* r)
+    :
+    refs(1),
+    length(l->length + r->length),
+    left(l),
+    right(r)
+{
+}
+
+SharedString::SharedString(std::string s)
+    :
+    _rep(s.empty() ? nullptr : new Rep(std::move(s)))
+{
+}
+
+const std::string&
+SharedString::emptyString()
+{
+    static const std::string empty;
+    return empty;
+}
+
+void
+SharedString::destroy(Rep* rep)
+{
+    // Ropes built by repeated concatenation can be very deep.
+    std::vector<Rep*> dead;
+
+    for (;;) {
+        if (rep->left) {
+            for (Rep* child : { rep->left, rep->right }) {
+                if (child->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    dead.push_back(child);
+                }
+            }
+        }
+        delete rep;
+
+        if (dead.empty()) return;
+        rep = dead.back();
+        dead.pop_back();
+    }
+}
+
+void
+SharedString::flatten(Rep& rep)
+{
+    std::string s;
+    s.reserve(rep.length);
+
+    std::vector<const Rep*> todo(1, &rep);
+    while (!todo.empty()) {
+        const Rep* r = todo.back();
+        todo.pop_back();
+        if (r->left) {
+            todo.push_back(r->right);
+            todo.push_back(r->left);
+        }
+        else s += r->flat;
+    }
+
+    rep.flat.swap(s);
+
+    Rep* l = rep.left;
+    Rep* r = rep.right;
+    rep.left = rep.right = nullptr;
+    release(l);
+    release(r);
+}
+
+SharedString
+operator+(const SharedString& a, const SharedString& b)
+{
+    typedef SharedString::Rep Rep;
+
+    if (b.empty()) return a;
+    if (a.empty()) return b;
+
+    if (a.size() + b.size() <= MaxFlat) {
+        std::string s;
+        s.reserve(a.size() + b.size());
+        s += a.str();
+        s += b.str();
+        return SharedString(std::move(s));
+    }
+
+    // Appending a few characters at a time is the common case: add
+    // them to the last piece of the rope rather than making a node for
+    // each. b is short enough to be flat.
+    Rep* last = a._rep->right;
+    if (last && !last->left && last->length + b.size() <= MaxFlat) {
+        SharedString::addRef(a._rep->left);
+        return SharedString(new Rep(a._rep->left,
+                    new Rep(last->flat + b.str())));
+    }
+
+    SharedString::addRef(a._rep);
+    SharedString::addRef(b._rep);
+    return SharedString(new Rep(a._rep, b._rep));
+}
+
+} // namespace gnash
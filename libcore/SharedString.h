@@ -0,0 +1,174 @@
+// SharedString.h: immutable, shared ActionScript strings, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_SHAREDSTRING_H
+#define GNASH_SHAREDSTRING_H
+
+#include <string>
+#include <cstddef>
+#include <ostream>
+#include <atomic>
+
+#include "dsodefs.h"
+
+namespace gnash {
+
+/// An immutable, reference counted string.
+//
+/// This is the storage of String as_values. Copying a SharedString
+/// only copies a pointer, and concatenation does not copy either
+/// operand: it makes a node referring to both (a rope). The characters
+/// are only joined into a single buffer when str() is first called,
+/// so building a string with a series of concatenations takes linear
+/// rather than quadratic time. Short strings are always kept flat.
+//
+/// Reference counting is thread-safe, but flattening is not: a string
+/// built by concatenation should only be read by the thread that
+/// built it, i.e. the thread running ActionScript.
+class DSOEXPORT SharedString
+{
+public:
+
+    /// Construct an empty string.
+    SharedString() : _rep(nullptr) {}
+
+    explicit SharedString(std::string s);
+
+    SharedString(const SharedString& other)
+        :
+        _rep(other._rep)
+    {
+        addRef(_rep);
+    }
+
+    SharedString(SharedString&& other) noexcept
+        :
+        _rep(other._rep)
+    {
+        other._rep = nullptr;
+    }
+
+    ~SharedString() {
+        release(_rep);
+    }
+
+    SharedString& operator=(const SharedString& other) {
+        addRef(other._rep);
+        release(_rep);
+        _rep = other._rep;
+        return *this;
+    }
+
+    SharedString& operator=(SharedString&& other) noexcept {
+        if (this != &other) {
+            release(_rep);
+            _rep = other._rep;
+            other._rep = nullptr;
+        }
+        return *this;
+    }
+
+    /// The characters of the string, joined if necessary.
+    const std::string& str() const {
+        if (!_rep) return emptyString();
+        if (_rep->left) flatten(*_rep);
+        return _rep->flat;
+    }
+
+    /// The length of the string in bytes, without joining it.
+    size_t size() const {
+        return _rep ? _rep->length : 0;
+    }
+
+    bool empty() const {
+        return !size();
+    }
+
+    /// Whether the characters have not been joined yet.
+    bool isRope() const {
+        return _rep && _rep->left;
+    }
+
+    /// Concatenate two strings.
+    friend DSOEXPORT SharedString operator+(const SharedString& a,
+            const SharedString& b);
+
+    friend bool operator==(const SharedString& a, const SharedString& b) {
+        return a._rep == b._rep || a.str() == b.str();
+    }
+
+private:
+
+    struct Rep
+    {
+        explicit Rep(std::string s);
+
+        Rep(Rep* l, Rep* r);
+
+        std::atomic<size_t> refs;
+
+        /// The length in bytes.
+        size_t length;
+
+        /// The characters, once the string is flat.
+        std::string flat;
+
+        /// The two halves of an unjoined rope, or null.
+        Rep* left;
+        Rep* right;
+    };
+
+    explicit SharedString(Rep* rep) : _rep(rep) {}
+
+    static void addRef(Rep* rep) {
+        if (rep) rep->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void release(Rep* rep) {
+        if (rep && rep->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            destroy(rep);
+        }
+    }
+
+    /// Free an unreferenced string, and a whole rope without recursion.
+    static void destroy(Rep* rep);
+
+    static const std::string& emptyString();
+
+    /// Join the characters of a rope into its own buffer.
+    static void flatten(Rep& rep);
+
+    Rep* _rep;
+};
+
+inline bool
+operator!=(const SharedString& a, const SharedString& b)
+{
+    return !(a == b);
+}
+
+inline std::ostream&
+operator<<(std::ostream& o, const SharedString& s)
+{
+    return o << s.str();
+}
+
+} // namespace gnash
+
+#endif
@@ -37,6 +37,7 @@
 #include <utility>
 #include <map>
 #include <functional>
+#include <boost/tuple/tuple.hpp>
 
 #include "utf8.h"
 #include "log.h"
@@ -56,6 +57,7 @@
 #include "MouseButtonState.h"
 #include "Global_as.h"
 #include "Renderer.h"
+#include "RecordingRenderer.h"
 #include "Transform.h"
 #include "ObjectURI.h"
 #include "Movie.h"
@@ -290,6 +292,10 @@ TextField::display(Renderer& renderer, const Transform& base)
 {
     const DisplayObject::MaskRenderer mr(renderer, *this);
 
+    // Registering the variable is retried every frame until it succeeds,
+    // so this mustn't be skipped until then.
+    if (!_text_variable_registered) RecordingRenderer::markVolatile(renderer);
+
     registerTextVariable();
 
     const bool drawBorder = getDrawBorder();
@@ -349,9 +355,11 @@ TextField::display(Renderer& renderer, const Transform& base)
 
     //offset the lines
     int yoffset = (getFontHeight() + fontLeading) + PADDING_TWIPS;
-    size_t recordline;
+    size_t recordline = 0;
     for (size_t i = 0; i < _textRecords.size(); ++i) {
-        recordline = 0;
+        // Records usually start in order, so the search for the line
+        // carries on from the last record's.
+        if (i && _recordStarts[i] < _recordStarts[i - 1]) recordline = 0;
         //find the line the record is on
         while (recordline < _line_starts.size() && 
                 _line_starts[recordline] <= _recordStarts[i]) {
@@ -386,6 +394,11 @@ TextField::add_invalidated_bounds(InvalidatedRanges& ranges, bool force)
 
     SWFRect bounds = getBounds();
     bounds.expand_to_rect(m_text_bounding_box); 
+
+    // Only the lines laid out again after a change to the text.
+    const SWFRect& area = invalidatedArea();
+    if (!area.is_null()) bounds = area;
+
     wm.transform(bounds);
     ranges.add(bounds.getRange());            
 }
@@ -495,6 +508,11 @@ TextField::replaceSelection(const std::string& replace)
     const size_t replaceLength = wstr.size();
 
     _text.replace(start, end - start, wstr);
+
+    // The layout of the lines after the change can't be reused.
+    while (!_lineLayouts.empty() && _lineLayouts.back().textPos > start) {
+        _lineLayouts.pop_back();
+    }
     _selection = std::make_pair(start + replaceLength, start + replaceLength);
 }
 
@@ -800,14 +818,33 @@ TextField::updateText(const std::wstring& wstr)
     _textDefined = true;
     if (_text == wstr) return;
 
-    set_invalidated();
+    const std::wstring::size_type common = std::min(_text.size(), wstr.size());
+    const std::wstring::size_type changed = std::mismatch(_text.begin(),
+            _text.begin() + common, wstr.begin()).first - _text.begin();
+
+    // If the lines before the change are kept, only the others need
+    // redrawing. This starts a line early for the cursor, which may
+    // move off the line before.
+    const LineLayout* line = resumeLine(changed);
+    const int lineHeight = getFontHeight() + PADDING_TWIPS;
+    const int top = line ? (static_cast<int>(line->lineStarts) - 2 -
+            static_cast<int>(_scroll)) * lineHeight : 0;
+
+    if (top > 0 && !invalidated()) {
+        SWFRect area = getBounds();
+        area.expand_to_rect(m_text_bounding_box);
+        area.set_to_rect(area.get_x_min(), _bounds.get_y_min() + top,
+                area.get_x_max(), area.get_y_max());
+        set_area_invalidated(area);
+    }
+    else set_invalidated();
 
     _text = wstr;
 
     _selection.first = std::min(_selection.first, _text.size());
     _selection.second = std::min(_selection.second, _text.size());
 
-    format_text();
+    format_text(changed);
 }
 
 void
@@ -1011,20 +1048,61 @@ TextField::insertTab(SWF::TextRecord& rec, std::int32_t& x, float scale)
 }
 
 void
-TextField::format_text()
+TextField::format_text(std::wstring::size_type changed)
 {
+    if (const LineLayout* line = resumeLine(changed)) {
+
+        // Carry on from the start of the line the change is on.
+        _textRecords.resize(line->records);
+        _recordStarts.resize(line->recordStarts);
+        _line_starts.resize(line->lineStarts);
+        _glyphcount = line->glyphcount;
+        m_text_bounding_box = line->textBounds;
+        _maxScroll = line->maxScroll;
+
+        std::int32_t x = line->x;
+        std::int32_t y = line->y;
+        SWF::TextRecord rec = line->rec;
+        int last_code = line->lastCode;
+        int last_space_glyph = line->lastSpaceGlyph;
+        LineStarts::value_type last_line_start_record =
+            line->lastLineStartRecord;
+        std::wstring::const_iterator it = _text.begin() + line->textPos;
+
+        _lineLayouts.resize(line - &_lineLayouts.front() + 1);
+
+        const size_t scroll = _scroll;
+
+        handleChar(it, _text.end(), x, y, rec, last_code, last_space_glyph,
+                last_line_start_record);
+
+        _textRecords.push_back(rec);
+        align_line(getTextAlignment(), last_line_start_record, x);
+        scrollLines();
+
+        // The caller invalidates the lines that change, so everything is
+        // only redrawn if they scrolled.
+        if (!invalidated() || _scroll != scroll) set_invalidated();
+        return;
+    }
+
     _textRecords.clear();
     _line_starts.clear();
     _recordStarts.clear();
+    _lineLayouts.clear();
     _glyphcount = 0;
 
+    // Only this layout counts, so that it is the same however the text
+    // came to be what it is.
+    reset_bounding_box(0, 0);
+    _maxScroll = 1;
+
     _recordStarts.push_back(0);
 		
     // nothing more to do if text is empty
     if (_text.empty()) {
         // TODO: should we still reset _bounds if autoSize != AUTOSIZE_NONE ?
         //       not sure we should...
-        reset_bounding_box(0, 0);
         return;
     }
     
@@ -1112,6 +1190,12 @@ TextField::format_text()
     size_t last_line_start_record = 0;
 
     _line_starts.push_back(0);
+
+    _layoutKey = layoutKey();
+    if (incrementalLayout()) {
+        saveLine(0, x, y, rec, last_code, last_space_glyph,
+                last_line_start_record);
+    }
     
     // String iterators are very sensitive to 
     // potential changes to the string (to allow for copy-on-write).
@@ -1305,9 +1389,13 @@ TextField::handleChar(std::wstring::const_iterator& it,
     const float leading = 0;
     const float fontLeading = 0;
     
+    const bool saveLines = incrementalLayout();
+
     std::uint32_t code = 0;
     while (it != e)
     {
+        const size_t lines = _line_starts.size();
+
         code = *it++;
         if (!code) break;
 
@@ -1875,9 +1963,74 @@ TextField::handleChar(std::wstring::const_iterator& it,
 #endif 
             }
         }
+
+        if (saveLines && _line_starts.size() != lines) {
+            saveLine(it - _text.begin(), x, y, rec, last_code,
+                    last_space_glyph, last_line_start_record);
+        }
     }
 }
 
+bool
+TextField::incrementalLayout() const
+{
+    return !doHtml() && (getAutoSize() == AUTOSIZE_NONE || doWordWrap());
+}
+
+void
+TextField::saveLine(std::wstring::size_type textPos, std::int32_t x,
+        std::int32_t y, const SWF::TextRecord& rec, int last_code,
+        int last_space_glyph, LineStarts::value_type last_line_start_record)
+{
+    const LineLayout line = { textPos, _textRecords.size(),
+        _recordStarts.size(), _line_starts.size(), _glyphcount, x, y, rec,
+        last_code, last_space_glyph, last_line_start_record,
+        m_text_bounding_box, _maxScroll };
+    _lineLayouts.push_back(line);
+}
+
+const TextField::LineLayout*
+TextField::resumeLine(std::wstring::size_type changed) const
+{
+    if (!changed || _lineLayouts.empty() || !incrementalLayout()) return nullptr;
+    if (!(layoutKey() == _layoutKey)) return nullptr;
+
+    // The line before the last one starting at or before the change, as
+    // the first word of a line may now fit at the end of the line before.
+    const auto it = std::upper_bound(_lineLayouts.begin(), _lineLayouts.end(),
+            changed, [](std::wstring::size_type pos, const LineLayout& l) {
+                return pos < l.textPos;
+            });
+    if (it - _lineLayouts.begin() < 2) return nullptr;
+    return &*(it - 2);
+}
+
+TextField::LayoutKey
+TextField::layoutKey() const
+{
+    const LayoutKey key = { _font.get(), _fontHeight, _embedFonts, _wordWrap,
+        _password, _bullet, _autoSize, _alignment, _display, _leftMargin,
+        _rightMargin, _indent, _blockIndent, _leading, _textColor,
+        _underlined, _tabStops, _url, _target, _bounds.width(),
+        _bounds.height() };
+    return key;
+}
+
+bool
+TextField::LayoutKey::operator==(const LayoutKey& o) const
+{
+    return font == o.font && fontHeight == o.fontHeight &&
+        embedFonts == o.embedFonts && wordWrap == o.wordWrap &&
+        password == o.password && bullet == o.bullet &&
+        autoSize == o.autoSize && alignment == o.alignment &&
+        display == o.display && leftMargin == o.leftMargin &&
+        rightMargin == o.rightMargin && indent == o.indent &&
+        blockIndent == o.blockIndent && leading == o.leading &&
+        textColor == o.textColor && underlined == o.underlined &&
+        tabStops == o.tabStops && url == o.url && target == o.target &&
+        width == o.width && height == o.height;
+}
+
 int
 TextField::getDefinitionVersion() const
 {
@@ -29,15 +29,14 @@
 #include "SWFRect.h" // for inlines
 #include "GnashKey.h"
 #include "RGBA.h" // for rgba
+#include "TextRecord.h" // for LineLayout
 
 // Forward declarations
 namespace gnash {
     namespace SWF {
         class DefineEditTextTag;
-        class TextRecord;
     }
     class TextFormat_as;
-    class Font;
 }
 
 #ifdef __ANDROID__
@@ -559,23 +558,23 @@ public:
 	void setDisplay(TextFormatDisplay display);
 	void setScroll(size_t scroll) {
 		_scroll = scroll;
-		format_text();
+		format_text(_text.size());
 	}
 	void setMaxScroll(size_t maxScroll) {
 		_maxScroll = maxScroll;
-		format_text();
+		format_text(_text.size());
 	}
 	void setHScroll(size_t hScroll) {
 		_hScroll = hScroll;
-		format_text();
+		format_text(_text.size());
 	}
 	void setMaxHScroll(size_t maxHScroll) {
 		_maxHScroll = maxHScroll;
-		format_text();
+		format_text(_text.size());
 	}
 	void setbottomScroll(size_t bottomScroll) {
 		_bottomScroll = bottomScroll;
-		format_text();
+		format_text(_text.size());
 	}
 
 	/// Returns the number of the record that the cursor is in
@@ -596,6 +595,58 @@ public:
 
 private:
 
+	/// The state of format_text() at the start of a line.
+	struct LineLayout
+	{
+		/// The position of the first character in _text not laid out.
+		std::wstring::size_type textPos;
+
+		/// The sizes of _textRecords, _recordStarts and _line_starts.
+		size_t records;
+		size_t recordStarts;
+		size_t lineStarts;
+
+		size_t glyphcount;
+		std::int32_t x;
+		std::int32_t y;
+		SWF::TextRecord rec;
+		int lastCode;
+		int lastSpaceGlyph;
+		LineStarts::value_type lastLineStartRecord;
+
+		/// The text bounds and maxscroll of the lines before.
+		SWFRect textBounds;
+		size_t maxScroll;
+	};
+
+	/// The properties the layout depends on.
+	struct LayoutKey
+	{
+		const Font* font;
+		std::uint16_t fontHeight;
+		bool embedFonts;
+		bool wordWrap;
+		bool password;
+		bool bullet;
+		AutoSize autoSize;
+		TextAlignment alignment;
+		TextFormatDisplay display;
+		std::uint16_t leftMargin;
+		std::uint16_t rightMargin;
+		std::uint16_t indent;
+		std::uint16_t blockIndent;
+		std::int16_t leading;
+		rgba textColor;
+		bool underlined;
+		std::vector<int> tabStops;
+		std::string url;
+		std::string target;
+		std::int32_t width;
+		std::int32_t height;
+
+		bool operator==(const LayoutKey& o) const;
+	};
+
     void init();
 
 	/// \brief Set our text to the given string by effect of an update of a
@@ -630,7 +681,38 @@ private:
 
 	/// Convert the DisplayObjects in _text into a series of
 	/// text_glyph_records to be rendered.
-	void format_text();
+	//
+	/// If nothing but the text changed since the last layout, the lines
+	/// before the one the change starts on are kept, except the last of
+	/// them, which the change may let more of the text onto.
+	///
+	/// @param changed	The position of the first character of _text that
+	///					changed since the last layout.
+	void format_text(std::wstring::size_type changed = 0);
+
+	/// Whether format_text() can carry on from the start of a line.
+	//
+	/// This is not possible for HTML, whose tags are laid out
+	/// recursively, or when autosizing changes the bounds as the text is
+	/// laid out.
+	bool incrementalLayout() const;
+
+	/// Keep the state of the layout at the start of a line.
+	void saveLine(std::wstring::size_type textPos, std::int32_t x,
+			std::int32_t y, const SWF::TextRecord& rec, int last_code,
+			int last_space_glyph,
+			LineStarts::value_type last_line_start_record);
+
+	/// The line to carry on the layout from after a change.
+	//
+	/// @param changed	The position of the first character that changed.
+	/// @return			The line before the last one starting at or before
+	///					the change, or 0 if all of the text must be laid
+	///					out.
+	const LineLayout* resumeLine(std::wstring::size_type changed) const;
+
+	/// The current values of the properties the layout depends on.
+	LayoutKey layoutKey() const;
 	
 	/// Move viewable lines based on m_cursor
 	void scrollLines();
@@ -832,6 +914,12 @@ private:
 	bool _html;
 
 	bool _selectable;
+
+	/// The start of each line of the last layout, if incrementalLayout().
+	std::vector<LineLayout> _lineLayouts;
+
+	/// The properties _lineLayouts were laid out with.
+	LayoutKey _layoutKey;
 	
 };
 
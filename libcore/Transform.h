@@ -44,11 +44,9 @@ public:
         colorTransform(std::move(cx))
     {}
 
-    Transform(const Transform& other)
-        :
-        matrix(other.matrix),
-        colorTransform(other.colorTransform)
-    {}
+    Transform(const Transform& other) = default;
+
+    Transform& operator=(const Transform& other) = default;
 
     Transform& operator*=(const Transform& other) {
         matrix.concatenate(other.matrix);
@@ -30,6 +30,7 @@
 #include "MediaHandler.h" // for setting up embedded video decoder 
 #include "VideoDecoder.h" // for setting up embedded video decoder
 #include "Renderer.h"
+#include "RecordingRenderer.h"
 #include "RunResources.h"
 #include "Transform.h"
 
@@ -104,6 +105,9 @@ Video::display(Renderer& renderer, const Transform& base)
 {
 	assert(m_def);
 
+    // New frames are decoded without invalidating anything.
+    RecordingRenderer::markVolatile(renderer);
+
     const DisplayObject::MaskRenderer mr(renderer, *this);
 
     const Transform xform = base * transform();
@@ -2,17 +2,17 @@
 //
 //   Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012
 //   Free Software Foundation, Inc.
-// 
+//
 // This program is free software; you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
 // the Free Software Foundation; either version 3 of the License, or
 // (at your option) any later version.
-// 
+//
 // This program is distributed in the hope that it will be useful,
 // but WITHOUT ANY WARRANTY; without even the implied warranty of
 // MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
 // GNU General Public License for more details.
-// 
+//
 // You should have received a copy of the GNU General Public License
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
@@ -21,55 +21,130 @@
 #define GNASH_CODESTREAM_H
 
 #include <string>
+#include <utility>
+#include <cstddef>
 #include <boost/utility.hpp>
 #include <cstdint>
-#include <istream>
-#include <sstream>
 
 namespace gnash {
 
-/// The exception which will be thrown by the CodeStream for access
-/// violations.
-class CodeStreamException { };
-
 /// A checked read DisplayObject array
 ///
-/// CodeStream provides a safe interface to read various things from a
-/// DisplayObject array of known size.  Any attempt to access memory outside
-/// of the given array will throw an exception of type CodeStreamException
-class CodeStream : public std::istream, private boost::noncopyable
+/// CodeStream provides a safe interface to read the bytecode of an
+/// ActionScript 3 method. It reads straight from memory, as it is in the
+/// innermost loop of the Machine.
+///
+/// Reading past the end gives 0, which is the END opcode, and seeking
+/// outside the code goes to the end, so broken code stops running
+/// rather than reading outside the array.
+class CodeStream : private boost::noncopyable
 {
 public:
-	CodeStream(std::string data): std::istream(new std::stringbuf(data)){
-		
+	CodeStream(std::string data)
+		:
+		_data(std::move(data)),
+		_begin(reinterpret_cast<const std::uint8_t*>(_data.data())),
+		_end(_begin + _data.size()),
+		_current(_begin)
+	{
 	}
 
 /// Read a variable length encoded 32 bit unsigned integer
-std::uint32_t read_V32();
+std::uint32_t read_V32()
+{
+	std::uint32_t result = next();
+	if (!(result & 0x00000080)) return result;
+
+	result = (result & 0x0000007F) | static_cast<std::uint32_t>(next()) << 7;
+	if (!(result & 0x00004000)) return result;
+
+	result = (result & 0x00003FFF) | static_cast<std::uint32_t>(next()) << 14;
+	if (!(result & 0x00200000)) return result;
+
+	result = (result & 0x001FFFFF) | static_cast<std::uint32_t>(next()) << 21;
+	if (!(result & 0x10000000)) return result;
+
+	return (result & 0x0FFFFFFF) | static_cast<std::uint32_t>(next()) << 28;
+}
 
 /// Read an opcode for ActionScript 3
-std::uint8_t read_as3op();
+std::uint8_t read_as3op()
+{
+	return next();
+}
 
 /// Change the current position by a relative value.
-void seekBy(int change);
+void seekBy(int change)
+{
+	seekTo(tell() + change);
+}
 
 /// Set the current position to an absolute value (relative to the start)
-void seekTo(unsigned int set);
+void seekTo(std::size_t set)
+{
+	_current = set > size() ? _end : _begin + set;
+}
+
+/// Get the current position, relative to the start.
+std::size_t tell() const
+{
+	return _current - _begin;
+}
+
+/// Get the size of the code.
+std::size_t size() const
+{
+	return _end - _begin;
+}
 
 ///Read a signed 24 bit interger.
-std::int32_t read_S24();
+std::int32_t read_S24()
+{
+	std::uint32_t result = next();
+	result |= static_cast<std::uint32_t>(next()) << 8;
+	result |= static_cast<std::uint32_t>(next()) << 16;
+	if (result & (1 << 23)) {
+		result |= 0xFF000000;
+	}
+	return static_cast<std::int32_t>(result);
+}
 
 /// Read a signed 8-bit character.
-int8_t read_s8();
+std::int8_t read_s8()
+{
+	return static_cast<std::int8_t>(next());
+}
 
 /// Read an unsigned 8-bit character.
-std::uint8_t read_u8();
+std::uint8_t read_u8()
+{
+	return next();
+}
 
 /// Same as read_V32(), but doesn't bother with the arithmetic for
 /// calculating the value.
-void skip_V32();
+void skip_V32()
+{
+	for (int i = 0; i < 5 && (next() & 0x80); ++i) {}
+}
+
+private:
+
+/// The next byte, or 0 at the end.
+std::uint8_t next()
+{
+	return _current != _end ? *_current++ : 0;
+}
+
+	const std::string _data;
+
+	const std::uint8_t* const _begin;
+
+	const std::uint8_t* const _end;
+
+	const std::uint8_t* _current;
 
 };
 
 } // namespace gnash
-#endif 
+#endif
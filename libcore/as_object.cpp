@@ -23,6 +23,9 @@
 #include <string>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <utility> // for std::pair
+#include <algorithm>
+#include <typeinfo>
+#include <boost/container/small_vector.hpp>
 
 #include "RunResources.h"
 #include "log.h"
@@ -54,7 +57,7 @@ public:
         _iterations(0),
         _condition(std::move(cmp))
     {
-        _visited.insert(top);
+        _visited.push_back(top);
     }
 
     /// Iterate to the next object in the inheritance chain.
@@ -77,16 +80,21 @@ public:
 
         // TODO: there is recursion prevention anyway; is this extra 
         // check for circularity really necessary?
-        if (!_visited.insert(_object).second) return 0;
+        if (std::find(_visited.begin(), _visited.end(), _object) !=
+                _visited.end()) return 0;
+        _visited.push_back(_object);
         return _object && !_object->displayObject();
     }
 
     /// Return the wanted property if it exists and satisfies the predicate.
     //
+    /// An Array element kept in elements() is not found; use getElement()
+    /// to read it, or spillElement() first where a Property is needed.
     /// This will abort if there is no current object.
     Property* getProperty(as_object** owner = nullptr) const {
 
         assert(_object);
+
         Property* prop = _object->_members.getProperty(_uri);
         
         if (prop && _condition(*prop)) {
@@ -96,10 +104,27 @@ public:
         return nullptr;
     }
 
+    /// Return the wanted Array element if the current object has it.
+    //
+    /// Elements have no flags, so they satisfy any predicate.
+    const as_value* getElement() const {
+        assert(_object);
+        return _object->getElement(_uri);
+    }
+
+    /// Turn the wanted Array element into a Property.
+    void spillElement() const {
+        assert(_object);
+        _object->spillElement(_uri);
+    }
+
 private:
     as_object* _object;
     const ObjectURI& _uri;
-    std::set<const as_object*> _visited;
+
+    /// Chains are short, so a linear search beats a std::set, which
+    /// would also allocate on every lookup.
+    boost::container::small_vector<const as_object*, 8> _visited;
     size_t _iterations;
     T _condition;
 };
@@ -312,9 +337,80 @@ as_object::stringValue() const
 std::pair<bool,bool>
 as_object::delProperty(const ObjectURI& uri)
 {
+    if (getElement(uri)) {
+        // The elements after a hole are kept as properties.
+        const size_t i = elementIndex(uri);
+        spillElements(i + 1);
+        _elements.pop_back();
+        _elementOrders.pop_back();
+        return std::make_pair(true, true);
+    }
     return _members.delProperty(uri);
 }
 
+int
+as_object::elementIndex(const ObjectURI& uri) const
+{
+    if (!_array) return -1;
+    return _vm.keyIndex(getName(uri));
+}
+
+ObjectURI
+as_object::elementKey(size_t i) const
+{
+    return arrayKey(_vm, i);
+}
+
+void
+as_object::spillElements(size_t from)
+{
+    if (from >= _elements.size()) return;
+
+    // The properties go where the elements were in the creation order.
+    std::vector<std::pair<ObjectURI, std::uint32_t> > orders;
+    orders.reserve(_elements.size() - from);
+    for (size_t i = from; i < _elements.size(); ++i) {
+        const ObjectURI& key = elementKey(i);
+        _members.setValue(key, _elements[i]);
+        orders.emplace_back(key, _elementOrders[i]);
+    }
+    _members.restoreOrder(orders);
+    _elements.resize(from);
+    _elementOrders.resize(from);
+}
+
+void
+as_object::elementsResized()
+{
+    _elementOrders.resize(std::min(_elementOrders.size(), _elements.size()));
+    while (_elementOrders.size() < _elements.size()) {
+        _elementOrders.push_back(_members.nextOrder());
+    }
+}
+
+void
+as_object::spillElement(const ObjectURI& uri)
+{
+    if (getElement(uri)) spillElements(elementIndex(uri));
+}
+
+void
+as_object::absorbElements()
+{
+    for (;;) {
+        const ObjectURI& key = elementKey(_elements.size());
+        Property* prop = _members.getProperty(key);
+        if (!prop || prop->isGetterSetter() || prop->getFlags().get_flags()) {
+            return;
+        }
+        if (_trigs.get() && _trigs->find(key) != _trigs->end()) return;
+
+        _elements.push_back(prop->getValue(*this));
+        _elementOrders.push_back(_members.order(key));
+        _members.delProperty(key);
+    }
+}
+
 
 void
 as_object::add_property(const std::string& name, as_function& getter,
@@ -322,6 +418,8 @@ as_object::add_property(const std::string& name, as_function& getter,
 {
     const ObjectURI& uri = getURI(vm(), name);
 
+    spillElement(uri);
+
     Property* prop = _members.getProperty(uri);
 
     if (prop) {
@@ -379,6 +477,11 @@ as_object::get_member(const ObjectURI& uri, as_value* val)
 {
     assert(val);
 
+    if (const as_value* e = getElement(uri)) {
+        *val = *e;
+        return true;
+    }
+
     const int version = getSWFVersion(*this);
 
     PrototypeRecursor<IsVisible> pr(this, uri, IsVisible(version));
@@ -390,6 +493,10 @@ as_object::get_member(const ObjectURI& uri, as_value* val)
             if (getDisplayObjectProperty(*d, uri, *val)) return true;
         }
         while (pr()) {
+            if (const as_value* e = pr.getElement()) {
+                *val = *e;
+                return true;
+            }
             if ((prop = pr.getProperty())) break;
         }
     }
@@ -481,7 +588,9 @@ as_object::findProperty(const ObjectURI& uri, as_object** owner)
 
     PrototypeRecursor<IsVisible> pr(this, uri, IsVisible(version));
 
+    // The caller may change the Property.
     do {
+        pr.spillElement();
         Property* prop = pr.getProperty(owner);
         if (prop) return prop;
     } while (pr());
@@ -496,6 +605,9 @@ as_object::findUpdatableProperty(const ObjectURI& uri)
 
     PrototypeRecursor<Exists> pr(this, uri);
 
+    // Elements in the inheritance chain are never getter-setters, so
+    // only an own one needs to be a Property.
+    pr.spillElement();
     Property* prop = pr.getProperty();
 
     // We won't scan the inheritance chain if we find a member,
@@ -592,7 +704,19 @@ as_object::set_member(const ObjectURI& uri, const as_value& val, bool ifFound)
 
     // Handle the length property for arrays. NB: checkArrayLength() will
     // call this function again if the key is a valid index.
-    if (array()) checkArrayLength(*this, uri, val);
+    if (array()) {
+        checkArrayLength(*this, uri, val);
+
+        // Elements are plain values, so nothing else can happen.
+        if (!_elements.empty()) {
+            const int i = elementIndex(uri);
+            if (i >= 0 && static_cast<size_t>(i) < _elements.size()) {
+                if (GC::incrementalMarking()) val.setReachable();
+                _elements[i] = val;
+                return true;
+            }
+        }
+    }
 
     PrototypeRecursor<Exists> pr(this, uri);
 
@@ -645,6 +769,17 @@ as_object::set_member(const ObjectURI& uri, const as_value& val, bool ifFound)
     // Else, add new property...
     if (ifFound) return false;
         
+    // The next element of an Array goes with the others, unless it is
+    // watched.
+    if (array() && elementIndex(uri) == static_cast<int>(_elements.size()) &&
+            !(_trigs.get() && _trigs->find(uri) != _trigs->end())) {
+        if (GC::incrementalMarking()) val.setReachable();
+        _elements.push_back(val);
+        _elementOrders.push_back(_members.nextOrder());
+        absorbElements();
+        return tfVarFound;
+    }
+
     // Property does not exist, so it won't be read-only. Set it.
     if (!_members.setValue(uri, val)) {
             
@@ -675,6 +810,7 @@ as_object::init_member(const std::string& key1, const as_value& val, int flags)
 void
 as_object::init_member(const ObjectURI& uri, const as_value& val, int flags)
 {
+    spillElement(uri);
 
     // Set (or create) a SimpleProperty 
     if (!_members.setValue(uri, val, flags)) {
@@ -698,6 +834,7 @@ void
 as_object::init_property(const ObjectURI& uri, as_function& getter,
                          as_function& setter, int flags)
 {
+    spillElement(uri);
     _members.addGetterSetter(uri, getter, &setter, as_value(), flags);
 }
 
@@ -713,6 +850,7 @@ void
 as_object::init_property(const ObjectURI& uri, as_c_function_ptr getter,
                          as_c_function_ptr setter, int flags)
 {
+    spillElement(uri);
     _members.addGetterSetter(uri, getter, setter, flags);
 }
 
@@ -720,6 +858,7 @@ bool
 as_object::init_destructive_property(const ObjectURI& uri, as_function& getter,
                                      int flags)
 {
+    spillElement(uri);
     return _members.addDestructiveGetter(uri, getter, flags);
 }
 
@@ -727,6 +866,7 @@ bool
 as_object::init_destructive_property(const ObjectURI& uri,
                                      as_c_function_ptr getter, int flags)
 {
+    spillElement(uri);
     return _members.addDestructiveGetter(uri, getter, flags);
 }
 
@@ -752,6 +892,7 @@ as_object::init_readonly_property(const std::string& name,
 void
 as_object::set_member_flags(const ObjectURI& uri, int setTrue, int setFalse)
 {
+    spillElement(uri);
     _members.setFlags(uri, setTrue, setFalse);
 }
 
@@ -762,6 +903,7 @@ as_object::addInterface(as_object* obj)
     if (std::find(_interfaces.begin(), _interfaces.end(), obj) ==
         _interfaces.end()) {
         _interfaces.push_back(obj);
+        if (GC::incrementalMarking()) obj->setReachable();
     }
 }
 
@@ -851,8 +993,12 @@ as_object::prototypeOf(as_object& instance)
 void
 as_object::dump_members() 
 {
-    log_debug("%d members of object %p follow", _members.size(),
+    log_debug("%d members of object %p follow",
+            _members.size() + _elements.size(),
             static_cast<const void*>(this));
+    for (size_t i = 0; i < _elements.size(); ++i) {
+        log_debug("  %d: %s", i, _elements[i]);
+    }
     _members.dump();
 }
 
@@ -862,6 +1008,7 @@ as_object::setPropFlags(const as_value& props_val, int set_false, int set_true)
 
     if (props_val.is_null()) {
         // Take all the members of the object
+        spillElements(0);
         _members.setFlagsAll(set_true, set_false);
         return;
     }
@@ -916,7 +1063,29 @@ as_object::visitKeys(KeyVisitor& visitor) const
 	
     const as_object* current(this);
     while (current && visited.insert(current).second) {
-        current->_members.visitKeys(visitor, doneList);
+
+        if (current->_elements.empty()) {
+            current->_members.visitKeys(visitor, doneList);
+            current = current->get_prototype();
+            continue;
+        }
+
+        // Elements and properties are enumerated in creation order.
+        std::vector<std::pair<std::uint32_t, ObjectURI> > keys;
+        keys.reserve(current->_elements.size() + current->_members.size());
+        for (size_t i = 0; i < current->_elements.size(); ++i) {
+            keys.emplace_back(current->_elementOrders[i],
+                    current->elementKey(i));
+        }
+        current->_members.orderedKeys(keys);
+        std::sort(keys.begin(), keys.end(),
+                [](const std::pair<std::uint32_t, ObjectURI>& a,
+                   const std::pair<std::uint32_t, ObjectURI>& b) {
+                    return a.first < b.first;
+                });
+        for (const auto& k : keys) {
+            if (doneList.insert(k.second).second) visitor(k.second);
+        }
         current = current->get_prototype();
     }
 }
@@ -925,6 +1094,7 @@ as_object::visitKeys(KeyVisitor& visitor) const
 Property*
 as_object::getOwnProperty(const ObjectURI& uri)
 {
+    spillElement(uri);
     return _members.getProperty(uri);
 }
 
@@ -975,6 +1145,14 @@ as_object::watch(const ObjectURI& uri, as_function& trig,
 	
     std::string propname = getStringTable(*this).value(getName(uri));
 
+    // Watched elements need a Property.
+    spillElement(uri);
+
+    if (GC::incrementalMarking()) {
+        trig.setReachable();
+        cust.setReachable();
+    }
+
     if (!_trigs.get()) _trigs.reset(new TriggerContainer);
 
     TriggerContainer::iterator it = _trigs->find(uri);
@@ -1012,6 +1190,8 @@ as_object::markReachableResources() const
 {
     _members.setReachable();
 
+    for (const as_value& e : _elements) e.setReachable();
+
     if (_trigs.get()) {
         for (TriggerContainer::const_iterator it = _trigs->begin();
              it != _trigs->end(); ++it) {
@@ -1028,6 +1208,12 @@ as_object::markReachableResources() const
     if (_displayObject) _displayObject->setReachable();
 }
 
+bool
+as_object::writeBarriered() const
+{
+    return typeid(*this) == typeid(as_object) && !_relay && !_displayObject;
+}
+
 void
 Trigger::setReachable() const
 {
@@ -452,12 +452,27 @@ public:
     /// Get this object's own named property, if existing.
     //
     /// This function does *not* recurse in this object's prototype.
+    /// An Array element kept in elements() is turned into a Property,
+    /// so use getElement() first where only the value is needed.
     //
     /// @param uri      Property identifier. 
     /// @return         A Property pointer, or NULL if this object doesn't
     ///                 contain the named property.
     Property* getOwnProperty(const ObjectURI& uri);
 
+    /// Get an Array element kept in elements().
+    //
+    /// @param uri      Property identifier.
+    /// @return         The element, or NULL if uri doesn't name one.
+    const as_value* getElement(const ObjectURI& uri) const {
+        if (_elements.empty()) return nullptr;
+        const int i = elementIndex(uri);
+        if (i < 0 || static_cast<size_t>(i) >= _elements.size()) {
+            return nullptr;
+        }
+        return &_elements[i];
+    }
+
     /// Set member flags (probably used by ASSetPropFlags)
     //
     /// @param name     Name of the property. Must be all lowercase
@@ -532,6 +547,8 @@ public:
     /// Drop all properties from this object
     void clearProperties() {
         _members.clear();
+        _elements.clear();
+        _elementOrders.clear();
     }
 
     /// Visit the properties of this object by key/as_value pairs
@@ -545,6 +562,11 @@ public:
     ///                 a const as_value as second argument.
     template<typename T>
     void visitProperties(PropertyVisitor& visitor) const {
+        // Elements are plain properties, which all predicates accept.
+        for (size_t i = 0; i < _elements.size(); ++i) {
+            const as_value val = _elements[i];
+            if (!visitor.accept(elementKey(i), val)) return;
+        }
         _members.visitValues<T>(visitor);
     }
 
@@ -602,9 +624,12 @@ public:
     /// is assigned. There are tests verifying this behaviour in
     /// actionscript.all and the swfdec testsuite.
     void setRelay(Relay* p) {
-        if (p) _array = false;
+        if (p) setArray(false);
         if (_relay) _relay->clean();
         _relay.reset(p);
+
+        // The Relay's references are not updated with a write barrier.
+        if (p) GC::rescan(this);
     }
 
     /// Access the as_object's Relay object.
@@ -628,9 +653,36 @@ public:
 
     /// Set whether this object should be treated as an array.
     void setArray(bool array = true) {
+        if (!array) spillElements(0);
         _array = array;
     }
 
+    /// The elements of an Array kept in a vector.
+    //
+    /// Element i is kept here rather than as a Property for each i below
+    /// the size of the vector. Elements above, those after a deleted
+    /// one and those that need a Property (for flags, getter-setters or
+    /// watch triggers) are ordinary properties. Only Arrays keep
+    /// elements; all property functions take them into account.
+    const std::vector<as_value>& elements() const {
+        return _elements;
+    }
+
+    /// The elements of an Array, for Array functions to change directly.
+    //
+    /// Values added must be marked reachable during incremental marking,
+    /// as set_member() does, and none may be added for an index that has
+    /// a Property. elementsResized() must be called after changing the
+    /// size.
+    std::vector<as_value>& elements() {
+        return _elements;
+    }
+
+    /// Note that elements() grew or shrank at the end.
+    //
+    /// Elements added are enumerated after everything created before.
+    void elementsResized();
+
     /// Return the DisplayObject associated with this object.
     //
     /// @return     A DisplayObject if this is as_object is associated with
@@ -642,6 +694,7 @@ public:
     /// Set the DisplayObject associated with this as_object.
     void setDisplayObject(DisplayObject* d) {
         _displayObject = d;
+        if (d) GC::rescan(this);
     }
 
 protected:
@@ -667,8 +720,17 @@ protected:
     /// this function directly as the last step.
     virtual void markReachableResources() const;
 
+    /// Plain objects only store references through write barriers.
+    //
+    /// Derived classes, relays and DisplayObjects may hold references
+    /// in C++ members.
+    virtual bool writeBarriered() const;
+
 private:
 
+    /// MemberCache replicates the lookups of get_member and set_member.
+    friend class MemberCache;
+
     /// Find an existing property for update
     //
     /// Scans the inheritance chain only for getter/setters or statics.
@@ -685,6 +747,21 @@ private:
     void executeTriggers(Property* prop, const ObjectURI& uri,
             const as_value& val);
 
+    /// The Array index a key stands for, or -1.
+    int elementIndex(const ObjectURI& uri) const;
+
+    /// The key of an Array index.
+    ObjectURI elementKey(size_t i) const;
+
+    /// Turn elements from the given index on into properties.
+    void spillElements(size_t from);
+
+    /// Turn the element a key names, and those after it, into properties.
+    void spillElement(const ObjectURI& uri);
+
+    /// Move plain properties following the elements into them.
+    void absorbElements();
+
     /// A utility class for processing this as_object's inheritance chain
     template<typename T> class PrototypeRecursor;
 
@@ -715,6 +792,12 @@ private:
     /// Properties of this as_object
     PropertyList _members;
 
+    /// The elements of an Array that aren't in _members.
+    std::vector<as_value> _elements;
+
+    /// The place of each of _elements in the creation order of _members.
+    std::vector<std::uint32_t> _elementOrders;
+
     /// The constructors of the objects implemented by this as_object.
     //
     /// There is no need to use a complex container as the list of 
@@ -776,6 +859,7 @@ getMember(as_object& o, const ObjectURI& uri)
 inline as_value
 getOwnProperty(as_object& o, const ObjectURI& uri)
 {
+    if (const as_value* e = o.getElement(uri)) return *e;
     Property* p = o.getOwnProperty(uri);
     return p ? p->getValue(o) : as_value();
 }
@@ -853,7 +937,7 @@ get(as_object* o)
 inline bool
 hasOwnProperty(as_object& o, const ObjectURI& uri)
 {
-    return (o.getOwnProperty(uri));
+    return o.getElement(uri) || o.getOwnProperty(uri);
 }
 
 DSOTEXPORT as_object* getObjectWithPrototype(Global_as& gl, const ObjectURI& c);
@@ -248,6 +248,25 @@ as_value::to_string(int version) const
     
 }
 
+SharedString
+as_value::to_shared_string(int version) const
+{
+    switch (_type)
+    {
+        case STRING:
+            return boost::get<SharedString>(_value);
+        case OBJECT:
+        {
+            String_as* s;
+            if (isNativeType(getObj(), s)) return s->sharedValue();
+            break;
+        }
+        default:
+            break;
+    }
+    return SharedString(to_string(version));
+}
+
 as_value::AsType
 as_value::defaultPrimitive(int version) const
 {
@@ -732,7 +751,14 @@ void
 as_value::set_string(const std::string& str)
 {
     _type = STRING;
-    _value = str;
+    _value = SharedString(str);
+}
+
+void
+as_value::set_string(SharedString str)
+{
+    _type = STRING;
+    _value = std::move(str);
 }
 
 void
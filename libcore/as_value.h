@@ -28,6 +28,7 @@
 
 #include "dsodefs.h" // for DSOTEXPORT
 #include "CharacterProxy.h"
+#include "SharedString.h"
 #include "GnashNumeric.h" // for isNaN
 
 
@@ -145,11 +146,18 @@ public:
     DSOEXPORT as_value(const char* str)
         :
         _type(STRING),
-        _value(std::string(str))
+        _value(SharedString(str))
     {}
 
     /// Construct a primitive String value 
     DSOEXPORT as_value(std::string str)
+        :
+        _type(STRING),
+        _value(SharedString(std::move(str)))
+    {}
+
+    /// Construct a primitive String value sharing another's storage
+    DSOEXPORT as_value(SharedString str)
         :
         _type(STRING),
         _value(std::move(str))
@@ -234,6 +242,12 @@ public:
     //
     /// TODO: drop the default argument.
     DSOTEXPORT std::string to_string(int version = 7) const;
+
+    /// Get a SharedString representation for this value.
+    //
+    /// This is the same as to_string(), but a String value's storage is
+    /// shared rather than copied.
+    SharedString to_shared_string(int version = 7) const;
     
     /// Get a number representation for this value
     //
@@ -317,6 +331,9 @@ public:
     
     /// Set to a primitive string.
     void set_string(const std::string& str);
+
+    /// Set to a primitive string, sharing its storage.
+    void set_string(SharedString str);
     
     /// Set to a primitive number.
     void set_double(double val);
@@ -423,7 +440,7 @@ private:
                            bool,
                            as_object*,
                            CharacterProxy,
-                           std::string>
+                           SharedString>
     AsValueType;
     
     /// Use the relevant equality function, not operator==
@@ -478,7 +495,7 @@ private:
     /// The caller must check that this value is a String.
     const std::string& getStr() const {
         assert(_type == STRING);
-        return boost::get<std::string>(_value);
+        return boost::get<SharedString>(_value).str();
     }
     
 };
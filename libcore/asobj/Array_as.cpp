@@ -25,8 +25,8 @@
 #include <cmath>
 #include <functional>
 #include <iterator>
+#include <list>
 #include <boost/algorithm/string/case_conv.hpp>
-#include <boost/lexical_cast.hpp>
 
 #include "as_value.h"
 #include "log.h"
@@ -87,7 +87,6 @@ namespace {
     as_value array_splice(const fn_call& fn);
 
     ObjectURI getKey(const fn_call& fn, size_t i);
-    int isIndex(const std::string& name);
 
     /// Implementation of foreachArray that takes a start and end range.
     template<typename T> void foreachArray(as_object& array, int start,
@@ -110,6 +109,13 @@ namespace {
 
     void resizeArray(as_object& o, const int size);
 
+    /// Whether all elements of an object are in its Array vector.
+    bool dense(as_object& array);
+
+    /// Whether no property is in the way of adding elements to a dense
+    /// Array.
+    bool canGrow(as_object& array, size_t count);
+
 }
 
 /// Function objects for foreachArray()
@@ -276,6 +282,43 @@ SafeSort(IterType begin, IterType end, const as_value_custom& compare);
 ///	boolean functor or function comparing two as_value& objects
 ///     used to determine equality
 ///
+/// Copy the elements of an array to a container.
+template<typename T>
+void
+getElements(as_object& o, T& v)
+{
+    if (dense(o)) {
+        v.assign(o.elements().begin(), o.elements().end());
+        return;
+    }
+    PushToContainer<T> pv(v);
+    foreachArray(o, pv);
+}
+
+/// Store sorted values as the elements of an array.
+//
+/// A scripted comparator may have changed the array, in which case the
+/// values are set one by one.
+template<typename T>
+void
+setElements(as_object& o, const T& v)
+{
+    if (dense(o) && o.elements().size() == v.size()) {
+        if (GC::incrementalMarking()) {
+            for (const as_value& val : v) val.setReachable();
+        }
+        std::copy(v.begin(), v.end(), o.elements().begin());
+        return;
+    }
+
+    VM& vm = getVM(o);
+    size_t i = 0;
+    for (const as_value& val : v) {
+        o.set_member(arrayKey(vm, i), val);
+        ++i;
+    }
+}
+
 template <class AVCMP, class AVEQ>
 bool sort(as_object& o, AVCMP avc, AVEQ ave)
 {
@@ -298,26 +341,13 @@ bool sort(as_object& o, AVCMP avc, AVEQ ave)
     typedef std::list<as_value> SortContainer;
 
     SortContainer v;
-    PushToContainer<SortContainer> pv(v);
-    foreachArray(o, pv);
-
-    const size_t size = v.size(); 
+    getElements(o, v);
 
     v.sort(avc);
 
     if (std::adjacent_find(v.begin(), v.end(), ave) != v.end()) return false;
 
-    VM& vm = getVM(o);
-
-    SortContainer::const_iterator it = v.begin();
-
-    for (size_t i = 0; i < size; ++i) {
-        if (i >= v.size()) {
-            break;
-        }
-        o.set_member(arrayKey(vm, i), *it);
-        ++it;
-    }
+    setElements(o, v);
     return true;
 }
 
@@ -330,24 +360,11 @@ sort(as_object& o, AVCMP avc)
     typedef std::list<as_value> SortContainer;
 
     SortContainer v;
-    PushToContainer<SortContainer> pv(v);
-    foreachArray(o, pv);
-
-    const size_t size = v.size(); 
+    getElements(o, v);
 
     v.sort(avc);
 
-    VM& vm = getVM(o);
-
-    SortContainer::const_iterator it = v.begin();
-
-    for (size_t i = 0; i < size; ++i) {
-        if (it == v.end()) {
-            break;
-        }
-        o.set_member(arrayKey(vm, i), *it);
-        ++it;
-    }
+    setElements(o, v);
 }
 
 /// \brief
@@ -911,7 +928,7 @@ bool
 IsStrictArray::accept(const ObjectURI& uri, const as_value& /*val*/)
 {
     // We ignore namespace.
-    if (isIndex(uri.toString(_st.getStringTable())) >= 0) return true;
+    if (_st.keyIndex(getName(uri)) >= 0) return true;
     _strict = false;
     return false;
 }
@@ -919,22 +936,25 @@ IsStrictArray::accept(const ObjectURI& uri, const as_value& /*val*/)
 void
 checkArrayLength(as_object& array, const ObjectURI& uri, const as_value& val)
 {
-    // TODO: check if we should really be doing
-    //       case-sensitive comparison here!
-    const bool caseless = true;
-    ObjectURI::CaseEquals eq(getStringTable(array), caseless);
-    if (eq(uri, getURI(getVM(array), NSV::PROP_LENGTH))) {
-        resizeArray(array, toInt(val, getVM(array)));
-        return;
-    }
+    VM& vm = getVM(array);
 
-    const int index = isIndex(uri.toString(getStringTable(array)));
+    // Element keys are the most common, and can't be "length".
+    const int index = vm.keyIndex(getName(uri));
 
     // if we were sent a valid array index
     if (index >= 0) {
         if (static_cast<size_t>(index) >= arrayLength(array)) {
             setArrayLength(array, index + 1);
         }
+        return;
+    }
+
+    // TODO: check if we should really be doing
+    //       case-sensitive comparison here!
+    const bool caseless = true;
+    ObjectURI::CaseEquals eq(getStringTable(array), caseless);
+    if (eq(uri, getURI(vm, NSV::PROP_LENGTH))) {
+        resizeArray(array, toInt(val, vm));
     }
 }
 
@@ -994,8 +1014,7 @@ array_class_init(as_object& where, const ObjectURI& uri)
 ObjectURI
 arrayKey(VM& vm, size_t i)
 {
-    // TODO: tell getURI that the string is already lowercase!
-    return getURI(vm, std::to_string(i), true);
+    return ObjectURI(static_cast<NSV::NamedStrings>(vm.indexKey(i)));
 }
 
 namespace {
@@ -1071,6 +1090,36 @@ array_splice(const fn_call& fn)
     Global_as& gl = getGlobal(fn);
     as_object* ret = gl.createArray();
 
+    const size_t newelements = fn.nargs > 2 ? fn.nargs - 2 : 0;
+
+    if (dense(*array) && canGrow(*array, newelements - std::min(newelements,
+                    remove))) {
+        std::vector<as_value>& e = array->elements();
+        const bool marking = GC::incrementalMarking();
+
+        std::vector<as_value>& removed = ret->elements();
+        removed.assign(e.begin() + start, e.begin() + start + remove);
+        if (marking) {
+            for (const as_value& val : removed) val.setReachable();
+        }
+        ret->elementsResized();
+        setArrayLength(*ret, remove);
+
+        e.erase(e.begin() + start, e.begin() + start + remove);
+        if (newelements) {
+            e.insert(e.begin() + start, fn.getArgs().begin() + 2,
+                    fn.getArgs().end());
+            if (marking) {
+                for (size_t i = 0; i < newelements; ++i) {
+                    fn.arg(i + 2).setReachable();
+                }
+            }
+        }
+        array->elementsResized();
+        setArrayLength(*array, e.size());
+        return as_value(ret);
+    }
+
     // Copy the original array values for reinsertion. It's not possible
     // to do a simple copy in-place without overwriting values that still
     // need to be shifted. The algorithm could certainly be improved though.
@@ -1079,8 +1128,6 @@ array_splice(const fn_call& fn)
     PushToContainer<TempContainer> pv(v);
     foreachArray(*array, pv);
 
-    const size_t newelements = fn.nargs > 2 ? fn.nargs - 2 : 0;
-    
     // Push removed elements to the new array.
     ObjectURI propPush = getURI(getVM(fn), NSV::PROP_PUSH);
     for (size_t i = 0; i < remove; ++i) {
@@ -1320,6 +1367,17 @@ array_push(const fn_call& fn)
 
     const size_t size = arrayLength(*array);
 
+    if (dense(*array) && canGrow(*array, shift)) {
+        std::vector<as_value>& e = array->elements();
+        if (GC::incrementalMarking()) {
+            for (size_t i = 0; i < shift; ++i) fn.arg(i).setReachable();
+        }
+        e.insert(e.end(), fn.getArgs().begin(), fn.getArgs().end());
+        array->elementsResized();
+        setArrayLength(*array, size + shift);
+        return as_value(size + shift);
+    }
+
     for (size_t i = 0; i < shift; ++i) {
         array->set_member(getKey(fn, size + i), fn.arg(i));
     }
@@ -1340,6 +1398,17 @@ array_unshift(const fn_call& fn)
 
     const size_t size = arrayLength(*array);
 
+    if (dense(*array) && canGrow(*array, shift)) {
+        std::vector<as_value>& e = array->elements();
+        if (GC::incrementalMarking()) {
+            for (size_t i = 0; i < shift; ++i) fn.arg(i).setReachable();
+        }
+        e.insert(e.begin(), fn.getArgs().begin(), fn.getArgs().end());
+        array->elementsResized();
+        setArrayLength(*array, size + shift);
+        return as_value(size + shift);
+    }
+
     for (size_t i = size + shift - 1; i >= shift ; --i) {
         const ObjectURI nextkey = getKey(fn, i - shift);
         const ObjectURI currentkey = getKey(fn, i);
@@ -1367,6 +1436,15 @@ array_pop(const fn_call& fn)
     const size_t size = arrayLength(*array);
     if (size < 1) return as_value();
 
+    if (dense(*array)) {
+        std::vector<as_value>& e = array->elements();
+        const as_value ret = e.back();
+        e.pop_back();
+        array->elementsResized();
+        setArrayLength(*array, size - 1);
+        return ret;
+    }
+
     const ObjectURI ind = getKey(fn, size - 1);
     as_value ret = getOwnProperty(*array, ind);
     array->delProperty(ind);
@@ -1386,6 +1464,15 @@ array_shift(const fn_call& fn)
     // An array with no elements has nothing to return.
     if (size < 1) return as_value();
 
+    if (dense(*array)) {
+        std::vector<as_value>& e = array->elements();
+        const as_value ret = e.front();
+        e.erase(e.begin());
+        array->elementsResized();
+        setArrayLength(*array, size - 1);
+        return ret;
+    }
+
     as_value ret = getOwnProperty(*array, getKey(fn, 0));
 
     for (size_t i = 0; i < static_cast<size_t>(size - 1); ++i) {
@@ -1410,6 +1497,11 @@ array_reverse(const fn_call& fn)
     // An array with 0 or 1 elements has nothing to reverse.
     if (size < 2) return as_value();
 
+    if (dense(*array)) {
+        std::reverse(array->elements().begin(), array->elements().end());
+        return array;
+    }
+
     for (size_t i = 0; i < static_cast<size_t>(size) / 2; ++i) {
         const ObjectURI bottomkey = getKey(fn, i);
         const ObjectURI topkey = getKey(fn, size - i - 1);
@@ -1559,8 +1651,7 @@ join(as_object* array, const std::string& separator)
 
     for (size_t i = 0; i < size; ++i) {
         if (i) s += separator;
-        const std::string& index = std::to_string(i);
-        const as_value& el = getOwnProperty(*array, getURI(vm, index));
+        const as_value& el = getOwnProperty(*array, arrayKey(vm, i));
         s += el.to_string(version);
     }
     return as_value(s);
@@ -1621,6 +1712,16 @@ resizeArray(as_object& o, const int size)
 
     const size_t currentSize = arrayLength(o);
     if (realSize < currentSize) {
+
+        // Only elements that aren't in the vector are properties.
+        std::vector<as_value>& e = o.elements();
+        const bool sparse = e.size() < currentSize;
+        if (e.size() > realSize) {
+            e.resize(realSize);
+            o.elementsResized();
+        }
+        if (!sparse) return;
+
         VM& vm = getVM(o);
         for (size_t i = realSize; i < currentSize; ++i) {
             o.delProperty(arrayKey(vm, i));
@@ -1628,6 +1729,23 @@ resizeArray(as_object& o, const int size)
     }
 }
 
+bool
+dense(as_object& array)
+{
+    return array.array() && array.elements().size() == arrayLength(array);
+}
+
+bool
+canGrow(as_object& array, size_t count)
+{
+    const size_t size = array.elements().size();
+    VM& vm = getVM(array);
+    for (size_t i = size; i < size + count; ++i) {
+        if (hasOwnProperty(array, arrayKey(vm, i))) return false;
+    }
+    return true;
+}
+
 void
 setArrayLength(as_object& array, const int size)
 {
@@ -1638,17 +1756,6 @@ setArrayLength(as_object& array, const int size)
     array.set_member(NSV::PROP_LENGTH, size);
 }
 
-int
-isIndex(const std::string& nameString)
-{
-    try {
-        return boost::lexical_cast<int>(nameString);
-    }
-    catch (boost::bad_lexical_cast& e) {
-        return -1;
-    }
-}
-
 } // anonymous namespace
 
 } // end of gnash namespace
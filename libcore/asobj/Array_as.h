@@ -41,7 +41,8 @@ size_t arrayLength(as_object& array);
 /// Convert an integral value into an ObjectURI
 //
 /// NB this function adds a string value to the VM for each separate
-/// integral value. It's the way the VM works.
+/// integral value. It's the way the VM works. The keys of small values
+/// are cached by the VM (see VM::indexKey()).
 //
 /// @param i        The integral value to find
 /// @return         The ObjectURI to look up.
@@ -44,6 +44,7 @@
 #include "Renderer.h"
 #include "RunResources.h"
 #include "ASConversions.h"
+#include "Filters.h"
 
 namespace gnash {
 
@@ -360,29 +361,119 @@ as_value
 movieclip_cacheAsBitmap(const fn_call& fn)
 {
     MovieClip* movieclip = ensure<IsDisplayObject<MovieClip> >(fn);
-    UNUSED(movieclip);
-    LOG_ONCE( log_unimpl(_("MovieClip.cacheAsBitmap()")) );
+
+    if (!fn.nargs) {
+        // Getter
+        return as_value(movieclip->cacheAsBitmap());
+    }
+
+    // Setter
+    movieclip->setCacheAsBitmap(toBool(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
 
+/// Collects the filters of the elements of a filters array.
+//
+/// Elements that are not filters are skipped.
+class PushFilter
+{
+public:
+    PushFilter(BitmapFilters& filters, VM& vm)
+        :
+        _filters(filters),
+        _vm(vm)
+    {}
+
+    void operator()(const as_value& val) {
+        as_object* o = toObject(val, _vm);
+        if (!o) return;
+        const BitmapFilter* f = dynamic_cast<const BitmapFilter*>(o->relay());
+        if (!f) return;
+        _filters.push_back(std::shared_ptr<const BitmapFilter>(f->clone()));
+    }
+
+private:
+    BitmapFilters& _filters;
+    VM& _vm;
+};
+
+/// Make an object of the ActionScript class 'name' holding a copy of
+/// the filter, if it is a T.
+template<typename T>
+as_object*
+copyFilter(const BitmapFilter& filter, const std::string& name,
+        const fn_call& fn)
+{
+    const T* from = dynamic_cast<const T*>(&filter);
+    if (!from) return nullptr;
+
+    as_value cl(findObject(fn.env(), name));
+    as_function* ctor = cl.to_function();
+    if (!ctor) return nullptr;
+
+    fn_call::Args args;
+    as_object* o = constructInstance(*ctor, fn.env(), args);
+    T* to = dynamic_cast<T*>(o->relay());
+    if (!to) return nullptr;
+
+    *to = *from;
+    return o;
+}
+
+/// Make an ActionScript copy of a filter.
+//
+/// @return     The copy, or 0 if there is no ActionScript class for it.
+as_object*
+filterObject(const BitmapFilter& f, const fn_call& fn)
+{
+    as_object* o;
+    if ((o = copyFilter<BlurFilter>(f, "flash.filters.BlurFilter", fn)) ||
+        (o = copyFilter<GlowFilter>(f, "flash.filters.GlowFilter", fn)) ||
+        (o = copyFilter<DropShadowFilter>(f,
+                "flash.filters.DropShadowFilter", fn)) ||
+        (o = copyFilter<ColorMatrixFilter>(f,
+                "flash.filters.ColorMatrixFilter", fn)) ||
+        (o = copyFilter<BevelFilter>(f, "flash.filters.BevelFilter", fn)) ||
+        (o = copyFilter<GradientBevelFilter>(f,
+                "flash.filters.GradientBevelFilter", fn)) ||
+        (o = copyFilter<GradientGlowFilter>(f,
+                "flash.filters.GradientGlowFilter", fn)) ||
+        (o = copyFilter<ConvolutionFilter>(f,
+                "flash.filters.ConvolutionFilter", fn))) {
+        return o;
+    }
+    return nullptr;
+}
+
+/// The filters are copied when they are set and when they are got, so
+/// changing a filter has no effect until it is assigned again.
 as_value
 movieclip_filters(const fn_call& fn)
 {
     MovieClip* movieclip = ensure<IsDisplayObject<MovieClip> >(fn);
     
-    UNUSED(movieclip);
-
-    LOG_ONCE(log_unimpl(_("MovieClip.filters()")));
-
     if (!fn.nargs) {
-        // Getter
+        // Getter. This includes filters placed by SWF tags.
         Global_as& gl = getGlobal(fn);
         as_object* array = gl.createArray();
+        for (const auto& filter : movieclip->filters()) {
+            as_object* o = filterObject(*filter, fn);
+            if (o) callMethod(array, NSV::PROP_PUSH, o);
+        }
         return as_value(array);
     }
 
     // Setter
+    BitmapFilters filters;
+
+    as_object* arg = toObject(fn.arg(0), getVM(fn));
+    if (arg) {
+        PushFilter pf(filters, getVM(fn));
+        foreachArray(*arg, pf);
+    }
+
+    movieclip->setFilters(std::move(filters));
     return as_value();
 }
 
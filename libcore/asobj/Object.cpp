@@ -385,7 +385,12 @@ object_isPropertyEnumerable(const fn_call& fn)
         return as_value();
     }
 
-    Property* prop = obj->getOwnProperty(getURI(getVM(fn),propname));
+    const ObjectURI& uri = getURI(getVM(fn), propname);
+
+    // Array elements kept as values are always enumerable.
+    if (obj->getElement(uri)) return as_value(true);
+
+    Property* prop = obj->getOwnProperty(uri);
 
     if (!prop) {
         return as_value(false);
@@ -71,9 +71,11 @@ namespace {
     inline int getStringVersioned(const fn_call& fn, const as_value& arg,
             std::string& str);
 
+    inline int callerVersion(const fn_call& fn);
+
 }
 
-String_as::String_as(std::string s)
+String_as::String_as(SharedString s)
     :
     _string(std::move(s))
 {
@@ -154,11 +156,11 @@ string_concat(const fn_call& fn)
 {
     as_value val(fn.this_ptr);
 
-    std::string str;
-    const int version = getStringVersioned(fn, val, str);
+    const int version = callerVersion(fn);
+    SharedString str = val.to_shared_string(version);
 
     for (size_t i = 0; i < fn.nargs; i++) {
-        str += fn.arg(i).to_string(version);
+        str = str + fn.arg(i).to_shared_string(version);
     }
 
     return as_value(str);
@@ -705,14 +707,14 @@ as_value
 string_valueOf(const fn_call& fn)
 {
     const int version = getSWFVersion(fn);
-    return as_value(fn.this_ptr).to_string(version);
+    return as_value(fn.this_ptr).to_shared_string(version);
 }
 
 as_value
 string_toString(const fn_call& fn)
 {
     String_as* str = ensure<ThisIsNative<String_as> >(fn);
-    return as_value(str->value());
+    return as_value(str->sharedValue());
 }
 
 
@@ -721,10 +723,10 @@ string_ctor(const fn_call& fn)
 {
     const int version = getSWFVersion(fn);
 
-    std::string str;
+    SharedString str;
 
     if (fn.nargs) {
-        str = fn.arg(0).to_string(version);
+        str = fn.arg(0).to_shared_string(version);
     }
 
     if (!fn.isInstantiation())
@@ -735,7 +737,8 @@ string_ctor(const fn_call& fn)
     as_object* obj = fn.this_ptr;
 
     obj->setRelay(new String_as(str));
-    std::wstring wstr = utf8::decodeCanonicalString(str, getSWFVersion(fn));
+    std::wstring wstr = utf8::decodeCanonicalString(str.str(),
+            getSWFVersion(fn));
     obj->init_member(NSV::PROP_LENGTH, wstr.size(), as_object::DefaultFlags);
 
     return as_value();
@@ -744,7 +747,14 @@ string_ctor(const fn_call& fn)
 inline int
 getStringVersioned(const fn_call& fn, const as_value& val, std::string& str)
 {
+    const int version = callerVersion(fn);
+    str = val.to_string(version);
+    return version;
+}
 
+inline int
+callerVersion(const fn_call& fn)
+{
     /// version to use is the one of the SWF containing caller code.
     /// If callerDef is null, this calls is spontaneous (system-event?)
     /// in which case we should research on which version should drive
@@ -756,14 +766,7 @@ getStringVersioned(const fn_call& fn, const as_value& val, std::string& str)
         log_error(_("No fn_call::callerDef in string function call"));
     }
 
-    const int version = fn.callerDef ? fn.callerDef->get_version() :
-        getSWFVersion(fn);
-    
-    str = val.to_string(version);
-
-    return version;
-
-
+    return fn.callerDef ? fn.callerDef->get_version() : getSWFVersion(fn);
 }
 
 /// Check the number of arguments, returning false if there
@@ -50,6 +50,8 @@
 #include "NativeFunction.h"
 #include "GnashNumeric.h"
 #include "Array_as.h"
+#include "Filters.h"
+#include "BitmapKernels.h"
 
 namespace gnash {
 
@@ -126,10 +128,33 @@ namespace {
     /// @param h    The height of the rectangle.
     void adjustRect(int& x, int& y, int& w, int& h, const BitmapData_as& b);
 
-    std::uint32_t setChannel(std::uint32_t targ, std::uint8_t bitmask,
-            std::uint8_t value);
+    /// The byte of a pixel in a BitmapData_as::row() holding a channel.
+    //
+    /// @param bitmask  One of the BitmapData_as::Channel values.
+    size_t channelOffset(std::uint8_t bitmask);
 
-    std::uint8_t getChannel(std::uint32_t src, std::uint8_t bitmask);
+    /// The pixels an operation reads from one BitmapData_as and writes
+    /// to another.
+    struct CopyArea
+    {
+        int sourceX;
+        int sourceY;
+        int destX;
+        int destY;
+        int width;
+        int height;
+    };
+
+    /// Find the pixels to copy from a source rectangle to a point.
+    //
+    /// The area is clipped to both BitmapData_as objects as for
+    /// copyPixels().
+    //
+    /// @param rect     An object with the rectangle's x, y, width and height.
+    /// @param point    An object with the point's x and y, or 0 for (0, 0).
+    /// @return         false if no pixels are copied.
+    bool copyArea(const BitmapData_as& source, const BitmapData_as& dest,
+            as_object& rect, as_object* point, CopyArea& area);
 
     void floodFill(const BitmapData_as& bd, size_t startx, size_t starty,
             std::uint32_t old, std::uint32_t fill);
@@ -242,37 +267,49 @@ private:
     const bool _greyscale;
 };
 
-/// Copy a single channel from one ARGB value to a channel in another.
+/// The source rows of a CopyArea.
 //
-/// Due to peculiarities in the Adobe implementation, this also supports
-/// setting them to black.
-template<typename Iterator>
-struct CopyChannel
+/// When the source and destination are the same, the rows are copied
+/// first so that writing the destination doesn't change them.
+class SourceRows
 {
-    typedef boost::tuple<Iterator, Iterator> iterator_tuple;
-    typedef boost::zip_iterator<iterator_tuple> iterator_type;
-
-    CopyChannel(bool multiple, std::uint8_t srcchans,
-            std::uint8_t destchans)
+public:
+    SourceRows(const BitmapData_as& source, const BitmapData_as& dest,
+            const CopyArea& area)
         :
-        _multiple(multiple),
-        _srcchans(srcchans),
-        _destchans(destchans)
-    {}
+        _source(source),
+        _area(area),
+        _channels(source.channels())
+    {
+        if (&source != &dest) return;
 
-    std::uint32_t operator()(typename iterator_type::value_type p) const {
-        // If multiple source channels, we set the destination channel
-        // to black. Else to the value of the requested channel.
-        const std::uint8_t val = _multiple ?
-            0 : getChannel(boost::get<0>(p), _srcchans);
-        return setChannel(boost::get<1>(p), _destchans, val);
+        const size_t bytes = _area.width * _channels;
+        _copy.resize(bytes * _area.height);
+        for (int i = 0; i < _area.height; ++i) {
+            std::copy(row(i), row(i) + bytes, _copy.begin() + i * bytes);
+        }
+    }
+
+    /// The bytes of row i of the area.
+    const std::uint8_t* operator[](int i) const {
+        if (_copy.empty()) return row(i);
+        return &_copy[i * _area.width * _channels];
+    }
+
+    size_t channels() const {
+        return _channels;
     }
 
 private:
-    const bool _multiple;
-    const std::uint8_t _srcchans;
-    const std::uint8_t _destchans;
 
+    const std::uint8_t* row(int i) const {
+        return _source.row(_area.sourceY + i) + _area.sourceX * _channels;
+    }
+
+    const BitmapData_as& _source;
+    const CopyArea& _area;
+    const size_t _channels;
+    std::vector<std::uint8_t> _copy;
 };
 
 template<typename T> 
@@ -607,7 +644,10 @@ BitmapData_as::BitmapData_as(as_object* owner,
     
     // If there is a renderer, cache the image there, otherwise we store it.
     Renderer* r = getRunResources(*_owner).renderer();
-    if (r) _cachedBitmap = r->createCachedBitmap(std::move(im));
+    if (r) {
+        _cachedBitmap = r->createCachedBitmap(std::move(im));
+        if (_cachedBitmap) _cachedBitmap->setChanging();
+    }
     else _image.reset(im.release());
 }
     
@@ -622,6 +662,7 @@ BitmapData_as::setReachable()
 void
 BitmapData_as::updateObjects() const
 {
+    if (_cachedBitmap) _cachedBitmap->changed();
     std::for_each(_attachedObjects.begin(), _attachedObjects.end(),
             std::mem_fun(&DisplayObject::update));
 }
@@ -709,12 +750,107 @@ registerBitmapDataNative(as_object& global)
 
 namespace {
 
+// sourceBitmap: BitmapData,
+// sourceRect: Rectangle,
+// destPoint: Point,
+// filter: BitmapFilter
 as_value
 bitmapdata_applyFilter(const fn_call& fn)
 {
     BitmapData_as* ptr = ensure<ThisIsNative<BitmapData_as> >(fn);
-    UNUSED(ptr);
-    LOG_ONCE(log_unimpl(__FUNCTION__) );
+    if (ptr->disposed()) return as_value();
+
+    if (fn.nargs < 4) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("BitmapData.applyFilter(): needs 4 arguments"));
+        );
+        return as_value();
+    }
+
+    as_object* o = toObject(fn.arg(0), getVM(fn));
+    BitmapData_as* source;
+    if (!isNativeType(o, source) || source->disposed()) {
+        return as_value();
+    }
+
+    as_object* rect = toObject(fn.arg(1), getVM(fn));
+    as_object* destpoint = toObject(fn.arg(2), getVM(fn));
+    if (!rect || !destpoint) return as_value();
+
+    as_object* f = toObject(fn.arg(3), getVM(fn));
+    const BitmapFilter* filter =
+        f ? dynamic_cast<const BitmapFilter*>(f->relay()) : nullptr;
+    if (!filter) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("BitmapData.applyFilter(): last argument is "
+                    "not a BitmapFilter"));
+        );
+        return as_value();
+    }
+
+    as_value x, y, w, h, px, py;
+    rect->get_member(NSV::PROP_X, &x);
+    rect->get_member(NSV::PROP_Y, &y);
+    rect->get_member(NSV::PROP_WIDTH, &w);
+    rect->get_member(NSV::PROP_HEIGHT, &h);
+    destpoint->get_member(NSV::PROP_X, &px);
+    destpoint->get_member(NSV::PROP_Y, &py);
+
+    int sourceX = toInt(x, getVM(fn));
+    int sourceY = toInt(y, getVM(fn));
+    int sourceW = toInt(w, getVM(fn));
+    int sourceH = toInt(h, getVM(fn));
+
+    int destX = toInt(px, getVM(fn));
+    int destY = toInt(py, getVM(fn));
+
+    if (sourceX < 0) destX -= sourceX;
+    if (sourceY < 0) destY -= sourceY;
+
+    adjustRect(sourceX, sourceY, sourceW, sourceH, *source);
+    if (sourceW == 0 || sourceH == 0) return as_value();
+
+    // The filtered source is copied to a premultiplied image, as the
+    // filters are applied to the images the renderer draws.
+    image::ImageRGBA im(sourceW, sourceH);
+    BitmapData_as::iterator src = pixelAt(*source, sourceX, sourceY);
+    std::uint8_t* p = im.begin();
+    for (int i = 0; i < sourceH; ++i, src += source->width()) {
+        for (int j = 0; j < sourceW; ++j, p += 4) {
+            const std::uint32_t pix = *(src + j);
+            const std::uint32_t a = pix >> 24;
+            p[0] = ((pix >> 16) & 0xff) * a / 255;
+            p[1] = ((pix >> 8) & 0xff) * a / 255;
+            p[2] = (pix & 0xff) * a / 255;
+            p[3] = a;
+        }
+    }
+
+    filter->apply(im);
+
+    // Only the part of the destination covered by the source changes.
+    const int offsetX = destX;
+    const int offsetY = destY;
+    int destW = sourceW;
+    int destH = sourceH;
+    adjustRect(destX, destY, destW, destH, *ptr);
+    if (destW == 0 || destH == 0) return as_value();
+
+    BitmapData_as::iterator targ = pixelAt(*ptr, destX, destY);
+    for (int i = 0; i < destH; ++i, targ += ptr->width()) {
+        const std::uint8_t* q =
+            im.begin() + ((destY - offsetY + i) * sourceW +
+                    (destX - offsetX)) * 4;
+        for (int j = 0; j < destW; ++j, q += 4) {
+            const std::uint32_t a = q[3];
+            const std::uint32_t r = a ? std::min<std::uint32_t>(q[0] * 255 / a, 255) : 0;
+            const std::uint32_t g = a ? std::min<std::uint32_t>(q[1] * 255 / a, 255) : 0;
+            const std::uint32_t b = a ? std::min<std::uint32_t>(q[2] * 255 / a, 255) : 0;
+            *(targ + j) = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+
+    ptr->updateObjects();
     return as_value();
 }
 
@@ -751,12 +887,64 @@ bitmapdata_clone(const fn_call& fn)
     return as_value(ret);
 }
 
+// rect: Rectangle,
+// colorTransform: ColorTransform
 as_value
 bitmapdata_colorTransform(const fn_call& fn)
 {
     BitmapData_as* ptr = ensure<ThisIsNative<BitmapData_as> >(fn);
-    UNUSED(ptr);
-    LOG_ONCE(log_unimpl(__FUNCTION__) );
+    if (ptr->disposed()) return as_value();
+
+    if (fn.nargs < 2) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("BitmapData.colorTransform(): needs 2 arguments"));
+        );
+        return as_value();
+    }
+
+    as_object* rect = toObject(fn.arg(0), getVM(fn));
+    as_object* o = toObject(fn.arg(1), getVM(fn));
+    ColorTransform_as* tr;
+    if (!rect || !isNativeType(o, tr)) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("BitmapData.colorTransform(): needs a rectangle "
+                    "and a ColorTransform"));
+        );
+        return as_value();
+    }
+
+    as_value x, y, w, h;
+    rect->get_member(NSV::PROP_X, &x);
+    rect->get_member(NSV::PROP_Y, &y);
+    rect->get_member(NSV::PROP_WIDTH, &w);
+    rect->get_member(NSV::PROP_HEIGHT, &h);
+
+    int rectX = toInt(x, getVM(fn));
+    int rectY = toInt(y, getVM(fn));
+    int rectW = toInt(w, getVM(fn));
+    int rectH = toInt(h, getVM(fn));
+
+    adjustRect(rectX, rectY, rectW, rectH, *ptr);
+    if (rectW == 0 || rectH == 0) return as_value();
+
+    const ColorTransformFactors cx = {
+        {{ static_cast<float>(tr->getRedMultiplier()),
+           static_cast<float>(tr->getGreenMultiplier()),
+           static_cast<float>(tr->getBlueMultiplier()),
+           static_cast<float>(tr->getAlphaMultiplier()) }},
+        {{ static_cast<float>(tr->getRedOffset()),
+           static_cast<float>(tr->getGreenOffset()),
+           static_cast<float>(tr->getBlueOffset()),
+           static_cast<float>(tr->getAlphaOffset()) }}
+    };
+
+    const size_t channels = ptr->channels();
+    for (int i = 0; i < rectH; ++i) {
+        colorTransformRow(ptr->row(rectY + i) + rectX * channels, channels,
+                rectW, cx);
+    }
+
+    ptr->updateObjects();
     return as_value();
 }
 
@@ -859,33 +1047,44 @@ bitmapdata_copyChannel(const fn_call& fn)
         return as_value();
     }
 
-    BitmapData_as::iterator targ = pixelAt(*ptr, destX, destY);
-    BitmapData_as::iterator src = pixelAt(*source, sourceX, sourceY);
-
     // Just being careful...
     assert(sourceX + destW <= static_cast<int>(source->width()));
     assert(sourceY + destH <= static_cast<int>(source->height()));
     assert(destX + destW <= static_cast<int>(ptr->width()));
     assert(destY + destH <= static_cast<int>(ptr->height()));
 
+    const size_t srcChannels = source->channels();
+    const size_t destChannels = ptr->channels();
+    const size_t srcOffset = channelOffset(srcchans);
+    const size_t destOffset = channelOffset(destchans);
+
+    // There is no alpha channel to copy to in an opaque image.
+    if (destOffset >= destChannels) return as_value();
+
     // Copy for the width and height of the *dest* image.
     // We have already ensured that the copied area
     // is inside both bitmapdatas
-    typedef CopyChannel<BitmapData_as::iterator> Copier;
-    Copier c(multiple, srcchans, destchans);
-
-    const size_t ourwidth = ptr->width();
-    const size_t srcwidth = source->width();
-
+    //
     // Note that copying the same channel to a range starting in the
     // source range produces unexpected effects because the source
     // range is changed while it is being copied. This is verified
     // to happen with the Adobe player too.
     for (int i = 0; i < destH; ++i) {
-        Copier::iterator_type zip(boost::make_tuple(src, targ));
-        std::transform(zip, zip + destW, targ, c);
-        targ += ourwidth;
-        src += srcwidth;
+        std::uint8_t* targ =
+            ptr->row(destY + i) + destX * destChannels;
+        const std::uint8_t* src =
+            source->row(sourceY + i) + sourceX * srcChannels;
+
+        // If multiple source channels, we set the destination channel
+        // to black. Opaque images have full alpha.
+        if (multiple || srcOffset >= srcChannels) {
+            fillChannelRow(targ, destChannels, destOffset,
+                    multiple ? 0 : 0xff, destW);
+        }
+        else {
+            copyChannelRow(src, srcChannels, srcOffset, targ, destChannels,
+                    destOffset, destW);
+        }
     }
 
     ptr->updateObjects();
@@ -986,12 +1185,7 @@ bitmapdata_copyPixels(const fn_call& fn)
         return as_value();
     }
 
-    BitmapData_as::iterator targ = pixelAt(*ptr, destX, destY);
-    BitmapData_as::iterator src = pixelAt(*source, sourceX, sourceY);
-
     const bool sameImage = (ptr == source);
-    const bool copyToXRange = sameImage && 
-        (destX >= sourceX && destX < sourceX + destW);
     const bool copyToYRange = sameImage &&
         (destY >= sourceY && destY < sourceY + destH);
 
@@ -1001,45 +1195,21 @@ bitmapdata_copyPixels(const fn_call& fn)
     assert(destX + destW <= static_cast<int>(ptr->width()));
     assert(destY + destH <= static_cast<int>(ptr->height()));
 
-    const size_t ourwidth = ptr->width();
-    const size_t srcwidth = source->width();
+    const size_t srcChannels = source->channels();
+    const size_t destChannels = ptr->channels();
 
     // Copy for the width and height of the *dest* image.
     // We have already ensured that the copied area
     // is inside both bitmapdatas.
     //
     // If the destination y-range starts within the source y-range, copy from
-    // bottom to top.
-    // If the destination x-range starts within the source x-range, copy from
-    // right to left.
-    if (copyToYRange) {
-        assert(destH > 0);
-        targ += (destH - 1) * ourwidth;
-        src += (destH - 1) * srcwidth;
-        // Copy from bottom to top.
-        for (int i = destH; i > 0; --i) {
-            if (copyToXRange) {
-                std::copy_backward(src, src + destW, targ + destW);
-            }
-            else {
-                std::copy(src, src + destW, targ);
-            }
-            targ -= ourwidth;
-            src -= srcwidth;
-        }
-    }
-    else {
-        // Normal copy from top to bottom.
-        for (int i = 0; i < destH; ++i) {
-            if (copyToXRange) {
-                std::copy_backward(src, src + destW, targ + destW);
-            }
-            else {
-                std::copy(src, src + destW, targ);
-            }
-            targ += ourwidth;
-            src += srcwidth;
-        }
+    // bottom to top. Rows of the same image may overlap, which copyRow()
+    // allows for.
+    for (int i = 0; i < destH; ++i) {
+        const int row = copyToYRange ? destH - 1 - i : i;
+        copyRow(source->row(sourceY + row) + sourceX * srcChannels,
+                srcChannels, ptr->row(destY + row) + destX * destChannels,
+                destChannels, destW);
     }
 
     ptr->updateObjects();
@@ -1260,12 +1430,58 @@ bitmapdata_hitTest(const fn_call& fn)
     return as_value();
 }
 
+// sourceBitmap: BitmapData,
+// sourceRect: Rectangle,
+// destPoint: Point,
+// redMultiplier: Number,
+// greenMultiplier: Number,
+// blueMultiplier: Number,
+// alphaMultiplier: Number
 as_value
 bitmapdata_merge(const fn_call& fn)
 {
     BitmapData_as* ptr = ensure<ThisIsNative<BitmapData_as> >(fn);
-    UNUSED(ptr);
-    LOG_ONCE(log_unimpl(__FUNCTION__) );
+    if (ptr->disposed()) return as_value();
+
+    if (fn.nargs < 7) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("BitmapData.merge(): needs 7 arguments"));
+        );
+        return as_value();
+    }
+
+    as_object* o = toObject(fn.arg(0), getVM(fn));
+    BitmapData_as* source;
+    if (!isNativeType(o, source) || source->disposed()) {
+        return as_value();
+    }
+
+    as_object* rect = toObject(fn.arg(1), getVM(fn));
+    if (!rect) return as_value();
+
+    CopyArea area;
+    if (!copyArea(*source, *ptr, *rect, toObject(fn.arg(2), getVM(fn)),
+                area)) {
+        return as_value();
+    }
+
+    // Multipliers are in the order of the bytes of a pixel.
+    const MergeMultipliers m = {{
+        static_cast<std::uint16_t>(clamp(toInt(fn.arg(3), getVM(fn)), 0, 256)),
+        static_cast<std::uint16_t>(clamp(toInt(fn.arg(4), getVM(fn)), 0, 256)),
+        static_cast<std::uint16_t>(clamp(toInt(fn.arg(5), getVM(fn)), 0, 256)),
+        static_cast<std::uint16_t>(clamp(toInt(fn.arg(6), getVM(fn)), 0, 256))
+    }};
+
+    const SourceRows src(*source, *ptr, area);
+    const size_t channels = ptr->channels();
+    for (int i = 0; i < area.height; ++i) {
+        mergeRow(src[i], src.channels(),
+                ptr->row(area.destY + i) + area.destX * channels, channels,
+                area.width, m);
+    }
+
+    ptr->updateObjects();
     return as_value();
 }
 
@@ -1307,12 +1523,67 @@ bitmapdata_noise(const fn_call& fn)
     return as_value();
 }
 
+// sourceBitmap: BitmapData,
+// sourceRect: Rectangle,
+// destPoint: Point,
+// [redArray: Array],
+// [greenArray: Array],
+// [blueArray: Array],
+// [alphaArray: Array]
 as_value
 bitmapdata_paletteMap(const fn_call& fn)
 {
     BitmapData_as* ptr = ensure<ThisIsNative<BitmapData_as> >(fn);
-    UNUSED(ptr);
-    LOG_ONCE(log_unimpl(__FUNCTION__) );
+    if (ptr->disposed()) return as_value();
+
+    if (fn.nargs < 3) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("BitmapData.paletteMap(): needs at least 3 "
+                    "arguments"));
+        );
+        return as_value();
+    }
+
+    as_object* o = toObject(fn.arg(0), getVM(fn));
+    BitmapData_as* source;
+    if (!isNativeType(o, source) || source->disposed()) {
+        return as_value();
+    }
+
+    as_object* rect = toObject(fn.arg(1), getVM(fn));
+    if (!rect) return as_value();
+
+    CopyArea area;
+    if (!copyArea(*source, *ptr, *rect, toObject(fn.arg(2), getVM(fn)),
+                area)) {
+        return as_value();
+    }
+
+    // Channels without an array, and values past the end of an array,
+    // are left as they are.
+    PaletteTables tables;
+    const int shifts[] = { 16, 8, 0, 24 };
+    for (size_t c = 0; c < 4; ++c) {
+        as_object* arr = fn.nargs > 3 + c ?
+            toObject(fn.arg(3 + c), getVM(fn)) : nullptr;
+        const size_t size = arr ? std::min<size_t>(arrayLength(*arr), 256) : 0;
+        for (size_t i = 0; i < 256; ++i) {
+            tables[c][i] = i < size ?
+                toInt(getOwnProperty(*arr, arrayKey(getVM(fn), i)),
+                        getVM(fn)) :
+                i << shifts[c];
+        }
+    }
+
+    const SourceRows src(*source, *ptr, area);
+    const size_t channels = ptr->channels();
+    for (int i = 0; i < area.height; ++i) {
+        paletteMapRow(src[i], src.channels(),
+                ptr->row(area.destY + i) + area.destX * channels, channels,
+                area.width, tables);
+    }
+
+    ptr->updateObjects();
     return as_value();
 }
 
@@ -1512,13 +1783,76 @@ bitmapdata_compare(const fn_call& fn)
     return as_value();
 }
 
+// sourceBitmap: BitmapData,
+// sourceRect: Rectangle,
+// destPoint: Point,
+// operation: String,
+// threshold: Number,
+// [color: Number],
+// [mask: Number],
+// [copySource: Boolean]
 as_value
 bitmapdata_threshold(const fn_call& fn)
 {
     BitmapData_as* ptr = ensure<ThisIsNative<BitmapData_as> >(fn);
-    UNUSED(ptr);
-    LOG_ONCE(log_unimpl(__FUNCTION__) );
-    return as_value();
+    if (ptr->disposed()) return as_value();
+
+    if (fn.nargs < 5) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("BitmapData.threshold(): needs at least 5 "
+                    "arguments"));
+        );
+        return as_value();
+    }
+
+    as_object* o = toObject(fn.arg(0), getVM(fn));
+    BitmapData_as* source;
+    if (!isNativeType(o, source) || source->disposed()) {
+        return as_value();
+    }
+
+    as_object* rect = toObject(fn.arg(1), getVM(fn));
+    if (!rect) return as_value();
+
+    const std::string& opName = fn.arg(3).to_string();
+    ThresholdOperation op;
+    if (opName == "<") op = THRESHOLD_LESS;
+    else if (opName == "<=") op = THRESHOLD_LESS_EQUAL;
+    else if (opName == ">") op = THRESHOLD_GREATER;
+    else if (opName == ">=") op = THRESHOLD_GREATER_EQUAL;
+    else if (opName == "==") op = THRESHOLD_EQUAL;
+    else if (opName == "!=") op = THRESHOLD_NOT_EQUAL;
+    else {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("BitmapData.threshold(): unknown operation %s"),
+                opName);
+        );
+        return as_value(0.0);
+    }
+
+    const std::uint32_t threshold = toInt(fn.arg(4), getVM(fn));
+    const std::uint32_t color = fn.nargs > 5 ? toInt(fn.arg(5), getVM(fn)) : 0;
+    const std::uint32_t mask =
+        fn.nargs > 6 ? toInt(fn.arg(6), getVM(fn)) : 0xffffffff;
+    const bool copySource = fn.nargs > 7 ? toBool(fn.arg(7), getVM(fn)) : false;
+
+    CopyArea area;
+    if (!copyArea(*source, *ptr, *rect, toObject(fn.arg(2), getVM(fn)),
+                area)) {
+        return as_value(0.0);
+    }
+
+    const SourceRows src(*source, *ptr, area);
+    const size_t channels = ptr->channels();
+    size_t count = 0;
+    for (int i = 0; i < area.height; ++i) {
+        count += thresholdRow(src[i], src.channels(),
+                ptr->row(area.destY + i) + area.destX * channels, channels,
+                area.width, op, threshold, color, mask, copySource);
+    }
+
+    ptr->updateObjects();
+    return as_value(static_cast<double>(count));
 }
 
 as_value
@@ -1769,6 +2103,7 @@ setPixel(const BitmapData_as& bd, size_t x, size_t y, std::uint32_t color)
     BitmapData_as::iterator it = pixelAt(bd, x, y);
     const std::uint32_t val = *it;
     *it = (color & 0xffffff) | (val & 0xff000000);
+    bd.updateObjects();
 }
 
 void
@@ -1779,6 +2114,7 @@ setPixel32(const BitmapData_as& bd, size_t x, size_t y, std::uint32_t color)
 
     BitmapData_as::iterator it = pixelAt(bd, x, y);
     *it = color;
+    bd.updateObjects();
 }
 
 void
@@ -1792,17 +2128,10 @@ fillRect(const BitmapData_as& bd, int x, int y, int w, int h,
     // the bitmap.    
     if (w == 0 || h == 0) return;
     
-    const size_t width = bd.width();
-
-    BitmapData_as::iterator it = bd.begin() + y * width;
-    BitmapData_as::iterator e = it + width * h;
-    
-    assert(e <= bd.end());
+    const size_t channels = bd.channels();
 
-    while (it != e) {
-        // Fill from x for the width of the rectangle.
-        std::fill_n(it + x, w, color);
-        it += width;
+    for (int i = 0; i < h; ++i) {
+        fillRow(bd.row(y + i) + x * channels, channels, w, color);
     }
     bd.updateObjects();
 }
@@ -1924,58 +2253,73 @@ adjustRect(int& x, int& y, int& w, int& h, const BitmapData_as& b)
 }
 
 
-std::uint8_t
-getChannel(std::uint32_t src, std::uint8_t bitmask)
+bool
+copyArea(const BitmapData_as& source, const BitmapData_as& dest,
+        as_object& rect, as_object* point, CopyArea& area)
 {
-    if (bitmask & BitmapData_as::CHANNEL_RED) {
-        // Red
-        return (src >> 16) & 0xff;
-    }
-    if (bitmask & BitmapData_as::CHANNEL_GREEN) {
-        // Green
-        return (src >> 8) & 0xff;
-    }
-    if (bitmask & BitmapData_as::CHANNEL_BLUE) {
-        // Blue
-        return src & 0xff;
-    }
-    if (bitmask & BitmapData_as::CHANNEL_ALPHA) {
-        // Alpha
-        return src >> 24;
+    VM& vm = getVM(rect);
+
+    as_value x, y, w, h;
+    rect.get_member(NSV::PROP_X, &x);
+    rect.get_member(NSV::PROP_Y, &y);
+    rect.get_member(NSV::PROP_WIDTH, &w);
+    rect.get_member(NSV::PROP_HEIGHT, &h);
+
+    int destX = 0;
+    int destY = 0;
+    if (point) {
+        as_value px, py;
+        point->get_member(NSV::PROP_X, &px);
+        point->get_member(NSV::PROP_Y, &py);
+        destX = toInt(px, vm);
+        destY = toInt(py, vm);
     }
-    return 0;
+
+    int sourceX = toInt(x, vm);
+    int sourceY = toInt(y, vm);
+    int sourceW = toInt(w, vm);
+    int sourceH = toInt(h, vm);
+
+    // Any part of the source rect that is not in the image (i.e.
+    // above or left) is concatenated to the destination offset.
+    if (sourceX < 0) destX -= sourceX;
+    if (sourceY < 0) destY -= sourceY;
+
+    adjustRect(sourceX, sourceY, sourceW, sourceH, source);
+    if (sourceW == 0 || sourceH == 0) return false;
+
+    // Parts of the source that would be copied above or left of the
+    // destination are skipped.
+    const int offsetX = destX;
+    const int offsetY = destY;
+    int destW = sourceW;
+    int destH = sourceH;
+    adjustRect(destX, destY, destW, destH, dest);
+    if (destW == 0 || destH == 0) return false;
+
+    area.sourceX = sourceX + destX - offsetX;
+    area.sourceY = sourceY + destY - offsetY;
+    area.destX = destX;
+    area.destY = destY;
+    area.width = destW;
+    area.height = destH;
+    return true;
 }
 
-std::uint32_t
-setChannel(std::uint32_t targ, std::uint8_t bitmask, std::uint8_t value)
+size_t
+channelOffset(std::uint8_t bitmask)
 {
-    std::uint32_t bytemask = 0;
-    std::uint32_t valmask = 0;
-    if (bitmask & BitmapData_as::CHANNEL_RED) {
-        // Red
-        bytemask = 0xff0000;
-        valmask = value << 16;
-    }
-    else if (bitmask & BitmapData_as::CHANNEL_GREEN) {
-        // Green
-        bytemask = 0xff00;
-        valmask = value << 8;
-    }
-    else if (bitmask & BitmapData_as::CHANNEL_BLUE) {
-        // Blue
-        bytemask = 0xff;
-        valmask = value;
-    }
-    else if (bitmask & BitmapData_as::CHANNEL_ALPHA) {
-        // Alpha
-        bytemask = 0xff000000;
-        valmask = value << 24;
-    }
-    targ &= ~bytemask;
-    targ |= valmask;
-    return targ;
+    switch (bitmask) {
+        case BitmapData_as::CHANNEL_RED:
+            return 0;
+        case BitmapData_as::CHANNEL_GREEN:
+            return 1;
+        case BitmapData_as::CHANNEL_BLUE:
+            return 2;
+        default:
+            return 3;
+    }
 }
 
-
 } // anonymous namespace
 } // end of gnash namespace
@@ -152,7 +152,26 @@ public:
         return image::end<image::ARGB>(*data());
     }
 
+    /// Return the bytes of a row of pixels.
+    //
+    /// These are RGB, or RGBA if transparent(), with alpha not
+    /// premultiplied.
+    std::uint8_t* row(size_t y) const {
+        assert(!disposed());
+        assert(y < height());
+        return image::scanline(*data(), y);
+    }
+
+    /// The number of bytes in each pixel of a row().
+    size_t channels() const {
+        assert(!disposed());
+        return data()->channels();
+    }
+
     /// Inform any attached objects that the data has changed.
+    //
+    /// This must follow every change to the pixels, as frames drawn in
+    /// another thread only copy them again then.
     void updateObjects() const;
 
 private:
@@ -0,0 +1,463 @@
+// BitmapKernels.cpp: row operations on BitmapData pixels, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "BitmapKernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+// AVX2 code is compiled for the functions that use it, and only run if
+// the CPU supports it.
+# if defined(__GNUC__) && (__GNUC__ >= 5 || defined(__clang__))
+#  define GNASH_AVX2_KERNELS 1
+#  include <immintrin.h>
+# endif
+#endif
+
+namespace gnash {
+
+namespace {
+
+/// Read a pixel as ARGB.
+inline std::uint32_t
+readPixel(const std::uint8_t* p, size_t channels)
+{
+    const std::uint32_t a = channels == 4 ? p[3] : 0xff;
+    return a << 24 | p[0] << 16 | p[1] << 8 | p[2];
+}
+
+/// Write an ARGB colour to a pixel.
+inline void
+writePixel(std::uint8_t* p, size_t channels, std::uint32_t color)
+{
+    p[0] = color >> 16;
+    p[1] = color >> 8;
+    p[2] = color;
+    if (channels == 4) p[3] = color >> 24;
+}
+
+/// Whether two rows of RGBA pixels share any memory.
+inline bool
+overlap(const std::uint8_t* a, const std::uint8_t* b, size_t pixels)
+{
+    return a < b + pixels * 4 && b < a + pixels * 4;
+}
+
+/// Test a value as BitmapData.threshold() does.
+inline bool
+passes(ThresholdOperation op, std::uint32_t value, std::uint32_t threshold)
+{
+    switch (op) {
+        case THRESHOLD_LESS:
+            return value < threshold;
+        case THRESHOLD_LESS_EQUAL:
+            return value <= threshold;
+        case THRESHOLD_GREATER:
+            return value > threshold;
+        case THRESHOLD_GREATER_EQUAL:
+            return value >= threshold;
+        case THRESHOLD_EQUAL:
+            return value == threshold;
+        case THRESHOLD_NOT_EQUAL:
+            return value != threshold;
+    }
+    return false;
+}
+
+#if defined(__SSE2__)
+
+/// Swap the first and third bytes of each 32-bit value.
+//
+/// This turns RGBA pixels read as little-endian values into ARGB values,
+/// and back.
+inline __m128i
+swapRedBlue(__m128i x)
+{
+    const __m128i ag = _mm_and_si128(x, _mm_set1_epi32(0xff00ff00));
+    const __m128i rb = _mm_and_si128(x, _mm_set1_epi32(0x00ff00ff));
+    return _mm_or_si128(ag,
+            _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16)));
+}
+
+/// Compare unsigned 32-bit values, giving all ones where the test passes.
+inline __m128i
+compare(ThresholdOperation op, __m128i value, __m128i threshold)
+{
+    // SSE2 only compares signed values.
+    const __m128i sign = _mm_set1_epi32(0x80000000);
+    const __m128i v = _mm_xor_si128(value, sign);
+    const __m128i t = _mm_xor_si128(threshold, sign);
+    const __m128i ones = _mm_set1_epi32(-1);
+
+    switch (op) {
+        case THRESHOLD_LESS:
+            return _mm_cmpgt_epi32(t, v);
+        case THRESHOLD_LESS_EQUAL:
+            return _mm_xor_si128(_mm_cmpgt_epi32(v, t), ones);
+        case THRESHOLD_GREATER:
+            return _mm_cmpgt_epi32(v, t);
+        case THRESHOLD_GREATER_EQUAL:
+            return _mm_xor_si128(_mm_cmpgt_epi32(t, v), ones);
+        case THRESHOLD_EQUAL:
+            return _mm_cmpeq_epi32(v, t);
+        case THRESHOLD_NOT_EQUAL:
+            return _mm_xor_si128(_mm_cmpeq_epi32(v, t), ones);
+    }
+    return _mm_setzero_si128();
+}
+
+/// Merge four RGBA pixels.
+inline __m128i
+merge(__m128i s, __m128i d, __m128i m, __m128i im)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = _mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), m),
+            _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), im));
+    const __m128i hi = _mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), m),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), im));
+    return _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+}
+
+/// Transform one RGBA pixel held as four 32-bit values.
+inline __m128i
+transform(__m128i p, __m128 mult, __m128 add)
+{
+    __m128 f = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(p), mult), add);
+    f = _mm_min_ps(_mm_max_ps(f, _mm_setzero_ps()), _mm_set1_ps(255));
+    return _mm_cvttps_epi32(f);
+}
+
+#endif
+
+#if defined(GNASH_AVX2_KERNELS)
+
+bool
+haveAVX2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+/// Merge rows of RGBA pixels, eight at a time.
+//
+/// @return     The number of pixels merged.
+__attribute__((target("avx2"))) size_t
+mergeAVX2(const std::uint8_t* src, std::uint8_t* dst, size_t pixels,
+        const MergeMultipliers& mult)
+{
+    const __m256i m = _mm256_setr_epi16(mult[0], mult[1], mult[2], mult[3],
+            mult[0], mult[1], mult[2], mult[3],
+            mult[0], mult[1], mult[2], mult[3],
+            mult[0], mult[1], mult[2], mult[3]);
+    const __m256i im = _mm256_sub_epi16(_mm256_set1_epi16(256), m);
+    const __m256i zero = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        const __m256i s = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(src + i * 4));
+        const __m256i d = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(dst + i * 4));
+
+        // Unpacking and packing work within each 128-bit half, so the
+        // pixels come back in order.
+        const __m256i lo = _mm256_add_epi16(
+                _mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero), m),
+                _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), im));
+        const __m256i hi = _mm256_add_epi16(
+                _mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero), m),
+                _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), im));
+        const __m256i r = _mm256_packus_epi16(_mm256_srli_epi16(lo, 8),
+                _mm256_srli_epi16(hi, 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), r);
+    }
+    return i;
+}
+
+/// Transform a row of RGBA pixels, eight at a time.
+//
+/// @return     The number of pixels transformed.
+__attribute__((target("avx2"))) size_t
+colorTransformAVX2(std::uint8_t* row, size_t pixels,
+        const ColorTransformFactors& cx)
+{
+    const __m256 mult = _mm256_setr_ps(cx.multipliers[0], cx.multipliers[1],
+            cx.multipliers[2], cx.multipliers[3], cx.multipliers[0],
+            cx.multipliers[1], cx.multipliers[2], cx.multipliers[3]);
+    const __m256 add = _mm256_setr_ps(cx.offsets[0], cx.offsets[1],
+            cx.offsets[2], cx.offsets[3], cx.offsets[0], cx.offsets[1],
+            cx.offsets[2], cx.offsets[3]);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 max = _mm256_set1_ps(255);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        std::uint8_t* p = row + i * 4;
+
+        // Each pair of pixels is transformed as eight values.
+        __m256i r[4];
+        for (size_t k = 0; k < 4; ++k) {
+            const __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(
+                        reinterpret_cast<const __m128i*>(p + k * 8)));
+            const __m256 f = _mm256_add_ps(
+                    _mm256_mul_ps(_mm256_cvtepi32_ps(v), mult), add);
+            r[k] = _mm256_cvttps_epi32(
+                    _mm256_min_ps(_mm256_max_ps(f, zero), max));
+        }
+
+        // Packing works within each 128-bit half, which leaves the even
+        // pixels in the low half and the odd ones in the high half.
+        const __m256i w = _mm256_packus_epi16(
+                _mm256_packs_epi32(r[0], r[1]),
+                _mm256_packs_epi32(r[2], r[3]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p),
+                _mm256_permutevar8x32_epi32(w, order));
+    }
+    return i;
+}
+
+#endif
+
+} // anonymous namespace
+
+void
+fillRow(std::uint8_t* row, size_t channels, size_t pixels,
+        std::uint32_t color)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    if (channels == 4) {
+        const __m128i c = swapRedBlue(_mm_set1_epi32(color));
+        for (; i + 4 <= pixels; i += 4) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i * 4), c);
+        }
+    }
+#endif
+
+    for (; i < pixels; ++i) writePixel(row + i * channels, channels, color);
+}
+
+void
+copyRow(const std::uint8_t* src, size_t srcChannels, std::uint8_t* dst,
+        size_t dstChannels, size_t pixels)
+{
+    if (srcChannels == dstChannels) {
+        std::memmove(dst, src, pixels * srcChannels);
+        return;
+    }
+
+    for (size_t i = 0; i < pixels; ++i) {
+        writePixel(dst + i * dstChannels, dstChannels,
+                readPixel(src + i * srcChannels, srcChannels));
+    }
+}
+
+void
+copyChannelRow(const std::uint8_t* src, size_t srcChannels,
+        size_t srcOffset, std::uint8_t* dst, size_t dstChannels,
+        size_t dstOffset, size_t pixels)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    // Overlapping rows are copied a pixel at a time, see the header.
+    if (srcChannels == 4 && dstChannels == 4 && !overlap(src, dst, pixels)) {
+        const __m128i srcShift = _mm_cvtsi32_si128(srcOffset * 8);
+        const __m128i dstShift = _mm_cvtsi32_si128(dstOffset * 8);
+        const __m128i byte = _mm_set1_epi32(0xff);
+        const __m128i mask = _mm_sll_epi32(byte, dstShift);
+        for (; i + 4 <= pixels; i += 4) {
+            const __m128i s = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(src + i * 4));
+            __m128i* p = reinterpret_cast<__m128i*>(dst + i * 4);
+            const __m128i v = _mm_sll_epi32(
+                    _mm_and_si128(_mm_srl_epi32(s, srcShift), byte), dstShift);
+            _mm_storeu_si128(p,
+                    _mm_or_si128(_mm_andnot_si128(mask, _mm_loadu_si128(p)), v));
+        }
+    }
+#endif
+
+    for (; i < pixels; ++i) {
+        dst[i * dstChannels + dstOffset] = src[i * srcChannels + srcOffset];
+    }
+}
+
+void
+fillChannelRow(std::uint8_t* row, size_t channels, size_t offset,
+        std::uint8_t value, size_t pixels)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    if (channels == 4) {
+        const __m128i shift = _mm_cvtsi32_si128(offset * 8);
+        const __m128i mask = _mm_sll_epi32(_mm_set1_epi32(0xff), shift);
+        const __m128i v = _mm_sll_epi32(_mm_set1_epi32(value), shift);
+        for (; i + 4 <= pixels; i += 4) {
+            __m128i* p = reinterpret_cast<__m128i*>(row + i * 4);
+            _mm_storeu_si128(p,
+                    _mm_or_si128(_mm_andnot_si128(mask, _mm_loadu_si128(p)), v));
+        }
+    }
+#endif
+
+    for (; i < pixels; ++i) row[i * channels + offset] = value;
+}
+
+void
+mergeRow(const std::uint8_t* src, size_t srcChannels, std::uint8_t* dst,
+        size_t dstChannels, size_t pixels, const MergeMultipliers& m)
+{
+    size_t i = 0;
+
+    if (srcChannels == 4 && dstChannels == 4) {
+#if defined(GNASH_AVX2_KERNELS)
+        if (haveAVX2()) i = mergeAVX2(src, dst, pixels, m);
+#endif
+#if defined(__SSE2__)
+        const __m128i mult = _mm_setr_epi16(m[0], m[1], m[2], m[3],
+                m[0], m[1], m[2], m[3]);
+        const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(256), mult);
+        for (; i + 4 <= pixels; i += 4) {
+            const __m128i s = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(src + i * 4));
+            __m128i* p = reinterpret_cast<__m128i*>(dst + i * 4);
+            _mm_storeu_si128(p, merge(s, _mm_loadu_si128(p), mult, inverse));
+        }
+#endif
+    }
+
+    for (; i < pixels; ++i) {
+        const std::uint8_t* s = src + i * srcChannels;
+        std::uint8_t* d = dst + i * dstChannels;
+        for (size_t c = 0; c < dstChannels; ++c) {
+            const unsigned sv = c < srcChannels ? s[c] : 0xff;
+            d[c] = (sv * m[c] + d[c] * (256 - m[c])) >> 8;
+        }
+    }
+}
+
+void
+colorTransformRow(std::uint8_t* row, size_t channels, size_t pixels,
+        const ColorTransformFactors& cx)
+{
+    size_t i = 0;
+
+    if (channels == 4) {
+#if defined(GNASH_AVX2_KERNELS)
+        if (haveAVX2()) i = colorTransformAVX2(row, pixels, cx);
+#endif
+#if defined(__SSE2__)
+        const __m128 mult = _mm_setr_ps(cx.multipliers[0], cx.multipliers[1],
+                cx.multipliers[2], cx.multipliers[3]);
+        const __m128 add = _mm_setr_ps(cx.offsets[0], cx.offsets[1],
+                cx.offsets[2], cx.offsets[3]);
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 4 <= pixels; i += 4) {
+            __m128i* p = reinterpret_cast<__m128i*>(row + i * 4);
+            const __m128i v = _mm_loadu_si128(p);
+            const __m128i lo = _mm_unpacklo_epi8(v, zero);
+            const __m128i hi = _mm_unpackhi_epi8(v, zero);
+            const __m128i a = _mm_packs_epi32(
+                    transform(_mm_unpacklo_epi16(lo, zero), mult, add),
+                    transform(_mm_unpackhi_epi16(lo, zero), mult, add));
+            const __m128i b = _mm_packs_epi32(
+                    transform(_mm_unpacklo_epi16(hi, zero), mult, add),
+                    transform(_mm_unpackhi_epi16(hi, zero), mult, add));
+            _mm_storeu_si128(p, _mm_packus_epi16(a, b));
+        }
+#endif
+    }
+
+    for (; i < pixels; ++i) {
+        std::uint8_t* p = row + i * channels;
+        for (size_t c = 0; c < channels; ++c) {
+            const float v = p[c] * cx.multipliers[c] + cx.offsets[c];
+            p[c] = std::min(std::max(v, 0.0f), 255.0f);
+        }
+    }
+}
+
+size_t
+thresholdRow(const std::uint8_t* src, size_t srcChannels,
+        std::uint8_t* dst, size_t dstChannels, size_t pixels,
+        ThresholdOperation op, std::uint32_t threshold, std::uint32_t color,
+        std::uint32_t mask, bool copySource)
+{
+    threshold &= mask;
+
+    size_t i = 0;
+    size_t count = 0;
+
+#if defined(__SSE2__)
+    if (srcChannels == 4 && dstChannels == 4 && !overlap(src, dst, pixels)) {
+        const __m128i t = _mm_set1_epi32(threshold);
+        const __m128i m = _mm_set1_epi32(mask);
+        const __m128i c = swapRedBlue(_mm_set1_epi32(color));
+        for (; i + 4 <= pixels; i += 4) {
+            const __m128i s = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(src + i * 4));
+            __m128i* p = reinterpret_cast<__m128i*>(dst + i * 4);
+            const __m128i pass =
+                compare(op, _mm_and_si128(swapRedBlue(s), m), t);
+            const __m128i other = copySource ? s : _mm_loadu_si128(p);
+            _mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(pass, c),
+                        _mm_andnot_si128(pass, other)));
+
+            const int bits = _mm_movemask_ps(_mm_castsi128_ps(pass));
+            count += (bits & 1) + (bits >> 1 & 1) + (bits >> 2 & 1) +
+                (bits >> 3 & 1);
+        }
+    }
+#endif
+
+    for (; i < pixels; ++i) {
+        const std::uint32_t p = readPixel(src + i * srcChannels, srcChannels);
+        std::uint8_t* d = dst + i * dstChannels;
+        if (passes(op, p & mask, threshold)) {
+            writePixel(d, dstChannels, color);
+            ++count;
+        }
+        else if (copySource) writePixel(d, dstChannels, p);
+    }
+    return count;
+}
+
+void
+paletteMapRow(const std::uint8_t* src, size_t srcChannels,
+        std::uint8_t* dst, size_t dstChannels, size_t pixels,
+        const PaletteTables& tables)
+{
+    for (size_t i = 0; i < pixels; ++i) {
+        const std::uint8_t* s = src + i * srcChannels;
+        const std::uint8_t a = srcChannels == 4 ? s[3] : 0xff;
+        writePixel(dst + i * dstChannels, dstChannels,
+                tables[0][s[0]] + tables[1][s[1]] + tables[2][s[2]] +
+                tables[3][a]);
+    }
+}
+
+} // namespace gnash
@@ -0,0 +1,121 @@
+// BitmapKernels.h: row operations on BitmapData pixels, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_BITMAPKERNELS_H
+#define GNASH_BITMAPKERNELS_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// These work on one row of an image at a time, given as bytes in the
+// image's own order: RGB, or RGBA with alpha not premultiplied. Colours
+// passed in are ARGB values as in ActionScript. An RGB source reads as
+// opaque, and the alpha of an RGB destination is left out.
+//
+// Rows of RGBA images are processed several pixels at a time with SSE2
+// where available, and with AVX2 for the arithmetic kernels when the CPU
+// has it.
+
+namespace gnash {
+
+/// Set every pixel of a row to a colour.
+void fillRow(std::uint8_t* row, size_t channels, size_t pixels,
+        std::uint32_t color);
+
+/// Copy pixels, converting between RGB and RGBA.
+//
+/// Rows of the same type may overlap.
+void copyRow(const std::uint8_t* src, size_t srcChannels, std::uint8_t* dst,
+        size_t dstChannels, size_t pixels);
+
+/// Copy one channel of each source pixel to one channel of the destination.
+//
+/// If the rows overlap, pixels are copied one after the other from the
+/// left, so a copy may read pixels it has already written.
+///
+/// @param srcOffset    The byte of the channel in a source pixel.
+/// @param dstOffset    The byte of the channel in a destination pixel.
+void copyChannelRow(const std::uint8_t* src, size_t srcChannels,
+        size_t srcOffset, std::uint8_t* dst, size_t dstChannels,
+        size_t dstOffset, size_t pixels);
+
+/// Set one channel of every pixel of a row.
+void fillChannelRow(std::uint8_t* row, size_t channels, size_t offset,
+        std::uint8_t value, size_t pixels);
+
+/// How much of the source each channel takes in mergeRow().
+//
+/// In the order of the bytes of an RGBA pixel, from 0 to 256.
+typedef std::array<std::uint16_t, 4> MergeMultipliers;
+
+/// Blend source pixels into the destination, channel by channel.
+//
+/// Each channel becomes (src * m + dst * (256 - m)) / 256.
+void mergeRow(const std::uint8_t* src, size_t srcChannels, std::uint8_t* dst,
+        size_t dstChannels, size_t pixels, const MergeMultipliers& m);
+
+/// A colour transform, in the order of the bytes of an RGBA pixel.
+struct ColorTransformFactors
+{
+    std::array<float, 4> multipliers;
+    std::array<float, 4> offsets;
+};
+
+/// Apply a colour transform to a row.
+//
+/// Each channel becomes c * multiplier + offset, clamped to 0..255.
+void colorTransformRow(std::uint8_t* row, size_t channels, size_t pixels,
+        const ColorTransformFactors& cx);
+
+/// The comparisons of BitmapData.threshold().
+enum ThresholdOperation
+{
+    THRESHOLD_LESS,
+    THRESHOLD_LESS_EQUAL,
+    THRESHOLD_GREATER,
+    THRESHOLD_GREATER_EQUAL,
+    THRESHOLD_EQUAL,
+    THRESHOLD_NOT_EQUAL
+};
+
+/// Set the destination pixels whose source pixels pass a test to a colour.
+//
+/// A source pixel p passes if (p & mask) op (threshold & mask).
+///
+/// @param copySource   Whether pixels that don't pass are copied from
+///                     the source, rather than left alone.
+/// @return             The number of pixels that passed.
+size_t thresholdRow(const std::uint8_t* src, size_t srcChannels,
+        std::uint8_t* dst, size_t dstChannels, size_t pixels,
+        ThresholdOperation op, std::uint32_t threshold, std::uint32_t color,
+        std::uint32_t mask, bool copySource);
+
+/// The colours each value of a channel maps to, for red, green, blue and
+/// alpha in that order.
+typedef std::array<std::array<std::uint32_t, 256>, 4> PaletteTables;
+
+/// Replace each pixel with the sum of its channels' entries in the tables.
+void paletteMapRow(const std::uint8_t* src, size_t srcChannels,
+        std::uint8_t* dst, size_t dstChannels, size_t pixels,
+        const PaletteTables& tables);
+
+} // namespace gnash
+
+#endif
@@ -26,6 +26,9 @@
 #include <map>
 #include <bitset>
 #include <cassert>
+#include <csignal>
+#include <fstream>
+#include <iostream>
 #include <functional>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/ptr_container/ptr_deque.hpp>
@@ -51,6 +54,8 @@
 #include "IOChannel.h"
 #include "RunResources.h"
 #include "Renderer.h"
+#include "RecordingRenderer.h"
+#include "BitmapCache.h"
 #include "ExternalInterface.h"
 #include "TextField.h"
 #include "Button.h"
@@ -58,6 +63,9 @@
 #include "StreamProvider.h"
 #include "SystemClock.h"
 #include "as_function.h"
+#include "MemberCache.h"
+#include "MemoryPool.h"
+#include "rc.h"
 
 #ifdef USE_SWFTREE
 # include "tree.hh"
@@ -94,6 +102,15 @@ namespace {
     as_object* getBuiltinObject(movie_root& mr, const ObjectURI& cl);
     void advanceLiveChar(MovieClip* ch);
     void notifyLoad(MovieClip* ch);
+    void writeGCStats(const movie_root& mr);
+    void writeProfile(const FrameProfiler& profiler);
+    void writeJSON(std::ostream& os, const TimeHistogram& h);
+
+    /// Set by movie_root::requestGCStatsDump().
+    volatile std::sig_atomic_t gcStatsRequested = 0;
+
+    /// Set by movie_root::requestProfileDump().
+    volatile std::sig_atomic_t profileRequested = 0;
 }
 
 // Utility classes
@@ -134,7 +151,12 @@ clear(movie_root::ActionQueue& aq)
 
 movie_root::movie_root(VirtualClock& clock, const RunResources& runResources)
     :
+    _bitmapCaches(RcInitFile::getDefaultInstance().getBitmapCacheSize() *
+            1024 * 1024),
     _gc(*this),
+    _profiler(RcInitFile::getDefaultInstance().getProfileFrames()),
+    _displayFrame(0),
+    _retainCommands(RcInitFile::getDefaultInstance().retainCommands()),
     _runResources(runResources),
     _vm(*this, clock),
     _interfaceHandler(nullptr),
@@ -189,6 +211,8 @@ movie_root::disableScripts()
 
 movie_root::~movie_root()
 {
+    if (_profiler.enabled()) writeProfile(_profiler);
+
     clear(_actionQueue);
     _intervalTimers.clear();
     _movieLoader.clear();
@@ -309,6 +333,71 @@ movie_root::cleanupAndCollect()
 
     cleanupDisplayList();
     _gc.fuzzyCollect();
+
+    if (gcStatsRequested) {
+        gcStatsRequested = 0;
+        writeGCStats(*this);
+    }
+
+    if (profileRequested) {
+        profileRequested = 0;
+        if (_profiler.enabled()) writeProfile(_profiler);
+    }
+}
+
+void
+movie_root::requestGCStatsDump()
+{
+    gcStatsRequested = 1;
+}
+
+void
+movie_root::requestProfileDump()
+{
+    profileRequested = 1;
+}
+
+void
+movie_root::dumpGCStats(std::ostream& os) const
+{
+    const GcStats& st = _gc.stats();
+
+    os << "{\n"
+       << "  \"collectables\": " << _gc.collectables() << ",\n"
+       << "  \"cycles\": " << st.cycles << ",\n"
+       << "  \"allocated\": " << st.allocated << ",\n"
+       << "  \"survived\": " << st.survived << ",\n"
+       << "  \"freed\": " << st.freed << ",\n"
+       << "  \"last_survived\": " << st.lastSurvived << ",\n"
+       << "  \"last_freed\": " << st.lastFreed << ",\n"
+       << "  \"scanned\": " << st.scanned << ",\n"
+       << "  \"last_scanned\": " << st.lastScanned << ",\n"
+       << "  \"last_mark_ms\": " << st.lastMarkTime << ",\n"
+       << "  \"last_sweep_ms\": " << st.lastSweepTime << ",\n"
+       << "  \"allocation_rate\": " << st.allocationRate << ",\n"
+       << "  \"mark_ms\": ";
+    writeJSON(os, st.markTimes);
+    os << ",\n  \"sweep_ms\": ";
+    writeJSON(os, st.sweepTimes);
+    os << ",\n  \"pause_ms\": ";
+    writeJSON(os, st.pauses);
+
+    const MemoryPool::Stats& pool = MemoryPool::stats();
+    os << ",\n  \"pool\": { \"allocations\": " << pool.allocations
+       << ", \"in_use\": " << pool.inUse
+       << ", \"chunks\": " << pool.chunks
+       << ", \"oversized\": " << pool.oversized << " }";
+
+    GC::CollectablesCount count;
+    _gc.countCollectables(count);
+
+    os << ",\n  \"live\": {";
+    for (GC::CollectablesCount::const_iterator i = count.begin(),
+            e = count.end(); i != e; ++i) {
+        if (i != count.begin()) os << ",";
+        os << "\n    \"" << i->first << "\": " << i->second;
+    }
+    os << "\n  }\n}\n";
 }
 
 /* private */
@@ -852,6 +941,9 @@ movie_root::advance()
     // contructed from a negative value.
     const size_t now = std::max<size_t>(_vm.getTime(), _lastMovieAdvancement);
 
+    _profiler.startFrame();
+    FrameProfiler::Scope profile(_profiler, FrameProfiler::ADVANCE);
+
     bool advanced = false;
 
     try {
@@ -959,6 +1051,8 @@ movie_root::advance()
 void
 movie_root::advanceMovie()
 {
+    FrameProfiler::Scope profile(_profiler, FrameProfiler::ADVANCE_MOVIE);
+
     // Do mouse drag, if needed
     doMouseDrag();
 
@@ -999,6 +1093,54 @@ movie_root::display()
 {
     // GNASH_REPORT_FUNCTION;
 
+    FrameProfiler::Scope profile(_profiler, FrameProfiler::DISPLAY);
+
+    Renderer* renderer = recordDisplay();
+    if (!renderer) return;
+
+    const SWFRect& frame_size = _rootMovie->get_frame_size();
+
+    {
+        Renderer::External ex(*renderer, m_background_color,
+                _stageWidth, _stageHeight,
+                frame_size.get_x_min(), frame_size.get_x_max(),
+                frame_size.get_y_min(), frame_size.get_y_max());
+
+        _displayCommands.replay(*renderer);
+    }
+
+    // Some renderers draw when the frame ends, so only now are the
+    // images dropped while recording the commands drawn.
+    _bitmapCaches.expire();
+}
+
+std::unique_ptr<RenderFrame>
+movie_root::recordFrame()
+{
+    FrameProfiler::Scope profile(_profiler, FrameProfiler::DISPLAY);
+
+    std::unique_ptr<RenderFrame> frame;
+    Renderer* renderer = recordDisplay();
+    if (!renderer) return frame;
+
+    frame.reset(new RenderFrame(m_background_color, _stageWidth,
+                _stageHeight, _rootMovie->get_frame_size()));
+
+    // The recording is kept to be reused by the next frame, so detach
+    // a copy.
+    frame->commands = _displayCommands;
+    frame->commands.detach(_shapeCopies, *renderer);
+    _shapeCopies.expire();
+
+    // The frame draws copies of the images dropped while recording it.
+    _bitmapCaches.expire();
+
+    return frame;
+}
+
+Renderer*
+movie_root::recordDisplay()
+{
     assert(testInvariant());
 
     clearInvalidated();
@@ -1010,34 +1152,41 @@ movie_root::display()
         // TODO: check what we should do if other levels
         //       have valid bounds
         log_debug("original root movie had null bounds, not displaying");
-        return;
+        return nullptr;
     }
 
     Renderer* renderer = _runResources.renderer();
-    if (!renderer) return;
+    if (!renderer) return nullptr;
+
+    // Record the frame, copying what didn't change from the last one.
+    _lastDisplayCommands.clear();
+    _lastDisplayCommands.swap(_displayCommands);
+    ++_displayFrame;
 
-    Renderer::External ex(*renderer, m_background_color,
-            _stageWidth, _stageHeight,
-            frame_size.get_x_min(), frame_size.get_x_max(),
-            frame_size.get_y_min(), frame_size.get_y_max());
+    RecordingRenderer recorder(*renderer, _displayCommands,
+            _lastDisplayCommands, _displayFrame, _retainCommands);
 
     for (auto& elem : _movies) {
         MovieClip* movie = elem.second;
 
-        movie->clear_invalidated();
-
-        if (movie->visible() == false) continue;
+        if (movie->visible() == false) {
+            movie->clear_invalidated();
+            continue;
+        }
 
         // null frame size ? don't display !
         const SWFRect& sub_frame_size = movie->get_frame_size();
 
         if (sub_frame_size.is_null()) {
             log_debug("_level%u has null frame size, skipping", elem.first);
+            movie->clear_invalidated();
             continue;
         }
 
-        movie->display(*renderer, Transform());
+        movie->display(recorder, Transform());
     }
+
+    return renderer;
 }
 
 bool
@@ -1469,6 +1618,9 @@ movie_root::removeAdvanceCallback(ActiveRelay* obj)
 void
 movie_root::processActionQueue()
 {
+    FrameProfiler::Scope profile(_profiler,
+            FrameProfiler::PROCESS_ACTION_QUEUE);
+
     if (_disableScripts) {
         /// cleanup anything pushed later..
         clear(_actionQueue);
@@ -1713,6 +1865,8 @@ movie_root::executeTimers()
         return;
     }
 
+    FrameProfiler::Scope profile(_profiler, FrameProfiler::EXECUTE_TIMERS);
+
     unsigned long now = _vm.getTime();
 
     typedef std::multimap<unsigned long, Timer*>
@@ -1810,7 +1964,8 @@ movie_root::markReachableResources() const
 #ifdef ALLOW_GC_RUN_DURING_ACTIONS_EXECUTION
         (*i)->setReachable();
 #else
-        assert((*i)->isReachable());
+        // Incremental marking only queues the DisplayObjects for a scan.
+        assert((*i)->isReachable() || GC::incrementalMarking());
 #endif
     }
 #endif
@@ -2001,6 +2156,9 @@ movie_root::registerButton(Button* listener)
 void
 movie_root::cleanupDisplayList()
 {
+    FrameProfiler::Scope profile(_profiler,
+            FrameProfiler::CLEANUP_DISPLAY_LIST);
+
 //#define GNASH_DEBUG_INSTANCE_LIST 1
 
 #ifdef GNASH_DEBUG_INSTANCE_LIST
@@ -2352,6 +2510,54 @@ movie_root::getMovieInfo(InfoTree& tr, InfoTree::iterator it)
     // Stage: scripts state (enabled/disabled)
     localIter = tr.append_child(it, std::make_pair("Scripts",
                 _disableScripts ? " disabled" : "enabled"));
+
+    // Scripts: member lookups served by inline caches.
+    os.str("");
+    os << MemberCache::hits() << "/" <<
+        MemberCache::hits() + MemberCache::misses();
+    localIter = tr.append_child(it, std::make_pair("Member cache hits",
+                os.str()));
+
+    // Renderer caches
+    if (const Renderer* renderer = _runResources.renderer()) {
+        for (const auto& s : renderer->cacheStats()) {
+            localIter = tr.append_child(it, s);
+        }
+    }
+
+    // Garbage collector
+    const GcStats& gcStats = _gc.stats();
+    localIter = tr.append_child(it, std::make_pair("Garbage collector", ""));
+
+    os.str("");
+    os << _gc.collectables();
+    tr.append_child(localIter, std::make_pair("Collectables", os.str()));
+
+    os.str("");
+    os << gcStats.cycles;
+    tr.append_child(localIter, std::make_pair("Cycles", os.str()));
+
+    os.str("");
+    os << gcStats.lastSurvived << " kept, " << gcStats.lastFreed << " freed";
+    tr.append_child(localIter, std::make_pair("Last cycle", os.str()));
+
+    os.str("");
+    os << gcStats.lastMarkTime << " ms mark, " << gcStats.lastSweepTime << " ms sweep";
+    tr.append_child(localIter, std::make_pair("Last cycle time", os.str()));
+
+    os.str("");
+    os << gcStats.pauses.max() << " ms";
+    tr.append_child(localIter, std::make_pair("Longest pause", os.str()));
+
+    os.str("");
+    os << static_cast<long>(gcStats.allocationRate) << "/s";
+    tr.append_child(localIter, std::make_pair("Allocation rate", os.str()));
+
+    const MemoryPool::Stats& pool = MemoryPool::stats();
+    os.str("");
+    os << pool.inUse << " in use, " << pool.allocations << " allocated, " <<
+        pool.oversized << " too large";
+    tr.append_child(localIter, std::make_pair("Pooled blocks", os.str()));
      
     getCharacterTree(tr, it);    
 }
@@ -2687,6 +2893,58 @@ notifyLoad(MovieClip* mo)
     }
 }
 
+void
+writeGCStats(const movie_root& mr)
+{
+    const std::string& file = RcInitFile::getDefaultInstance().getGCStatsFile();
+    if (file.empty()) {
+        mr.dumpGCStats(std::cerr);
+        return;
+    }
+
+    std::ofstream os(file.c_str(), std::ios::trunc);
+    if (!os) {
+        log_error(_("Could not write garbage collector statistics to %s"),
+                file);
+        return;
+    }
+    mr.dumpGCStats(os);
+}
+
+void
+writeProfile(const FrameProfiler& profiler)
+{
+    const std::string& file = RcInitFile::getDefaultInstance().getProfileFile();
+    if (file.empty()) {
+        profiler.writeTrace(std::cerr);
+        return;
+    }
+
+    std::ofstream os(file.c_str(), std::ios::trunc);
+    if (!os) {
+        log_error(_("Could not write the frame profile to %s"), file);
+        return;
+    }
+    profiler.writeTrace(os);
+}
+
+/// Write a histogram as an object with the bucket bounds as keys.
+void
+writeJSON(std::ostream& os, const TimeHistogram& h)
+{
+    os << "{ \"count\": " << h.total() << ", \"sum\": " << h.sum()
+       << ", \"max\": " << h.max() << ", \"buckets\": {";
+    for (size_t i = 0; i < TimeHistogram::Buckets; ++i) {
+        if (i) os << ",";
+        const double bound = TimeHistogram::bound(i);
+        os << " \"";
+        if (bound) os << "<" << bound;
+        else os << ">=" << TimeHistogram::bound(i - 1);
+        os << "\": " << h.count(i);
+    }
+    os << " } }";
+}
+
 } // anonymous namespace
 } // namespace gnash
 
@@ -90,6 +90,9 @@
 #include "MovieLoader.h"
 #include "ExternalInterface.h"
 #include "GC.h"
+#include "BitmapCache.h"
+#include "FrameProfiler.h"
+#include "RenderCommands.h"
 #include "VM.h"
 #include "HostInterface.h"
 #include "log.h"
@@ -386,6 +389,14 @@ public:
 
     void display();
 
+    /// Record the stage to be drawn later, possibly by another thread.
+    //
+    /// What it draws is copied, so the frame can be drawn while the
+    /// stage changes.
+    ///
+    /// @return     The frame, or null if there is nothing to display.
+    std::unique_ptr<RenderFrame> recordFrame();
+
     /// Get a unique number for unnamed instances.
     size_t nextUnnamedInstance() {
         return ++_unnamedInstance;
@@ -823,6 +834,34 @@ public:
         return _gc;
     }
 
+    /// The images of DisplayObjects with filters or cacheAsBitmap.
+    BitmapCacheList& bitmapCaches() {
+        return _bitmapCaches;
+    }
+
+    /// Write the garbage collector statistics as a JSON object.
+    //
+    /// Besides GcStats this includes the number of live resources of
+    /// each type, which takes a walk over all of them.
+    void dumpGCStats(std::ostream& os) const;
+
+    /// Have the garbage collector statistics written out after the next
+    /// collection.
+    //
+    /// They go to the gcStatsFile set in gnashrc, or to standard error.
+    /// This only sets a flag, so it can be called from a signal handler.
+    static void requestGCStatsDump();
+
+    FrameProfiler& profiler() {
+        return _profiler;
+    }
+
+    /// Have the frame profile written out after the next frame.
+    //
+    /// It goes to the profileFile set in gnashrc, or to standard error.
+    /// This only sets a flag, so it can be called from a signal handler.
+    static void requestProfileDump();
+
     /// Ask the host interface a question.
     //
     /// @param what The question to pose.
@@ -963,11 +1002,37 @@ private:
 
     void handleActionLimitHit(const std::string& ref);
 
+    /// Record the drawing calls of the stage in _displayCommands.
+    //
+    /// @return     The renderer to draw them on, or null if there is
+    ///             nothing to display.
+    Renderer* recordDisplay();
+
     typedef std::forward_list<Button*> ButtonListeners;
     ButtonListeners _buttonListeners;
 
+    /// This must outlive the DisplayObjects deleted by _gc.
+    BitmapCacheList _bitmapCaches;
+
     GC _gc;
 
+    FrameProfiler _profiler;
+
+    /// The drawing calls of the frame being displayed.
+    RenderCommands _displayCommands;
+
+    /// The drawing calls of the last frame displayed.
+    RenderCommands _lastDisplayCommands;
+
+    /// The number of frames displayed.
+    size_t _displayFrame;
+
+    /// Whether unchanged subtrees are recorded from their last commands.
+    const bool _retainCommands;
+
+    /// Copies of the shapes in frames from recordFrame().
+    ShapeCopies _shapeCopies;
+
     const RunResources& _runResources; 
 
     /// This initializes a SharedObjectLibrary, which requires 
@@ -0,0 +1,149 @@
+// BitmapLibrary.cpp: the bitmaps defined by a movie, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "BitmapLibrary.h"
+
+#include <utility>
+
+#include "RunResources.h"
+#include "Renderer.h"
+#include "GnashImage.h"
+#include "log.h"
+
+namespace gnash {
+
+BitmapLibrary::BitmapLibrary(const RunResources& r, size_t limit)
+    :
+    _runResources(r),
+    _limit(limit),
+    _bytes(0),
+    _expiries(0)
+{
+}
+
+BitmapLibrary::~BitmapLibrary()
+{
+}
+
+bool
+BitmapLibrary::add(int id, boost::intrusive_ptr<CachedBitmap> bitmap)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Entry& e = _entries[id];
+    if (e.bitmap || e.decoder) return false;
+    e.bitmap = bitmap;
+    return true;
+}
+
+bool
+BitmapLibrary::add(int id, Decoder decoder)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Entry& e = _entries[id];
+    if (e.bitmap || e.decoder) return false;
+    e.decoder = std::move(decoder);
+    return true;
+}
+
+CachedBitmap*
+BitmapLibrary::get(int id)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::map<int, Entry>::iterator it = _entries.find(id);
+    if (it == _entries.end()) return nullptr;
+
+    Entry& e = it->second;
+    e.expiries = _expiries;
+    if (!e.decoder) return e.bitmap.get();
+
+    if (e.bytes) {
+        _used.splice(_used.end(), _used, e.used);
+        return e.bitmap.get();
+    }
+
+    if (e.failed) return nullptr;
+
+    Renderer* renderer = _runResources.renderer();
+    if (!renderer) return nullptr;
+
+    std::unique_ptr<image::GnashImage> im = e.decoder();
+    if (!im) {
+        e.failed = true;
+        return nullptr;
+    }
+
+    // The renderer may keep the image elsewhere, so it is measured here.
+    const size_t bytes = im->size();
+
+    e.bitmap = renderer->createCachedBitmap(std::move(im));
+    if (!e.bitmap) {
+        e.failed = true;
+        return nullptr;
+    }
+
+    e.bytes = bytes;
+    e.used = _used.insert(_used.end(), id);
+    _bytes += e.bytes;
+
+    IF_VERBOSE_PARSE(
+        log_parse(_("Decoded bitmap %d (%d bytes)"), id, bytes);
+    );
+
+    return e.bitmap.get();
+}
+
+void
+BitmapLibrary::expire()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::list<int>::iterator it = _used.begin();
+    while (_bytes > _limit && it != _used.end()) {
+
+        Entry& e = _entries[*it];
+
+        // The rest were used in the last frame.
+        if (e.expiries == _expiries) break;
+
+        // Something still draws or copies it.
+        if (e.bitmap->get_ref_count() > 1) {
+            ++it;
+            continue;
+        }
+
+        _bytes -= e.bytes;
+        e.bytes = 0;
+        e.bitmap.reset();
+        it = _used.erase(it);
+    }
+
+    ++_expiries;
+}
+
+size_t
+BitmapLibrary::decodedBytes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _bytes;
+}
+
+} // namespace gnash
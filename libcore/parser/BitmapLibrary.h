@@ -0,0 +1,144 @@
+// BitmapLibrary.h: the bitmaps defined by a movie, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_BITMAPLIBRARY_H
+#define GNASH_BITMAPLIBRARY_H
+
+#include <map>
+#include <list>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <cstddef>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "CachedBitmap.h"
+#include "dsodefs.h"
+
+namespace gnash {
+    class RunResources;
+    namespace image {
+        class GnashImage;
+    }
+}
+
+namespace gnash {
+
+/// The bitmaps defined by a movie.
+//
+/// Bitmaps may be kept as they are in the SWF and only decoded when
+/// first used. The decoded images take at most the limit the library is
+/// made with, not counting those used since the last call to expire().
+/// The least recently used of the others are dropped, and decoded again
+/// if they are needed later.
+class DSOEXPORT BitmapLibrary : boost::noncopyable
+{
+public:
+
+    /// Decodes a bitmap, returning 0 if it can't.
+    typedef std::function<std::unique_ptr<image::GnashImage>()> Decoder;
+
+    /// @param r        The resources giving the renderer bitmaps are for.
+    /// @param limit    The memory in bytes decoded images may take.
+    BitmapLibrary(const RunResources& r, size_t limit);
+
+    ~BitmapLibrary();
+
+    /// Add a bitmap that is already decoded.
+    //
+    /// @return     false if there already is a bitmap with the id.
+    bool add(int id, boost::intrusive_ptr<CachedBitmap> bitmap);
+
+    /// Add a bitmap to decode when it is first used.
+    //
+    /// @return     false if there already is a bitmap with the id.
+    bool add(int id, Decoder decoder);
+
+    /// Get a bitmap, decoding it if needed.
+    //
+    /// @return     0 if there is no bitmap with the id or it can't be
+    ///             decoded.
+    CachedBitmap* get(int id);
+
+    /// Drop the least recently used images over the size limit.
+    //
+    /// Images returned by get() may be deleted, so this must only be
+    /// called when no bitmaps are being drawn. Images held elsewhere,
+    /// or used since the last call, are kept.
+    void expire();
+
+    /// The number of times expire() has been called.
+    //
+    /// This can be read while other threads use the library. Bitmaps
+    /// returned by get() are only dropped when it changes.
+    size_t revision() const {
+        return _expiries;
+    }
+
+    /// The memory taken by decoded images that can be dropped.
+    size_t decodedBytes() const;
+
+private:
+
+    struct Entry
+    {
+        Entry() : bytes(0), failed(false), expiries(0) {}
+
+        /// Empty for bitmaps that were added decoded.
+        Decoder decoder;
+
+        boost::intrusive_ptr<CachedBitmap> bitmap;
+
+        /// The size of the decoded image, 0 when it isn't decoded.
+        size_t bytes;
+
+        /// Whether decoding failed, so it isn't tried again.
+        bool failed;
+
+        /// The value of _expiries when the bitmap was last used.
+        size_t expiries;
+
+        /// Where the bitmap is in _used, while it is decoded.
+        std::list<int>::iterator used;
+    };
+
+    const RunResources& _runResources;
+
+    const size_t _limit;
+
+    std::map<int, Entry> _entries;
+
+    /// The ids of the decoded bitmaps that can be dropped, the least
+    /// recently used first.
+    std::list<int> _used;
+
+    /// The memory taken by the images in _used.
+    size_t _bytes;
+
+    /// The number of times expire() has been called.
+    std::atomic<size_t> _expiries;
+
+    mutable std::mutex _mutex;
+};
+
+} // namespace gnash
+
+#endif
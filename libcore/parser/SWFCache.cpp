@@ -0,0 +1,301 @@
+// SWFCache.cpp: inflated SWF files kept on disk, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "SWFCache.h"
+
+#include <algorithm>
+#include <utility>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <ctime>
+#include <utime.h>
+#include <boost/format.hpp>
+
+#include "GnashFileUtilities.h"
+#include "IOChannel.h"
+#include "tu_file.h"
+#include "zlib_adapter.h"
+#include "log.h"
+#include "rc.h"
+
+namespace gnash {
+
+namespace {
+
+/// The size of the header of a SWF file, which isn't compressed.
+const size_t headerSize = 8;
+
+/// Whether a copy looks like an inflated SWF file of this version.
+bool
+validCopy(const std::uint8_t* copy, size_t size, std::uint8_t version)
+{
+    if (size < headerSize) return false;
+    if (copy[0] != 'F' || copy[1] != 'W' || copy[2] != 'S') return false;
+    if (copy[3] != version) return false;
+
+    // Stored copies have their real size here, so a truncated one is
+    // noticed.
+    const std::uint32_t length = copy[4] | (copy[5] << 8) |
+        (copy[6] << 16) | (static_cast<std::uint32_t>(copy[7]) << 24);
+    return length == size;
+}
+
+/// A 64-bit FNV-1a hash of the data.
+std::uint64_t
+hash(const std::uint8_t* data, size_t size)
+{
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (const std::uint8_t* end = data + size; data != end; ++data) {
+        h = (h ^ *data) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+bool
+endsWith(const std::string& s, const std::string& end)
+{
+    return s.size() >= end.size() &&
+        s.compare(s.size() - end.size(), end.size(), end) == 0;
+}
+
+/// Whether a file name is one SWFCache::path() makes.
+//
+/// Other files in the directory are left alone.
+bool
+copyName(const std::string& name)
+{
+    const size_t dash = 16;
+    if (name.size() < dash + 6 || name[dash] != '-') return false;
+    if (!endsWith(name, ".swf")) return false;
+    for (size_t i = 0; i < dash; ++i) {
+        if (!std::isxdigit(static_cast<unsigned char>(name[i]))) return false;
+    }
+    const size_t end = name.size() - 4;
+    for (size_t i = dash + 1; i < end; ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(name[i]))) return false;
+    }
+    return true;
+}
+
+/// Whether a file name is one store() writes a copy to before renaming.
+bool
+tmpName(const std::string& name)
+{
+    if (!endsWith(name, ".tmp")) return false;
+    const std::string::size_type dot = name.rfind('.', name.size() - 5);
+    return dot != std::string::npos && copyName(name.substr(0, dot));
+}
+
+/// Files left by a store() that didn't finish are removed after this
+/// many seconds, which is far longer than writing any copy takes.
+const time_t tmpAge = 3600;
+
+} // anonymous namespace
+
+SWFCache::SWFCache()
+    :
+    _dir(RcInitFile::getDefaultInstance().getSWFCacheDir()),
+    _limit(RcInitFile::getDefaultInstance().getSWFCacheSize() *
+            static_cast<size_t>(1024 * 1024))
+{
+}
+
+SWFCache::SWFCache(std::string dir, size_t limit)
+    :
+    _dir(std::move(dir)),
+    _limit(limit)
+{
+}
+
+std::string
+SWFCache::path(const std::uint8_t* swf, size_t size) const
+{
+    std::ostringstream s;
+    s << _dir << '/' << std::hex << std::setfill('0') << std::setw(16)
+        << hash(swf, size) << '-' << std::dec << size << ".swf";
+    return s.str();
+}
+
+std::unique_ptr<IOChannel>
+SWFCache::find(const std::uint8_t* swf, size_t size) const
+{
+    if (!enabled() || size < headerSize) return nullptr;
+
+    const std::string file = path(swf, size);
+
+    FILE* fp = std::fopen(file.c_str(), "rb");
+    if (!fp) return nullptr;
+
+    std::unique_ptr<IOChannel> copy = makeFileChannel(fp, true);
+    const std::uint8_t* data = copy->map();
+    if (!data || !validCopy(data, copy->size(), swf[3])) {
+        log_debug("Removing bad SWF cache file %s", file);
+        copy.reset();
+        std::remove(file.c_str());
+        return nullptr;
+    }
+
+    // Its time is when it was last played, for trim().
+    utime(file.c_str(), nullptr);
+
+    IF_VERBOSE_PARSE(
+        log_parse(_("Reading inflated SWF from cache file %s"), file);
+    );
+    return copy;
+}
+
+bool
+SWFCache::store(const std::uint8_t* swf, size_t size,
+        const std::vector<std::uint8_t>& inflated) const
+{
+    if (!enabled() || size < headerSize) return false;
+    if (inflated.size() < headerSize || inflated.size() > 0xffffffffU) {
+        return false;
+    }
+    if (_limit && inflated.size() > _limit) return false;
+
+    const std::string file = path(swf, size);
+    if (!mkdirRecursive(file)) {
+        log_error(_("Could not create SWF cache directory %s"), _dir);
+        return false;
+    }
+
+    // Mark the copy uncompressed, with its real size.
+    std::uint8_t header[headerSize];
+    std::copy(inflated.begin(), inflated.begin() + headerSize, header);
+    header[0] = 'F';
+    const std::uint32_t length = inflated.size();
+    for (size_t i = 0; i < 4; ++i) header[4 + i] = length >> (8 * i);
+
+    // Write to another file first, so that a player never finds a
+    // partly written copy.
+    const std::string tmp = (boost::format("%s.%d.tmp") % file %
+            getpid()).str();
+    {
+        std::ofstream out(tmp.c_str(), std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(header), headerSize);
+        out.write(reinterpret_cast<const char*>(inflated.data() + headerSize),
+                inflated.size() - headerSize);
+        if (!out) {
+            log_error(_("Could not write SWF cache file %s"), tmp);
+            out.close();
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(tmp.c_str(), file.c_str())) {
+        log_error(_("Could not rename SWF cache file %s: %s"), tmp,
+                std::strerror(errno));
+        std::remove(tmp.c_str());
+        return false;
+    }
+
+    IF_VERBOSE_PARSE(
+        log_parse(_("Kept inflated SWF in cache file %s"), file);
+    );
+
+    trim();
+    return true;
+}
+
+void
+SWFCache::trim() const
+{
+    if (!enabled()) return;
+
+    DIR* dir = opendir(_dir.c_str());
+    if (!dir) return;
+
+    struct CacheFile
+    {
+        time_t time;
+        size_t size;
+        std::string path;
+    };
+
+    std::vector<CacheFile> files;
+    size_t total = 0;
+    const time_t now = std::time(nullptr);
+
+    while (const struct dirent* entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        const bool tmp = tmpName(name);
+        if (!tmp && !copyName(name)) continue;
+
+        const std::string file = _dir + '/' + name;
+        struct stat st;
+        if (stat(file.c_str(), &st) || !S_ISREG(st.st_mode)) continue;
+
+        if (tmp) {
+            if (now - st.st_mtime > tmpAge && !std::remove(file.c_str())) {
+                log_debug("Removed stale SWF cache file %s", file);
+            }
+            continue;
+        }
+
+        files.push_back(CacheFile{st.st_mtime, static_cast<size_t>(
+                    st.st_size), file});
+        total += st.st_size;
+    }
+    closedir(dir);
+
+    if (!_limit || total <= _limit) return;
+
+    std::sort(files.begin(), files.end(),
+            [](const CacheFile& a, const CacheFile& b) {
+                return a.time < b.time;
+            });
+
+    for (const CacheFile& f : files) {
+        if (total <= _limit) break;
+        if (std::remove(f.path.c_str())) continue;
+        log_debug("Removed SWF cache file %s", f.path);
+        total -= f.size;
+    }
+}
+
+bool
+SWFCache::inflate(const std::uint8_t* swf, size_t size,
+        std::vector<std::uint8_t>& out)
+{
+    if (size < headerSize) return false;
+
+    // The advertised length is only trusted so far for the first
+    // allocation.
+    const std::uint32_t length = swf[4] | (swf[5] << 8) | (swf[6] << 16) |
+        (static_cast<std::uint32_t>(swf[7]) << 24);
+    const size_t maxGuess = 1 << 26;
+    out.clear();
+    out.reserve(std::min<size_t>(std::max<size_t>(length, headerSize),
+                maxGuess));
+    out.assign(swf, swf + headerSize);
+
+    return zlib_adapter::inflate_all(swf + headerSize, size - headerSize, out);
+}
+
+} // namespace gnash
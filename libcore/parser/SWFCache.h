@@ -0,0 +1,117 @@
+// SWFCache.h: inflated SWF files kept on disk, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_SWFCACHE_H
+#define GNASH_SWFCACHE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+#include "dsodefs.h" // for DSOEXPORT
+
+// Forward declarations
+namespace gnash {
+    class IOChannel;
+}
+
+namespace gnash {
+
+/// Inflated copies of compressed SWF files, kept on disk between runs.
+//
+/// Each copy is an uncompressed SWF file named after a hash of the
+/// compressed file and its size, so a changed movie never finds the
+/// copy of the old one. Copies that aren't played any more are removed,
+/// the least recently played first, when the cache is over its limit.
+///
+/// Only the inflated stream is kept. An index of tag offsets would only
+/// save reading tag headers, which takes microseconds for a whole movie,
+/// as every definition is still parsed when the movie loads.
+class DSOEXPORT SWFCache
+{
+public:
+
+    /// A cache with the swfCacheDir and swfCacheSize set in gnashrc.
+    SWFCache();
+
+    /// @param dir      The directory holding the copies, empty to
+    ///                 disable the cache.
+    /// @param limit    The most bytes the copies take, 0 for no limit.
+    SWFCache(std::string dir, size_t limit);
+
+    /// Whether there is a directory to keep copies in.
+    bool enabled() const {
+        return !_dir.empty();
+    }
+
+    /// Find the inflated copy of a compressed SWF file.
+    //
+    /// @param swf      The whole compressed file.
+    /// @param size     The size of the compressed file.
+    /// @return         The copy, which can be mapped, or 0 if there is
+    ///                 none.
+    std::unique_ptr<IOChannel> find(const std::uint8_t* swf,
+            size_t size) const;
+
+    /// Keep the inflated copy of a compressed SWF file.
+    //
+    /// Least recently played copies are removed to stay within the limit.
+    ///
+    /// @param swf      The whole compressed file.
+    /// @param size     The size of the compressed file.
+    /// @param inflated The inflated file, as made by inflate().
+    /// @return         false if the copy couldn't be written.
+    bool store(const std::uint8_t* swf, size_t size,
+            const std::vector<std::uint8_t>& inflated) const;
+
+    /// Remove the least recently played copies over the limit.
+    //
+    /// Only copies and the files they are written to first are counted
+    /// and removed; the latter once they are an hour old, as they are
+    /// left by a player that stopped while writing.
+    void trim() const;
+
+    /// Inflate a whole compressed SWF file.
+    //
+    /// The header is copied uncompressed, so that positions are the
+    /// same as in an uncompressed file.
+    ///
+    /// @param swf      The whole compressed file.
+    /// @param size     The size of the compressed file.
+    /// @param out      Receives the inflated file.
+    /// @return         false if the file is corrupt or truncated, in which
+    ///                 case out holds as much as could be inflated.
+    static bool inflate(const std::uint8_t* swf, size_t size,
+            std::vector<std::uint8_t>& out);
+
+private:
+
+    /// The file the copy of a compressed SWF file is kept in.
+    std::string path(const std::uint8_t* swf, size_t size) const;
+
+    std::string _dir;
+
+    size_t _limit;
+};
+
+} // namespace gnash
+
+#endif
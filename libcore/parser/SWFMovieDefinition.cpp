@@ -42,12 +42,14 @@
 #include "Font.h"
 #include "VM.h"
 #include "log.h"
+#include "rc.h"
 #include "SWFMovie.h"
 #include "GnashException.h" // for parser exception
 #include "ControlTag.h"
 #include "sound_definition.h" // for sound_sample
 #include "GnashAlgorithm.h"
 #include "SWFParser.h"
+#include "SWFCache.h"
 #include "Global_as.h"
 #include "namedStrings.h"
 #include "as_function.h"
@@ -130,6 +132,8 @@ SWFMovieLoader::start()
 
 SWFMovieDefinition::SWFMovieDefinition(const RunResources& runResources)
     :
+    _bitmaps(runResources, RcInitFile::getDefaultInstance()
+            .getBitmapLibrarySize() * 1024 * 1024),
     m_frame_rate(30.0f),
     m_frame_count(0u),
     m_version(0),
@@ -206,16 +210,36 @@ SWFMovieDefinition::get_font(const std::string& name, bool bold, bool italic)
 CachedBitmap*
 SWFMovieDefinition::getBitmap(int id) const
 {
-    const Bitmaps::const_iterator it = _bitmaps.find(id);
-    if (it == _bitmaps.end()) return nullptr;
-    return it->second.get();
+    return _bitmaps.get(id);
 }
 
 void
 SWFMovieDefinition::addBitmap(int id, boost::intrusive_ptr<CachedBitmap> im)
 {
     assert(im);
-    _bitmaps.insert(std::make_pair(id, im));
+    if (!_bitmaps.add(id, im)) {
+        IF_VERBOSE_MALFORMED_SWF(
+            log_swferror(_("DEFINEBITS: Duplicate id (%d) for bitmap "
+                    "DisplayObject - discarding it"), id);
+        );
+    }
+}
+
+void
+SWFMovieDefinition::addBitmap(int id, BitmapDecoder decoder)
+{
+    if (!_bitmaps.add(id, std::move(decoder))) {
+        IF_VERBOSE_MALFORMED_SWF(
+            log_swferror(_("DEFINEBITS: Duplicate id (%d) for bitmap "
+                    "DisplayObject - discarding it"), id);
+        );
+    }
+}
+
+void
+SWFMovieDefinition::expireBitmaps() const
+{
+    _bitmaps.expire();
 }
 
 sound_sample*
@@ -273,6 +297,10 @@ SWFMovieDefinition::readHeader(std::unique_ptr<IOChannel> in,
         log_parse(_("version: %d, file_length: %d"), m_version, m_file_length);
     );
 
+    // A local file is read straight from memory, which saves a virtual
+    // call for every byte the parser reads.
+    const std::uint8_t* mapped = _in->map();
+
     if (compressed) {
 #ifndef HAVE_ZLIB_H
         log_error(_("SWFMovieDefinition::read(): unable to read "
@@ -283,14 +311,47 @@ SWFMovieDefinition::readHeader(std::unique_ptr<IOChannel> in,
             log_parse(_("file is compressed"));
         );
 
-        // Uncompress the input as we read it.
-        _in = zlib_adapter::make_inflater(std::move(_in));
+        if (mapped) {
+            const size_t start = _in->tell();
+            const SWFCache cache;
+
+            // A copy inflated on an earlier run is read instead.
+            std::unique_ptr<IOChannel> copy = cache.find(mapped, _in->size());
+            if (copy) {
+                _in = std::move(copy);
+                _str.reset(new SWFStream(_in->map(), _in->size(), start));
+            }
+            else {
+                // Inflate it all at once, so that positions are the
+                // same as in an uncompressed file.
+                if (SWFCache::inflate(mapped, _in->size(), _buffer)) {
+                    cache.store(mapped, _in->size(), _buffer);
+                }
+                else {
+                    IF_VERBOSE_MALFORMED_SWF(
+                        log_swferror(_("Compressed SWF data is corrupt or "
+                                "truncated"));
+                    );
+                }
+                _in.reset();
+                _str.reset(new SWFStream(_buffer.data(), _buffer.size(),
+                            start));
+            }
+        }
+        else {
+            // Uncompress the input as we read it.
+            _in = zlib_adapter::make_inflater(std::move(_in));
+        }
 #endif
     }
+    else if (mapped) {
+        _str.reset(new SWFStream(mapped, _in->size(), _in->tell()));
+    }
 
-    assert(_in.get());
-
-    _str.reset(new SWFStream(_in.get()));
+    if (!_str.get()) {
+        assert(_in.get());
+        _str.reset(new SWFStream(_in.get()));
+    }
 
     m_frame_size = readRect(*_str);
 
@@ -446,6 +507,10 @@ SWFMovieDefinition::read_all_swf()
 
     SWFParser parser(*_str, this, _runResources);
 
+    const unsigned int decodeThreads =
+        RcInitFile::getDefaultInstance().getDecodeThreads();
+    if (decodeThreads) parser.decodeInParallel(decodeThreads);
+
     const size_t startPos = _str->tell();
     assert (startPos <= _swf_end_pos);
 
@@ -480,6 +545,9 @@ SWFMovieDefinition::read_all_swf()
         log_error(_("Error while parsing SWF stream."));
     }
 
+    // Keep what was defined before the end or an error.
+    parser.finish();
+
     // Set bytesLoaded to the current stream position unless it's greater
     // than the reported length. TODO: should we be trying to continue
     // parsing after an exception?
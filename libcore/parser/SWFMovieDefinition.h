@@ -40,6 +40,7 @@
 #include <condition_variable>
 
 #include "movie_definition.h" // for inheritance
+#include "BitmapLibrary.h"
 #include "StringPredicates.h" 
 #include "SWFRect.h"
 #include "GnashNumeric.h"
@@ -248,9 +249,23 @@ public:
     // See dox in movie_definition.h
     DSOTEXPORT CachedBitmap* getBitmap(int DisplayObject_id) const;
 
+    // See dox in movie_definition.h
+    size_t bitmapRevision() const {
+        return _bitmaps.revision();
+    }
+
     // See dox in movie_definition.h
     void addBitmap(int DisplayObject_id, boost::intrusive_ptr<CachedBitmap> im);
 
+    // See dox in movie_definition.h
+    void addBitmap(int DisplayObject_id, BitmapDecoder decoder);
+
+    /// Drop decoded bitmaps not used lately, if they take too much memory.
+    //
+    /// This must only be called when no bitmaps of the movie are being
+    /// drawn.
+    void expireBitmaps() const;
+
     // See dox in movie_definition.h
     sound_sample* get_sound_sample(int DisplayObject_id) const;
 
@@ -401,8 +416,8 @@ private:
     typedef std::map<int, boost::intrusive_ptr<Font> > FontMap;
     FontMap m_fonts;
 
-    typedef std::map<int, boost::intrusive_ptr<CachedBitmap> > Bitmaps;
-    Bitmaps _bitmaps;
+    /// Bitmaps, decoded when first used. Expired by SWFMovie::advance.
+    mutable BitmapLibrary _bitmaps;
 
     typedef std::map<int, boost::intrusive_ptr<sound_sample> > SoundSampleMap;
     SoundSampleMap m_sound_samples;
@@ -464,6 +479,11 @@ private:
 
     std::unique_ptr<IOChannel> _in;
 
+    /// A compressed movie from a local file, inflated at once.
+    //
+    /// _str reads from this when it isn't empty.
+    std::vector<std::uint8_t> _buffer;
+
     /// swf end position (as read from header)
     // This is set by readHeader, and used in the parsing thread, which starts
     // after readHeader() runs.
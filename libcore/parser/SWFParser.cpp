@@ -24,17 +24,119 @@
 #include "log.h"
 
 #include <iomanip>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <boost/noncopyable.hpp>
 
 namespace gnash {
 
 // Forward declarations
 namespace {
     void dumpTagBytes(SWFStream& in, std::ostream& os);
+    bool independent(SWF::TagType tag);
+}
+
+/// Threads running jobs in the order they are added.
+class SWFParser::DecodingPool : boost::noncopyable
+{
+public:
+
+    explicit DecodingPool(size_t threads)
+        :
+        _stop(false)
+    {
+        for (size_t i = 0; i < threads; ++i) {
+            _threads.push_back(std::thread(&DecodingPool::work, this));
+        }
+    }
+
+    /// Wait for the jobs that have started, and drop the others.
+    ~DecodingPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+            _jobs.clear();
+        }
+        _wakeup.notify_all();
+        for (std::thread& t : _threads) t.join();
+    }
+
+    void add(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _jobs.push_back(std::move(job));
+        }
+        _wakeup.notify_one();
+    }
+
+private:
+
+    void work() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wakeup.wait(lock, [this] { return _stop || !_jobs.empty(); });
+                if (_stop) return;
+                job = std::move(_jobs.front());
+                _jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    std::vector<std::thread> _threads;
+
+    std::mutex _mutex;
+
+    /// Signalled when there is a job, or the threads should stop.
+    std::condition_variable _wakeup;
+
+    std::deque<std::function<void()> > _jobs;
+
+    bool _stop;
+};
+
+SWFParser::SWFParser(SWFStream& in, movie_definition* md,
+        const RunResources& runResources)
+    :
+    _stream(in),
+    _md(md),
+    _runResources(runResources),
+    _bytesRead(0),
+    _tagOpen(false),
+    _endRead(0),
+    _nextTagEnd(0),
+    _tagStart(0),
+    _tag(SWF::END), // Initialized to zero to have a well known value
+    _maxDecoding(0)
+{
+}
+
+SWFParser::~SWFParser()
+{
+}
+
+void
+SWFParser::decodeInParallel(size_t threads)
+{
+    assert(!_pool.get());
+    assert(threads);
+    _pool.reset(new DecodingPool(threads));
+
+    // Enough to keep the threads busy without holding on to too many
+    // decoded tags when the movie only uses them much later.
+    _maxDecoding = threads * 4;
 }
 
 size_t
 SWFParser::openTag()
 {
+    _tagStart = _stream.tell();
     _tag = _stream.open_tag();
     _tagOpen = true;
     return _stream.get_tag_end_position();
@@ -80,17 +182,28 @@ SWFParser::read(std::streamsize bytes)
             // a SWF::END tag is encountered.
             if (_tag == SWF::END) {
                 closeTag();
+                define(true);
                 return false;
             }
 
             SWF::TagLoadersTable::TagLoader lf = nullptr;
+            SWF::TagLoadersTable::TagDecoder df = nullptr;
 
             if (_tag == SWF::SHOWFRAME) {
                 // show frame tag -- advance to the next frame.
                 IF_VERBOSE_PARSE(log_parse(_("SHOWFRAME tag")));
+
+                // The frame can't be played before its definitions are in.
+                define(true);
                 _md->incrementLoadedFrames();
             }
+            else if (_pool.get() && tagLoaders.getDecoder(_tag, df)) {
+                dispatch(df);
+            }
             else if (tagLoaders.get(_tag, lf)) {
+                // Other tags may look up definitions as they are read.
+                if (!independent(_tag)) define(true);
+
                 // call the tag loader.  The tag loader should add
                 // DisplayObjects or tags to the movie data structure.
                 lf(_stream, _tag, *_md, _runResources);
@@ -117,12 +230,92 @@ SWFParser::read(std::streamsize bytes)
         _bytesRead += (_stream.tell() - startPos);
     }
 
+    define(false);
     return true;
 
 }
 
+void
+SWFParser::dispatch(SWF::TagLoadersTable::TagDecoder decoder)
+{
+    // Don't read too far ahead of the decoding threads.
+    if (_decoding.size() >= _maxDecoding) defineFirst();
+
+    // Copy the whole tag, so that it can be read as it is in the SWF.
+    const size_t size = _stream.get_tag_end_position() - _tagStart;
+    std::shared_ptr<std::vector<std::uint8_t> > data(
+            new std::vector<std::uint8_t>(size));
+
+    _stream.seek(_tagStart);
+    if (_stream.read(reinterpret_cast<char*>(data->data()), size) < size) {
+        throw ParserException(_("Unexpected end of stream while reading"));
+    }
+
+    movie_definition& md = *_md;
+    const RunResources& r = _runResources;
+
+    std::shared_ptr<std::packaged_task<DecodedTag()> > task(
+        new std::packaged_task<DecodedTag()>([data, decoder, &md, &r] {
+            SWFStream in(data->data(), data->size(), 0);
+            const SWF::TagType tag = in.open_tag();
+            return decoder(in, tag, md, r);
+        }));
+
+    _decoding.push_back(task->get_future());
+    _pool->add([task] { (*task)(); });
+}
+
+void
+SWFParser::defineFirst()
+{
+    assert(!_decoding.empty());
+
+    std::future<DecodedTag> decoding = std::move(_decoding.front());
+    _decoding.pop_front();
+
+    try {
+        decoding.get()(*_md);
+    }
+    catch (const ParserException& e) {
+        log_error(_("Parsing exception: %s"), e.what());
+    }
+}
+
+void
+SWFParser::define(bool wait)
+{
+    while (!_decoding.empty()) {
+        if (!wait && _decoding.front().wait_for(std::chrono::seconds(0)) !=
+                std::future_status::ready) {
+            return;
+        }
+        defineFirst();
+    }
+}
+
 namespace {
 
+/// Whether a tag can be read before earlier definitions are added.
+//
+/// These neither define anything nor look up definitions when read.
+bool
+independent(SWF::TagType tag)
+{
+    switch (tag) {
+        case SWF::PLACEOBJECT:
+        case SWF::PLACEOBJECT2:
+        case SWF::PLACEOBJECT3:
+        case SWF::REMOVEOBJECT:
+        case SWF::REMOVEOBJECT2:
+        case SWF::DOACTION:
+        case SWF::FRAMELABEL:
+        case SWF::SETBACKGROUNDCOLOR:
+            return true;
+        default:
+            return false;
+    }
+}
+
 /// Log the contents of the current tag, in hex to the output strream
 void 
 dumpTagBytes(SWFStream& in, std::ostream& os)
@@ -24,6 +24,11 @@
 #define GNASH_SWFPARSER_H
 
 #include "SWF.h"
+#include "TagLoadersTable.h"
+
+#include <deque>
+#include <future>
+#include <memory>
 
 namespace gnash {
     class SWFStream;
@@ -51,19 +56,10 @@ class SWFParser
 {
 
 public:
-    SWFParser(SWFStream& in, movie_definition* md, const RunResources& runResources)
-        :
-        _stream(in),
-        _md(md),
-        _runResources(runResources),
-        _bytesRead(0),
-        _tagOpen(false),
-        _endRead(0),
-        _nextTagEnd(0),
-        _tag(SWF::END) // Initialized to zero to have a well known value
-
-    {
-    }
+    SWFParser(SWFStream& in, movie_definition* md,
+            const RunResources& runResources);
+
+    ~SWFParser();
 
     /// The number of bytes processed by this SWFParser.
     size_t bytesRead() const {
@@ -84,13 +80,46 @@ public:
     ///                 This can be mean that a SWF::END tag appears before
     ///                 the end of the bytes to parse.
     bool read(std::streamsize bytes);
+
+    /// Decode definitions in other threads.
+    //
+    /// Tags with a TagDecoder are then read by a pool of threads while
+    /// the parser goes on with the next tags. What they define is added
+    /// to the movie in the order of the SWF, before any tag that might
+    /// use it and before the frame they are in counts as loaded.
+    //
+    /// @param threads  The number of threads to decode with.
+    void decodeInParallel(size_t threads);
+
+    /// Add any definitions still being decoded to the movie.
+    //
+    /// Call this once there is nothing more to read.
+    void finish() {
+        define(true);
+    }
     
 private:
 
+    class DecodingPool;
+
+    typedef SWF::TagLoadersTable::DecodedTag DecodedTag;
+
     size_t openTag();
 
     void closeTag();
 
+    /// Have the open tag decoded by the pool.
+    void dispatch(SWF::TagLoadersTable::TagDecoder decoder);
+
+    /// Add the first decoded tag to the movie, waiting for it if needed.
+    void defineFirst();
+
+    /// Add decoded tags to the movie in order.
+    //
+    /// @param wait     Whether to wait for all of them, or only add the
+    ///                 ones that are ready.
+    void define(bool wait);
+
     SWFStream& _stream;
     
     movie_definition* _md;
@@ -104,9 +133,21 @@ private:
     size_t _endRead;
     
     size_t _nextTagEnd;
+
+    /// The position of the open tag's header.
+    size_t _tagStart;
     
     SWF::TagType _tag;
 
+    /// The threads decoding tags, if there are any.
+    std::unique_ptr<DecodingPool> _pool;
+
+    /// The tags being decoded, in the order of the SWF.
+    std::deque<std::future<DecodedTag> > _decoding;
+
+    /// The most tags to decode ahead of those added to the movie.
+    size_t _maxDecoding;
+
 };
 
 } // namespace gnash
@@ -27,6 +27,7 @@
 #include "SWFStream.h"
 #include "SWF.h"
 #include "ASHandlers.h"
+#include "DecodedActions.h"
 #include "movie_definition.h"
 
 namespace gnash {
@@ -44,6 +45,10 @@ action_buffer::action_buffer(const movie_definition& md)
 {
 }
 
+action_buffer::~action_buffer()
+{
+}
+
 void
 action_buffer::read(SWFStream& in, unsigned long endPos)
 {
@@ -145,6 +150,13 @@ action_buffer::readConstantPool(size_t start_pc, size_t stop_pc) const
 }
 
 
+const DecodedActions&
+action_buffer::decoded() const
+{
+    if (!_decoded) _decoded.reset(new DecodedActions(*this));
+    return *_decoded;
+}
+
 // Disassemble one instruction to the log. The maxBufferLength
 // argument is the number of bytes remaining in the action_buffer
 // and prevents malformed instructions causing a read past the
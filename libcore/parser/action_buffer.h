@@ -22,11 +22,14 @@
 #include <string>
 #include <vector> 
 #include <map> 
+#include <memory>
+#include <unordered_map>
 #include <boost/noncopyable.hpp>
 #include <cstdint>
 
 #include "GnashException.h"
 #include "ConstantPool.h"
+#include "MemberCache.h"
 #include "log.h"
 
 // Forward declarations
@@ -34,6 +37,7 @@ namespace gnash {
 	class as_value;
 	class movie_definition;
 	class SWFStream; // for read signature
+	class DecodedActions;
 }
 
 namespace gnash {
@@ -52,6 +56,8 @@ public:
 
 	action_buffer(const movie_definition& md);
 
+	~action_buffer();
+
 	/// Read action bytes from input stream up to but not including endPos
 	//
 	/// @param endPos
@@ -176,6 +182,21 @@ public:
 	///
 	const ConstantPool& readConstantPool(size_t start_pc, size_t stop_pc) const;
 
+	/// Return the pre-decoded form of this action buffer
+	//
+	/// Decoding is done on first call, and the result is cached
+	/// for the lifetime of the buffer. See DecodedActions.
+	///
+	const DecodedActions& decoded() const;
+
+	/// Return the inline member cache of the action at the given offset
+	//
+	/// Caches are created on first use. See MemberCache.
+	///
+	MemberCache& memberCache(size_t pc) const {
+		return _memberCaches[pc];
+	}
+
     /// Return url of the SWF this action block was found in
 	const std::string& getDefinitionURL() const;
 
@@ -195,6 +216,13 @@ private:
 	typedef std::map<size_t, ConstantPool> PoolsMap;
 	mutable PoolsMap _pools;
 
+	/// The pre-decoded actions, built on demand by decoded()
+	mutable std::unique_ptr<DecodedActions> _decoded;
+
+	/// The member caches of ActionGetMember and ActionSetMember actions
+	typedef std::unordered_map<size_t, MemberCache> MemberCaches;
+	mutable MemberCaches _memberCaches;
+
 	/// The movie_definition containing this action buffer
 	//
 	/// This pointer will be used to determine domain-based
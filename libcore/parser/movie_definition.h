@@ -55,6 +55,7 @@
 #include <string>
 #include <memory> // for unique_ptr
 #include <vector> // for PlayList typedef
+#include <functional>
 #include <boost/intrusive_ptr.hpp>
 #include <cstdint>
 
@@ -73,6 +74,7 @@ namespace gnash {
     class sound_sample;
     namespace image {
         class JpegInput;
+        class GnashImage;
     }
 }
 
@@ -331,6 +333,18 @@ public:
 		return nullptr;
 	}
 
+	/// The number of times bitmaps may have been dropped.
+	//
+	/// A bitmap returned by getBitmap() stays valid, and is returned
+	/// again for its id, as long as this doesn't change.
+	///
+	/// The default implementation returns 0.
+	///
+	virtual size_t bitmapRevision() const
+	{
+		return 0;
+	}
+
 	/// \brief
 	/// Add a bitmap DisplayObject in the dictionary, with the specified
 	/// DisplayObject id.
@@ -341,6 +355,20 @@ public:
 	{
 	}
 
+	/// Decodes a bitmap, returning 0 if it can't.
+	typedef std::function<std::unique_ptr<image::GnashImage>()>
+		BitmapDecoder;
+
+	/// \brief
+	/// Add a bitmap DisplayObject to be decoded when it is first used,
+	/// with the specified DisplayObject id.
+	//
+	/// The default implementation is a no-op.
+	///
+	virtual void addBitmap(int /*id*/, BitmapDecoder /*decoder*/)
+	{
+	}
+
 	/// Get the sound sample with given ID.
 	//
 	/// @return NULL if the given DisplayObject ID isn't found in the
@@ -141,6 +141,12 @@ public:
 		return m_movie_def.getBitmap(id);
 	}
 
+	/// Delegate call to associated root movie
+	virtual size_t bitmapRevision() const
+	{
+		return m_movie_def.bitmapRevision();
+	}
+
 	/// Overridden just for complaining  about malformed SWF
 	virtual void addBitmap(int /*id*/, boost::intrusive_ptr<CachedBitmap> /*im*/)
 	{
@@ -149,6 +155,14 @@ public:
 		);
 	}
 
+	/// Overridden just for complaining  about malformed SWF
+	virtual void addBitmap(int /*id*/, BitmapDecoder /*decoder*/)
+	{
+		IF_VERBOSE_MALFORMED_SWF (
+		log_swferror(_("add_bitmap_SWF::DefinitionTag appears in sprite tags"));
+		);
+	}
+
 	/// Delegate call to associated root movie
 	virtual sound_sample* get_sound_sample(int id) const
 	{
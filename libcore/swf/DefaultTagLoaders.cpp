@@ -68,6 +68,8 @@ namespace {
 
 typedef TagLoadersTable::Loaders::value_type TagPair;
 
+typedef TagLoadersTable::Decoders::value_type DecoderPair;
+
 class AddLoader
 {
 public:
@@ -244,6 +246,23 @@ addDefaultLoaders(TagLoadersTable& table)
 
     std::for_each(tags.begin(), tags.end(), AddLoader(table));
 
+    // Definitions that depend on nothing else in the movie, and take
+    // long enough to read to be worth reading in parallel.
+    const std::vector<DecoderPair> decoders = {
+        {SWF::DEFINESHAPE, DefineShapeTag::decoder},
+        {SWF::DEFINESHAPE2, DefineShapeTag::decoder},
+        {SWF::DEFINESHAPE3, DefineShapeTag::decoder},
+        {SWF::DEFINESHAPE4, DefineShapeTag::decoder},
+        {SWF::DEFINESHAPE4_, DefineShapeTag::decoder},
+        {SWF::DEFINEFONT, DefineFontTag::decoder},
+        {SWF::DEFINEFONT2, DefineFontTag::decoder},
+        {SWF::DEFINEFONT3, DefineFontTag::decoder}
+    };
+
+    for (const DecoderPair& d : decoders) {
+        table.registerDecoder(d.first, d.second);
+    }
+
 }
 
 } // namespace SWF
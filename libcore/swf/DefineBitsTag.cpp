@@ -26,6 +26,7 @@
 
 #include <limits>
 #include <cassert>
+#include <memory>
 
 #include "IOChannel.h"
 #include "utility.h"
@@ -53,6 +54,8 @@ namespace SWF {
 namespace {
     void inflateWrapper(SWFStream& in, void* buffer, size_t buffer_bytes);
 
+    void lazyLoader(SWFStream& in, TagType tag, movie_definition& m);
+
     std::unique_ptr<image::GnashImage> readDefineBitsJpeg(SWFStream& in,
             movie_definition& m);
     std::unique_ptr<image::GnashImage> readDefineBitsJpeg2(SWFStream& in);
@@ -196,37 +199,17 @@ void
 DefineBitsTag::loader(SWFStream& in, TagType tag, movie_definition& m,
         const RunResources& r)
 {
-    in.ensureBytes(2);
-    const std::uint16_t id = in.read_u16();
-
-    if (m.getBitmap(id)) {
-        IF_VERBOSE_MALFORMED_SWF(
-            log_swferror(_("DEFINEBITS: Duplicate id (%d) for bitmap "
-                    "DisplayObject - discarding it"), id);
-        );
+    // Only a DEFINEBITS tag needs the movie's JPEG tables, which
+    // may change, so it is decoded now.
+    if (tag != SWF::DEFINEBITS) {
+        lazyLoader(in, tag, m);
         return;
     }
 
-    std::unique_ptr<image::GnashImage> im;
+    in.ensureBytes(2);
+    const std::uint16_t id = in.read_u16();
 
-    switch (tag) {
-        case SWF::DEFINEBITS:
-            im = readDefineBitsJpeg(in, m);
-            break;
-        case SWF::DEFINEBITSJPEG2:
-            im = readDefineBitsJpeg2(in);
-            break;
-        case SWF::DEFINEBITSJPEG3:
-        case SWF::DEFINEBITSJPEG4:
-            im = readDefineBitsJpeg3(in, tag);
-            break;
-        case SWF::DEFINELOSSLESS:
-        case SWF::DEFINELOSSLESS2:
-            im = readLossless(in, tag);
-            break;
-        default:
-            std::abort();
-    }
+    std::unique_ptr<image::GnashImage> im = readDefineBitsJpeg(in, m);
 
     if (!im.get()) {
         IF_VERBOSE_MALFORMED_SWF(
@@ -253,6 +236,71 @@ DefineBitsTag::loader(SWFStream& in, TagType tag, movie_definition& m,
 
 namespace {
 
+void
+lazyLoader(SWFStream& in, TagType tag, movie_definition& m)
+{
+    in.ensureBytes(2);
+    const std::uint16_t id = in.read_u16();
+
+    // Keep the whole tag, so that it can be read as it is in the SWF.
+    const unsigned long start = in.get_tag_start_position();
+    const size_t size = in.get_tag_end_position() - start;
+    std::shared_ptr<std::vector<std::uint8_t> > data(
+            new std::vector<std::uint8_t>(size));
+
+    in.seek(start);
+    if (in.read(reinterpret_cast<char*>(data->data()), size) < size) {
+        throw ParserException(_("Unexpected end of stream while reading"));
+    }
+
+    IF_VERBOSE_PARSE(
+        log_parse(_("Adding bitmap id %1%, to decode when used"), id);
+    );
+
+    m.addBitmap(id, [data, tag, id]() {
+
+        std::unique_ptr<image::GnashImage> im;
+
+        try {
+            SWFStream in(data->data(), data->size(), 0);
+            in.open_tag();
+            in.ensureBytes(2);
+            in.read_u16();
+
+            switch (tag) {
+                case SWF::DEFINEBITSJPEG2:
+                    im = readDefineBitsJpeg2(in);
+                    break;
+                case SWF::DEFINEBITSJPEG3:
+                case SWF::DEFINEBITSJPEG4:
+                    im = readDefineBitsJpeg3(in, tag);
+                    break;
+                case SWF::DEFINELOSSLESS:
+                case SWF::DEFINELOSSLESS2:
+                    im = readLossless(in, tag);
+                    break;
+                default:
+                    std::abort();
+            }
+        }
+        catch (const ParserException& e) {
+            log_error(_("Parsing exception: %s"), e.what());
+        }
+
+        if (!im.get()) {
+            IF_VERBOSE_MALFORMED_SWF(
+                log_swferror(_("Failed to parse bitmap for character %1%"),
+                    id);
+            );
+        }
+        return im;
+    });
+}
+
+} // anonymous namespace
+
+namespace {
+
 // A JPEG image without included tables; those should be in an
 // existing image::JpegInput object stored in the movie.
 std::unique_ptr<image::GnashImage>
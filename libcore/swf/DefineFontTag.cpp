@@ -40,6 +40,13 @@ namespace SWF {
 void
 DefineFontTag::loader(SWFStream& in, TagType tag, movie_definition& m,
             const RunResources& r)
+{
+    decoder(in, tag, m, r)(m);
+}
+
+TagLoadersTable::DecodedTag
+DefineFontTag::decoder(SWFStream& in, TagType tag, movie_definition& m,
+            const RunResources& r)
 {
     assert(tag == DEFINEFONT || tag == DEFINEFONT2 || tag == DEFINEFONT3);
 
@@ -49,7 +56,9 @@ DefineFontTag::loader(SWFStream& in, TagType tag, movie_definition& m,
     std::unique_ptr<DefineFontTag> ft(new DefineFontTag(in, m, tag, r));
     boost::intrusive_ptr<Font> f(new Font(std::move(ft)));
 
-    m.add_font(fontID, f);
+    return [fontID, f](movie_definition& m) {
+        m.add_font(fontID, f);
+    };
 }
 
 void
@@ -32,6 +32,7 @@
 
 #include "SWF.h"
 #include "Font.h"
+#include "TagLoadersTable.h"
 #include <map>
 #include <string>
 #include <cstdint>
@@ -57,6 +58,10 @@ public:
     static void loader(SWFStream& in, TagType tag, movie_definition& m,
             const RunResources& r);
 
+    /// Read a DefineFont tag, to be added by the returned function.
+    static TagLoadersTable::DecodedTag decoder(SWFStream& in, TagType tag,
+            movie_definition& m, const RunResources& r);
+
     /// Return the glyphs read from the DefineFont tag.
     const Font::GlyphInfoRecords& glyphTable() const {
         return _glyphTable;
@@ -44,6 +44,13 @@ namespace SWF {
 void
 DefineShapeTag::loader(SWFStream& in, TagType tag, movie_definition& m,
         const RunResources& r)
+{
+    decoder(in, tag, m, r)(m);
+}
+
+TagLoadersTable::DecodedTag
+DefineShapeTag::decoder(SWFStream& in, TagType tag, movie_definition& m,
+        const RunResources& r)
 {
     assert(tag == DEFINESHAPE ||
            tag == DEFINESHAPE2 ||
@@ -58,9 +65,12 @@ DefineShapeTag::loader(SWFStream& in, TagType tag, movie_definition& m,
         log_parse(_("DefineShapeTag(%s): id = %d"), tag, id);
     );
 
-    DefineShapeTag* ch = new DefineShapeTag(in, tag, m, r, id);
-    m.addDisplayObject(id, ch);
+    boost::intrusive_ptr<DefineShapeTag> ch(
+            new DefineShapeTag(in, tag, m, r, id));
 
+    return [id, ch](movie_definition& m) {
+        m.addDisplayObject(id, ch.get());
+    };
 }
 
 DisplayObject*
@@ -12,6 +12,7 @@
 #include "DefinitionTag.h" // for inheritance of DefineShapeTag
 #include "SWF.h"
 #include "ShapeRecord.h"
+#include "TagLoadersTable.h"
 
 namespace gnash {
 	class SWFStream;
@@ -36,6 +37,10 @@ public:
     static void loader(SWFStream& in, TagType tag, movie_definition& m,
             const RunResources& r);
 
+    /// Read a DefineShape tag, to be defined by the returned function.
+    static TagLoadersTable::DecodedTag decoder(SWFStream& in, TagType tag,
+            movie_definition& m, const RunResources& r);
+
     // Display a Shape character.
     void display(Renderer& renderer, const Transform& xform) const;
 
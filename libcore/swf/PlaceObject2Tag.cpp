@@ -51,6 +51,7 @@ PlaceObject2Tag::PlaceObject2Tag(const movie_definition& def)
     _ratio(0),
     m_clip_depth(0),
     _blendMode(0),
+    _bitmapCaching(false),
     _movie_def(def)
 {
 }
@@ -387,10 +388,9 @@ PlaceObject2Tag::readPlaceObject3(SWFStream& in)
     }
 
     if (hasFilters()) {
-        Filters v; // TODO: Attach the filters to the display object.
+        Filters v;
         filter_factory::read(in, true, &v);
-	    // at time of writing no renderer supports bitmap filters
-	    LOG_ONCE( log_unimpl("Bitmap filters") );
+        for (auto& f : v) _filters.push_back(std::move(f));
     }
 
     if (hasBlendMode()) {
@@ -399,7 +399,6 @@ PlaceObject2Tag::readPlaceObject3(SWFStream& in)
         LOG_ONCE(log_unimpl("Blend mode in PlaceObject tag"));
     }
 
-    std::uint8_t bitmask = 0;
     if (hasBitmapCaching()) {
         // cacheAsBitmap is a boolean value, so the flag itself ought to be
         // enough. Alexis' SWF reference is unsure about this, but suggests
@@ -409,12 +408,10 @@ PlaceObject2Tag::readPlaceObject3(SWFStream& in)
         // However, the movie the-last-stand.swf has one PlaceObject3 tag
         // with both PlaceActions and bitmap caching, and the reserved bytes
         // of the PlaceActions (see readPlaceActions) are not 0 if this byte
-        // isn't read.
-        // TODO: set object property
+        // isn't read. Later versions of the SWF specification say that
+        // 0 disables caching.
         in.ensureBytes(1);
-        bitmask = in.read_u8();
-	    LOG_ONCE(log_unimpl("Bitmap caching"));
-        UNUSED(bitmask);
+        _bitmapCaching = in.read_u8();
     }
 
     if (hasClipActions()) {
@@ -26,6 +26,7 @@
 #include "SWF.h" // for TagType definition
 #include "SWFMatrix.h" // for composition
 #include "SWFCxForm.h" // for composition 
+#include "Filters.h" // for composition
 
 // Forward declarations
 namespace gnash {
@@ -148,6 +149,18 @@ public:
         return _blendMode;
     }
 
+    /// Whether the character is drawn from a cached image.
+    //
+    /// Only meaningful if hasBitmapCaching() is true.
+    bool getBitmapCaching() const {
+        return _bitmapCaching;
+    }
+
+    /// Get the bitmap filters to apply.
+    const BitmapFilters& getFilters() const {
+        return _filters;
+    }
+
 private:
 
     // read SWF::PLACEOBJECT 
@@ -173,6 +186,10 @@ private:
     
     std::uint8_t _blendMode;
 
+    bool _bitmapCaching;
+
+    BitmapFilters _filters;
+
     /// NOTE: getPlaceType() is dependent on the enum values.
     enum PlaceType
     {
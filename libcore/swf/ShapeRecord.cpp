@@ -20,6 +20,7 @@
 #include "ShapeRecord.h"
 
 #include <vector>
+#include <atomic>
 
 #include "TypesParser.h"
 #include "utility.h"
@@ -69,15 +70,23 @@ private:
     const double _ratio;
 };
 
+/// The last revision given to a shape. Shapes are parsed in loader
+/// threads.
+std::atomic<std::uint64_t> lastRevision(0);
+
 } // anonymous namespace
 
 ShapeRecord::ShapeRecord(SWFStream& in, SWF::TagType tag, movie_definition& m,
         const RunResources& r)
+    :
+    _revision(++lastRevision)
 {
     read(in, tag, m, r);
 }
 
 ShapeRecord::ShapeRecord()
+    :
+    _revision(++lastRevision)
 {
 }
 
@@ -90,6 +99,13 @@ ShapeRecord::clear()
 {
     _bounds.set_null();
     _subshapes.clear();
+    touch();
+}
+
+void
+ShapeRecord::touch()
+{
+    _revision = ++lastRevision;
 }
 
 void
@@ -136,6 +152,8 @@ ShapeRecord::setLerp(const ShapeRecord& aa, const ShapeRecord& bb,
        return;
     }
 
+    touch();
+
     // Update current bounds.
     _bounds.set_lerp(aa.getBounds(), bb.getBounds(), ratio);
     const Subshape& a = aa.subshapes().front();
@@ -225,6 +243,7 @@ void
 ShapeRecord::read(SWFStream& in, SWF::TagType tag, movie_definition& m,
         const RunResources& r)
 {
+    touch();
 
     /// TODO: is this correct?
     const bool styleInfo = (tag == SWF::DEFINESHAPE ||
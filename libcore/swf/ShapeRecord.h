@@ -26,6 +26,7 @@
 #include "SWFRect.h"
 
 #include <vector>
+#include <cstdint>
 
 
 namespace gnash {
@@ -161,12 +162,22 @@ public:
 
     void addSubshape(const Subshape& subshape) {
     	_subshapes.push_back(subshape);
+        touch();
     }
 
     const SWFRect& getBounds() const {
         return _bounds;
     }
 
+    /// A number identifying the current paths and styles of this shape.
+    //
+    /// It changes whenever they do, and no two shapes with different
+    /// contents have the same revision, so renderers can use it as a
+    /// cache key.
+    std::uint64_t revision() const {
+        return _revision;
+    }
+
     /// Set to the lerp of two ShapeRecords.
     //
     /// Used in shape morphing.
@@ -178,6 +189,7 @@ public:
 
     void setBounds(const SWFRect& bounds) {
         _bounds = bounds;
+        touch();
     }
 
     bool pointTest(std::int32_t x, std::int32_t y,
@@ -193,6 +205,9 @@ public:
 
 private:
 
+    /// Give the shape a new revision after it changed.
+    void touch();
+
     unsigned readStyleChange(SWFStream& in, size_t num_fill_bits, size_t numStyles);
 
     /// Shape record flags for use in parsing.
@@ -207,6 +222,7 @@ private:
 
     SWFRect _bounds;
     Subshapes _subshapes;
+    std::uint64_t _revision;
 };
 
 std::ostream& operator<<(std::ostream& o, const ShapeRecord& sh);
@@ -22,6 +22,7 @@
 #include "SWF.h"
 
 #include <map>
+#include <functional>
 #include <boost/noncopyable.hpp>
 
 // Forward declarations
@@ -50,6 +51,22 @@ public:
 
     typedef std::map<SWF::TagType, TagLoader> Loaders;
 
+	/// Adds what a TagDecoder read to the movie.
+	typedef std::function<void(movie_definition& m)> DecodedTag;
+
+	/// Signature of an SWF tag decoder
+	//
+	/// A decoder reads a definition tag that doesn't depend on any
+	/// other, so that it can run in another thread while the loader
+	/// goes on with the next tags. It may only query the movie's
+	/// version, and leaves defining what it read to the DecodedTag
+	/// it returns.
+	///
+	typedef DecodedTag (*TagDecoder)(SWFStream& input, TagType type,
+            movie_definition& m, const RunResources& r);
+
+    typedef std::map<SWF::TagType, TagDecoder> Decoders;
+
     /// Construct an empty TagLoadersTable
 	TagLoadersTable() {}
 
@@ -76,10 +93,28 @@ public:
 	///
 	bool registerLoader(TagType t, TagLoader lf);
 
+	/// Get the TagDecoder for a specified TagType.
+	//
+	/// @return false if the tag can only be read by its loader.
+	///
+	bool getDecoder(TagType t, TagDecoder& df) const;
+
+	/// Register a decoder for the specified SWF::TagType.
+	//
+	/// The tag's loader must do the same as the decoder followed by
+	/// the DecodedTag it returns.
+	///
+	/// @return false if a decoder is already registered
+	///               for the given tag
+	///
+	bool registerDecoder(TagType t, TagDecoder df);
+
 private:
 
 	Loaders _loaders;
 
+	Decoders _decoders;
+
 };
 
 } // namespace gnash::SWF
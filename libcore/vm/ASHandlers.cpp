@@ -42,6 +42,7 @@
 #include "as_environment.h"
 #include "URL.h"
 #include "action_buffer.h"
+#include "MemberCache.h"
 #include "as_object.h"
 #include "DragState.h"
 #include "VM.h" // for getting the root
@@ -52,6 +53,7 @@
 #include "StringPredicates.h" 
 #include "GnashNumeric.h"
 #include "Global_as.h"
+#include "Array_as.h"
 #include "DisplayObject.h"
 #include "as_environment.h"
 #include "as_value.h"
@@ -232,12 +234,6 @@ ActionHandler::ActionHandler(ActionType type, ActionCallback func,
 {
 }
 
-void
-ActionHandler::execute(ActionExec& thread) const
-{
-    return _callback(thread);
-}
-
 SWFHandlers::SWFHandlers()
     :
     _handlers(256)
@@ -1019,8 +1015,8 @@ ActionStringConcat(ActionExec& thread)
     as_environment& env = thread.env;
     const int version = getSWFVersion(env);
 
-    const std::string& op1 = env.top(0).to_string(version);
-    const std::string& op2 = env.top(1).to_string(version);
+    const SharedString op1 = env.top(0).to_shared_string(version);
+    const SharedString op2 = env.top(1).to_shared_string(version);
 
     env.top(1).set_string(op2 + op1);
     env.drop(1);
@@ -2370,9 +2366,7 @@ ActionInitArray(ActionExec& thread)
     VM& vm = getVM(env);
     // Fill the elements with the initial values from the stack.
     for (int i = 0; i < array_size; i++) {
-        const ObjectURI& k = 
-            getURI(vm, std::to_string(i));
-        ao->set_member(k, env.pop());
+        ao->set_member(arrayKey(vm, i), env.pop());
     }
 
     env.push(ao);
@@ -2593,7 +2587,9 @@ ActionGetMember(ActionExec& thread)
 
     const ObjectURI& k = getURI(getVM(env), member_name.to_string());
 
-    if (!obj->get_member(k, &env.top(1))) {
+    MemberCache& cache = thread.code.memberCache(thread.getCurrentPC());
+
+    if (!getMember(*obj, k, env.top(1), cache)) {
         IF_VERBOSE_ASCODING_ERRORS(
             log_aserror("Reference to undefined member %s of object %s",
                 member_name, target);
@@ -2627,7 +2623,8 @@ ActionSetMember(ActionExec& thread)
         );
     }
     else if (obj) {
-        obj->set_member(getURI(getVM(env), member_name), member_value);
+        MemberCache& cache = thread.code.memberCache(thread.getCurrentPC());
+        setMember(*obj, getURI(getVM(env), member_name), member_value, cache);
 
         IF_VERBOSE_ACTION (
             log_action(_("-- set_member %s.%s=%s"),
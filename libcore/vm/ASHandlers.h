@@ -57,7 +57,9 @@ public:
             ArgumentType format = ARG_NONE);
 
     /// Execute the action
-    void execute(ActionExec& thread) const;
+    void execute(ActionExec& thread) const {
+        _callback(thread);
+    }
 
     ActionType getType()   const { return _type; }
     ArgumentType getArgFormat() const { return _arg_format; }
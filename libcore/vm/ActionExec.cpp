@@ -34,6 +34,7 @@
 #include "as_environment.h"
 #include "SystemClock.h"
 #include "CallStack.h"
+#include "DecodedActions.h"
 
 #include <sstream>
 #include <string>
@@ -75,7 +76,8 @@ ActionExec::ActionExec(const Function& func, as_environment& newEnv,
     _abortOnUnload(false),
     pc(func.getStartPC()),
     next_pc(pc),
-    stop_pc(pc + func.getLength())
+    stop_pc(pc + func.getLength()),
+    _actionCounts(nullptr)
 {
     assert(stop_pc < code.size());
 
@@ -117,7 +119,8 @@ ActionExec::ActionExec(const action_buffer& abuf, as_environment& newEnv,
     _abortOnUnload(abortOnUnloaded),
     pc(0),
     next_pc(0),
-    stop_pc(abuf.size())
+    stop_pc(abuf.size()),
+    _actionCounts(nullptr)
 {
 }
 
@@ -140,6 +143,8 @@ ActionExec::operator()()
 
     _initialStackSize = env.stack_size();
 
+    _actionCounts = getRoot(vm).profiler().actionCounts();
+
 #if DEBUG_STACK
     IF_VERBOSE_ACTION (
             log_action(_("at ActionExec operator() start, pc=%d"
@@ -166,6 +171,14 @@ ActionExec::operator()()
     const size_t maxTime = getRoot(vm).getTimeoutLimit() * 1000;
     SystemClock clock; // TODO: should we use a CPUClock here ?
 
+    // The pre-decoded interpreter does not log actions, so verbose
+    // action logging always uses the classic one.
+    const DecodedActions* decoded = nullptr;
+    if (vm.predecodeActions()) {
+        decoded = &code.decoded();
+        IF_VERBOSE_ACTION(decoded = nullptr);
+    }
+
     try {
 
         // We might not stop at stop_pc, if we are trying.
@@ -213,6 +226,19 @@ ActionExec::operator()()
                 _scopeStack.pop_back();
             }
 
+            if (decoded) {
+                if (!runDecoded(*decoded, clock, maxTime)) break;
+
+                // Let the checks above deal with the end of the
+                // code or of a with block.
+                if (pc >= stop_pc) continue;
+                if (!_withStack.empty() && pc >= _withStack.back().end_pc()) {
+                    continue;
+                }
+
+                // Otherwise run this action the classic way.
+            }
+
             // Get the opcode.
             std::uint8_t action_id = code[pc];
 
@@ -255,6 +281,8 @@ ActionExec::operator()()
                 break;
             }
 
+            if (_actionCounts) ++_actionCounts[action_id];
+
             ash.execute(static_cast<SWF::ActionType>(action_id), *this);
 
             // Code round here has to do with bugs: #20974, #21069, #20996,
@@ -297,22 +325,7 @@ ActionExec::operator()()
 
             // Do some housecleaning on branch back
             if (next_pc <= pc) {
-                // Check for script limits hit. 
-                // See: http://www.gnashdev.org/wiki/index.php/ScriptLimits
-                if (clock.elapsed() > maxTime) {
-                    boost::format fmt = 
-                        boost::format(_("Time exceeded (%4% secs) while "
-                            "executing code in %1% between pc %2% and %3%. "
-                            "Disable scripts?")) %
-                            code.getMovieDefinition().get_url() % next_pc %
-                            pc % (maxTime/1000);
-
-                    if (getRoot(env).queryInterface(fmt.str())) {
-                        throw ActionLimitException(fmt.str());
-                    } 
-
-                    clock.restart();
-                }
+                checkTimeLimit(clock, maxTime);
                 // TODO: Run garbage collector ? If stack isn't too big ?
             }
 
@@ -332,6 +345,144 @@ ActionExec::operator()()
 
 }
 
+bool
+ActionExec::runDecoded(const DecodedActions& actions, SystemClock& clock,
+        size_t maxTime)
+{
+    const DecodedAction* a;
+
+    // Each action kind jumps straight to the code for the next action
+    // (threaded dispatch) where the compiler supports computed gotos.
+#ifdef __GNUC__
+    static void* const labels[] = {
+        &&handler,          // DecodedAction::HANDLER
+        &&push,             // DecodedAction::PUSH
+        &&jump,             // DecodedAction::JUMP
+        &&branchIfTrue,     // DecodedAction::BRANCH_IF_TRUE
+        &&bailOut           // DecodedAction::BAIL_OUT
+    };
+# define GNASH_DISPATCH_ACTION() goto *labels[a->kind]
+#else
+# define GNASH_DISPATCH_ACTION() \
+    switch (a->kind) { \
+        case DecodedAction::HANDLER: goto handler; \
+        case DecodedAction::PUSH: goto push; \
+        case DecodedAction::JUMP: goto jump; \
+        case DecodedAction::BRANCH_IF_TRUE: goto branchIfTrue; \
+        default: goto bailOut; \
+    }
+#endif
+
+fetch:
+    if (pc >= stop_pc) return true;
+    if (!_withStack.empty() && pc >= _withStack.back().end_pc()) return true;
+
+    a = actions.at(pc);
+    if (!a || a->nextPC > stop_pc) return true;
+
+    next_pc = a->nextPC;
+    if (_actionCounts && a->kind != DecodedAction::BAIL_OUT) {
+        ++_actionCounts[a->id];
+    }
+    GNASH_DISPATCH_ACTION();
+
+handler:
+    try {
+        a->handler->execute(*this);
+    }
+    catch (const ActionParserException& e) {
+        log_swferror(_("Malformed action code: %s"), e.what());
+    }
+
+    {
+        // See the main loop in operator().
+        DisplayObject* guardedChar = env.target();
+        if (_abortOnUnload && guardedChar && guardedChar->unloaded()) {
+            return false;
+        }
+    }
+    goto branched;
+
+push:
+    {
+        const PushOperand* op = actions.operands(*a);
+        const PushOperand* end = op + a->operandCount;
+        for (; op != end; ++op) {
+            switch (op->type) {
+                case PushOperand::LITERAL:
+                    env.push(op->value);
+                    break;
+                case PushOperand::REGISTER:
+                {
+                    const as_value* v = getVM(env).getRegister(op->index);
+                    if (!v) {
+                        IF_VERBOSE_MALFORMED_SWF(
+                            log_swferror(_("Invalid register %d in "
+                                    "ActionPush"), op->index);
+                        );
+                        env.push(as_value());
+                    }
+                    else env.push(*v);
+                    break;
+                }
+                case PushOperand::CONSTANT:
+                {
+                    const ConstantPool* pool = getVM(env).getConstantPool();
+                    if (!pool || op->index >= pool->size()) {
+                        IF_VERBOSE_MALFORMED_SWF(
+                            log_swferror(_("Unknown constant '%1%'"),
+                                op->index);
+                        );
+                        env.push(as_value());
+                    }
+                    else env.push((*pool)[op->index]);
+                    break;
+                }
+            }
+        }
+    }
+    pc = next_pc;
+    goto fetch;
+
+jump:
+    next_pc = a->target;
+    goto branched;
+
+branchIfTrue:
+    if (toBool(env.pop(), getVM(env))) next_pc = a->target;
+    goto branched;
+
+bailOut:
+    return true;
+
+branched:
+    if (next_pc <= pc) checkTimeLimit(clock, maxTime);
+    pc = next_pc;
+    goto fetch;
+
+#undef GNASH_DISPATCH_ACTION
+}
+
+void
+ActionExec::checkTimeLimit(SystemClock& clock, size_t maxTime)
+{
+    // Check for script limits hit. 
+    // See: http://www.gnashdev.org/wiki/index.php/ScriptLimits
+    if (clock.elapsed() <= maxTime) return;
+
+    boost::format fmt = 
+        boost::format(_("Time exceeded (%4% secs) while "
+            "executing code in %1% between pc %2% and %3%. "
+            "Disable scripts?")) %
+            code.getMovieDefinition().get_url() % next_pc %
+            pc % (maxTime/1000);
+
+    if (getRoot(env).queryInterface(fmt.str())) {
+        throw ActionLimitException(fmt.str());
+    } 
+
+    clock.restart();
+}
 
 // Try / catch / finally rules:
 //
@@ -22,6 +22,7 @@
 #include <string>
 #include <stack>
 #include <vector>
+#include <cstdint>
 #include <boost/noncopyable.hpp>
 
 #include "as_environment.h" 
@@ -33,6 +34,8 @@ namespace gnash {
 	class as_value;
 	class Function;
 	class ActionExec;
+	class DecodedActions;
+	class SystemClock;
 }
 
 namespace gnash {
@@ -269,6 +272,25 @@ private:
     /// @param t the try block to process.
     bool processExceptions(TryBlock& t);
 
+	/// Execute actions from their pre-decoded form
+	//
+	/// Runs as many actions as possible without going back to the
+	/// main loop of operator(). Returns when the action at pc
+	/// needs the main loop's attention: the end of the code or of
+	/// a try or with block, or an action without decoded form.
+	/// The main loop then handles it, as it would without
+	/// pre-decoding.
+	//
+	/// @return false if execution should stop (the target was
+	///         unloaded), true otherwise.
+	bool runDecoded(const DecodedActions& actions, SystemClock& clock,
+			size_t maxTime);
+
+	/// Check for script limits, after a branch back
+	//
+	/// Throws an ActionLimitException if the user wants to stop.
+	void checkTimeLimit(SystemClock& clock, size_t maxTime);
+
 	/// Run after a complete run, or after an run interrupted by 
 	/// a bail-out exception (ActionLimitException, for example)
 	//
@@ -328,6 +350,9 @@ private:
 	/// Used for try/throw/catch blocks.
 	size_t stop_pc;
 
+	/// The frame profiler's action counters, or null when not profiling.
+	std::uint32_t* _actionCounts;
+
 };
 
 } // namespace gnash
@@ -0,0 +1,219 @@
+// DecodedActions.cpp: pre-decoded form of an action_buffer, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "DecodedActions.h"
+
+#include <string>
+
+#include "action_buffer.h"
+#include "GnashException.h"
+#include "SWF.h"
+#include "log.h"
+
+namespace gnash {
+
+DecodedActions::DecodedActions(const action_buffer& buf)
+    :
+    _index(buf.size(), -1)
+{
+    const SWF::SWFHandlers& ash = SWF::SWFHandlers::instance();
+
+    const size_t size = buf.size();
+    size_t pc = 0;
+
+    while (pc < size) {
+
+        DecodedAction a;
+        a.id = static_cast<SWF::ActionType>(buf[pc]);
+        a.kind = DecodedAction::HANDLER;
+        a.target = 0;
+        a.firstOperand = 0;
+        a.operandCount = 0;
+        a.handler = &ash[a.id];
+
+        size_t next;
+        std::uint16_t length = 0;
+
+        if ((a.id & 0x80) == 0) {
+            next = pc + 1;
+        }
+        else {
+            // There's no room for the length; the classic
+            // interpreter will complain when it gets here.
+            if (pc + 2 >= size) break;
+            length = buf.read_uint16(pc + 1);
+            next = pc + length + 3;
+        }
+
+        if (next > size) {
+            // An action overflowing the buffer. Leave it to the classic
+            // interpreter and stop decoding, as we lost sync anyway.
+            a.kind = DecodedAction::BAIL_OUT;
+            a.nextPC = size;
+            _index[pc] = _actions.size();
+            _actions.push_back(a);
+            break;
+        }
+
+        a.nextPC = next;
+
+        switch (a.id) {
+
+            case SWF::ACTION_END:
+                a.kind = DecodedAction::BAIL_OUT;
+                break;
+
+            case SWF::ACTION_PUSHDATA:
+                if (decodePush(buf, pc, a)) a.kind = DecodedAction::PUSH;
+                break;
+
+            case SWF::ACTION_BRANCHALWAYS:
+            case SWF::ACTION_BRANCHIFTRUE:
+            {
+                if (length < 2) break;
+                const std::int16_t offset = buf.read_int16(pc + 3);
+
+                // Jumps before the start of the buffer are refused
+                // (and logged) by ActionExec::adjustNextPC.
+                if (static_cast<int>(pc) + offset < 0) break;
+
+                a.target = next + offset;
+                a.kind = a.id == SWF::ACTION_BRANCHALWAYS ?
+                    DecodedAction::JUMP : DecodedAction::BRANCH_IF_TRUE;
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        _index[pc] = _actions.size();
+        _actions.push_back(a);
+        pc = next;
+    }
+}
+
+bool
+DecodedActions::decodePush(const action_buffer& buf, size_t pc,
+        DecodedAction& a)
+{
+    // This must parse exactly like ActionPushData, including its
+    // tolerance of operands running past the declared length.
+    const size_t first = _operands.size();
+
+    try {
+        const std::uint16_t length = buf.read_uint16(pc + 1);
+
+        size_t i = pc;
+        while (i - pc < length) {
+
+            const std::uint8_t type = buf[3 + i];
+            ++i;
+
+            switch (type) {
+
+                case 0: // string
+                {
+                    std::string str(buf.read_string(i + 3));
+                    i += str.size() + 1;
+                    _operands.emplace_back(as_value(std::move(str)));
+                    break;
+                }
+
+                case 1: // float
+                {
+                    const float f = buf.read_float_little(i + 3);
+                    i += 4;
+                    _operands.emplace_back(as_value(f));
+                    break;
+                }
+
+                case 2: // null
+                {
+                    as_value nullvalue;
+                    nullvalue.set_null();
+                    _operands.emplace_back(nullvalue);
+                    break;
+                }
+
+                case 3: // undefined
+                    _operands.emplace_back(as_value());
+                    break;
+
+                case 4: // register
+                    _operands.emplace_back(PushOperand::REGISTER, buf[3 + i]);
+                    ++i;
+                    break;
+
+                case 5: // bool
+                {
+                    const bool b = buf[3 + i];
+                    ++i;
+                    _operands.emplace_back(as_value(b));
+                    break;
+                }
+
+                case 6: // double
+                {
+                    const double d = buf.read_double_wacky(i + 3);
+                    i += 8;
+                    _operands.emplace_back(as_value(d));
+                    break;
+                }
+
+                case 7: // int
+                {
+                    const std::int32_t val = buf.read_int32(i + 3);
+                    i += 4;
+                    _operands.emplace_back(as_value(val));
+                    break;
+                }
+
+                case 8: // dict8
+                    _operands.emplace_back(PushOperand::CONSTANT, buf[3 + i]);
+                    ++i;
+                    break;
+
+                case 9: // dict16
+                {
+                    const std::uint16_t id = buf.read_int16(i + 3);
+                    i += 2;
+                    _operands.emplace_back(PushOperand::CONSTANT, id);
+                    break;
+                }
+
+                default:
+                    // Unknown type: let ActionPushData report it.
+                    _operands.erase(_operands.begin() + first,
+                            _operands.end());
+                    return false;
+            }
+        }
+    }
+    catch (const ActionParserException&) {
+        _operands.erase(_operands.begin() + first, _operands.end());
+        return false;
+    }
+
+    a.firstOperand = first;
+    a.operandCount = _operands.size() - first;
+    return true;
+}
+
+} // namespace gnash
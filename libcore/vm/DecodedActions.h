@@ -0,0 +1,162 @@
+// DecodedActions.h: pre-decoded form of an action_buffer, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_DECODEDACTIONS_H
+#define GNASH_DECODEDACTIONS_H
+
+#include <vector>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+
+#include "as_value.h"
+#include "ASHandlers.h"
+
+// Forward declarations
+namespace gnash {
+    class action_buffer;
+}
+
+namespace gnash {
+
+/// An operand of a pre-decoded ActionPush.
+//
+/// Literal values are converted to an as_value once, at decoding time.
+/// Registers and constant pool entries depend on runtime state, so only
+/// their index is stored.
+struct PushOperand
+{
+    enum Type {
+        LITERAL,
+        REGISTER,
+        CONSTANT
+    };
+
+    PushOperand(as_value v)
+        :
+        type(LITERAL),
+        value(std::move(v)),
+        index(0)
+    {}
+
+    PushOperand(Type t, unsigned int i)
+        :
+        type(t),
+        value(),
+        index(i)
+    {}
+
+    Type type;
+    as_value value;
+    unsigned int index;
+};
+
+/// A single action tag, with its header already parsed.
+struct DecodedAction
+{
+    /// How ActionExec should dispatch this action.
+    //
+    /// Only a handful of very common actions are executed inline;
+    /// everything else goes through its SWF::ActionHandler.
+    enum Kind {
+        /// Call the ActionHandler.
+        HANDLER,
+        /// ActionPushData with pre-parsed operands.
+        PUSH,
+        /// ActionBranchAlways with a resolved target.
+        JUMP,
+        /// ActionBranchIfTrue with a resolved target.
+        BRANCH_IF_TRUE,
+        /// Anything that must be left to the classic interpreter
+        /// (ACTION_END, or a length overflowing the buffer).
+        BAIL_OUT
+    };
+
+    Kind kind;
+
+    /// The action id.
+    SWF::ActionType id;
+
+    /// Offset of the next action tag.
+    std::uint32_t nextPC;
+
+    /// Absolute branch target for JUMP and BRANCH_IF_TRUE.
+    std::uint32_t target;
+
+    /// First operand in DecodedActions::operands() for PUSH.
+    std::uint32_t firstOperand;
+
+    /// Number of operands for PUSH.
+    std::uint32_t operandCount;
+
+    /// The handler to call for HANDLER.
+    const SWF::ActionHandler* handler;
+};
+
+/// A pre-decoded action_buffer.
+//
+/// The whole buffer is decoded linearly once, so that executing an
+/// action no longer needs to read its opcode and length from the byte
+/// stream, look up its handler or re-parse ActionPush operands.
+//
+/// Execution still uses byte offsets as program counter (handlers and
+/// try/with blocks depend on them), so each decoded action is reachable
+/// from its offset. Offsets that are not at an action boundary (e.g.
+/// jumps into the middle of an action in obfuscated SWFs) have no
+/// decoded action and must be executed by the classic interpreter.
+class DecodedActions : boost::noncopyable
+{
+public:
+
+    /// Decode the given action_buffer.
+    explicit DecodedActions(const action_buffer& buf);
+
+    /// Return the action starting at the given offset, or null.
+    const DecodedAction* at(size_t pc) const {
+        if (pc >= _index.size()) return nullptr;
+        const std::int32_t i = _index[pc];
+        return i < 0 ? nullptr : &_actions[i];
+    }
+
+    /// Return the ActionPush operands of the given action.
+    const PushOperand* operands(const DecodedAction& a) const {
+        return &_operands[a.firstOperand];
+    }
+
+    /// The number of decoded actions.
+    size_t size() const { return _actions.size(); }
+
+private:
+
+    /// Parse the operands of the ActionPush at pc.
+    //
+    /// @return false if the operands could not be parsed, in which
+    ///         case the action should be left to its handler.
+    bool decodePush(const action_buffer& buf, size_t pc, DecodedAction& a);
+
+    std::vector<DecodedAction> _actions;
+
+    std::vector<PushOperand> _operands;
+
+    /// Map from byte offset to index in _actions, -1 for no action.
+    std::vector<std::int32_t> _index;
+};
+
+} // namespace gnash
+
+#endif
@@ -387,7 +387,7 @@ Machine::execute()
     assert(mStream);
 
 	for (;;) {
-		std::size_t opStart = mStream->tellg();
+		std::size_t opStart = mStream->tell();
         
         try {
 
@@ -862,7 +862,7 @@ Machine::execute()
                 /// position on op entry.
                 case SWF::ABC_ACTION_LOOKUPSWITCH:
                 {
-                    std::size_t npos = mStream->tellg();
+                    std::size_t npos = mStream->tell();
                     if (!_stack.top(0).is_number()) throw ASException();
 
                     std::uint32_t index =
@@ -0,0 +1,229 @@
+// MemberCache.cpp: inline caches for ActionScript member access, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "MemberCache.h"
+
+#include "as_object.h"
+#include "as_value.h"
+#include "Property.h"
+#include "PropertyList.h"
+#include "ObjectURI.h"
+#include "GnashException.h"
+#include "namedStrings.h"
+#include "log.h"
+
+namespace gnash {
+
+std::uint64_t MemberCache::_hits = 0;
+std::uint64_t MemberCache::_misses = 0;
+
+MemberCache::MemberCache()
+    :
+    _next(0)
+{
+    for (Entry& e : _entries) e.depth = 0;
+}
+
+Property*
+MemberCache::find(const as_object& obj, const ObjectURI& uri, int version)
+    const
+{
+    const std::uint64_t epoch = PropertyList::prototypeEpoch();
+
+    for (const Entry& e : _entries) {
+
+        if (!e.depth || e.chain[0] != &obj) continue;
+        if (e.name != uri.name || e.version != version) continue;
+        if (e.epoch != epoch) continue;
+
+        // Each object can only be dereferenced once the previous one
+        // is known to be unchanged, as that is what keeps it alive.
+        size_t i = 0;
+        for (; i < e.depth; ++i) {
+            if (e.chain[i]->_members.layout() != e.layouts[i]) break;
+        }
+        if (i == e.depth) return e.prop;
+    }
+    return nullptr;
+}
+
+void
+MemberCache::store(const Entry& e)
+{
+    _entries[_next] = e;
+    _next = (_next + 1) % Entries;
+}
+
+Property*
+MemberCache::findGet(as_object& obj, const ObjectURI& uri)
+{
+    // Array elements may be kept outside the PropertyList.
+    if (obj.elementIndex(uri) >= 0) {
+        ++_misses;
+        return nullptr;
+    }
+
+    const int version = getSWFVersion(obj);
+
+    Property* prop = find(obj, uri, version);
+
+    // The chain is unchanged, but the Property's own flags may not be.
+    if (prop && visible(*prop, version)) {
+        ++_hits;
+        return prop;
+    }
+
+    ++_misses;
+
+    if (obj.isSuper()) return nullptr;
+
+    // Walk the chain as as_object::get_member does.
+    Entry e;
+    e.name = uri.name;
+    e.version = version;
+    e.epoch = PropertyList::prototypeEpoch();
+
+    as_object* o = &obj;
+
+    for (e.depth = 1; e.depth <= MaxDepth; ++e.depth) {
+
+        if (o->elementIndex(uri) >= 0) return nullptr;
+
+        e.chain[e.depth - 1] = o;
+        e.layouts[e.depth - 1] = o->_members.layout();
+
+        prop = o->_members.getProperty(uri);
+        if (prop) {
+            // An invisible property is skipped, but it would become
+            // visible when set.
+            if (!visible(*prop, version)) return nullptr;
+            e.prop = prop;
+            store(e);
+            return prop;
+        }
+
+        // DisplayObject magic properties come before the inheritance
+        // chain.
+        if (o->displayObject()) return nullptr;
+
+        // Only plain object __proto__ members can be followed without
+        // calling any ActionScript.
+        const Property* proto = o->_members.getProperty(NSV::PROP_uuPROTOuu);
+        if (!proto || !visible(*proto, version)) return nullptr;
+        if (proto->isGetterSetter()) return nullptr;
+
+        as_object* next = proto->getValue(*o).get_object();
+
+        // A DisplayObject ends the chain.
+        if (!next || next->displayObject()) return nullptr;
+
+        for (size_t i = 0; i < e.depth; ++i) {
+            if (e.chain[i] == next) return nullptr;
+        }
+        o = next;
+    }
+    return nullptr;
+}
+
+Property*
+MemberCache::findSet(as_object& obj, const ObjectURI& uri)
+{
+    // TextField variables, magic properties, Array lengths and
+    // triggers must be handled by as_object::set_member.
+    if (obj.displayObject() || obj.array()) {
+        ++_misses;
+        return nullptr;
+    }
+
+    if (obj._trigs.get() && obj._trigs->find(uri) != obj._trigs->end()) {
+        ++_misses;
+        return nullptr;
+    }
+
+    const int version = getSWFVersion(obj);
+
+    // Only own properties are cached; their visibility doesn't matter.
+    Property* prop = find(obj, uri, version);
+    if (prop) {
+        ++_hits;
+    }
+    else {
+        ++_misses;
+        prop = obj._members.getProperty(uri);
+        if (!prop) return nullptr;
+
+        Entry e;
+        e.name = uri.name;
+        e.version = version;
+        e.epoch = PropertyList::prototypeEpoch();
+        e.chain[0] = &obj;
+        e.layouts[0] = obj._members.layout();
+        e.depth = 1;
+        e.prop = prop;
+        store(e);
+    }
+
+    // Read-only properties are logged by as_object::set_member.
+    if (readOnly(*prop)) return nullptr;
+
+    return prop;
+}
+
+bool
+getMember(as_object& obj, const ObjectURI& uri, as_value& val,
+        MemberCache& cache)
+{
+    Property* prop = cache.findGet(obj, uri);
+    if (!prop) return obj.get_member(uri, &val);
+
+    try {
+        val = prop->getValue(obj);
+        return true;
+    }
+    catch (const ActionTypeError& exc) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("Caught exception: %s"), exc.what());
+            );
+        return false;
+    }
+}
+
+void
+setMember(as_object& obj, const ObjectURI& uri, const as_value& val,
+        MemberCache& cache)
+{
+    Property* prop = cache.findSet(obj, uri);
+    if (!prop) {
+        obj.set_member(uri, val);
+        return;
+    }
+
+    try {
+        prop->setValue(obj, val);
+        prop->clearVisible(getSWFVersion(obj));
+    }
+    catch (const ActionTypeError& exc) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("%s: %s"),
+                getStringTable(obj).value(getName(uri)), exc.what());
+        );
+    }
+}
+
+} // namespace gnash
@@ -0,0 +1,139 @@
+// MemberCache.h: inline caches for ActionScript member access, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_MEMBERCACHE_H
+#define GNASH_MEMBERCACHE_H
+
+#include <cstdint>
+#include <cstddef>
+
+#include "string_table.h"
+
+// Forward declarations
+namespace gnash {
+    class as_object;
+    class as_value;
+    class Property;
+    struct ObjectURI;
+}
+
+namespace gnash {
+
+/// An inline cache for the member accesses of a single action.
+//
+/// ActionGetMember and ActionSetMember keep one of these per action
+/// (see action_buffer::memberCache()). An entry remembers the objects
+/// walked to resolve a member, the layout of their PropertyLists and
+/// the Property found. As long as none of those layouts and no
+/// __proto__ value changed, the same lookup yields the same Property,
+/// so the inheritance chain walk can be skipped.
+//
+/// Only the plain cases are cached: DisplayObject magic properties,
+/// __resolve, Array lengths and elements, watch() triggers, super and
+/// getter-setter __proto__ members always take the as_object path.
+//
+/// No object is kept alive by a cache. An entry is validated starting
+/// from the accessed object, which is known to be alive and to reference
+/// the next object in the chain for as long as its layout and the
+/// prototype epoch are unchanged.
+class MemberCache
+{
+public:
+
+    MemberCache();
+
+    /// Find the Property that as_object::get_member would return.
+    //
+    /// @return     The Property, or null if the lookup is not cacheable
+    ///             and as_object::get_member must be used.
+    Property* findGet(as_object& obj, const ObjectURI& uri);
+
+    /// Find the own Property that as_object::set_member would set.
+    //
+    /// @return     The Property, or null if the update is not cacheable
+    ///             and as_object::set_member must be used.
+    Property* findSet(as_object& obj, const ObjectURI& uri);
+
+    /// Number of lookups served from a cache since startup.
+    static std::uint64_t hits() { return _hits; }
+
+    /// Number of lookups not served from a cache since startup.
+    static std::uint64_t misses() { return _misses; }
+
+private:
+
+    /// How many objects of an inheritance chain an entry can hold.
+    static const size_t MaxDepth = 4;
+
+    /// How many objects a single action can be cached for.
+    static const size_t Entries = 4;
+
+    struct Entry
+    {
+        /// The objects walked, starting with the accessed one.
+        const as_object* chain[MaxDepth];
+
+        /// The layout of each object's PropertyList.
+        std::uint64_t layouts[MaxDepth];
+
+        /// Number of objects in chain, 0 for an empty entry.
+        size_t depth;
+
+        /// The Property found, owned by chain[depth - 1].
+        Property* prop;
+
+        string_table::key name;
+
+        std::uint64_t epoch;
+
+        int version;
+    };
+
+    /// Return the matching entry's Property, or null.
+    Property* find(const as_object& obj, const ObjectURI& uri, int version)
+        const;
+
+    /// Store a new entry, replacing the oldest one.
+    void store(const Entry& e);
+
+    Entry _entries[Entries];
+
+    /// The next entry to replace.
+    size_t _next;
+
+    static std::uint64_t _hits;
+
+    static std::uint64_t _misses;
+};
+
+/// Get a member of an object, using an inline cache.
+//
+/// This behaves exactly like as_object::get_member.
+bool getMember(as_object& obj, const ObjectURI& uri, as_value& val,
+        MemberCache& cache);
+
+/// Set a member of an object, using an inline cache.
+//
+/// This behaves exactly like as_object::set_member.
+void setMember(as_object& obj, const ObjectURI& uri, const as_value& val,
+        MemberCache& cache);
+
+} // namespace gnash
+
+#endif
@@ -27,6 +27,7 @@
 #include <ostream>
 #include <memory>
 #include <boost/random.hpp> // for random generator
+#include <boost/lexical_cast.hpp>
 #include <cstdlib> 
 #include <cmath>
 #ifdef HAVE_SYS_UTSNAME_H
@@ -46,6 +47,9 @@
 
 namespace {
 gnash::RcInitFile& rcfile = gnash::RcInitFile::getDefaultInstance();
+
+/// Don't cache the keys of indices above this.
+const size_t maxCachedIndex = 65536;
 }
 
 namespace gnash {
@@ -59,7 +63,8 @@ VM::VM(movie_root& root, VirtualClock& clock)
 	_stack(),
     _shLib(new SharedObjectLibrary(*this)),
     _rng(clock.elapsed()),
-    _constantPool(nullptr)
+    _constantPool(nullptr),
+    _predecodeActions(rcfile.predecodeActions())
 {
 	NSV::loadStrings(_stringTable);
     _global->registerClasses();
@@ -70,6 +75,38 @@ VM::~VM()
 {
 }
 
+string_table::key
+VM::indexKey(size_t i)
+{
+    if (i >= maxCachedIndex) return _stringTable.find(std::to_string(i));
+
+    if (i >= _indexKeys.size()) _indexKeys.resize(i + 1, 0);
+
+    string_table::key& k = _indexKeys[i];
+    if (!k) k = _stringTable.find(std::to_string(i));
+    return k;
+}
+
+int
+VM::keyIndex(string_table::key k)
+{
+    if (k >= _keyIndices.size()) _keyIndices.resize(k + 1, -2);
+
+    int& index = _keyIndices[k];
+    if (index != -2) return index;
+
+    // Anything lexical_cast accepts as an int is an index, though
+    // negative ones are then ignored.
+    try {
+        index = boost::lexical_cast<int>(_stringTable.value(k));
+    }
+    catch (const boost::bad_lexical_cast&) {
+        index = -1;
+    }
+    if (index < 0) index = -1;
+    return index;
+}
+
 void
 VM::setSWFVersion(int v) 
 {
@@ -377,7 +414,8 @@ newAdd(as_value& op1, const as_value& op2, const VM& vm)
 		// use string semantic
 		const int version = vm.getSWFVersion();
 		convertToString(op1, vm);
-		op1.set_string(op1.to_string(version) + r.to_string(version));
+		op1.set_string(op1.to_shared_string(version) +
+                r.to_shared_string(version));
         return;
 	}
 
@@ -492,7 +530,7 @@ convertToNumber(as_value& v, const VM& vm)
 as_value&
 convertToString(as_value& v, const VM& vm)
 {
-    v.set_string(v.to_string(vm.getSWFVersion()));
+    v.set_string(v.to_shared_string(vm.getSWFVersion()));
     return v;
 }
 
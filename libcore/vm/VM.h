@@ -27,6 +27,7 @@
 #include <map>
 #include <memory> 
 #include <array>
+#include <vector>
 #include <cstdint>
 #include <boost/random/mersenne_twister.hpp>  // for mt11213b
 #include <boost/noncopyable.hpp>
@@ -248,6 +249,25 @@ public:
 
     const ConstantPool *getConstantPool() const { return _constantPool; }
 
+    /// Whether ActionExec should run code from its pre-decoded form
+    //
+    /// Defaults to the predecodeActions rcfile setting.
+    bool predecodeActions() const { return _predecodeActions; }
+
+    /// Switch between the pre-decoded and the classic interpreter.
+    void setPredecodeActions(bool x) { _predecodeActions = x; }
+
+    /// Return the key of the decimal representation of an array index.
+    //
+    /// Keys of small indices are cached, so that array element access
+    /// doesn't need to format and look up a string every time.
+    string_table::key indexKey(size_t i);
+
+    /// Return the array index a key represents, or -1 if it is none.
+    //
+    /// The result is cached for each key.
+    int keyIndex(string_table::key k);
+
 private:
 
 	/// Stage associated with this VM
@@ -281,6 +301,14 @@ private:
     RNG _rng;
 
     const ConstantPool* _constantPool;
+
+    bool _predecodeActions;
+
+    /// Keys of array indices, 0 for indices not looked up yet.
+    std::vector<string_table::key> _indexKeys;
+
+    /// Array indices of keys, -2 for keys not looked up yet.
+    std::vector<int> _keyIndices;
 };
 
 // @param lowerCaseHint if true the caller guarantees
@@ -142,6 +142,8 @@
 
 
 #include <vector>
+#include <string>
+#include <utility>
 #include <boost/noncopyable.hpp>
 
 #include "dsodefs.h" // for DSOEXPORT
@@ -196,6 +198,14 @@ public:
     /// Return a description of this renderer.
     virtual std::string description() const = 0;
 
+    /// Names and values describing how well the renderer's caches work.
+    typedef std::vector<std::pair<std::string, std::string> > CacheStats;
+
+    /// Report on the renderer's caches, for the movie info tree.
+    virtual CacheStats cacheStats() const {
+        return CacheStats();
+    }
+
     /// ==================================================================
     /// Interfaces for adjusting renderer output.
     /// ==================================================================
@@ -209,6 +219,8 @@ public:
     virtual void set_translation(float /*xoff*/, float /*yoff*/) {}
 
     void setQuality(Quality q) { _quality = q; }
+
+    Quality quality() const { return _quality; }
         
     /// ==================================================================
     /// Caching utitilies for core.
@@ -115,6 +115,15 @@ AGG resources
 #include <math.h> // We use round()!
 #include <climits>
 #include <functional>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <tuple>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <boost/noncopyable.hpp>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -157,6 +166,8 @@ AGG resources
 #include "FillStyle.h"
 #include "Transform.h"
 #include "IOChannel.h"
+#include "RenderCommands.h"
+#include "rc.h"
 
 #ifdef HAVE_VA_VA_H
 #include "GnashVaapiImage.h"
@@ -184,6 +195,34 @@ typedef std::vector<geometry::Range2d<int> > ClipBounds;
 typedef boost::ptr_vector<AlphaMask> AlphaMasks;
 typedef std::vector<Path> GnashPaths;
 
+/// Reads the vertices of an AGG path without changing it.
+//
+/// agg::path_storage keeps its read position itself, so bands of a
+/// threaded renderer drawing the same cached path read it through this.
+class PathReader
+{
+public:
+
+    explicit PathReader(const agg::path_storage& path)
+        :
+        _path(path),
+        _vertex(0)
+    {}
+
+    void rewind(unsigned path_id) {
+        _vertex = path_id;
+    }
+
+    unsigned vertex(double* x, double* y) {
+        if (_vertex >= _path.total_vertices()) return agg::path_cmd_stop;
+        return _path.vertex(_vertex++, x, y);
+    }
+
+private:
+    const agg::path_storage& _path;
+    unsigned _vertex;
+};
+
 // Note: this is here in case ::round doesn't exist. However, it's not
 // advisable to check using ifdefs (as previously), because ::round is
 // generally a function not a macro!
@@ -391,6 +430,376 @@ private:
     
 };
 
+// --- SHAPE AND GLYPH CACHES -------------------------------------------------
+// Drawing a subshape means copying and transforming its paths, converting
+// every edge to AGG path storage and building AGG styles for its fills. For
+// a shape whose definition and matrix don't change between frames, such as
+// a static background, the result is the same every time, so it is kept.
+// Entries are found by the shape's revision, which changes along with its
+// contents, the subshape index, and the transformation to the stage less
+// any whole pixels of translation. The scale, rotation and skew are fixed
+// point, so equal ones compare equal, and the rest of the translation is
+// in 1/20 pixels. A shape moving by whole pixels, such as a scrolling
+// one, thus finds its paths and only moves them when drawing. When the
+// cache grows past its limit, the least recently drawn entries are
+// dropped.
+//
+// Glyphs at a scale without rotation or skew are rasterized once into an
+// 8-bit coverage bitmap, which is then blended onto the stage in the text
+// color wherever the glyph appears. The glyph's revision identifies its
+// font and index. The scale is rounded to steps of about 0.3%, and the
+// position within a pixel to a quarter pixel.
+
+/// Identifies a subshape drawn with a particular transformation.
+struct ShapeKey
+{
+    std::uint64_t revision;
+    size_t subshape;
+
+    /// The transformation to 1/20 pixels, with a translation of less
+    /// than a pixel.
+    SWFMatrix mat;
+};
+
+inline bool
+operator<(const ShapeKey& a, const ShapeKey& b)
+{
+    return std::make_tuple(a.revision, a.subshape,
+            a.mat.a(), a.mat.b(), a.mat.c(), a.mat.d(), a.mat.tx(), a.mat.ty())
+        < std::make_tuple(b.revision, b.subshape,
+            b.mat.a(), b.mat.b(), b.mat.c(), b.mat.d(), b.mat.tx(), b.mat.ty());
+}
+
+/// The AGG styles built for a subshape's fills, and how they were built.
+struct KeptStyles
+{
+    KeptStyles() : quality(QUALITY_HIGH) {}
+
+    /// The fill styles, or null if they can't be kept.
+    //
+    /// Styles with bitmap fills are built for each drawing, as they point
+    /// to bitmap data that may be disposed of.
+    std::unique_ptr<StyleHandler> styles;
+
+    /// The color transform the styles were built with.
+    SWFCxForm cx;
+
+    /// The stage and object matrices the styles were built with.
+    SWFMatrix stage;
+    SWFMatrix mat;
+
+    /// The quality the styles were built with.
+    Quality quality;
+};
+
+/// A subshape converted for drawing with a particular transformation.
+struct ConvertedSubshape
+{
+    ConvertedSubshape()
+        :
+        haveShape(false),
+        haveOutline(false),
+        bytes(0)
+    {}
+
+    /// The paths, transformed by the key's matrix. They are still in
+    /// TWIPS, and are moved by whole pixels when drawn.
+    GnashPaths paths;
+
+    /// AGG paths for the fills.
+    AggPaths fills;
+
+    /// Pixel aligned AGG paths for the outlines.
+    AggPaths outlines;
+
+    bool haveShape;
+    bool haveOutline;
+
+    /// The styles of each band drawing the subshape.
+    //
+    /// AGG styles keep state while generating spans, so bands drawing
+    /// at the same time can't share them. Each band only uses its own.
+    std::vector<KeptStyles> styles;
+
+    /// An estimate of the memory used.
+    size_t bytes;
+};
+
+/// Estimate the memory used by Gnash paths.
+size_t
+pathBytes(const GnashPaths& paths)
+{
+    size_t bytes = paths.capacity() * sizeof(Path);
+    for (const Path& p : paths) bytes += p.m_edges.capacity() * sizeof(Edge);
+    return bytes;
+}
+
+/// Estimate the memory used by AGG paths.
+size_t
+pathBytes(const AggPaths& paths)
+{
+    // Each vertex is two coordinates and a command byte.
+    size_t bytes = paths.capacity() * sizeof(agg::path_storage);
+    for (const agg::path_storage& p : paths) {
+        bytes += p.total_vertices() * (2 * sizeof(double) + 1);
+    }
+    return bytes;
+}
+
+/// Identifies a glyph rasterized at a particular scale and subpixel offset.
+struct GlyphKey
+{
+    std::uint64_t revision;
+    int xScale;
+    int yScale;
+    int xOffset;
+    int yOffset;
+};
+
+inline bool
+operator<(const GlyphKey& a, const GlyphKey& b)
+{
+    return std::make_tuple(a.revision, a.xScale, a.yScale, a.xOffset,
+            a.yOffset) < std::make_tuple(b.revision, b.xScale, b.yScale,
+            b.xOffset, b.yOffset);
+}
+
+/// Where a glyph is drawn from the glyph cache.
+struct GlyphPlacement
+{
+    GlyphKey key;
+
+    /// Pixels per glyph unit.
+    double xScale;
+    double yScale;
+
+    /// The pixel of the glyph's origin.
+    int x;
+    int y;
+};
+
+/// The coverage of a rasterized glyph.
+struct GlyphBitmap
+{
+    /// The position of the bitmap relative to the glyph's origin pixel.
+    int left;
+    int top;
+
+    int width;
+    int height;
+
+    /// One byte per pixel, row by row.
+    std::vector<std::uint8_t> coverage;
+
+    /// The memory used.
+    size_t bytes;
+};
+
+/// Least recently used cache.
+//
+/// @tparam Value   Anything with a bytes member giving the memory it uses.
+template<typename Key, typename Value>
+class LRUCache : boost::noncopyable
+{
+public:
+
+    /// @param limit    The memory in bytes the values may use.
+    explicit LRUCache(size_t limit)
+        :
+        _limit(limit),
+        _bytes(0)
+    {}
+
+    /// Find a value, making it the most recently used.
+    //
+    /// @return     The value, or null if it isn't cached.
+    Value* get(const Key& key) {
+        const typename Index::iterator it = _index.find(key);
+        if (it == _index.end()) return nullptr;
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return it->second->second.get();
+    }
+
+    /// Find a value without changing the cache.
+    //
+    /// Values found this way can be used from several threads at once,
+    /// as long as nothing is added meanwhile.
+    ///
+    /// @return     The value, or null if it isn't cached.
+    Value* find(const Key& key) const {
+        const typename Index::const_iterator it = _index.find(key);
+        if (it == _index.end()) return nullptr;
+        return it->second->second.get();
+    }
+
+    /// Add a value, dropping the least recently used ones if needed.
+    //
+    /// The value stays cached even if it is larger than the limit, until
+    /// the next one is added.
+    Value& add(const Key& key, std::unique_ptr<Value> v) {
+
+        _bytes += v->bytes;
+        _entries.push_front(Entry(key, std::move(v)));
+        _index[key] = _entries.begin();
+
+        while (_bytes > _limit && _entries.size() > 1) {
+            const Entry& last = _entries.back();
+            _bytes -= last.second->bytes;
+            _index.erase(last.first);
+            _entries.pop_back();
+        }
+        return *_entries.front().second;
+    }
+
+private:
+
+    typedef std::pair<Key, std::unique_ptr<Value> > Entry;
+
+    /// The most recently used first.
+    typedef std::list<Entry> Entries;
+
+    typedef std::map<Key, typename Entries::iterator> Index;
+
+    const size_t _limit;
+    size_t _bytes;
+    Entries _entries;
+    Index _index;
+};
+
+typedef LRUCache<ShapeKey, ConvertedSubshape> ShapeCache;
+typedef LRUCache<GlyphKey, GlyphBitmap> GlyphCache;
+
+/// The memory the shape cache of a renderer may use.
+const size_t shapeCacheLimit = 16 * 1024 * 1024;
+
+/// The memory the glyph cache of a renderer may use.
+const size_t glyphCacheLimit = 4 * 1024 * 1024;
+
+/// What a renderer keeps between drawings, or the bands of a threaded one.
+struct RendererCaches : boost::noncopyable
+{
+    RendererCaches()
+        :
+        shapes(shapeCacheLimit),
+        glyphs(glyphCacheLimit)
+    {}
+
+    /// Subshapes converted for drawing.
+    ShapeCache shapes;
+
+    /// Glyphs rasterized for drawing.
+    GlyphCache glyphs;
+
+    /// Gradient colors interpolated for drawing.
+    GradientTables gradients;
+};
+
+/// Glyph scales are rounded to this many steps per doubling.
+const double glyphScaleSteps = 256;
+
+/// Glyph positions are rounded to this many steps per pixel.
+const int glyphSubpixels = 4;
+
+/// Glyphs larger than this many pixels across are drawn as shapes.
+const double maxCachedGlyphSize = 128;
+
+/// A rough size of the AGG style built for a fill.
+const size_t styleBytes = 1024;
+
+/// Describe how often gradient tables were reused, see
+/// Renderer::cacheStats().
+Renderer::CacheStats
+gradientTableStats(std::uint64_t hits, std::uint64_t misses)
+{
+    std::ostringstream os;
+    os << hits << "/" << hits + misses;
+    return Renderer::CacheStats(1,
+            std::make_pair("Gradient table hits", os.str()));
+}
+
+/// Whether AGG styles for fills can be kept between drawings.
+bool
+cacheableStyles(const std::vector<FillStyle>& fills)
+{
+    for (const FillStyle& f : fills) {
+        if (boost::get<BitmapFill>(&f.fill)) return false;
+    }
+    return true;
+}
+
+/// Rasterize a glyph's coverage.
+//
+/// Paths are filled like drawGlyph() fills them, with the non-zero
+/// rule and the same offset as buildPaths().
+///
+/// @param xScale   Horizontal pixels per glyph unit.
+/// @param yScale   Vertical pixels per glyph unit.
+/// @param dx       Horizontal position of the origin within its pixel.
+/// @param dy       Vertical position of the origin within its pixel.
+std::unique_ptr<GlyphBitmap>
+rasterizeGlyph(const SWF::ShapeRecord& shape, double xScale, double yScale,
+        double dx, double dy)
+{
+    const SWFRect& bounds = shape.getBounds();
+
+    std::unique_ptr<GlyphBitmap> g(new GlyphBitmap);
+
+    // Leave a pixel on each side for antialiasing.
+    g->left = std::floor(bounds.get_x_min() * xScale + dx) - 1;
+    g->top = std::floor(bounds.get_y_min() * yScale + dy) - 1;
+    g->width = std::ceil(bounds.get_x_max() * xScale + dx) + 2 - g->left;
+    g->height = std::ceil(bounds.get_y_max() * yScale + dy) + 2 - g->top;
+    g->coverage.resize(g->width * g->height);
+    g->bytes = sizeof(GlyphBitmap) + g->coverage.size();
+
+    agg::rendering_buffer rbuf(g->coverage.data(), g->width, g->height,
+            g->width);
+    agg::pixfmt_gray8 pixf(rbuf);
+    agg::renderer_base<agg::pixfmt_gray8> rbase(pixf);
+
+    const agg::trans_affine mtx(xScale, 0, 0, yScale,
+            dx - g->left + 0.05, dy - g->top + 0.05);
+
+    typedef agg::conv_transform<agg::path_storage> Transformed;
+    agg::path_storage path;
+    Transformed transformed(path, mtx);
+    agg::conv_curve<Transformed> curve(transformed);
+
+    agg::rasterizer_compound_aa<agg::rasterizer_sl_clip_int> rasc;
+    rasc.filling_rule(agg::fill_non_zero);
+
+    for (const Path& p : shape.subshapes().front().paths()) {
+
+        if (!p.m_fill0 && !p.m_fill1) continue;
+
+        path.remove_all();
+        rasc.styles(p.m_fill0 ? 0 : -1, p.m_fill1 ? 0 : -1);
+
+        path.move_to(p.ap.x, p.ap.y);
+        for (const Edge& e : p.m_edges) {
+            if (e.straight()) path.line_to(e.ap.x, e.ap.y);
+            else path.curve3(e.cp.x, e.cp.y, e.ap.x, e.ap.y);
+        }
+        rasc.add_path(curve);
+    }
+
+    agg::scanline_u8 sl;
+    agg::span_allocator<agg::gray8> alloc;
+    agg_mask_style_handler sh;
+    agg::render_scanlines_compound_layered(rasc, sl, rbase, alloc, sh);
+
+    return g;
+}
+
+/// Rasterize a glyph's coverage for where it is placed.
+std::unique_ptr<GlyphBitmap>
+rasterizeGlyph(const SWF::ShapeRecord& shape, const GlyphPlacement& p)
+{
+    return rasterizeGlyph(shape, p.xScale, p.yScale,
+            static_cast<double>(p.key.xOffset) / glyphSubpixels,
+            static_cast<double>(p.key.yOffset) / glyphSubpixels);
+}
+
 /// Class for rendering lines.
 template<typename PixelFormat>
 class LineRenderer
@@ -677,6 +1086,66 @@ public:
         return "AGG";
     }
 
+    CacheStats cacheStats() const {
+        return gradientTableStats(_caches->gradients.hits(),
+                _caches->gradients.misses());
+    }
+
+    /// Use caches shared with the other bands of a threaded renderer.
+    //
+    /// Shapes and glyphs are then only looked up while drawing, so that
+    /// the bands can draw at the same time; prepareShape() and
+    /// prepareGlyph() add them before. Any that aren't found are
+    /// converted for that drawing only.
+    ///
+    /// @param slot     Which of the styles kept with a converted subshape
+    ///                 this band uses, less than the number of bands.
+    void shareCaches(RendererCaches& caches, size_t slot) {
+        _caches = &caches;
+        _slot = slot;
+        _shared = true;
+    }
+
+    /// Convert a shape's subshapes for drawing, unless they are cached.
+    //
+    /// @param slots    The number of bands that will draw it.
+    void prepareShape(const SWF::ShapeRecord& shape, const SWFMatrix& mat,
+            size_t slots)
+    {
+        if (!_cachesEnabled) return;
+
+        const SWF::ShapeRecord::Subshapes& subshapes = shape.subshapes();
+        for (size_t i = 0; i < subshapes.size(); ++i) {
+
+            int dx, dy;
+            const ShapeKey key = shapeKey(shape.revision(), i, mat, dx, dy);
+
+            if (ConvertedSubshape* s = _caches->shapes.get(key)) {
+                if (s->styles.size() < slots) s->styles.resize(slots);
+                continue;
+            }
+
+            const SWF::Subshape& subshape = subshapes[i];
+            _caches->shapes.add(key, convertSubshape(subshape.fillStyles(),
+                        subshape.lineStyles(), subshape.paths(), key.mat,
+                        slots));
+        }
+    }
+
+    /// Rasterize a glyph for drawing, unless it is cached or drawn as a
+    /// shape.
+    void prepareGlyph(const SWF::ShapeRecord& shape, const SWFMatrix& mat)
+    {
+        if (!_cachesEnabled || shape.subshapes().empty() ||
+                shape.getBounds().is_null()) {
+            return;
+        }
+
+        GlyphPlacement p;
+        if (!placeGlyph(shape, mat, p) || _caches->glyphs.get(p.key)) return;
+        _caches->glyphs.add(p.key, rasterizeGlyph(shape, p));
+    }
+
     // Given an image, returns a pointer to a bitmap_info class
     // that can later be passed to FillStyleX_bitmap(), to set a
     // bitmap fill style.
@@ -802,7 +1271,12 @@ public:
       yres(1),
       bpp(bits_per_pixel),
       scale_set(false),
-      m_drawing_mask(false)
+      m_drawing_mask(false),
+      _band(geometry::worldRange),
+      _caches(&_ownCaches),
+      _slot(0),
+      _shared(false),
+      _cachesEnabled(RcInitFile::getDefaultInstance().rendererCaches())
   {
     // TODO: we really don't want to set the scale here as the core should
     // tell us the right values before rendering anything. However this is
@@ -1028,6 +1502,11 @@ public:
     select_clipbounds(shape.getBounds(), mat);
     
     if (_clipbounds_selected.empty()) return; 
+
+    if (!m_drawing_mask && drawCachedGlyph(shape, color, mat)) {
+      _clipbounds_selected.clear();
+      return;
+    }
       
     GnashPaths paths;
     apply_matrix_to_path(shape.subshapes().front().paths(), paths, mat);
@@ -1057,6 +1536,129 @@ public:
   }
 
 
+  /// Draw a glyph from the glyph cache, rasterizing it first if needed.
+  //
+  /// With the caches disabled the glyph is rasterized the same way, but
+  /// only for this drawing.
+  ///
+  /// @return   false if the glyph is rotated, skewed, flipped or too
+  ///           large, and should be drawn as a shape.
+  bool drawCachedGlyph(const SWF::ShapeRecord& shape, const rgba& color,
+          const SWFMatrix& mat)
+  {
+    GlyphPlacement p;
+    if (!placeGlyph(shape, mat, p)) return false;
+
+    std::unique_ptr<GlyphBitmap> own;
+    const GlyphBitmap* g = nullptr;
+    if (_cachesEnabled) {
+      g = _shared ? _caches->glyphs.find(p.key) : _caches->glyphs.get(p.key);
+    }
+    if (!g) {
+      own = rasterizeGlyph(shape, p);
+      g = own.get();
+      if (_cachesEnabled && !_shared) {
+        g = &_caches->glyphs.add(p.key, std::move(own));
+      }
+    }
+
+    blendGlyph(*g, p.x + g->left, p.y + g->top, color);
+    return true;
+  }
+
+  /// Find where a glyph is drawn from the glyph cache.
+  //
+  /// @return   false if the glyph is rotated, skewed, flipped or too
+  ///           large, and should be drawn as a shape.
+  bool placeGlyph(const SWF::ShapeRecord& shape, const SWFMatrix& mat,
+          GlyphPlacement& p) const
+  {
+    // The transformation apply_matrix_to_path() uses, in 1/20 pixels.
+    SWFMatrix m;
+    m.concatenate_scale(20.0, 20.0);
+    m.concatenate(stage_matrix);
+    m.concatenate(mat);
+
+    if (m.b() || m.c() || m.a() <= 0 || m.d() <= 0) return false;
+
+    const int xBucket = std::lround(
+            std::log2(m.a() / 65536.0 / 20) * glyphScaleSteps);
+    const int yBucket = std::lround(
+            std::log2(m.d() / 65536.0 / 20) * glyphScaleSteps);
+
+    const double xScale = std::exp2(xBucket / glyphScaleSteps);
+    const double yScale = std::exp2(yBucket / glyphScaleSteps);
+
+    const SWFRect& bounds = shape.getBounds();
+    if (bounds.width() * xScale > maxCachedGlyphSize ||
+            bounds.height() * yScale > maxCachedGlyphSize) {
+      return false;
+    }
+
+    const double x = m.tx() / 20.0;
+    const double y = m.ty() / 20.0;
+
+    int px = std::floor(x);
+    int py = std::floor(y);
+    int xOffset = std::lround((x - px) * glyphSubpixels);
+    int yOffset = std::lround((y - py) * glyphSubpixels);
+    if (xOffset == glyphSubpixels) {
+      ++px;
+      xOffset = 0;
+    }
+    if (yOffset == glyphSubpixels) {
+      ++py;
+      yOffset = 0;
+    }
+
+    const GlyphKey key = { shape.revision(), xBucket, yBucket, xOffset,
+      yOffset };
+
+    p.key = key;
+    p.xScale = xScale;
+    p.yScale = yScale;
+    p.x = px;
+    p.y = py;
+    return true;
+  }
+
+  /// Blend a glyph's coverage in the given color into the selected
+  /// clipping bounds, through the active mask if any.
+  void blendGlyph(const GlyphBitmap& g, int x, int y, const rgba& color)
+  {
+    const agg::rgba8 c = agg::rgba8_pre(color.m_r, color.m_g, color.m_b,
+            color.m_a);
+
+    std::vector<agg::int8u> covers;
+
+    for (const geometry::Range2d<int>* bounds : _clipbounds_selected) {
+
+      const int minX = std::max(x, bounds->getMinX());
+      const int maxX = std::min(x + g.width - 1, bounds->getMaxX());
+      const int minY = std::max(y, bounds->getMinY());
+      const int maxY = std::min(y + g.height - 1, bounds->getMaxY());
+
+      if (minX > maxX || minY > maxY) continue;
+
+      const int len = maxX - minX + 1;
+
+      for (int row = minY; row <= maxY; ++row) {
+
+        const agg::int8u* src =
+          &g.coverage[(row - y) * g.width + (minX - x)];
+
+        if (!_alphaMasks.empty()) {
+          covers.assign(src, src + len);
+          _alphaMasks.back().getMask().combine_hspan(minX, row,
+                  covers.data(), len);
+          src = covers.data();
+        }
+
+        m_rbase->blend_solid_hspan(minX, row, len, c, src);
+      }
+    }
+  }
+
   /// Fills _clipbounds_selected with pointers to _clipbounds members who
   /// intersect with the given character (transformed by mat). This avoids
   /// rendering of characters outside a particular clipping range.
@@ -1116,7 +1718,11 @@ public:
             return; // no need to draw
         }
 
-        for (const SWF::Subshape& subshape : shape.subshapes()) {
+        const SWF::ShapeRecord::Subshapes& subshapes = shape.subshapes();
+
+        for (size_t i = 0; i < subshapes.size(); ++i) {
+
+            const SWF::Subshape& subshape = subshapes[i];
 
             const SWF::ShapeRecord::FillStyles& fillStyles = subshape.fillStyles();
             const SWF::ShapeRecord::LineStyles& lineStyles = subshape.lineStyles();
@@ -1126,53 +1732,78 @@ public:
             select_clipbounds(shape.getBounds(), xform.matrix);
 
             // render the DisplayObject's subshape.
-            drawShape(fillStyles, lineStyles, paths, xform.matrix,
-                      xform.colorTransform);
+            drawShape(shape.revision(), i, fillStyles, lineStyles, paths,
+                      xform.matrix, xform.colorTransform);
         }
     }
 
-    void drawShape(const std::vector<FillStyle>& FillStyles,
+    /// The cache key of a subshape drawn with a matrix.
+    //
+    /// @param dx   Set to the whole pixels the converted paths are moved
+    ///             right by when drawn.
+    /// @param dy   Set to the whole pixels they are moved down by.
+    ShapeKey shapeKey(std::uint64_t revision, size_t subshape,
+        const SWFMatrix& mat, int& dx, int& dy) const
+    {
+        // The transformation apply_matrix_to_path() uses, in 1/20 pixels.
+        SWFMatrix m;
+        m.concatenate_scale(20.0, 20.0);
+        m.concatenate(stage_matrix);
+        m.concatenate(mat);
+
+        // The whole pixels of the translation are left out of the key.
+        dx = std::floor(m.tx() / 20.0);
+        dy = std::floor(m.ty() / 20.0);
+        m.set_translation(m.tx() - dx * 20, m.ty() - dy * 20);
+
+        const ShapeKey key = { revision, subshape, m };
+        return key;
+    }
+
+    void drawShape(std::uint64_t revision, size_t subshape,
+        const std::vector<FillStyle>& FillStyles,
         const std::vector<LineStyle>& line_styles,
         const std::vector<Path>& objpaths, const SWFMatrix& mat,
         const SWFCxForm& cx)
     {
+        int dx, dy;
+        const ShapeKey key = shapeKey(revision, subshape, mat, dx, dy);
+
+        // Subshapes that aren't cached are converted for this drawing only.
+        std::unique_ptr<ConvertedSubshape> own;
+        ConvertedSubshape* converted = nullptr;
+        if (_cachesEnabled) {
+            converted = _shared ? _caches->shapes.find(key) :
+                _caches->shapes.get(key);
+        }
+        if (!converted) {
+            own = convertSubshape(FillStyles, line_styles, objpaths, key.mat,
+                    _slot + 1);
+            converted = own.get();
+            if (_cachesEnabled && !_shared) {
+                converted = &_caches->shapes.add(key, std::move(own));
+            }
+        }
 
-        bool have_shape, have_outline;
+        const agg::trans_affine_translation move(dx, dy);
 
-        analyzePaths(objpaths, have_shape, have_outline);
+        const ConvertedSubshape& s = *converted;
 
-        if (!have_shape && !have_outline) {
+        if (!s.haveShape && !s.haveOutline) {
             // Early return for invisible character.
             return; 
         }
 
-        GnashPaths paths;
-        apply_matrix_to_path(objpaths, paths, mat);
-
         // Masks apparently do not use agg_paths, so return
         // early
         if (m_drawing_mask) {
 
             // Shape is drawn inside a mask, skip sub-shapes handling and
             // outlines
-            draw_mask_shape(paths, false); 
+            draw_mask_shape(s.paths, false, move); 
             return;
         }
 
-        AggPaths agg_paths;    
-        AggPaths agg_paths_rounded;    
-
-        // Flash only aligns outlines. Probably this is done at rendering
-        // level.
-        if (have_outline) {
-            buildPaths_rounded(agg_paths_rounded, paths, line_styles);     
-        }
-
-        if (have_shape) {
-            buildPaths(agg_paths, paths);
-        }
-        
-
         if (_clipbounds_selected.empty()) {
 #ifdef GNASH_WARN_WHOLE_CHARACTER_SKIP
             log_debug("Warning: AGG renderer skipping a whole character");
@@ -1180,21 +1811,87 @@ public:
             return; 
         }
 
-        // prepare fill styles
-        StyleHandler sh;
-        if (have_shape) build_agg_styles(sh, FillStyles, mat, cx);
+        if (s.haveShape) {
+            StyleHandler sh;
+            draw_shape(s.paths, s.fills,
+                    subshapeStyles(converted->styles[_slot], FillStyles, mat,
+                        cx, sh), true, move);
+        }
+        if (s.haveOutline) {
+            draw_outlines(s.paths, s.outlines, line_styles, cx, mat, move);
+        }
+
+        // Clear selected clipbounds to ease debugging 
+        _clipbounds_selected.clear();
+    }
+
+    /// Transform a subshape's paths and convert them to AGG paths.
+    //
+    /// @param mat      The transformation to 1/20 pixels.
+    /// @param slots    The number of bands that will draw it.
+    std::unique_ptr<ConvertedSubshape> convertSubshape(
+        const std::vector<FillStyle>& FillStyles,
+        const std::vector<LineStyle>& line_styles,
+        const std::vector<Path>& objpaths, const SWFMatrix& mat,
+        size_t slots)
+    {
+        std::unique_ptr<ConvertedSubshape> s(new ConvertedSubshape);
+        s->styles.resize(slots);
+
+        analyzePaths(objpaths, s->haveShape, s->haveOutline);
+
+        if (s->haveShape || s->haveOutline) {
 
+            s->paths = objpaths;
+            for (Path& p : s->paths) p.transform(mat);
 
-            if (have_shape) {
-                draw_shape(paths, agg_paths, sh, true);        
+            // Flash only aligns outlines. Probably this is done at rendering
+            // level.
+            if (s->haveOutline) {
+                buildPaths_rounded(s->outlines, s->paths, line_styles);
             }
-            if (have_outline)            {
-                draw_outlines(paths, agg_paths_rounded,
-                        line_styles, cx, mat);
+
+            if (s->haveShape) {
+                buildPaths(s->fills, s->paths);
             }
+        }
 
-        // Clear selected clipbounds to ease debugging 
-        _clipbounds_selected.clear();
+        s->bytes = sizeof(ConvertedSubshape) + pathBytes(s->paths) +
+            pathBytes(s->fills) + pathBytes(s->outlines) +
+            FillStyles.size() * styleBytes * slots;
+
+        return s;
+    }
+
+    /// The AGG styles for a converted subshape's fills.
+    //
+    /// Styles kept with the subshape are used if they were built for the
+    /// same color transform and quality. Otherwise they are built again,
+    /// and kept if possible.
+    ///
+    /// @param s    This band's styles of the subshape.
+    /// @param sh   Where to build styles that can't be kept.
+    StyleHandler& subshapeStyles(KeptStyles& s,
+        const std::vector<FillStyle>& FillStyles, const SWFMatrix& mat,
+        const SWFCxForm& cx, StyleHandler& sh)
+    {
+        if (s.styles && s.cx == cx && s.quality == _quality &&
+                s.stage == stage_matrix && s.mat == mat) {
+            return *s.styles;
+        }
+
+        if (!cacheableStyles(FillStyles)) {
+            build_agg_styles(sh, FillStyles, mat, cx);
+            return sh;
+        }
+
+        s.styles.reset(new StyleHandler);
+        s.cx = cx;
+        s.stage = stage_matrix;
+        s.mat = mat;
+        s.quality = _quality;
+        build_agg_styles(*s.styles, FillStyles, mat, cx);
+        return *s.styles;
     }
 
     /// Takes a path and translates it using the given SWFMatrix. The new path
@@ -1385,7 +2082,7 @@ public:
 
         for (size_t fno = 0; fno < fcount; ++fno) {
             const AddStyles st(stage_matrix, fillstyle_matrix, cx, sh,
-                    _quality);
+                    _caches->gradients, _quality);
             boost::apply_visitor(st, FillStyles[fno].fill);
         } 
     } 
@@ -1406,9 +2103,14 @@ public:
   /// @param subshape_id
   ///    Defines which subshape to draw. -1 means all subshapes.
   ///
+  ///
+  /// @param move
+  ///    Applied to the AGG paths as they are drawn.
+  ///
   void draw_shape(const GnashPaths &paths,
     const AggPaths& agg_paths,  
-    StyleHandler& sh, bool even_odd) {
+    StyleHandler& sh, bool even_odd,
+    const agg::trans_affine& move = agg::trans_affine()) {
     
     if (_alphaMasks.empty()) {
     
@@ -1419,7 +2121,7 @@ public:
       scanline_type sl;
       
       draw_shape_impl<scanline_type> (paths, agg_paths, 
-        sh, even_odd, sl);
+        sh, even_odd, move, sl);
         
     } else {
     
@@ -1430,7 +2132,7 @@ public:
       scanline_type sl(_alphaMasks.back().getMask());
       
       draw_shape_impl<scanline_type> (paths, agg_paths, 
-        sh, even_odd, sl);
+        sh, even_odd, move, sl);
         
     }
     
@@ -1442,7 +2144,8 @@ public:
   template <class scanline_type>
   void draw_shape_impl(const GnashPaths &paths,
     const AggPaths& agg_paths,
-    StyleHandler& sh, bool even_odd, scanline_type& sl) {
+    StyleHandler& sh, bool even_odd, const agg::trans_affine& move,
+    scanline_type& sl) {
     /*
     Fortunately, AGG provides a rasterizer that fits perfectly to the flash
     data model. So we just have to feed AGG with all data and we're done. :-)
@@ -1486,10 +2189,10 @@ public:
       for (size_t pno=0; pno<pcount; ++pno) {
           
         const Path &this_path_gnash = paths[pno];
-        agg::path_storage &this_path_agg = 
-          const_cast<agg::path_storage&>(agg_paths[pno]);
+        PathReader this_path_agg(agg_paths[pno]);
         
-        agg::conv_curve<agg::path_storage> curve(this_path_agg);        
+        agg::conv_transform<PathReader> moved(this_path_agg, move);
+        agg::conv_curve<agg::conv_transform<PathReader> > curve(moved);
 
         if ((this_path_gnash.m_fill0==0) && (this_path_gnash.m_fill1==0)) {
           // Skip this path as it contains no fill style
@@ -1517,7 +2220,8 @@ public:
 
   // very similar to draw_shape but used for generating masks. There are no
   // fill styles nor subshapes and such. Just render plain solid shapes.
-  void draw_mask_shape(const GnashPaths& paths, bool even_odd)
+  void draw_mask_shape(const GnashPaths& paths, bool even_odd,
+    const agg::trans_affine& move = agg::trans_affine())
   {
 
     const AlphaMasks::size_type mask_count = _alphaMasks.size();
@@ -1530,7 +2234,7 @@ public:
       
       scanline_type sl;
       
-      draw_mask_shape_impl(paths, even_odd, sl);
+      draw_mask_shape_impl(paths, even_odd, move, sl);
         
     }
     else {
@@ -1542,7 +2246,7 @@ public:
       
       scanline_type sl(_alphaMasks[mask_count - 2].getMask());
       
-      draw_mask_shape_impl(paths, even_odd, sl);
+      draw_mask_shape_impl(paths, even_odd, move, sl);
         
     }
     
@@ -1551,7 +2255,7 @@ public:
   
   template <class scanline_type>
   void draw_mask_shape_impl(const GnashPaths& paths, bool even_odd,
-    scanline_type& sl) {
+    const agg::trans_affine& move, scanline_type& sl) {
     
     typedef agg::pixfmt_gray8 pixfmt;
     typedef agg::renderer_base<pixfmt> renderer_base;
@@ -1573,7 +2277,8 @@ public:
       
     // push paths to AGG
     agg::path_storage path; 
-    agg::conv_curve<agg::path_storage> curve(path);
+    agg::conv_transform<agg::path_storage> moved(path, move);
+    agg::conv_curve<agg::conv_transform<agg::path_storage> > curve(moved);
 
     for (const Path& this_path : paths) {
 
@@ -1615,7 +2320,8 @@ public:
   void draw_outlines(const GnashPaths &paths,
     const AggPaths& agg_paths,
     const std::vector<LineStyle> &line_styles, const SWFCxForm& cx,
-    const SWFMatrix& linestyle_matrix) {
+    const SWFMatrix& linestyle_matrix,
+    const agg::trans_affine& move = agg::trans_affine()) {
     
     if (_alphaMasks.empty()) {
     
@@ -1626,7 +2332,7 @@ public:
       scanline_type sl;
       
       draw_outlines_impl<scanline_type> (paths, agg_paths, 
-        line_styles, cx, linestyle_matrix, sl);
+        line_styles, cx, linestyle_matrix, move, sl);
         
     } else {
     
@@ -1637,7 +2343,7 @@ public:
       scanline_type sl(_alphaMasks.back().getMask());
       
       draw_outlines_impl<scanline_type> (paths, agg_paths,
-        line_styles, cx, linestyle_matrix, sl);
+        line_styles, cx, linestyle_matrix, move, sl);
         
     }
     
@@ -1649,7 +2355,8 @@ public:
   void draw_outlines_impl(const GnashPaths &paths,
     const AggPaths& agg_paths,
     const std::vector<LineStyle> &line_styles, const SWFCxForm& cx, 
-    const SWFMatrix& linestyle_matrix, scanline_type& sl) {
+    const SWFMatrix& linestyle_matrix, const agg::trans_affine& move,
+    scanline_type& sl) {
     
     assert(m_pixf.get());
 
@@ -1685,16 +2392,17 @@ public:
 
         const Path& this_path_gnash = paths[pno];
 
-        agg::path_storage &this_path_agg = 
-          const_cast<agg::path_storage&>(agg_paths[pno]);
+        PathReader this_path_agg(agg_paths[pno]);
         
         if (this_path_gnash.m_line==0) {
           // Skip this path as it contains no line style
           continue;
         } 
         
-        agg::conv_curve< agg::path_storage > curve(this_path_agg); // to render curves
-        agg::conv_stroke< agg::conv_curve < agg::path_storage > > 
+        typedef agg::conv_transform<PathReader> Moved;
+        Moved moved(this_path_agg, move);
+        agg::conv_curve<Moved> curve(moved); // to render curves
+        agg::conv_stroke<agg::conv_curve<Moved> > 
           stroke(curve);  // to get an outline
 
         const LineStyle& lstyle = line_styles[this_path_gnash.m_line-1];
@@ -1920,6 +2628,7 @@ public:
     //       xres/yres.
     Range2d<int> visiblerect;
     if ( xres && yres ) visiblerect = Range2d<int>(0, 0, xres-1, yres-1);
+    visiblerect = Intersection(visiblerect, _band);
     
     for (size_t rno=0; rno<ranges.size(); ++rno) {
     
@@ -1985,6 +2694,15 @@ public:
   virtual unsigned int getBytesPerPixel() const {
     return bpp/8;
   }  
+
+  /// Only draw the given rows of the buffer.
+  //
+  /// This takes effect with the next set_invalidated_regions() or
+  /// init_buffer().
+  void setBand(int top, int bottom) {
+    if (top > bottom) _band.setNull();
+    else _band = geometry::Range2d<int>(0, top, INT_MAX, bottom);
+  }
   
 private:  // private variables
     
@@ -2013,17 +2731,355 @@ private:  // private variables
     // this flag is set while a mask is drawn
     bool m_drawing_mask; 
 
+    /// The rows drawn, see setBand().
+    geometry::Range2d<int> _band;
+
     // Alpha mask stack
     AlphaMasks _alphaMasks;
     
     /// Cached fill style list with just one entry used for font rendering
     std::vector<FillStyle> m_single_FillStyles;
 
+    /// The caches of this renderer, unless it shares those of others.
+    RendererCaches _ownCaches;
+
+    /// The caches used, see shareCaches().
+    RendererCaches* _caches;
+
+    /// Which of the styles kept with a converted subshape are this band's.
+    size_t _slot;
+
+    /// Whether the caches are shared, and only looked up while drawing.
+    bool _shared;
+
+    /// Whether shapes and glyphs are cached, see
+    /// RcInitFile::rendererCaches().
+    const bool _cachesEnabled;
+
 
 };
 
 
 
+
+// --- THREADED RENDERING ------------------------------------------------------
+// With more than one render thread, the calls drawing a frame are recorded
+// between begin_display() and end_display(). The stage is split into as
+// many horizontal bands as there are threads, each drawn by a Renderer_agg
+// clipped to it, and end_display() has every thread replay the recorded
+// calls on its band. Clipping to integer bounds doesn't change the pixels
+// AGG renders inside them, so the frame is the same as when drawn on one
+// thread.
+//
+// The renderers share the frame buffer and their caches, but have their
+// own masks. Before the bands are drawn, the calling thread converts the
+// shapes and rasterizes the glyphs of the frame into the caches, once for
+// all bands; the bands then only look them up. Each band keeps its own AGG
+// styles with a converted subshape, as they can't be used by two threads
+// at once. Gradient tables are shared under a lock.
+
+template <class PixelFormat>
+class Renderer_agg_threaded : public Renderer_agg_base
+{
+public:
+
+    typedef Renderer_agg<PixelFormat> Band;
+
+    /// @param threads  The number of bands, and of threads drawing them,
+    ///                 including the one calling end_display().
+    Renderer_agg_threaded(int bits_per_pixel, unsigned threads)
+        :
+        _inFrame(false),
+        _generation(0),
+        _pending(0),
+        _stop(false)
+    {
+        for (unsigned i = 0; i < threads; ++i) {
+            _bands.push_back(new Band(bits_per_pixel));
+            _bands.back().shareCaches(_caches, i);
+        }
+        for (size_t i = 1; i < _bands.size(); ++i) {
+            _threads.push_back(std::thread(
+                        &Renderer_agg_threaded::drawBands, this, i));
+        }
+    }
+
+    ~Renderer_agg_threaded() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wakeup.notify_all();
+        for (std::thread& t : _threads) t.join();
+    }
+
+    std::string description() const {
+        return "AGG";
+    }
+
+    CacheStats cacheStats() const {
+        return _bands.front().cacheStats();
+    }
+
+    CachedBitmap* createCachedBitmap(std::unique_ptr<image::GnashImage> im) {
+        return _bands.front().createCachedBitmap(std::move(im));
+    }
+
+    void init_buffer(unsigned char *mem, int size, int x, int y,
+            int rowstride) {
+        const int count = _bands.size();
+        for (int i = 0; i < count; ++i) {
+            _bands[i].setBand(y * i / count, y * (i + 1) / count - 1);
+            _bands[i].init_buffer(mem, size, x, y, rowstride);
+        }
+    }
+
+    unsigned int getBytesPerPixel() const {
+        return _bands.front().getBytesPerPixel();
+    }
+
+    void set_scale(float xscale, float yscale) {
+        for (Band& b : _bands) b.set_scale(xscale, yscale);
+    }
+
+    void set_translation(float xoff, float yoff) {
+        for (Band& b : _bands) b.set_translation(xoff, yoff);
+    }
+
+    void set_invalidated_regions(const InvalidatedRanges& ranges) {
+        for (Band& b : _bands) b.set_invalidated_regions(ranges);
+    }
+
+    void drawVideoFrame(image::GnashImage* frame, const Transform& xform,
+            const SWFRect* bounds, bool smooth) {
+        _commands.drawVideoFrame(frame, xform, bounds, smooth);
+        if (!_inFrame) draw();
+    }
+
+    void drawLine(const std::vector<point>& coords, const rgba& color,
+            const SWFMatrix& mat) {
+        _commands.drawLine(coords, color, mat);
+        if (!_inFrame) draw();
+    }
+
+    void draw_poly(const std::vector<point>& corners, const rgba& fill,
+            const rgba& outline, const SWFMatrix& mat, bool masked) {
+        _commands.drawPoly(corners, fill, outline, mat, masked);
+        if (!_inFrame) draw();
+    }
+
+    void drawShape(const SWF::ShapeRecord& shape, const Transform& xform) {
+        _commands.drawShape(shape, xform);
+        if (!_inFrame) draw();
+    }
+
+    void drawGlyph(const SWF::ShapeRecord& rec, const rgba& color,
+            const SWFMatrix& mat) {
+        _commands.drawGlyph(rec, color, mat);
+        if (!_inFrame) draw();
+    }
+
+    void begin_submit_mask() {
+        _commands.mask(RenderCommands::Mask::BEGIN_SUBMIT);
+    }
+
+    void end_submit_mask() {
+        _commands.mask(RenderCommands::Mask::END_SUBMIT);
+    }
+
+    void disable_mask() {
+        _commands.mask(RenderCommands::Mask::DISABLE);
+    }
+
+    void renderToImage(std::unique_ptr<IOChannel> io, FileType type,
+            int quality) const {
+        _bands.front().renderToImage(std::move(io), type, quality);
+    }
+
+    geometry::Range2d<int> world_to_pixel(const SWFRect& wb) const {
+        return _bands.front().world_to_pixel(wb);
+    }
+
+    point pixel_to_world(int x, int y) const {
+        return _bands.front().pixel_to_world(x, y);
+    }
+
+    bool bounds_in_clipping_area(const geometry::Range2d<int>& bounds) const {
+        for (const Band& b : _bands) {
+            if (b.bounds_in_clipping_area(bounds)) return true;
+        }
+        return false;
+    }
+
+    bool getPixel(rgba& color_return, int x, int y) const {
+        return _bands.front().getPixel(color_return, x, y);
+    }
+
+    RenderImages::const_iterator getFirstRenderImage() const {
+        return _bands.front().getFirstRenderImage();
+    }
+
+    RenderImages::const_iterator getLastRenderImage() const {
+        return _bands.front().getLastRenderImage();
+    }
+
+    void begin_display(const rgba& bg, int /*viewport_width*/,
+            int /*viewport_height*/, float /*x0*/, float /*x1*/,
+            float /*y0*/, float /*y1*/) {
+        _background = bg;
+        _commands.clear();
+        _inFrame = true;
+    }
+
+    void end_display() {
+        draw();
+        _inFrame = false;
+    }
+
+    Renderer* startInternalRender(image::GnashImage& im) {
+        return _bands.front().startInternalRender(im);
+    }
+
+    void endInternalRender() {
+        _bands.front().endInternalRender();
+    }
+
+private:
+
+    /// Converts the shapes and rasterizes the glyphs the bands will draw.
+    class Prepare : public boost::static_visitor<>
+    {
+    public:
+
+        explicit Prepare(Renderer_agg_threaded& r)
+            :
+            _r(r),
+            _mask(false)
+        {}
+
+        void operator()(const RenderCommands::DrawShape& c) {
+            SWFRect bounds;
+            bounds.expand_to_transformed_rect(c.xform.matrix,
+                    c.shape->getBounds());
+            if (!_r.bounds_in_clipping_area(bounds.getRange())) return;
+            _r._bands.front().prepareShape(*c.shape, c.xform.matrix,
+                    _r._bands.size());
+        }
+
+        void operator()(const RenderCommands::DrawGlyph& c) {
+            // Glyphs in masks are drawn as shapes.
+            if (_mask) return;
+            _r._bands.front().prepareGlyph(*c.glyph, c.mat);
+        }
+
+        void operator()(const RenderCommands::Mask& c) {
+            if (c.type == RenderCommands::Mask::BEGIN_SUBMIT) _mask = true;
+            else if (c.type == RenderCommands::Mask::END_SUBMIT) _mask = false;
+        }
+
+        template<typename T> void operator()(const T&) {}
+
+    private:
+        Renderer_agg_threaded& _r;
+
+        /// Whether a mask is drawn.
+        bool _mask;
+    };
+
+    /// Have all bands replay the recorded commands, and forget them.
+    void draw() {
+        // The caches are only added to while no band is drawn.
+        Prepare prepare(*this);
+        for (const RenderCommands::Command& c : _commands.commands()) {
+            boost::apply_visitor(prepare, c);
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        ++_generation;
+        _pending = _threads.size();
+        lock.unlock();
+        _wakeup.notify_all();
+
+        drawBand(_bands.front());
+
+        lock.lock();
+        _done.wait(lock, [this] { return !_pending; });
+        _commands.clear();
+    }
+
+    /// Replay the recorded commands on a band.
+    void drawBand(Band& band) {
+        band.setQuality(_quality);
+        if (_inFrame) band.begin_display(_background, 0, 0, 0, 0, 0, 0);
+        _commands.replay(band);
+        if (_inFrame) band.end_display();
+    }
+
+    /// Draw a band whenever draw() is called.
+    void drawBands(size_t band) {
+        size_t drawn = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wakeup.wait(lock, [this, drawn] {
+                        return _stop || _generation != drawn; });
+                if (_stop) return;
+                drawn = _generation;
+            }
+
+            drawBand(_bands[band]);
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!--_pending) _done.notify_one();
+        }
+    }
+
+    /// The caches of all bands.
+    RendererCaches _caches;
+
+    boost::ptr_vector<Band> _bands;
+
+    std::vector<std::thread> _threads;
+
+    RenderCommands _commands;
+
+    rgba _background;
+
+    /// Whether drawing is between begin_display() and end_display().
+    bool _inFrame;
+
+    std::mutex _mutex;
+
+    /// Signalled when the bands should be drawn.
+    std::condition_variable _wakeup;
+
+    /// Signalled when the last band has been drawn.
+    std::condition_variable _done;
+
+    /// Incremented each time the bands should be drawn.
+    size_t _generation;
+
+    /// The threads still drawing.
+    size_t _pending;
+
+    bool _stop;
+};
+
+/// Create a renderer drawing with the number of threads set in gnashrc.
+template <class PixelFormat>
+Renderer_agg_base*
+createRenderer(int bits_per_pixel)
+{
+    const unsigned threads =
+        RcInitFile::getDefaultInstance().getRenderThreads();
+
+    if (threads > 1) {
+        return new Renderer_agg_threaded<PixelFormat>(bits_per_pixel,
+                threads);
+    }
+    return new Renderer_agg<PixelFormat>(bits_per_pixel);
+}
+
 // detect the endianess of the host (would prefer to NOT have this function
 // here)
 bool is_little_endian_host() {
@@ -2056,42 +3112,42 @@ DSOEXPORT Renderer_agg_base*  create_Renderer_agg(const char *pixelformat)
   
 #ifdef PIXELFORMAT_RGB555  
   if (!strcmp(pixelformat, "RGB555"))
-    return new Renderer_agg<agg::pixfmt_rgb555_pre> (16); // yep, 16!
+    return createRenderer<agg::pixfmt_rgb555_pre>(16); // yep, 16!
   
   else
 #endif   
 #ifdef PIXELFORMAT_RGB565  
   if (!strcmp(pixelformat, "RGB565") || !strcmp(pixelformat, "RGBA16"))
-    return new Renderer_agg<agg::pixfmt_rgb565_pre> (16); 
+    return createRenderer<agg::pixfmt_rgb565_pre>(16); 
   else 
 #endif   
 #ifdef PIXELFORMAT_RGB24  
   if (!strcmp(pixelformat, "RGB24"))
-    return new Renderer_agg<agg::pixfmt_rgb24_pre> (24);    
+    return createRenderer<agg::pixfmt_rgb24_pre>(24);    
   else 
 #endif   
 #ifdef PIXELFORMAT_BGR24  
   if (!strcmp(pixelformat, "BGR24"))
-    return new Renderer_agg<agg::pixfmt_bgr24_pre> (24);
+    return createRenderer<agg::pixfmt_bgr24_pre>(24);
   else 
 #endif   
 #ifdef PIXELFORMAT_RGBA32 
   if (!strcmp(pixelformat, "RGBA32"))
-    return new Renderer_agg<agg::pixfmt_rgba32_pre> (32);
+    return createRenderer<agg::pixfmt_rgba32_pre>(32);
   else 
 #endif   
 #ifdef PIXELFORMAT_BGRA32  
   if (!strcmp(pixelformat, "BGRA32"))
-    return new Renderer_agg<agg::pixfmt_bgra32_pre> (32);
+    return createRenderer<agg::pixfmt_bgra32_pre>(32);
 #endif   
 #ifdef PIXELFORMAT_RGBA32 
   if (!strcmp(pixelformat, "ARGB32"))
-    return new Renderer_agg<agg::pixfmt_argb32_pre> (32);
+    return createRenderer<agg::pixfmt_argb32_pre>(32);
   else 
 #endif   
 #ifdef PIXELFORMAT_BGRA32  
   if (!strcmp(pixelformat, "ABGR32"))
-    return new Renderer_agg<agg::pixfmt_abgr32_pre> (32);
+    return createRenderer<agg::pixfmt_abgr32_pre>(32);
         
   else 
 #endif
@@ -22,6 +22,7 @@
 #include <memory>
 #include <memory>
 #include <cstdint>
+#include <atomic>
 
 #include "GnashImage.h"
 #include "CachedBitmap.h"
@@ -35,7 +36,8 @@ public:
     agg_bitmap_info(std::unique_ptr<image::GnashImage> im)
         :
         _image(im.release()),
-        _bpp(_image->type() == image::TYPE_RGB ? 24 : 32)
+        _bpp(_image->type() == image::TYPE_RGB ? 24 : 32),
+        _disposed(false)
     {
     }
   
@@ -44,12 +46,14 @@ public:
         return *_image;
     }
   
+    /// The image is kept until the last reference goes, as frames
+    /// recorded earlier may still be drawing it in a render thread.
     void dispose() {
-        _image.reset();
+        _disposed = true;
     }
 
     bool disposed() const {
-        return !_image.get();
+        return _disposed;
     }
    
     int get_width() const { return _image->width(); }  
@@ -63,6 +67,8 @@ private:
     std::unique_ptr<image::GnashImage> _image;
   
     int _bpp;
+
+    std::atomic<bool> _disposed;
       
 };
 
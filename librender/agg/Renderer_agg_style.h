@@ -24,6 +24,13 @@
 // to re-check the bitmap definitions as parsing goes on.
 
 #include <vector>
+#include <map>
+#include <list>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
@@ -51,6 +58,7 @@
 namespace gnash {
 
 class StyleHandler;
+class GradientTables;
 
 // Forward declarations.
 namespace {
@@ -65,13 +73,14 @@ namespace {
             bool smooth);
 
     /// Creates many (should be 18) gradient functions.
-    void storeGradient(StyleHandler& st, const GradientFill& fs,
-            const SWFMatrix& mat, const SWFCxForm& cx);
-    template<typename Spread> void storeGradient(StyleHandler& st,
+    void storeGradient(StyleHandler& st, GradientTables& tables,
             const GradientFill& fs, const SWFMatrix& mat, const SWFCxForm& cx);
-    template<typename Spread, typename Interpolation>
-            void storeGradient(StyleHandler& st, const GradientFill& fs,
+    template<typename Spread> void storeGradient(StyleHandler& st,
+            GradientTables& tables, const GradientFill& fs,
             const SWFMatrix& mat, const SWFCxForm& cx);
+    template<typename Spread, typename Interpolation>
+            void storeGradient(StyleHandler& st, GradientTables& tables,
+            const GradientFill& fs, const SWFMatrix& mat, const SWFCxForm& cx);
 }
 
 /// Internal style class that represents a fill style. Roughly speaking, AGG 
@@ -230,6 +239,125 @@ struct InterpolatorRGB
     };
 };
 
+/// Gradient color tables kept between drawings.
+//
+/// A table interpolates 256 colors from a gradient's records, so one is
+/// shared by all gradients with the same colors (after the color
+/// transform) and interpolation, in any shape and frame. The bands of a
+/// threaded renderer share one, so tables are found and built under a
+/// lock; that is once for each gradient style built, not for each pixel.
+class GradientTables : boost::noncopyable
+{
+public:
+
+    GradientTables()
+        :
+        _hits(0),
+        _misses(0)
+    {}
+
+    /// Get the color table of a gradient, building it if needed.
+    //
+    /// @tparam Table       The ColorInterpolator of the gradient's
+    ///                     interpolation, see InterpolatorRGB.
+    /// @param premultiply  Set to whether any color is transparent, so
+    ///                     that the colors drawn need premultiplying.
+    template<typename Table>
+    std::shared_ptr<Table> get(const GradientFill& fs, const SWFCxForm& cx,
+            bool& premultiply)
+    {
+        const size_t size = fs.recordCount();
+      
+        // It is essential that at least two colours are added; otherwise agg
+        // will use uninitialized values.
+        assert(size > 1);
+
+        Key key;
+        key.reserve(1 + size * 5);
+        key.push_back(fs.interpolation);
+        for (size_t i = 0; i != size; ++i) { 
+            const GradientRecord& gr = fs.record(i); 
+            const rgba tr = cx.transform(gr.color);
+            key.push_back(gr.ratio);
+            key.push_back(tr.m_r);
+            key.push_back(tr.m_g);
+            key.push_back(tr.m_b);
+            key.push_back(tr.m_a);
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        const Tables::iterator it = _tables.find(key);
+        if (it != _tables.end()) {
+            _hits.fetch_add(1, std::memory_order_relaxed);
+            _used.splice(_used.begin(), _used, it->second.used);
+            premultiply = it->second.premultiply;
+            return std::static_pointer_cast<Table>(it->second.table);
+        }
+        _misses.fetch_add(1, std::memory_order_relaxed);
+
+        std::shared_ptr<Table> table = std::make_shared<Table>();
+        table->remove_all();
+        premultiply = false;
+        for (Key::const_iterator i = key.begin() + 1; i != key.end(); i += 5) {
+            if (i[4] < 0xff) premultiply = true;
+            table->add_color(i[0] / 255.0,
+                    agg::rgba8(i[1], i[2], i[3], i[4]));
+        }
+        table->build_lut();
+
+        _used.push_front(key);
+        const Entry e = { table, premultiply, _used.begin() };
+        _tables.insert(std::make_pair(key, e));
+
+        // Tables of gradients still drawn are kept by their styles.
+        if (_tables.size() > maxTables) {
+            _tables.erase(_used.back());
+            _used.pop_back();
+        }
+        return table;
+    }
+
+    /// How many tables were found already built.
+    std::uint64_t hits() const {
+        return _hits.load(std::memory_order_relaxed);
+    }
+
+    /// How many tables had to be built.
+    std::uint64_t misses() const {
+        return _misses.load(std::memory_order_relaxed);
+    }
+
+private:
+
+    /// The interpolation, then the ratio and color of each record.
+    typedef std::vector<std::uint8_t> Key;
+
+    /// The most recently used first.
+    typedef std::list<Key> Used;
+
+    struct Entry
+    {
+        std::shared_ptr<void> table;
+        bool premultiply;
+        Used::iterator used;
+    };
+
+    typedef std::map<Key, Entry> Tables;
+
+    /// About 1KB each.
+    static const size_t maxTables = 1024;
+
+    std::mutex _mutex;
+
+    Tables _tables;
+    Used _used;
+
+    /// Counted atomically so that they can be read while drawing.
+    std::atomic<std::uint64_t> _hits;
+    std::atomic<std::uint64_t> _misses;
+};
+
 /// AGG gradient fill style. Don't use Gnash texture bitmaps as this is slower
 /// and less accurate. Even worse, the bitmap fill would need to be tweaked
 /// to have non-repeating gradients (first and last color stops continue 
@@ -241,38 +369,23 @@ class GradientStyle : public AggStyle
 {
 public:
   
-    GradientStyle(const GradientFill& fs, const SWFMatrix& mat,
-            SWFCxForm cx, int norm_size, GradientType gr = GradientType())
+    /// @param lut          The gradient's colors, see GradientTables.
+    /// @param premultiply  Whether the colors need premultiplying.
+    GradientStyle(std::shared_ptr<ColorInterpolator> lut, bool premultiply,
+            const SWFMatrix& mat, int norm_size,
+            GradientType gr = GradientType())
         :
         AggStyle(false),
-        m_cx(std::move(cx)),
         m_tr(mat.a() / 65536.0, mat.b() / 65536.0, mat.c() / 65536.0,
               mat.d() / 65536.0, mat.tx(), mat.ty()),
         m_span_interpolator(m_tr),
         m_gradient_adaptor(std::move(gr)),
-        m_sg(m_span_interpolator, m_gradient_adaptor, m_gradient_lut, 0,
+        m_gradient_lut(std::move(lut)),
+        m_sg(m_span_interpolator, m_gradient_adaptor, *m_gradient_lut, 0,
                 norm_size),
-      
-        m_need_premultiply(false)
+        m_need_premultiply(premultiply)
     {
-        // Build gradient lookup table
-        m_gradient_lut.remove_all(); 
-        const size_t size = fs.recordCount();
-      
-        // It is essential that at least two colours are added; otherwise agg
-        // will use uninitialized values.
-        assert(size > 1);
-    
-        for (size_t i = 0; i != size; ++i) { 
-            const GradientRecord& gr = fs.record(i); 
-            const rgba tr = m_cx.transform(gr.color);
-            if (tr.m_a < 0xff) m_need_premultiply = true;    
-            m_gradient_lut.add_color(gr.ratio / 255.0,
-                    agg::rgba8(tr.m_r, tr.m_g, tr.m_b, tr.m_a));
-        } 
-        m_gradient_lut.build_lut();
-        
-    } // GradientStyle constructor
+    }
   
     virtual ~GradientStyle() { }
   
@@ -288,9 +401,6 @@ public:
     
 protected:
     
-    // Color transform
-    SWFCxForm m_cx;
-    
     // Span allocator
     Allocator m_sa;
     
@@ -303,8 +413,8 @@ protected:
     // Gradient adaptor
     Adaptor m_gradient_adaptor;  
     
-    // Gradient LUT
-    ColorInterpolator m_gradient_lut;
+    // Gradient LUT, shared with other styles
+    std::shared_ptr<ColorInterpolator> m_gradient_lut;
     
     // Span generator
     SpanGenerator m_sg;  
@@ -474,24 +584,34 @@ public:
     } 
 
     template<typename T>
-    void addLinearGradient(const GradientFill& fs, const SWFMatrix& mat,
-            const SWFCxForm& cx)
+    void addLinearGradient(GradientTables& tables, const GradientFill& fs,
+            const SWFMatrix& mat, const SWFCxForm& cx)
     {
+        bool premultiply;
+        std::shared_ptr<typename T::ColorInterpolator> lut =
+            tables.get<typename T::ColorInterpolator>(fs, cx, premultiply);
+
         // NOTE: The value 256 is based on the bitmap texture used by other
         // Gnash renderers which is normally 256x1 pixels for linear gradients.
-        typename T::Type* st = new typename T::Type(fs, mat, cx, 256);
+        typename T::Type* st =
+            new typename T::Type(std::move(lut), premultiply, mat, 256);
         _styles.push_back(st);
     }
     
     template<typename T>
-    void addFocalGradient(const GradientFill& fs, const SWFMatrix& mat,
-            const SWFCxForm& cx)
+    void addFocalGradient(GradientTables& tables, const GradientFill& fs,
+            const SWFMatrix& mat, const SWFCxForm& cx)
     {
+        bool premultiply;
+        std::shared_ptr<typename T::ColorInterpolator> lut =
+            tables.get<typename T::ColorInterpolator>(fs, cx, premultiply);
+
         typename T::GradientType gr;
         gr.init(32.0, fs.focalPoint() * 32.0, 0.0);
         
         // div 2 because we need radius, not diameter      
-        typename T::Type* st = new typename T::Type(fs, mat, cx, 32.0, gr); 
+        typename T::Type* st =
+            new typename T::Type(std::move(lut), premultiply, mat, 32.0, gr); 
         
         // NOTE: The value 64 is based on the bitmap texture used by other
         // Gnash renderers which is normally 64x64 pixels for radial gradients.
@@ -499,12 +619,16 @@ public:
     }
     
     template<typename T>
-    void addRadialGradient(const GradientFill& fs, const SWFMatrix& mat,
-            const SWFCxForm& cx)
+    void addRadialGradient(GradientTables& tables, const GradientFill& fs,
+            const SWFMatrix& mat, const SWFCxForm& cx)
     {
+        bool premultiply;
+        std::shared_ptr<typename T::ColorInterpolator> lut =
+            tables.get<typename T::ColorInterpolator>(fs, cx, premultiply);
 
         // div 2 because we need radius, not diameter      
-        typename T::Type* st = new typename T::Type(fs, mat, cx, 64 / 2); 
+        typename T::Type* st =
+            new typename T::Type(std::move(lut), premultiply, mat, 64 / 2); 
           
         // NOTE: The value 64 is based on the bitmap texture used by other
         // Gnash renderers which is normally 64x64 pixels for radial gradients.
@@ -592,12 +716,13 @@ private:
 struct AddStyles : boost::static_visitor<>
 {
     AddStyles(SWFMatrix stage, SWFMatrix fill, const SWFCxForm& c,
-            StyleHandler& sh, Quality q)
+            StyleHandler& sh, GradientTables& tables, Quality q)
         :
         _stageMatrix(stage.invert()),
         _fillMatrix(fill.invert()),
         _cx(c),
         _sh(sh),
+        _tables(tables),
         _quality(q)
     {
     }
@@ -606,7 +731,7 @@ struct AddStyles : boost::static_visitor<>
           SWFMatrix m = f.matrix();
           m.concatenate(_fillMatrix);
           m.concatenate(_stageMatrix);
-          storeGradient(_sh, f, m, _cx);
+          storeGradient(_sh, _tables, f, m, _cx);
     }
 
     void operator()(const SolidFill& f) const {
@@ -673,6 +798,7 @@ private:
     const SWFMatrix _fillMatrix;
     const SWFCxForm& _cx;
     StyleHandler& _sh;
+    GradientTables& _tables;
     const Quality _quality;
 };  
 
@@ -705,8 +831,8 @@ storeBitmap(StyleHandler& st, const agg_bitmap_info* bi,
 
 template<typename Spread, typename Interpolation>
 void
-storeGradient(StyleHandler& st, const GradientFill& fs, const SWFMatrix& mat,
-        const SWFCxForm& cx)
+storeGradient(StyleHandler& st, GradientTables& tables,
+        const GradientFill& fs, const SWFMatrix& mat, const SWFCxForm& cx)
 {
       
     typedef agg::gradient_x Linear;
@@ -719,48 +845,49 @@ storeGradient(StyleHandler& st, const GradientFill& fs, const SWFMatrix& mat,
 
     switch (fs.type()) {
         case GradientFill::LINEAR:
-            st.addLinearGradient<LinearGradient>(fs, mat, cx);
+            st.addLinearGradient<LinearGradient>(tables, fs, mat, cx);
             return;
       
         case GradientFill::RADIAL:
             if (fs.focalPoint()) {
-                st.addFocalGradient<FocalGradient>(fs, mat, cx);
+                st.addFocalGradient<FocalGradient>(tables, fs, mat, cx);
                 return;
             }
-            st.addRadialGradient<RadialGradient>(fs, mat, cx);
+            st.addRadialGradient<RadialGradient>(tables, fs, mat, cx);
     }
 }
 
 template<typename Spread>
 void
-storeGradient(StyleHandler& st, const GradientFill& fs, const SWFMatrix& mat,
-        const SWFCxForm& cx)
+storeGradient(StyleHandler& st, GradientTables& tables,
+        const GradientFill& fs, const SWFMatrix& mat, const SWFCxForm& cx)
 {
     switch (fs.interpolation) {
         case SWF::GRADIENT_INTERPOLATION_NORMAL:
-            storeGradient<Spread, InterpolatorRGB>(st, fs, mat, cx);
+            storeGradient<Spread, InterpolatorRGB>(st, tables, fs, mat, cx);
             break;
         case SWF::GRADIENT_INTERPOLATION_LINEAR:
-            storeGradient<Spread, InterpolatorLinearRGB>(st, fs, mat, cx);
+            storeGradient<Spread, InterpolatorLinearRGB>(st, tables, fs, mat,
+                    cx);
             break;
     }
 
 }
 
 void
-storeGradient(StyleHandler& st, const GradientFill& fs, const SWFMatrix& mat,
-        const SWFCxForm& cx)
+storeGradient(StyleHandler& st, GradientTables& tables,
+        const GradientFill& fs, const SWFMatrix& mat, const SWFCxForm& cx)
 {   
 
       switch (fs.spreadMode) {
           case GradientFill::PAD:
-              storeGradient<Pad>(st, fs, mat, cx);
+              storeGradient<Pad>(st, tables, fs, mat, cx);
               break;
           case GradientFill::REFLECT:
-              storeGradient<Reflect>(st, fs, mat, cx);
+              storeGradient<Reflect>(st, tables, fs, mat, cx);
               break;
           case GradientFill::REPEAT:
-              storeGradient<Repeat>(st, fs, mat, cx);
+              storeGradient<Repeat>(st, tables, fs, mat, cx);
               break;
       }
 }
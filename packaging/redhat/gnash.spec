@@ -362,6 +362,7 @@ touch --no-create %{_datadir}/icons/hicolor
 %{_bindir}/findwebcams
 #%{_bindir}/dumpshm
 %{_bindir}/rtmpget
+%{_bindir}/swfcache
 %{_libdir}/gnash/*.so*
 %{_prefix}/share/gnash/GnashG.png
 %{_prefix}/share/gnash/gnash_128_96.ico
@@ -39,6 +39,8 @@
 #include "swf/TagLoadersTable.h"
 #include "swf/DefaultTagLoaders.h"
 #include "GnashFactory.h"
+#include "RenderCommands.h"
+#include "rc.h"
 
 #ifdef RENDERER_CAIRO
 # include "Renderer_cairo.h"
@@ -54,6 +56,7 @@
 
 #include <cstdio>
 #include <string>
+#include <thread>
 #include <memory> // for unique_ptr
 #include <cmath> // for ceil
 #include <iostream>
@@ -90,6 +93,7 @@ MovieTester::MovieTester(const std::string& url)
     _x(0),
     _y(0),
     _forceRedraw(true),
+    _pipeline(RcInitFile::getDefaultInstance().renderPipeline()),
     _samplesFetched(0)
 {
     
@@ -186,6 +190,17 @@ MovieTester::render(std::shared_ptr<Renderer> h,
     // that CachedBitmaps are missing.
     _runResources.setRenderer(h);
     
+    // Record the frame like Gui::queueFrame() does, replacing one not
+    // drawn yet.
+    if (_pipeline) {
+        std::unique_ptr<RenderFrame> frame = _movie_root->recordFrame();
+        if (!frame.get()) return;
+        if (_queuedFrame.get()) _queuedRanges.add(invalidated_regions);
+        else _queuedRanges = invalidated_regions;
+        _queuedFrame = std::move(frame);
+        return;
+    }
+
     h->set_invalidated_regions(invalidated_regions);
     
     // We call display here to simulate effect of a real run.
@@ -212,6 +227,17 @@ MovieTester::redraw()
     _forceRedraw=true;
     render();
 }
+
+void
+MovieTester::drawQueuedFrame()
+{
+    if (!_queuedFrame.get()) return;
+
+    Renderer& renderer = *_testingRenderers.front().getRenderer();
+    renderer.set_invalidated_regions(_queuedRanges);
+    _queuedFrame->draw(renderer);
+    _queuedFrame.reset();
+}
     
 void
 MovieTester::render() 
@@ -306,8 +332,21 @@ MovieTester::advance(bool updateClock)
         advanceClock(clockAdvance);
     }
     
-    if (_movie_root->advance()) render();
-    
+    if (!_queuedFrame.get()) {
+        if (_movie_root->advance()) render();
+        return;
+    }
+
+    // Draw the last frame while this one advances, as the GUI does.
+    std::unique_ptr<RenderFrame> frame = std::move(_queuedFrame);
+    Renderer& renderer = *_testingRenderers.front().getRenderer();
+    renderer.set_invalidated_regions(_queuedRanges);
+    std::thread drawing(&RenderFrame::draw, frame.get(), std::ref(renderer));
+
+    const bool advanced = _movie_root->advance();
+    drawing.join();
+
+    if (advanced) render();
 }
     
 void
@@ -368,6 +407,26 @@ MovieTester::movePointerTo(int x, int y)
     if ( _movie_root->mouseMoved(x, y) ) render();
 }
 
+size_t
+MovieTester::differentPixels(const MovieTester& other) const
+{
+    if (!canTestRendering() || !other.canTestRendering()) return 0;
+
+    const Renderer& r = *_testingRenderers.front().getRenderer();
+    const Renderer& o = *other._testingRenderers.front().getRenderer();
+
+    size_t different = 0;
+    for (unsigned y = 0; y < _height; ++y) {
+        for (unsigned x = 0; x < _width; ++x) {
+            rgba a, b;
+            if (!r.getPixel(a, x, y) || !o.getPixel(b, x, y) || !(a == b)) {
+                ++different;
+            }
+        }
+    }
+    return different;
+}
+
 void
 MovieTester::checkPixel(int x, int y, unsigned radius, const rgba& color,
 		short unsigned tolerance, const std::string& label, bool expectFailure) const
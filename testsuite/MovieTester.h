@@ -144,6 +144,15 @@ public:
 	///
 	void redraw();
 
+	/// Draw the frame recorded last, if it wasn't drawn yet.
+	//
+	/// With renderPipeline set in gnashrc when the MovieTester is made,
+	/// frames are recorded like the GUI records them, and each is drawn
+	/// by a thread while the next advance() runs. The pixels then show
+	/// the frame before the last one until this is called.
+	///
+	void drawQueuedFrame();
+
 	/// Return the invalidated ranges in PIXELS
 	//
 	/// This is to debug/test partial rendering
@@ -226,6 +235,16 @@ public:
 	void checkPixel(int x, int y, unsigned radius, const rgba& color,
 			short unsigned tolerance, const std::string& label, bool expectFailure=false) const;
 
+	/// Count the pixels drawn differently by another MovieTester
+	//
+	/// The first testing renderer of each is compared over the
+	/// whole stage, so both should play the same movie.
+	///
+	/// @return the number of pixels that differ, or 0 if either
+	///	MovieTester can't test rendering.
+	///
+	size_t differentPixels(const MovieTester& other) const;
+
     VM& vm() {
         assert(_movie_root);
         return _movie_root->getVM();
@@ -393,6 +412,13 @@ private:
 	// to the renderer(s) at ::render time.
 	bool _forceRedraw;
 
+	/// Whether frames are drawn while the next advance runs.
+	const bool _pipeline;
+
+	/// The frame recorded but not drawn yet, and the regions it updates.
+	std::unique_ptr<RenderFrame> _queuedFrame;
+	InvalidatedRanges _queuedRanges;
+
 	/// Virtual clock to use to let test runners
 	/// control time flow
 	ManualClock _clock;
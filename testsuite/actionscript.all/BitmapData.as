@@ -871,6 +871,108 @@ dest.copyChannel(dest, new Rect(0, 0, 100, 100), new Point(4, 4), 4, 4);
  check_equals(dest.getPixel(50, 96), 0x0000ff);
  check_equals(dest.getPixel(96, 96), 0x0000ff);
 
+// colorTransform()
+
+// Rows 21 pixels wide are changed partly several pixels at a time and
+// partly one at a time, so pixels are checked in each part.
+ct = new flash.display.BitmapData(21, 5, true, 0xff608020);
+ct.colorTransform(new Rect(0, 0, 21, 5),
+        new flash.geom.ColorTransform(0.5, 2, 1, 1, 16, -64, 0, 0));
+ check_equals(ct.getPixel32(2, 2) >>> 0, 0xff40c020);
+ check_equals(ct.getPixel32(17, 4) >>> 0, 0xff40c020);
+ check_equals(ct.getPixel32(20, 0) >>> 0, 0xff40c020);
+
+// Results are clamped, and only the rectangle changes.
+ct = new flash.display.BitmapData(21, 5, true, 0xff608020);
+ct.colorTransform(new Rect(0, 0, 11, 5),
+        new flash.geom.ColorTransform(1, 1, 1, 1, 200, -200, 0, 0));
+ check_equals(ct.getPixel32(2, 2) >>> 0, 0xffff0020);
+ check_equals(ct.getPixel32(10, 4) >>> 0, 0xffff0020);
+ check_equals(ct.getPixel32(11, 4) >>> 0, 0xff608020);
+ check_equals(ct.getPixel32(20, 0) >>> 0, 0xff608020);
+
+ct = new flash.display.BitmapData(21, 5, false, 0x608020);
+ct.colorTransform(new Rect(0, 0, 21, 5),
+        new flash.geom.ColorTransform(0.5, 2, 1, 1, 16, -64, 0, 0));
+ check_equals(ct.getPixel32(2, 2) >>> 0, 0xff40c020);
+ check_equals(ct.getPixel32(20, 4) >>> 0, 0xff40c020);
+
+// merge()
+
+// Each channel is (source * multiplier + dest * (256 - multiplier)) / 256.
+msrc = new flash.display.BitmapData(21, 5, true, 0xff608020);
+mdest = new flash.display.BitmapData(21, 5, true, 0xff2040a0);
+mdest.merge(msrc, new Rect(0, 0, 21, 5), new Point(0, 0), 128, 64, 256, 0);
+ check_equals(mdest.getPixel32(2, 2) >>> 0, 0xff405020);
+ check_equals(mdest.getPixel32(17, 4) >>> 0, 0xff405020);
+ check_equals(mdest.getPixel32(20, 0) >>> 0, 0xff405020);
+
+mdest = new flash.display.BitmapData(21, 5, true, 0xff2040a0);
+mdest.merge(msrc, new Rect(0, 0, 21, 5), new Point(0, 0), 0, 256, 0, 256);
+ check_equals(mdest.getPixel32(9, 1) >>> 0, 0xff2080a0);
+
+mdest = new flash.display.BitmapData(21, 5, true, 0xff2040a0);
+mdest.merge(msrc, new Rect(0, 0, 10, 5), new Point(11, 0), 256, 256, 256,
+        256);
+ check_equals(mdest.getPixel32(10, 2) >>> 0, 0xff2040a0);
+ check_equals(mdest.getPixel32(11, 2) >>> 0, 0xff608020);
+ check_equals(mdest.getPixel32(20, 2) >>> 0, 0xff608020);
+
+mdest = new flash.display.BitmapData(21, 5, false, 0x2040a0);
+mdest.merge(msrc, new Rect(0, 0, 21, 5), new Point(0, 0), 128, 64, 256, 0);
+ check_equals(mdest.getPixel(20, 4), 0x405020);
+
+// threshold()
+
+tsrc = new flash.display.BitmapData(21, 5, true, 0xff102030);
+tsrc.fillRect(new Rect(10, 0, 11, 5), 0xff908070);
+
+// Only the red channel is compared, and the pixels that pass are counted.
+tdest = new flash.display.BitmapData(21, 5, true, 0xff000000);
+ check_equals(tdest.threshold(tsrc, new Rect(0, 0, 21, 5), new Point(0, 0),
+             ">", 0x00800000, 0xffff0000, 0x00ff0000, false), 55);
+ check_equals(tdest.getPixel32(2, 2) >>> 0, 0xff000000);
+ check_equals(tdest.getPixel32(9, 4) >>> 0, 0xff000000);
+ check_equals(tdest.getPixel32(10, 0) >>> 0, 0xffff0000);
+ check_equals(tdest.getPixel32(17, 4) >>> 0, 0xffff0000);
+ check_equals(tdest.getPixel32(20, 4) >>> 0, 0xffff0000);
+
+// With copySource, the pixels that fail are copied from the source.
+tdest = new flash.display.BitmapData(21, 5, true, 0xff000000);
+ check_equals(tdest.threshold(tsrc, new Rect(0, 0, 21, 5), new Point(0, 0),
+             "==", 0x30, 0xff00ff00, 0xff, true), 50);
+ check_equals(tdest.getPixel32(2, 2) >>> 0, 0xff00ff00);
+ check_equals(tdest.getPixel32(9, 4) >>> 0, 0xff00ff00);
+ check_equals(tdest.getPixel32(10, 0) >>> 0, 0xff908070);
+ check_equals(tdest.getPixel32(20, 4) >>> 0, 0xff908070);
+
+tdest = new flash.display.BitmapData(21, 5, false, 0x000000);
+ check_equals(tdest.threshold(tsrc, new Rect(0, 0, 21, 5), new Point(0, 0),
+             "<", 0x00800000, 0xffffff00, 0x00ff0000), 50);
+ check_equals(tdest.getPixel(2, 2), 0xffff00);
+ check_equals(tdest.getPixel(20, 2), 0x000000);
+
+// paletteMap()
+
+// Each channel is looked up in its own array and the results are added.
+// Channels without an array are left as they are.
+reds = [];
+blues = [];
+for (i = 0; i < 256; ++i) {
+    reds[i] = (255 - i) << 16;
+    blues[i] = (i * 2) & 0xff;
+}
+psrc = new flash.display.BitmapData(21, 5, true, 0xff102030);
+psrc.fillRect(new Rect(10, 0, 11, 5), 0xff908070);
+pdest = new flash.display.BitmapData(21, 5, true, 0xff000000);
+pdest.paletteMap(psrc, new Rect(0, 0, 21, 5), new Point(0, 0), reds, null,
+        blues);
+ check_equals(pdest.getPixel32(2, 2) >>> 0, 0xffef2060);
+ check_equals(pdest.getPixel32(20, 4) >>> 0, 0xff6f80e0);
+
+psrc.paletteMap(psrc, new Rect(0, 0, 21, 5), new Point(0, 0), reds);
+ check_equals(psrc.getPixel32(2, 2) >>> 0, 0xffef2030);
+
 // noise().
 
 // Tests that a particular color does not appear.
@@ -1154,6 +1256,6 @@ flash.display.BitmapData.prototype = e;
 // END OF TEST
 //-------------------------------------------------------------
 
-totals(410);
+totals(444);
 
 #endif // OUTPUT_VERSION >= 8
@@ -127,7 +127,7 @@ endOfTest = function()
 #endif
 
 #if OUTPUT_VERSION >= 8
-	check_totals(1077); // SWF8+
+	check_totals(1082); // SWF8+
 #endif
 
 	play();
@@ -1143,30 +1143,44 @@ check_equals(typeof(this.$version), 'undefined');
     check_equals(_root.filters.toString(), "");
 
     _root.filters = [ new flash.filters.ConvolutionFilter() ];
-    xcheck_equals(_root.filters.length, 1);
-    xcheck_equals(_root.filters.toString(), "[object Object]");
+    check_equals(_root.filters.length, 1);
+    check_equals(_root.filters.toString(), "[object Object]");
 
     _root.filters = [ new flash.filters.ConvolutionFilter(),
                       new flash.filters.DropShadowFilter() ];
-    xcheck_equals(_root.filters.length, 2);
-    xcheck_equals(_root.filters.toString(), "[object Object],[object Object]");
+    check_equals(_root.filters.length, 2);
+    check_equals(_root.filters.toString(), "[object Object],[object Object]");
 
     // The filters are recreated every time.
     tmp1 = _root.filters;
     tmp2 = _root.filters;
-    xcheck(tmp1[0] !== tmp2[0]);
+    check(tmp1[0] !== tmp2[0]);
+
+    // They are copies, so changing one has no effect until it is assigned.
+    blur = new flash.filters.BlurFilter();
+    blur.blurX = 7;
+    _root.filters = [ blur ];
+    tmp1 = _root.filters;
+    check(tmp1[0] instanceof flash.filters.BlurFilter);
+    check_equals(tmp1[0].blurX, 7);
+    tmp1[0].blurX = 20;
+    check_equals(_root.filters[0].blurX, 7);
+    blur.blurX = 30;
+    check_equals(_root.filters[0].blurX, 7);
+    _root.filters = tmp1;
+    check_equals(_root.filters[0].blurX, 20);
     
     _root.filters = [ new flash.filters.ConvolutionFilter(),
                       new flash.filters.DropShadowFilter(),
                       "boh!" ];
-    xcheck_equals(_root.filters.length, 2);
-    xcheck_equals(_root.filters.toString(), "[object Object],[object Object]");
+    check_equals(_root.filters.length, 2);
+    check_equals(_root.filters.toString(), "[object Object],[object Object]");
 
     _root.filters = [ new flash.filters.ConvolutionFilter(),
                       "boh!",
                       new flash.filters.BlurFilter() ];
-    xcheck_equals(_root.filters.length, 2);
-    xcheck_equals(_root.filters.toString(), "[object Object],[object Object]");
+    check_equals(_root.filters.length, 2);
+    check_equals(_root.filters.toString(), "[object Object],[object Object]");
     
     _root.filters = 34;
     check_equals(_root.filters.length, 0);
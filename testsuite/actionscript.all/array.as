@@ -1754,6 +1754,80 @@ CA = function () {
 o = new CA();
 
 
+//-------------------------------
+// Holes and elements with flags
+//-------------------------------
+
+ar = [0, 1, 2, 3, 4];
+delete ar[1];
+check_equals(ar.length, 5);
+check_equals(typeof(ar[1]), "undefined");
+check_equals(ar[2], 2);
+ar[1] = "one";
+check_equals(ar.join(), "0,one,2,3,4");
+ar.push(5);
+check_equals(ar.join(), "0,one,2,3,4,5");
+check_equals(ar.pop(), 5);
+check_equals(ar.length, 5);
+
+ar = [];
+ar[3] = "d";
+check_equals(ar.length, 4);
+ar[0] = "a";
+ar[1] = "b";
+ar[2] = "c";
+check_equals(ar.join(""), "abcd");
+ar.splice(1, 2, "x");
+check_equals(ar.join(""), "axd");
+check_equals(ar.length, 3);
+ar.unshift("z");
+check_equals(ar.join(""), "zaxd");
+check_equals(ar.shift(), "z");
+ar.reverse();
+check_equals(ar.join(""), "dxa");
+ar.sort();
+check_equals(ar.join(""), "adx");
+
+// Read-only
+ASSetPropFlags(ar, "1", 4);
+ar[1] = "y";
+check_equals(ar[1], "d");
+ar.length = 1;
+check_equals(ar.join(""), "a");
+check_equals(typeof(ar[1]), "undefined");
+
+ar = ["a", "b"];
+ar.x = "c";
+s = "";
+for (var i in ar) s += ar[i];
+check_equals(s.length, 3);
+
+// Elements and other properties are enumerated in reverse order of
+// creation, like those of any other object.
+ar = [];
+ar.x = 1;
+ar[0] = 2;
+ar[1] = 3;
+check_equals(traceProps(ar), "1,0,x,");
+ar = [1, 2];
+ar.x = 3;
+ar.push(4);
+check_equals(traceProps(ar), "2,x,1,0,");
+ar.pop();
+ar.y = 5;
+ar[2] = 6;
+check_equals(traceProps(ar), "2,y,x,1,0,");
+
+#if OUTPUT_VERSION > 5
+ar = [1, 2, 3];
+ar.watch("1", function(id, o, n) { return n * 10; });
+ar[1] = 5;
+check_equals(ar[1], 50);
+ar.push(4);
+check_equals(ar.join(), "1,50,3,4");
+check(ar.hasOwnProperty("3"));
+#endif
+
 /// Test what happens with []
 backup = _global.Array;
 delete _global.Array;
@@ -1813,11 +1887,11 @@ check_equals(ar.__proto__, "string");
 //
 
 #if OUTPUT_VERSION < 6
- check_totals(552);
+ check_totals(574);
 #else
 # if OUTPUT_VERSION < 7
-  check_totals(636);
+  check_totals(661);
 # else
-  check_totals(646);
+  check_totals(671);
 # endif
 #endif
@@ -0,0 +1,85 @@
+#!/bin/sh
+
+#
+#   Copyright (C) 2005, 2006, 2009, 2010 Free Software Foundation, Inc.
+#
+#   This program is free software; you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation; either version 3 of the License, or
+#   (at your option) any later version.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with this program; if not, write to the Free Software
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+#
+
+# Compare the classic and the pre-decoded ActionScript interpreters
+# (see the predecodeActions gnashrc directive) by playing the given
+# SWF files through gprocessor with each of them.
+#
+# Usage: bench-dispatch.sh [-n <runs>] [-f <advances>] <top_builddir> <swf> ...
+#
+# Times are wall clock milliseconds, summed over <runs> runs.
+
+runs=3
+advances=100
+
+while getopts n:f: name; do
+	case $name in
+		n) runs="$OPTARG" ;;
+		f) advances="$OPTARG" ;;
+		?)
+		   echo "Usage: $0 [-n <runs>] [-f <advances>] <top_builddir> <swf> ..." >&2
+		   exit 1;;
+	esac
+done
+shift $(($OPTIND - 1))
+
+top_builddir=$1
+shift
+
+gprocessor=${top_builddir}/utilities/gprocessor
+if test ! -x ${gprocessor}; then
+	echo "Can't find ${gprocessor}" >&2
+	exit 1
+fi
+
+tmpdir=`mktemp -d`
+trap 'rm -rf ${tmpdir}' 0
+echo "set predecodeActions false" > ${tmpdir}/classic
+echo "set predecodeActions true" > ${tmpdir}/predecoded
+
+now_ms()
+{
+	expr `date +%s%N` / 1000000
+}
+
+# Run all runs of a SWF with the given rcfile and print the total time.
+run()
+{
+	start=`now_ms`
+	i=0
+	while test $i -lt ${runs}; do
+		GNASHRC=$1 ${gprocessor} -d 0 -f ${advances} $2 > /dev/null 2>&1
+		i=`expr $i + 1`
+	done
+	expr `now_ms` - ${start}
+}
+
+total_classic=0
+total_predecoded=0
+
+printf "%-32s %10s %10s\n" "SWF" "classic" "predecoded"
+for swf in "$@"; do
+	classic=`run ${tmpdir}/classic ${swf}`
+	predecoded=`run ${tmpdir}/predecoded ${swf}`
+	printf "%-32s %10d %10d\n" `basename ${swf}` ${classic} ${predecoded}
+	total_classic=`expr ${total_classic} + ${classic}`
+	total_predecoded=`expr ${total_predecoded} + ${predecoded}`
+done
+printf "%-32s %10d %10d\n" "TOTAL" ${total_classic} ${total_predecoded}
@@ -0,0 +1,195 @@
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+#include "GC.h"
+
+#include <vector>
+
+using namespace gnash;
+
+namespace {
+
+/// A resource holding references to others.
+class Node : public GcResource
+{
+public:
+    Node(GC& gc, bool barrier = false)
+        :
+        GcResource(gc),
+        _barrier(barrier)
+    {
+        ++live;
+    }
+
+    ~Node() { --live; }
+
+    void add(Node* n) {
+        _children.push_back(n);
+        if (_barrier && GC::incrementalMarking()) n->setReachable();
+    }
+
+    void clear() { _children.clear(); }
+
+    Node* child() const { return _children.empty() ? 0 : _children.back(); }
+
+    bool writeBarriered() const { return _barrier; }
+
+    static int live;
+
+protected:
+    void markReachableResources() const {
+        for (Node* n : _children) n->setReachable();
+    }
+
+private:
+    std::vector<Node*> _children;
+    const bool _barrier;
+};
+
+int Node::live = 0;
+
+class Root : public GcRoot
+{
+public:
+    void markReachableResources() const {
+        for (Node* n : nodes) n->setReachable();
+    }
+
+    std::vector<Node*> nodes;
+};
+
+/// Make a chain of resources, returning its head.
+Node*
+chain(GC& gc, size_t length)
+{
+    Node* head = new Node(gc);
+    Node* n = head;
+    for (size_t i = 1; i < length; ++i) {
+        Node* next = new Node(gc);
+        n->add(next);
+        n = next;
+    }
+    return head;
+}
+
+/// Move a resource during incremental marking from a resource not
+/// scanned yet to one already scanned, and check that it survives.
+void
+moveWhileMarking(bool barrier)
+{
+    Root root;
+    GC gc(root);
+    const int live = Node::live;
+
+    // The root's resources are scanned last first, so the end of the
+    // chain is far from being scanned after the first step.
+    Node* head = chain(gc, 400);
+    Node* scanned = new Node(gc, barrier);
+    root.nodes.push_back(head);
+    root.nodes.push_back(scanned);
+
+    gc.setFrameBudget(1e-6);
+    gc.fuzzyCollect();
+    check(GC::incrementalMarking());
+    check(scanned->isReachable());
+
+    Node* last = head;
+    while (last->child()->child()) last = last->child();
+    Node* moved = last->child();
+    check(!moved->isReachable());
+    last->clear();
+    scanned->add(moved);
+
+    size_t calls = 0;
+    while (gc.stats().cycles == 0 && calls < 10000) {
+        gc.fuzzyCollect();
+        ++calls;
+    }
+    check_equals(gc.stats().cycles, 1u);
+    check_equals(gc.stats().lastFreed, 0u);
+    check_equals(Node::live, live + 401);
+
+    // It is still reachable in the next cycle.
+    gc.setFrameBudget(0);
+    gc.runCycle();
+    check_equals(gc.stats().lastFreed, 0u);
+    check_equals(Node::live, live + 401);
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    moveWhileMarking(true);
+    moveWhileMarking(false);
+
+    Root root;
+    GC gc(root);
+    gc.setFrameBudget(0);
+
+    // Statistics of a cycle run at once.
+    root.nodes.push_back(chain(gc, 10));
+    chain(gc, 5);
+    check_equals(gc.stats().allocated, 15u);
+
+    gc.runCycle();
+    check_equals(gc.stats().cycles, 1u);
+    check_equals(gc.stats().lastSurvived, 10u);
+    check_equals(gc.stats().lastFreed, 5u);
+    check_equals(gc.stats().lastScanned, 0u);
+    check_equals(Node::live, 10);
+    check_equals(gc.collectables(), 10u);
+
+    // Surviving resources are counted again by each cycle.
+    gc.runCycle();
+    check_equals(gc.stats().cycles, 2u);
+    check_equals(gc.stats().lastSurvived, 10u);
+    check_equals(gc.stats().lastFreed, 0u);
+    check_equals(gc.stats().survived, 20u);
+    check_equals(gc.stats().freed, 5u);
+
+    // Statistics of an incremental cycle, which takes many steps.
+    root.nodes.push_back(chain(gc, 200));
+    chain(gc, 300);
+    gc.setFrameBudget(1e-6);
+    size_t calls = 0;
+    while (gc.stats().cycles == 2 && calls < 10000) {
+        gc.fuzzyCollect();
+        ++calls;
+    }
+    check(calls > 1);
+    check_equals(gc.stats().cycles, 3u);
+    check_equals(gc.stats().lastSurvived, 210u);
+    check_equals(gc.stats().lastFreed, 300u);
+    check_equals(gc.stats().survived, 230u);
+    check_equals(gc.stats().freed, 305u);
+
+    // Each reachable resource is scanned once.
+    check_equals(gc.stats().lastScanned, 210u);
+    check_equals(gc.stats().scanned, 210u);
+    check_equals(Node::live, 210);
+    check_equals(gc.stats().pauses.total(), calls + 2);
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+#include "MemoryPool.h"
+
+#include <cstring>
+#include <cstdint>
+#include <forward_list>
+#include <vector>
+
+using namespace gnash;
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    const MemoryPool::Stats& stats = MemoryPool::stats();
+    const std::uint64_t inUse = stats.inUse;
+
+    // A freed block is reused for the next request of its size class.
+    void* a = MemoryPool::allocate(40);
+    check(a);
+    check_equals(stats.inUse, inUse + 1);
+    MemoryPool::deallocate(a, 40);
+    check_equals(stats.inUse, inUse);
+    void* b = MemoryPool::allocate(48);
+    check_equals(a, b);
+    MemoryPool::deallocate(b, 48);
+
+    // Blocks are distinct, writable and suitably aligned.
+    std::vector<char*> blocks;
+    for (size_t i = 1; i <= MemoryPool::MaxSize; ++i) {
+        char* p = static_cast<char*>(MemoryPool::allocate(i));
+        std::memset(p, static_cast<int>(i), i);
+        blocks.push_back(p);
+    }
+    bool aligned = true;
+    bool intact = true;
+    for (size_t i = 1; i <= blocks.size(); ++i) {
+        char* p = blocks[i - 1];
+        if (reinterpret_cast<std::uintptr_t>(p) % alignof(double)) {
+            aligned = false;
+        }
+        for (size_t j = 0; j < i; ++j) {
+            if (p[j] != static_cast<char>(i)) intact = false;
+        }
+    }
+    check(aligned);
+    check(intact);
+    check_equals(stats.inUse, inUse + MemoryPool::MaxSize);
+    for (size_t i = 1; i <= blocks.size(); ++i) {
+        MemoryPool::deallocate(blocks[i - 1], i);
+    }
+    check_equals(stats.inUse, inUse);
+
+    // Larger requests go to the global allocator.
+    const std::uint64_t oversized = stats.oversized;
+    void* big = MemoryPool::allocate(MemoryPool::MaxSize + 1);
+    check(big);
+    check_equals(stats.oversized, oversized + 1);
+    check_equals(stats.inUse, inUse);
+    MemoryPool::deallocate(big, MemoryPool::MaxSize + 1);
+
+    // Node based containers.
+    {
+        std::forward_list<int, PoolAllocator<int> > l;
+        for (int i = 0; i < 1000; ++i) l.push_front(i);
+        check_equals(stats.inUse, inUse + 1000);
+
+        int sum = 0;
+        for (int i : l) sum += i;
+        check_equals(sum, 999 * 1000 / 2);
+    }
+    check_equals(stats.inUse, inUse);
+
+    return 0;
+}
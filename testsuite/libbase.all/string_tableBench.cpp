@@ -0,0 +1,133 @@
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+// Compare string_table under contention with the locked
+// boost::multi_index_container it used to be built on. Each thread
+// interns the names of one "movie", as a parser thread does: mostly
+// names every movie uses, plus a few of its own. Run with "make bench".
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "string_table.h"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+
+using namespace std;
+using namespace gnash;
+
+namespace {
+
+/// The former string_table, reduced to find(). Its lookups read the
+/// index without the lock, which is only safe if nothing is being
+/// added at the same time, so here they take it.
+class LockedTable
+{
+public:
+    LockedTable() : _highestKey(0) {}
+
+    string_table::key find(const string& s) {
+        lock_guard<mutex> lock(_lock);
+        Table::iterator i = _table.find(s);
+        if (i != _table.end()) return i->id;
+        return _table.insert(string_table::svt(s, ++_highestKey)).first->id;
+    }
+
+private:
+    typedef boost::multi_index_container<string_table::svt,
+        boost::multi_index::indexed_by<
+            boost::multi_index::hashed_unique<
+                boost::multi_index::member<string_table::svt, string,
+                    &string_table::svt::value> >
+        > > Table;
+
+    Table _table;
+    mutex _lock;
+    size_t _highestKey;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+/// Run one thread per name list, each looking up its names many times.
+template<typename Table>
+double
+run(const vector<vector<string> >& movies, size_t threads)
+{
+    Table table;
+    vector<thread> workers;
+
+    const Clock::time_point start = Clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&table, &movies, t] {
+            const vector<string>& names = movies[t];
+            size_t sum = 0;
+            for (size_t rep = 0; rep < 200; ++rep) {
+                for (const string& name : names) sum += table.find(name);
+            }
+            if (!sum) cerr << "Unexpected result!" << endl;
+        });
+    }
+    for (thread& w : workers) w.join();
+
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    const size_t maxThreads = 8;
+
+    vector<vector<string> > movies(maxThreads);
+    for (size_t t = 0; t < maxThreads; ++t) {
+        for (size_t i = 0; i < 2000; ++i) {
+            ostringstream s;
+            // One name in ten is only used by this movie.
+            if (i % 10) s << "sharedName" << i;
+            else s << "movie" << t << "Name" << i;
+            movies[t].push_back(s.str());
+        }
+    }
+
+    cout << "string_table lookups (ms)" << endl;
+    cout << setw(8) << "threads" << setw(10) << "locked"
+         << setw(10) << "new" << endl;
+
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        const double locked = run<LockedTable>(movies, threads);
+        const double current = run<string_table>(movies, threads);
+        cout << fixed << setprecision(1)
+             << setw(8) << threads << setw(10) << locked
+             << setw(10) << current << endl;
+    }
+
+    return 0;
+}
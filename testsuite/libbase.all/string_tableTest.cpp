@@ -28,6 +28,9 @@
 #include <cassert>
 #include <cmath>
 #include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
 
 #include "check.h"
 
@@ -59,5 +62,81 @@ trymain(int /*argc*/, char** /*argv*/)
     check(!equal(st, st.find("AbAb"), st.find("abaB"), false));
     check(!equal(st, st.find("AbAb"), st.find("ABAB"), false));
 
+    check_equals(st.value(st.find("AbAb")), "AbAb");
+    check_equals(st.value(st.noCase(st.find("AbAb"))), "abab");
+    check_equals(st.value(0), "");
+    check_equals(st.value(1000000), "");
+
+    // Threads adding the same strings at once must agree on their keys,
+    // and keys must keep working while the table grows.
+    const size_t threads = 4;
+    const size_t names = 5000;
+    std::vector<std::vector<string_table::key> > keys(threads);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&st, &keys, t, names] {
+            for (size_t i = 0; i < names; ++i) {
+                std::ostringstream s;
+                s << "Name" << (t % 2 ? names - i - 1 : i);
+                keys[t].push_back(st.find(s.str()));
+            }
+        });
+    }
+    for (std::thread& w : workers) w.join();
+
+    bool agreed = true;
+    bool found = true;
+    for (size_t i = 0; i < names; ++i) {
+        std::ostringstream s;
+        s << "Name" << i;
+        const string_table::key k = keys[0][i];
+        if (keys[2][i] != k || keys[1][names - i - 1] != k) agreed = false;
+        if (st.value(k) != s.str() || st.find(s.str(), false) != k) {
+            found = false;
+        }
+    }
+    check(agreed);
+    check(found);
+
+    // A key found by one thread while another adds it must already
+    // have its value. Readers look up the names writers are adding,
+    // without adding them themselves.
+    const size_t added = 20000;
+    std::atomic<bool> done(false);
+    std::atomic<size_t> mismatches(0);
+    std::atomic<size_t> hits(0);
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < threads; ++t) {
+        readers.emplace_back([&st, &done, &mismatches, &hits, t, added] {
+            size_t i = t;
+            while (!done.load()) {
+                std::ostringstream s;
+                s << "Stress" << i % added;
+                const string_table::key k = st.find(s.str(), false);
+                if (k) {
+                    ++hits;
+                    if (st.value(k) != s.str()) ++mismatches;
+                }
+                i += 7;
+            }
+        });
+    }
+    std::vector<std::thread> writers;
+    for (size_t t = 0; t < 2; ++t) {
+        writers.emplace_back([&st, t, added] {
+            for (size_t i = t; i < added; i += 2) {
+                std::ostringstream s;
+                s << "Stress" << i;
+                st.find(s.str());
+            }
+        });
+    }
+    for (std::thread& w : writers) w.join();
+    done.store(true);
+    for (std::thread& r : readers) r.join();
+
+    check_equals(mismatches.load(), 0u);
+    check(hits.load() > 0);
+
     return 0;
 }
@@ -0,0 +1,198 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "BitmapLibrary.h"
+#include "RunResources.h"
+#include "Renderer.h"
+#include "GnashImage.h"
+#include "CachedBitmap.h"
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "check.h"
+
+using namespace gnash;
+
+namespace {
+
+/// A bitmap that only keeps its image.
+class TestBitmap : public CachedBitmap
+{
+public:
+    explicit TestBitmap(std::unique_ptr<image::GnashImage> im)
+        :
+        _image(std::move(im))
+    {}
+
+    image::GnashImage& image() { return *_image; }
+    void dispose() { _image.reset(); }
+    bool disposed() const { return !_image.get(); }
+
+private:
+    std::unique_ptr<image::GnashImage> _image;
+};
+
+/// A renderer that only makes bitmaps.
+class TestRenderer : public Renderer
+{
+public:
+    std::string description() const { return "Test"; }
+
+    CachedBitmap* createCachedBitmap(std::unique_ptr<image::GnashImage> im) {
+        return new TestBitmap(std::move(im));
+    }
+
+    void drawVideoFrame(image::GnashImage*, const Transform&,
+            const SWFRect*, bool) {}
+    void drawLine(const std::vector<point>&, const rgba&,
+            const SWFMatrix&) {}
+    void draw_poly(const std::vector<point>&, const rgba&, const rgba&,
+            const SWFMatrix&, bool) {}
+    void drawShape(const SWF::ShapeRecord&, const Transform&) {}
+    void drawGlyph(const SWF::ShapeRecord&, const rgba&, const SWFMatrix&) {}
+    void begin_submit_mask() {}
+    void end_submit_mask() {}
+    void disable_mask() {}
+
+    geometry::Range2d<int> world_to_pixel(const SWFRect&) const {
+        return geometry::Range2d<int>();
+    }
+
+    point pixel_to_world(int, int) const { return point(); }
+
+    void begin_display(const rgba&, int, int, float, float, float, float) {}
+    void end_display() {}
+
+    Renderer* startInternalRender(image::GnashImage&) { return nullptr; }
+    void endInternalRender() {}
+};
+
+/// The number of times each bitmap was decoded.
+std::map<int, int> decoded;
+
+/// Decode a 10x10 image, counting it.
+BitmapLibrary::Decoder
+decoder(int id)
+{
+    return [id]() {
+        ++decoded[id];
+        return std::unique_ptr<image::GnashImage>(new image::ImageRGB(10, 10));
+    };
+}
+
+/// A bitmap that can't be decoded.
+BitmapLibrary::Decoder
+failing(int id)
+{
+    return [id]() {
+        ++decoded[id];
+        return std::unique_ptr<image::GnashImage>();
+    };
+}
+
+}
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    const size_t bytes = image::ImageRGB(10, 10).size();
+
+    RunResources runResources;
+    runResources.setRenderer(std::shared_ptr<Renderer>(new TestRenderer));
+
+    // Room for three images.
+    BitmapLibrary library(runResources, bytes * 3 + bytes / 2);
+
+    for (int id = 1; id <= 5; ++id) {
+        check(library.add(id, decoder(id)));
+    }
+    check(library.add(6, failing(6)));
+    check(!library.add(1, decoder(1)));
+
+    // Bitmaps are decoded when first asked for, and only once.
+    check_equals(decoded[1], 0);
+    CachedBitmap* first = library.get(1);
+    check(first);
+    check_equals(decoded[1], 1);
+    check(library.get(1) == first);
+    check_equals(decoded[1], 1);
+    check_equals(library.decodedBytes(), bytes);
+
+    // Those that fail aren't tried again.
+    check(!library.get(6));
+    check(!library.get(6));
+    check_equals(decoded[6], 1);
+    check(!library.get(7));
+
+    // Each expire() is a new revision.
+    const size_t revision = library.revision();
+    library.expire();
+    check_equals(library.revision(), revision + 1);
+
+    // A frame using more than the limit keeps them all.
+    boost::intrusive_ptr<CachedBitmap> pinned;
+    for (int id = 1; id <= 4; ++id) {
+        CachedBitmap* b = library.get(id);
+        check(b);
+        if (id == 2) pinned = b;
+    }
+    check_equals(library.decodedBytes(), bytes * 4);
+    library.expire();
+    check_equals(library.revision(), revision + 2);
+    check_equals(library.decodedBytes(), bytes * 4);
+
+    // After a frame using only 4, the least recently used goes.
+    library.get(4);
+    library.expire();
+    check_equals(library.decodedBytes(), bytes * 3);
+
+    // A bitmap held elsewhere isn't dropped, so 3 goes next.
+    library.get(5);
+    library.expire();
+    check_equals(library.decodedBytes(), bytes * 3);
+    check(library.get(2) == pinned.get());
+    check_equals(decoded[2], 1);
+    check_equals(decoded[4], 1);
+    check_equals(decoded[5], 1);
+
+    // Dropped bitmaps are decoded again when needed.
+    check(library.get(3));
+    check_equals(decoded[3], 2);
+    check(library.get(1));
+    check_equals(decoded[1], 2);
+    check_equals(library.decodedBytes(), bytes * 5);
+
+    // Bitmaps added decoded are never dropped.
+    boost::intrusive_ptr<CachedBitmap> added(new TestBitmap(
+                std::unique_ptr<image::GnashImage>(
+                    new image::ImageRGB(10, 10))));
+    check(library.add(8, added));
+    check(library.get(8) == added.get());
+    added.reset();
+    library.expire();
+    library.expire();
+    check(library.get(8));
+    check_equals(library.decodedBytes(), bytes * 3);
+
+    return 0;
+}
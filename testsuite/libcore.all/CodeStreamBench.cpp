@@ -0,0 +1,273 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+// Time decoding AS3 bytecode as CodeStream used to read it (through
+// std::istream) and as it reads it now. The code is the mix of scope,
+// property, call and branch instructions the as3compile.all tests
+// compile to. Run with "make bench".
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "CodeStream.h"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+using namespace std;
+using namespace gnash;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double
+elapsed(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+}
+
+/// The opcodes used, with the operands Machine reads for them.
+enum {
+    OP_IFNGT = 0x0f,         // S24
+    OP_JUMP = 0x10,          // S24
+    OP_PUSHBYTE = 0x24,      // s8
+    OP_PUSHSCOPE = 0x30,
+    OP_CALLPROPERTY = 0x46,  // V32, V32
+    OP_RETURNVOID = 0x47,
+    OP_CALLPROPVOID = 0x4f,  // V32, V32
+    OP_FINDPROPSTRICT = 0x5d,// V32
+    OP_GETPROPERTY = 0x66,   // V32
+    OP_GETLOCAL0 = 0xd0,
+    OP_GETLOCAL1 = 0xd1,
+    OP_SETLOCAL1 = 0xd5
+};
+
+/// CodeStream as it was: every read goes through the stream buffer.
+class OldCodeStream : public std::istream
+{
+public:
+    explicit OldCodeStream(const std::string& data)
+        :
+        std::istream(&_buf),
+        _buf(data)
+    {}
+
+    std::uint8_t read_as3op() {
+        char data;
+        read(&data, 1);
+        return eof() ? 0 : static_cast<std::uint8_t>(data);
+    }
+
+    std::uint8_t read_u8() {
+        char data;
+        read(&data, 1);
+        return static_cast<std::uint8_t>(data);
+    }
+
+    std::int8_t read_s8() {
+        return static_cast<std::int8_t>(read_u8());
+    }
+
+    std::uint32_t read_V32() {
+        std::uint32_t result = read_u8();
+        if (!(result & 0x00000080)) return result;
+        result = (result & 0x0000007F) |
+            static_cast<std::uint32_t>(read_u8()) << 7;
+        if (!(result & 0x00004000)) return result;
+        result = (result & 0x00003FFF) |
+            static_cast<std::uint32_t>(read_u8()) << 14;
+        if (!(result & 0x00200000)) return result;
+        result = (result & 0x001FFFFF) |
+            static_cast<std::uint32_t>(read_u8()) << 21;
+        if (!(result & 0x10000000)) return result;
+        return (result & 0x0FFFFFFF) |
+            static_cast<std::uint32_t>(read_u8()) << 28;
+    }
+
+    std::int32_t read_S24() {
+        char buffer[3];
+        read(buffer, 3);
+        std::uint32_t result = static_cast<std::uint8_t>(buffer[0]);
+        result |= static_cast<std::uint32_t>(
+                static_cast<std::uint8_t>(buffer[1])) << 8;
+        result |= static_cast<std::uint32_t>(
+                static_cast<std::uint8_t>(buffer[2])) << 16;
+        if (result & (1 << 23)) result |= 0xFF000000;
+        return static_cast<std::int32_t>(result);
+    }
+
+    void seekBy(int change) {
+        seekg(change, ios_base::cur);
+    }
+
+private:
+    std::stringbuf _buf;
+};
+
+void
+V32(std::string& code, std::uint32_t v)
+{
+    while (v > 0x7f) {
+        code += static_cast<char>((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    code += static_cast<char>(v);
+}
+
+void
+S24(std::string& code, std::int32_t v)
+{
+    code += static_cast<char>(v & 0xff);
+    code += static_cast<char>((v >> 8) & 0xff);
+    code += static_cast<char>((v >> 16) & 0xff);
+}
+
+/// A method body of 'blocks' loop iterations with calls and branches.
+//
+/// Branches jump to the next instruction, so the code runs straight
+/// through but still seeks at each one.
+std::string
+method(size_t blocks)
+{
+    std::string code;
+    code += static_cast<char>(OP_GETLOCAL0);
+    code += static_cast<char>(OP_PUSHSCOPE);
+    for (size_t i = 0; i < blocks; ++i) {
+        code += static_cast<char>(OP_FINDPROPSTRICT);
+        V32(code, 5 + i % 300);
+        code += static_cast<char>(OP_PUSHBYTE);
+        code += static_cast<char>(i % 100);
+        code += static_cast<char>(OP_CALLPROPVOID);
+        V32(code, 5 + i % 300);
+        V32(code, 1);
+        code += static_cast<char>(OP_GETLOCAL1);
+        code += static_cast<char>(OP_GETPROPERTY);
+        V32(code, 20000 + i);
+        code += static_cast<char>(OP_SETLOCAL1);
+        code += static_cast<char>(OP_GETLOCAL1);
+        code += static_cast<char>(OP_PUSHBYTE);
+        code += static_cast<char>(10);
+        code += static_cast<char>(OP_IFNGT);
+        S24(code, 0);
+        code += static_cast<char>(OP_FINDPROPSTRICT);
+        V32(code, 3);
+        code += static_cast<char>(OP_CALLPROPERTY);
+        V32(code, 3);
+        V32(code, 0);
+        code += static_cast<char>(OP_JUMP);
+        S24(code, 0);
+    }
+    code += static_cast<char>(OP_RETURNVOID);
+    return code;
+}
+
+/// Decode every instruction and its operands as Machine does, returning
+/// a sum of them so that both readers can be checked to agree.
+template<typename Stream>
+std::uint64_t
+run(Stream& stream, size_t& ops)
+{
+    std::uint64_t sum = 0;
+    for (;;) {
+        const std::uint8_t op = stream.read_as3op();
+        ++ops;
+        sum += op;
+        switch (op) {
+            case OP_IFNGT:
+            case OP_JUMP:
+            {
+                const std::int32_t offset = stream.read_S24();
+                sum += offset;
+                stream.seekBy(offset);
+                break;
+            }
+            case OP_PUSHBYTE:
+                sum += stream.read_s8();
+                break;
+            case OP_FINDPROPSTRICT:
+            case OP_GETPROPERTY:
+                sum += stream.read_V32();
+                break;
+            case OP_CALLPROPERTY:
+            case OP_CALLPROPVOID:
+                sum += stream.read_V32();
+                sum += stream.read_V32();
+                break;
+            case OP_RETURNVOID:
+            case 0:
+                return sum;
+            default:
+                break;
+        }
+    }
+}
+
+void
+bench()
+{
+    cout << "AS3 bytecode decoding (ms)" << endl;
+    cout << setw(8) << "runs" << setw(10) << "ops"
+         << setw(12) << "old" << setw(10) << "new" << endl;
+
+    const std::string code = method(2000);
+    const size_t counts[] = { 10, 50, 200 };
+
+    for (size_t count : counts) {
+
+        size_t ops = 0;
+        std::uint64_t oldSum = 0;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            OldCodeStream stream(code);
+            oldSum += run(stream, ops);
+        }
+        const double o = elapsed(start);
+
+        size_t newOps = 0;
+        std::uint64_t newSum = 0;
+        start = Clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            CodeStream stream(code);
+            newSum += run(stream, newOps);
+        }
+        const double n = elapsed(start);
+
+        if (newSum != oldSum || newOps != ops) {
+            cerr << "Unexpected result!" << endl;
+        }
+
+        cout << fixed << setprecision(1)
+             << setw(8) << count << setw(10) << ops
+             << setw(12) << o << setw(10) << n << endl;
+    }
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    bench();
+    return 0;
+}
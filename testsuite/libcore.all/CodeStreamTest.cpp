@@ -57,7 +57,6 @@ main(int /*argc*/, char** /*argv*/)
 
 	//Reset stream.
 	stream->seekTo(0);
-	stream->clear();
 
 	//Test seekTo
 	stream->seekTo(5);
@@ -67,7 +66,6 @@ main(int /*argc*/, char** /*argv*/)
 
 	//Reset stream.
 	stream->seekTo(0);
-	stream->clear();	
 
 	//Test read_u8.
 	i=0;
@@ -77,7 +75,7 @@ main(int /*argc*/, char** /*argv*/)
 		i++;
 	}
 	
-	char newData[6] = {0x5,0xC5,0x0,0x0,0x1,0x2}; 
+	char newData[6] = {0x5,(char)0xC5,0x0,0x0,0x1,0x2}; 
 	CodeStream* streamA = new CodeStream(std::string(newData,6));
 	
 	std::uint8_t byteA = streamA->read_u8();
@@ -87,6 +85,23 @@ main(int /*argc*/, char** /*argv*/)
 	std::int32_t byteB = streamA->read_S24();
 	check_equals(byteB,197);
 
+	//Test read_S24 with a negative offset.
+	char negative[3] = {(char)0xFE,(char)0xFF,(char)0xFF};
+	CodeStream streamB(std::string(negative,3));
+	check_equals(streamB.read_S24(), -2);
+
+	//Test read_V32 with a high bit in each byte but the last, and
+	//the fifth byte setting bits 28-31.
+	char varint[5] = {(char)0x81,(char)0x80,(char)0x80,(char)0x80,0x0F};
+	CodeStream streamC(std::string(varint,5));
+	check_equals(streamC.read_V32(), 0xF0000001u);
+	check_equals(streamC.tell(), 5u);
+
+	//Test read_V32 with a second byte over 0x7F.
+	char twoBytes[2] = {(char)0xE5,(char)0x7F};
+	CodeStream streamD(std::string(twoBytes,2));
+	check_equals(streamD.read_V32(), 0x3FE5u);
+
 	
 	
 	return 0;
@@ -0,0 +1,359 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "SWFMovieDefinition.h"
+#include "DefineShapeTag.h"
+#include "Font.h"
+#include "RunResources.h"
+#include "TagLoadersTable.h"
+#include "DefaultTagLoaders.h"
+#include "tu_file.h"
+#include "IOChannel.h"
+#include "log.h"
+#include "rc.h"
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <memory>
+
+#include "check.h"
+
+using namespace gnash;
+
+namespace {
+
+/// The number of frames in the test movie.
+const size_t frames = 6;
+
+/// The id of the shape that can't be read.
+const int malformed = 200;
+
+/// Writes the fields of SWF records.
+class Writer
+{
+public:
+
+    Writer() : _bits(0) {}
+
+    void u8(std::uint8_t v) {
+        align();
+        _data.push_back(v);
+    }
+
+    void u16(std::uint16_t v) {
+        u8(v & 0xff);
+        u8(v >> 8);
+    }
+
+    void u32(std::uint32_t v) {
+        u16(v & 0xffff);
+        u16(v >> 16);
+    }
+
+    void bytes(const std::vector<std::uint8_t>& v) {
+        align();
+        _data.insert(_data.end(), v.begin(), v.end());
+    }
+
+    /// Write the low 'n' bits of 'v', most significant first.
+    void bits(std::uint32_t v, unsigned n) {
+        while (n--) {
+            if (!_bits) {
+                _data.push_back(0);
+                _bits = 8;
+            }
+            --_bits;
+            if ((v >> n) & 1) _data.back() |= 1 << _bits;
+        }
+    }
+
+    void sbits(std::int32_t v, unsigned n) {
+        bits(static_cast<std::uint32_t>(v), n);
+    }
+
+    void align() {
+        _bits = 0;
+    }
+
+    const std::vector<std::uint8_t>& data() const { return _data; }
+
+private:
+    std::vector<std::uint8_t> _data;
+
+    /// The bits left in the last byte.
+    unsigned _bits;
+};
+
+void
+rect(Writer& w, int size)
+{
+    w.bits(15, 5);
+    w.sbits(0, 15);
+    w.sbits(size, 15);
+    w.sbits(0, 15);
+    w.sbits(size, 15);
+    w.align();
+}
+
+/// A square outline of the given size, filled with the first style.
+void
+square(Writer& w, int size)
+{
+    w.bits(1, 4);
+    w.bits(0, 4);
+
+    // Move to the origin and set fill style 1.
+    w.bits(0, 1);
+    w.bits(0x05, 5);
+    w.bits(15, 5);
+    w.sbits(0, 15);
+    w.sbits(0, 15);
+    w.bits(1, 1);
+
+    const int edges[][2] = { {size, 0}, {0, size}, {-size, 0}, {0, -size} };
+    for (const auto& edge : edges) {
+        w.bits(1, 1);
+        w.bits(1, 1);
+        w.bits(13, 4);
+        w.bits(0, 1);
+        w.bits(edge[0] ? 0 : 1, 1);
+        w.sbits(edge[0] ? edge[0] : edge[1], 15);
+    }
+
+    w.bits(0, 6);
+    w.align();
+}
+
+void
+tag(Writer& swf, SWF::TagType type, const Writer& body)
+{
+    swf.u16((type << 6) | 0x3f);
+    swf.u32(body.data().size());
+    swf.bytes(body.data());
+}
+
+void
+defineShape(Writer& swf, int id, int size)
+{
+    Writer w;
+    w.u16(id);
+    rect(w, size);
+    w.u8(1);
+    w.u8(0x00);
+    w.u8(id);
+    w.u8(size);
+    w.u8(0x80);
+    w.u8(0);
+    square(w, size);
+    tag(swf, SWF::DEFINESHAPE, w);
+}
+
+/// A DefineShape that ends in the middle of its fill styles.
+void
+defineMalformedShape(Writer& swf, int id)
+{
+    Writer w;
+    w.u16(id);
+    rect(w, 100);
+    w.u8(5);
+    w.u8(0x00);
+    w.u8(0xff);
+    tag(swf, SWF::DEFINESHAPE, w);
+}
+
+void
+placeObject(Writer& swf, int id, int depth)
+{
+    Writer w;
+    w.u8(0x06);
+    w.u16(depth);
+    w.u16(id);
+    w.u8(0);
+    tag(swf, SWF::PLACEOBJECT2, w);
+}
+
+/// A font of squares, and the DefineFontInfo naming it.
+//
+/// DefineFontInfo looks up the font while it is read.
+void
+defineFont(Writer& swf, int id, size_t glyphs, const std::string& name)
+{
+    std::vector<Writer> shapes(glyphs);
+    for (size_t i = 0; i < glyphs; ++i) square(shapes[i], 20 * (i + 1));
+
+    Writer w;
+    w.u16(id);
+    size_t offset = 2 * glyphs;
+    for (const Writer& s : shapes) {
+        w.u16(offset);
+        offset += s.data().size();
+    }
+    for (const Writer& s : shapes) w.bytes(s.data());
+    tag(swf, SWF::DEFINEFONT, w);
+
+    Writer info;
+    info.u16(id);
+    info.u8(name.size());
+    info.bytes(std::vector<std::uint8_t>(name.begin(), name.end()));
+    info.u8(0);
+    for (size_t i = 0; i < glyphs; ++i) info.u8('a' + i);
+    tag(swf, SWF::DEFINEFONTINFO, info);
+}
+
+/// Each frame defines and places shapes, and defines a font.
+std::vector<std::uint8_t>
+movie()
+{
+    Writer tags;
+    for (size_t f = 0; f < frames; ++f) {
+        const int base = f * 20;
+        for (int i = 1; i <= 10; ++i) {
+            defineShape(tags, base + i, 100 * i + f);
+            placeObject(tags, base + i, base + i);
+            if (f == 2 && i == 5) defineMalformedShape(tags, malformed);
+        }
+        defineFont(tags, base + 11, 20 + f, "Font " + std::to_string(f));
+        tag(tags, SWF::SHOWFRAME, Writer());
+    }
+    tag(tags, SWF::END, Writer());
+
+    Writer header;
+    rect(header, 8000);
+    header.u16(12 << 8);
+    header.u16(frames);
+
+    Writer swf;
+    swf.u8('F');
+    swf.u8('W');
+    swf.u8('S');
+    swf.u8(8);
+    swf.u32(8 + header.data().size() + tags.data().size());
+    swf.bytes(header.data());
+    swf.bytes(tags.data());
+    return swf.data();
+}
+
+/// Load the movie with the given number of decoding threads.
+boost::intrusive_ptr<SWFMovieDefinition>
+load(const std::vector<std::uint8_t>& swf, unsigned int threads,
+        const RunResources& r)
+{
+    RcInitFile::getDefaultInstance().setDecodeThreads(threads);
+
+    FILE* f = std::tmpfile();
+    std::fwrite(swf.data(), 1, swf.size(), f);
+    std::rewind(f);
+
+    boost::intrusive_ptr<SWFMovieDefinition> md(new SWFMovieDefinition(r));
+    check(md->readHeader(makeFileChannel(f, true), ""));
+    check(md->completeLoad());
+
+    // Waiting for a frame past the last waits for the end of loading.
+    md->ensure_frame_loaded(frames + 1);
+    return md;
+}
+
+/// Check that the movies loaded the same way.
+void
+compare(const SWFMovieDefinition& parallel,
+        const SWFMovieDefinition& sequential)
+{
+    check_equals(parallel.get_loading_frame(),
+            sequential.get_loading_frame());
+
+    for (size_t f = 0; f < frames; ++f) {
+        const movie_definition::PlayList* p = parallel.getPlaylist(f);
+        const movie_definition::PlayList* s = sequential.getPlaylist(f);
+        check(p && s);
+        if (p && s) check_equals(p->size(), s->size());
+    }
+
+    for (int id = 1; id <= malformed; ++id) {
+        const SWF::DefineShapeTag* p =
+            dynamic_cast<SWF::DefineShapeTag*>(parallel.getDefinitionTag(id));
+        const SWF::DefineShapeTag* s =
+            dynamic_cast<SWF::DefineShapeTag*>(sequential.getDefinitionTag(id));
+        check_equals(!p, !s);
+        if (p && s) {
+            check_equals(p->bounds().toString(), s->bounds().toString());
+        }
+
+        const Font* pf = parallel.get_font(id);
+        const Font* sf = sequential.get_font(id);
+        check_equals(!pf, !sf);
+        if (pf && sf) {
+            check_equals(pf->name(), sf->name());
+            check_equals(pf->glyphCount(), sf->glyphCount());
+            check_equals(pf->get_glyph_index('c', true),
+                    sf->get_glyph_index('c', true));
+        }
+    }
+}
+
+}
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+    gnash::LogFile& dbglogfile = gnash::LogFile::getDefaultInstance();
+    dbglogfile.setVerbosity(0);
+
+    RunResources runResources;
+    std::shared_ptr<SWF::TagLoadersTable> loaders(new SWF::TagLoadersTable());
+    SWF::addDefaultLoaders(*loaders);
+    runResources.setTagLoaders(loaders);
+
+    const std::vector<std::uint8_t> swf = movie();
+
+    boost::intrusive_ptr<SWFMovieDefinition> sequential =
+        load(swf, 0, runResources);
+
+    // All frames are loaded, with every definition but the malformed one.
+    check_equals(sequential->get_loading_frame(), frames);
+    for (size_t f = 0; f < frames; ++f) {
+        for (int i = 1; i <= 10; ++i) {
+            check(sequential->getDefinitionTag(f * 20 + i));
+        }
+        const Font* font = sequential->get_font(f * 20 + 11);
+        check(font);
+        if (font) {
+            check_equals(font->name(), "Font " + std::to_string(f));
+            check_equals(font->glyphCount(), 20 + f);
+            check_equals(font->get_glyph_index('c', true), 2);
+        }
+    }
+    check(!sequential->getDefinitionTag(malformed));
+
+    // Loading is the same with several threads, however they happen
+    // to be scheduled.
+    for (size_t i = 0; i < 5; ++i) {
+        boost::intrusive_ptr<SWFMovieDefinition> parallel =
+            load(swf, 4, runResources);
+        compare(*parallel, *sequential);
+    }
+
+    RcInitFile::getDefaultInstance().setDecodeThreads(0);
+
+    return 0;
+}
@@ -0,0 +1,228 @@
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "Filters.h"
+#include "GnashImage.h"
+#include "check.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace gnash;
+
+namespace {
+
+std::mt19937 rng(20121);
+
+/// An image of random premultiplied RGBA pixels.
+//
+/// A quarter of them are transparent and a quarter opaque, as around the
+/// edges of shapes.
+std::unique_ptr<image::ImageRGBA>
+randomImage(size_t width, size_t height)
+{
+    std::unique_ptr<image::ImageRGBA> im(
+            new image::ImageRGBA(width, height));
+    std::uint8_t* p = im->begin();
+    for (size_t i = 0, e = width * height; i < e; ++i, p += 4) {
+        const unsigned kind = rng() % 4;
+        const unsigned a = kind == 0 ? 0 : kind == 1 ? 0xff : rng() % 256;
+        for (size_t c = 0; c < 3; ++c) p[c] = rng() % (a + 1);
+        p[3] = a;
+    }
+    return im;
+}
+
+/// The largest difference between the bytes of two images.
+int
+maxDifference(const image::GnashImage& a, const image::GnashImage& b)
+{
+    int d = 0;
+    for (size_t i = 0, e = a.size(); i < e; ++i) {
+        d = std::max(d, std::abs(a.begin()[i] - b.begin()[i]));
+    }
+    return d;
+}
+
+/// Apply a filter with and without the vector code, and compare.
+//
+/// The widths leave rows that the vector code only partly covers. The
+/// vector code rounds halves to even where the scalar code rounds them
+/// up, so a byte may be one off.
+void
+compare(const std::string& name, const BitmapFilter& f)
+{
+    const size_t widths[] = { 1, 3, 7, 15, 17, 33, 61 };
+    const size_t heights[] = { 1, 5, 19 };
+
+    for (size_t w : widths) {
+        for (size_t h : heights) {
+            std::unique_ptr<image::ImageRGBA> vector = randomImage(w, h);
+            image::ImageRGBA scalar(w, h);
+            scalar.update(*vector);
+
+            f.apply(*vector);
+            setFilterVectorCode(false);
+            f.apply(scalar);
+            setFilterVectorCode(true);
+
+            std::ostringstream label;
+            label << name << " " << w << "x" << h;
+            check_equals_label(label.str(),
+                    (maxDifference(*vector, scalar) <= 1), true);
+        }
+    }
+}
+
+/// A 9x9 image, transparent but for an opaque white pixel in the middle.
+std::unique_ptr<image::ImageRGBA>
+dot()
+{
+    std::unique_ptr<image::ImageRGBA> im(new image::ImageRGBA(9, 9));
+    std::fill(im->begin(), im->end(), 0);
+    std::fill(im->begin() + (4 * 9 + 4) * 4, im->begin() + (4 * 9 + 5) * 4,
+            0xff);
+    return im;
+}
+
+/// Check that every channel of each pixel of a 9x9 image has the value
+/// given for it in rows of the middle, and is zero elsewhere.
+//
+/// @param rows     The values of the 5x5 pixels around the middle, or
+///                 of fewer rows when only they are drawn.
+void
+checkDot(const std::string& name, const image::GnashImage& im,
+        const std::vector<std::vector<int> >& rows)
+{
+    const size_t top = 4 - rows.size() / 2;
+    const size_t left = 4 - rows.front().size() / 2;
+
+    size_t wrong = 0;
+    for (size_t y = 0; y < 9; ++y) {
+        for (size_t x = 0; x < 9; ++x) {
+            int expected = 0;
+            if (y >= top && y - top < rows.size() && x >= left &&
+                    x - left < rows.front().size()) {
+                expected = rows[y - top][x - left];
+            }
+            const std::uint8_t* p = im.begin() + (y * 9 + x) * 4;
+            for (size_t c = 0; c < 4; ++c) {
+                if (p[c] != expected) ++wrong;
+            }
+        }
+    }
+    check_equals_label(name, wrong, 0u);
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    compare("blur", BlurFilter(4, 4, 1));
+    compare("blur", BlurFilter(9, 2, 3));
+    compare("blur", BlurFilter(0, 40, 2));
+
+    compare("drop shadow", DropShadowFilter(4, 45, 0x336699, 0xff, 6, 6, 1,
+                1, false, false, false));
+    compare("drop shadow", DropShadowFilter(3, 200, 0xff0000, 0x80, 4, 10,
+                2.5, 3, false, true, false));
+    compare("inner shadow", DropShadowFilter(5, 90, 0x000000, 0xff, 8, 8, 1,
+                2, true, false, false));
+    compare("glow", GlowFilter(0x00ff00, 0xc0, 10, 10, 2, 1, false, false));
+
+    const float invert[] = {
+        -1, 0, 0, 0, 255,
+        0, -1, 0, 0, 255,
+        0, 0, -1, 0, 255,
+        0, 0, 0, 1, 0
+    };
+    compare("color matrix", ColorMatrixFilter(
+                std::vector<float>(invert, invert + 20)));
+
+    const float mix[] = {
+        0.3f, 0.59f, 0.11f, 0, 0,
+        0.5f, 0.5f, 0, 0, 20,
+        0, 0.25f, 1.2f, 0, -30,
+        0, 0, 0, 0.6f, 40
+    };
+    compare("color matrix", ColorMatrixFilter(
+                std::vector<float>(mix, mix + 20)));
+
+    // Known results, from the vector code and the scalar code.
+    const bool vectorCode[] = { true, false };
+    for (bool v : vectorCode) {
+        setFilterVectorCode(v);
+        const std::string code = v ? " (vector)" : " (scalar)";
+
+        // A box of 5 pixels spreads 255 to 51, then 10 over 5x5.
+        std::unique_ptr<image::ImageRGBA> im = dot();
+        BlurFilter(4, 4, 1).apply(*im);
+        const std::vector<int> ten(5, 10);
+        checkDot("blur 4x4" + code, *im,
+                std::vector<std::vector<int> >(5, ten));
+
+        // Two passes of a box of 3 pixels.
+        im = dot();
+        BlurFilter(2, 2, 2).apply(*im);
+        checkDot("blur 2x2 twice" + code, *im, {
+                { 3, 6, 9, 6, 3 },
+                { 6, 13, 19, 13, 6 },
+                { 9, 19, 28, 19, 9 },
+                { 6, 13, 19, 13, 6 },
+                { 3, 6, 9, 6, 3 } });
+
+        // Only along rows: 255 / 7.
+        im = dot();
+        BlurFilter(6, 1, 1).apply(*im);
+        checkDot("blur 6x1" + code, *im, { std::vector<int>(7, 36) });
+
+        // Inverting the colours of opaque, half transparent and
+        // transparent pixels.
+        image::ImageRGBA pixels(3, 1);
+        const std::uint8_t before[] = {
+            200, 100, 0, 255,
+            64, 32, 0, 128,
+            0, 0, 0, 0
+        };
+        std::copy(before, before + 12, pixels.begin());
+        ColorMatrixFilter(std::vector<float>(invert, invert + 20))
+            .apply(pixels);
+        const std::uint8_t after[] = {
+            55, 155, 255, 255,
+            64, 96, 128, 128,
+            0, 0, 0, 0
+        };
+        const std::string inverted = "inverted" + code;
+        check_equals_label(inverted,
+                std::equal(after, after + 12, pixels.begin()), true);
+    }
+    setFilterVectorCode(true);
+
+    return 0;
+}
+
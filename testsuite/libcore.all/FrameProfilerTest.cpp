@@ -0,0 +1,178 @@
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "FrameProfiler.h"
+#include "check.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+
+using namespace gnash;
+
+namespace {
+
+struct TraceEvent
+{
+    std::string name;
+    double start;
+    double end;
+};
+
+/// Read the complete events of a trace, in order.
+std::vector<TraceEvent>
+readEvents(const std::string& trace)
+{
+    std::vector<TraceEvent> events;
+    std::istringstream is(trace);
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.find("\"ph\":\"X\"") == std::string::npos) continue;
+        const size_t name = line.find("\"name\":\"") + 8;
+        const size_t ts = line.find("\"ts\":") + 5;
+        const size_t dur = line.find("\"dur\":") + 6;
+        TraceEvent e;
+        e.name = line.substr(name, line.find('"', name) - name);
+        e.start = std::strtod(line.c_str() + ts, nullptr);
+        e.end = e.start + std::strtod(line.c_str() + dur, nullptr);
+        events.push_back(e);
+    }
+    return events;
+}
+
+/// Whether an event lies within another, allowing for rounding in the
+/// trace.
+bool
+within(const TraceEvent& inner, const TraceEvent& outer)
+{
+    return inner.start >= outer.start - 0.002 &&
+        inner.end <= outer.end + 0.002;
+}
+
+void
+wait(int ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+/// Record a frame as movie_root::advance() does.
+void
+advance(FrameProfiler& p)
+{
+    p.startFrame();
+    FrameProfiler::Scope a(p, FrameProfiler::ADVANCE);
+    wait(1);
+    {
+        FrameProfiler::Scope m(p, FrameProfiler::ADVANCE_MOVIE);
+        wait(2);
+    }
+    {
+        FrameProfiler::Scope t(p, FrameProfiler::EXECUTE_TIMERS);
+        wait(1);
+    }
+    {
+        FrameProfiler::Scope t(p, FrameProfiler::EXECUTE_TIMERS);
+        wait(1);
+    }
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    // A disabled profiler records nothing.
+    FrameProfiler off(0);
+    check(!off.enabled());
+    check(!off.actionCounts());
+    advance(off);
+    check_equals(off.total(FrameProfiler::ADVANCE), 0);
+
+    FrameProfiler p(3);
+    check(p.enabled());
+
+    for (int i = 0; i < 4; ++i) advance(p);
+    {
+        FrameProfiler::Scope d(p, FrameProfiler::DISPLAY);
+        wait(1);
+    }
+
+    // Per-frame totals, in microseconds.
+    for (size_t ago = 0; ago < 3; ++ago) {
+        const double adv = p.total(FrameProfiler::ADVANCE, ago);
+        const double movie = p.total(FrameProfiler::ADVANCE_MOVIE, ago);
+        const double timers = p.total(FrameProfiler::EXECUTE_TIMERS, ago);
+        check(movie >= 2000);
+        check(timers >= 2000);
+        check(adv >= 5000);
+        check(adv >= movie + timers);
+    }
+    check(p.total(FrameProfiler::DISPLAY) >= 1000);
+    check_equals(p.total(FrameProfiler::DISPLAY, 1), 0);
+    check_equals(p.total(FrameProfiler::PROCESS_ACTION_QUEUE), 0);
+
+    // Only the last three frames are kept.
+    check_equals(p.total(FrameProfiler::ADVANCE, 3), 0);
+
+    std::ostringstream os;
+    p.writeTrace(os);
+    const std::vector<TraceEvent> events = readEvents(os.str());
+
+    // Three frames, each with four sections, and the display.
+    check_equals(events.size(), 16u);
+    if (events.size() != 16) return 0;
+
+    // Each section lies within its frame, and advanceMovie and
+    // executeTimers within advance.
+    size_t frames = 0;
+    for (size_t i = 0; i < events.size(); ) {
+        const TraceEvent& frame = events[i];
+        check_equals(frame.name.compare(0, 6, "frame "), 0);
+        ++frames;
+
+        const TraceEvent& adv = events[i + 4];
+        check_equals(adv.name, "advance");
+        check(within(adv, frame));
+        check_equals(events[i + 1].name, "advanceMovie");
+        check_equals(events[i + 2].name, "executeTimers");
+        check_equals(events[i + 3].name, "executeTimers");
+        for (size_t j = i + 1; j < i + 4; ++j) {
+            check(within(events[j], adv));
+        }
+        check(events[i + 2].start >= events[i + 1].end - 0.002);
+
+        i += 5;
+        if (i == 15) {
+            check_equals(events[i].name, "display");
+            check(within(events[i], frame));
+            check(events[i].start >= adv.end - 0.002);
+            ++i;
+        }
+    }
+    check_equals(frames, 3u);
+    check_equals(events[0].name, "frame 2");
+
+    return 0;
+}
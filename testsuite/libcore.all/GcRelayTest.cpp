@@ -0,0 +1,154 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "DummyMovieDefinition.h"
+#include "VM.h"
+#include "movie_root.h"
+#include "as_object.h"
+#include "as_value.h"
+#include "Global_as.h"
+#include "Relay.h"
+#include "GC.h"
+#include "log.h"
+#include "ManualClock.h"
+#include "RunResources.h"
+#include "StreamProvider.h"
+
+#include <string>
+
+#include "check.h"
+
+using namespace gnash;
+
+namespace {
+
+/// Set when the object it is the Relay of is deleted.
+class Flag : public Relay
+{
+public:
+    explicit Flag(bool& deleted) : _deleted(deleted) {}
+    ~Flag() { _deleted = true; }
+private:
+    bool& _deleted;
+};
+
+/// A Relay holding a reference in a C++ member.
+class Holder : public Relay
+{
+public:
+    explicit Holder(as_object* held) : _held(held) {}
+    void setReachable() { _held->setReachable(); }
+private:
+    as_object* _held;
+};
+
+}
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+    // Set by the end of the chain when it is deleted.
+    bool deleted = false;
+
+    RunResources runResources;
+    const URL url("");
+    runResources.setStreamProvider(
+            std::shared_ptr<StreamProvider>(new StreamProvider(url, url)));
+
+    boost::intrusive_ptr<movie_definition> md(
+            new DummyMovieDefinition(runResources, 7));
+
+    ManualClock clock;
+    movie_root root(clock, runResources);
+    root.init(md.get(), MovieClip::MovieVariables());
+
+    VM& vm = root.getVM();
+    Global_as& gl = getGlobal(vm);
+    GC& gc = root.gc();
+
+    // A long chain of objects, whose end is found late by marking.
+    as_object* head = new as_object(gl);
+    as_object* last = head;
+    for (size_t i = 0; i < 400; ++i) {
+        as_object* next = new as_object(gl);
+        last->set_member(getURI(vm, "next"), next);
+        last = next;
+    }
+    last->setRelay(new Flag(deleted));
+
+    // The object to give a Relay to, set last so that it is scanned
+    // first. Its only property shows when it has been scanned.
+    as_object* holder = new as_object(gl);
+    as_object* tag = new as_object(gl);
+    holder->set_member(getURI(vm, "tag"), tag);
+
+    gl.set_member(getURI(vm, "head"), head);
+    gl.set_member(getURI(vm, "holder"), holder);
+
+    gc.setFrameBudget(0);
+    gc.runCycle();
+    check(!deleted);
+
+    gc.setFrameBudget(1e-6);
+    for (size_t i = 0; i < 1000; ++i) {
+        new as_object(gl);
+    }
+    gc.fuzzyCollect();
+    check(GC::incrementalMarking());
+    size_t steps = 0;
+    while (!tag->isReachable() && GC::incrementalMarking() && steps < 10000) {
+        gc.fuzzyCollect();
+        ++steps;
+    }
+    check(tag->isReachable());
+    check(!last->isReachable());
+
+    // Move the end of the chain from an object not scanned yet to the
+    // Relay of one already scanned.
+    holder->setRelay(new Holder(last));
+    as_object* beforeLast = head;
+    while (getMember(*beforeLast, getURI(vm, "next")).to_object(vm) != last) {
+        beforeLast = getMember(*beforeLast, getURI(vm, "next")).to_object(vm);
+    }
+    beforeLast->delProperty(getURI(vm, "next"));
+
+    const size_t cycles = gc.stats().cycles;
+    steps = 0;
+    while (gc.stats().cycles == cycles && steps < 100000) {
+        gc.fuzzyCollect();
+        ++steps;
+    }
+    check_equals(gc.stats().cycles, cycles + 1);
+    check(!deleted);
+
+    // It stays alive through the Relay.
+    gc.setFrameBudget(0);
+    gc.runCycle();
+    check(!deleted);
+
+    // Until that goes.
+    gl.delProperty(getURI(vm, "holder"));
+    gc.runCycle();
+    check(deleted);
+
+    return 0;
+}
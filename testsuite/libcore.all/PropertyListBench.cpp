@@ -0,0 +1,288 @@
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+// Compare PropertyList with the boost::multi_index_container it used
+// to be built on (a sequenced index plus case-sensitive and caseless
+// ordered indices). Run with "make bench".
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "PropertyList.h"
+#include "DummyMovieDefinition.h"
+#include "VM.h"
+#include "movie_root.h"
+#include "as_object.h"
+#include "as_value.h"
+#include "log.h"
+#include "PropFlags.h"
+#include "ManualClock.h"
+#include "RunResources.h"
+#include "StreamProvider.h"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/tuple/tuple.hpp>
+
+using namespace std;
+using namespace gnash;
+
+namespace {
+
+struct KeyExtractor
+{
+    typedef const ObjectURI& result_type;
+    result_type operator()(const Property& p) const {
+        return p.uri();
+    }
+};
+
+struct CreationOrder {};
+struct Case {};
+struct NoCase {};
+
+/// The former PropertyList container.
+typedef boost::multi_index_container<
+    Property,
+    boost::multi_index::indexed_by<
+        boost::multi_index::sequenced<
+            boost::multi_index::tag<CreationOrder> >,
+        boost::multi_index::ordered_unique<
+            boost::multi_index::tag<Case>, KeyExtractor,
+            ObjectURI::LessThan>,
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<NoCase>, KeyExtractor,
+            ObjectURI::CaseLessThan>
+        >
+    > MultiIndex;
+
+/// The former PropertyList, reduced to what is measured here.
+class MultiIndexList
+{
+public:
+    MultiIndexList(as_object& owner)
+        :
+        _props(boost::make_tuple(
+                    boost::tuple<>(),
+                    boost::make_tuple(KeyExtractor(), ObjectURI::LessThan()),
+                    boost::make_tuple(KeyExtractor(),
+                        ObjectURI::CaseLessThan(getStringTable(owner), true))
+                    )),
+        _owner(owner)
+    {}
+
+    bool setValue(const ObjectURI& uri, const as_value& val) {
+        MultiIndex::const_iterator it = find(uri);
+        if (it == _props.end()) {
+            _props.push_back(Property(uri, val, 0));
+            return true;
+        }
+        return it->setValue(_owner, val);
+    }
+
+    Property* getProperty(const ObjectURI& uri) const {
+        MultiIndex::const_iterator it = find(uri);
+        if (it == _props.end()) return nullptr;
+        return const_cast<Property*>(&*it);
+    }
+
+    /// As the former PropertyList::visitKeys.
+    template<typename V>
+    void visit(V& v) const {
+        PropertyList::PropertyTracker done;
+        for (const Property& p : _props) {
+            if (p.getFlags().test<PropFlags::dontEnum>()) continue;
+            if (done.insert(p.uri()).second) v(p.uri());
+        }
+    }
+
+private:
+    MultiIndex::const_iterator find(const ObjectURI& uri) const {
+        if (getVM(_owner).getSWFVersion() > 6) {
+            return _props.project<CreationOrder>(
+                    _props.get<Case>().find(uri));
+        }
+        return _props.project<CreationOrder>(
+                _props.get<NoCase>().find(uri));
+    }
+
+    MultiIndex _props;
+    as_object& _owner;
+};
+
+struct Counter : KeyVisitor
+{
+    Counter() : count(0) {}
+    void operator()(const ObjectURI&) { ++count; }
+    size_t count;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+double
+elapsed(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+}
+
+/// Time building, reading (hits and misses) and enumerating lists of
+/// the given size, in milliseconds.
+template<typename List>
+void
+run(as_object& obj, const vector<ObjectURI>& names,
+        const vector<ObjectURI>& missing, size_t count, size_t lists,
+        double& build, double& lookup, double& enumerate)
+{
+    const as_value val(1.0);
+    vector<unique_ptr<List> > all;
+
+    Clock::time_point start = Clock::now();
+    for (size_t l = 0; l < lists; ++l) {
+        all.emplace_back(new List(obj));
+        for (size_t i = 0; i < count; ++i) all.back()->setValue(names[i], val);
+    }
+    build = elapsed(start);
+
+    size_t found = 0;
+    start = Clock::now();
+    for (size_t rep = 0; rep < 10; ++rep) {
+        for (const auto& list : all) {
+            for (size_t i = 0; i < count; ++i) {
+                if (list->getProperty(names[i])) ++found;
+                if (list->getProperty(missing[i])) ++found;
+            }
+        }
+    }
+    lookup = elapsed(start);
+
+    Counter c;
+    start = Clock::now();
+    for (size_t rep = 0; rep < 10; ++rep) {
+        for (const auto& list : all) list->visit(c);
+    }
+    enumerate = elapsed(start);
+
+    if (found != lists * count * 10 || c.count != lists * count * 10) {
+        cerr << "Unexpected result!" << endl;
+    }
+}
+
+/// Gives PropertyList the interface of MultiIndexList.
+class Adapter
+{
+public:
+    Adapter(as_object& owner) : _props(owner) {}
+
+    bool setValue(const ObjectURI& uri, const as_value& val) {
+        return _props.setValue(uri, val);
+    }
+
+    Property* getProperty(const ObjectURI& uri) const {
+        return _props.getProperty(uri);
+    }
+
+    template<typename V>
+    void visit(V& v) const {
+        PropertyList::PropertyTracker done;
+        _props.visitKeys(v, done);
+    }
+
+private:
+    PropertyList _props;
+};
+
+void
+bench(movie_root& root, const char* label)
+{
+    VM& vm = root.getVM();
+    as_object* obj = new as_object(getGlobal(vm));
+
+    const size_t maxCount = 256;
+    vector<ObjectURI> names, missing;
+    for (size_t i = 0; i < maxCount; ++i) {
+        ostringstream s;
+        s << "prop" << i;
+        names.push_back(getURI(vm, s.str()));
+        s << "_missing";
+        missing.push_back(getURI(vm, s.str()));
+    }
+
+    cout << label << " (ms)" << endl;
+    cout << setw(6) << "props"
+         << setw(14) << "build old" << setw(10) << "new"
+         << setw(14) << "lookup old" << setw(10) << "new"
+         << setw(14) << "enum old" << setw(10) << "new" << endl;
+
+    const size_t counts[] = { 2, 4, 8, 16, 64, 256 };
+
+    for (size_t count : counts) {
+
+        // Keep the number of properties constant.
+        const size_t lists = 100000 / count;
+
+        double ob, ol, oe, nb, nl, ne;
+        run<MultiIndexList>(*obj, names, missing, count, lists, ob, ol, oe);
+        run<Adapter>(*obj, names, missing, count, lists, nb, nl, ne);
+
+        cout << fixed << setprecision(1)
+             << setw(6) << count
+             << setw(14) << ob << setw(10) << nb
+             << setw(14) << ol << setw(10) << nl
+             << setw(14) << oe << setw(10) << ne << endl;
+    }
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    // We don't care about the base URL.
+    RunResources runResources;
+    const URL url("");
+    runResources.setStreamProvider(
+            std::shared_ptr<StreamProvider>(new StreamProvider(url, url)));
+
+    // SWF 6 lookups are caseless, SWF 7 lookups are not.
+    boost::intrusive_ptr<movie_definition> md6(
+            new DummyMovieDefinition(runResources, 6));
+    boost::intrusive_ptr<movie_definition> md7(
+            new DummyMovieDefinition(runResources, 7));
+
+    ManualClock clock;
+
+    movie_root root6(clock, runResources);
+    root6.init(md6.get(), MovieClip::MovieVariables());
+    bench(root6, "SWF6 (caseless)");
+
+    movie_root root7(clock, runResources);
+    root7.init(md7.get(), MovieClip::MovieVariables());
+    bench(root7, "SWF7");
+
+    return 0;
+}
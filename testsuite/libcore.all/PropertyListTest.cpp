@@ -31,6 +31,7 @@
 #include "ManualClock.h"
 #include "RunResources.h"
 #include "StreamProvider.h"
+#include "namedStrings.h"
 
 #include <iostream>
 #include <sstream>
@@ -203,6 +204,130 @@ trymain(int /*argc*/, char** /*argv*/)
 		check_equals(props.size(), 3);
 
 	}
+
+	// The layout changes with the set of properties and their flags,
+	// but not with their values.
+	{
+		PropertyList other(*obj);
+		check(other.layout() != props.layout());
+
+		std::uint64_t layout = props.layout();
+		check ( props.setValue(getURI(vm, "var1"), val2) );
+		check_equals(props.layout(), layout);
+
+		check ( props.setValue(getURI(vm, "var4"), val) );
+		check(props.layout() != layout);
+		layout = props.layout();
+
+		props.setFlags(getURI(vm, "var4"), PropFlags::dontEnum, 0);
+		check(props.layout() != layout);
+		layout = props.layout();
+
+		check(props.delProperty(getURI(vm, "var4")).second);
+		check(props.layout() != layout);
+
+		// Setting any __proto__ bumps the prototype epoch.
+		const std::uint64_t epoch = PropertyList::prototypeEpoch();
+		check ( props.setValue(NSV::PROP_uuPROTOuu, val) );
+		check_equals(PropertyList::prototypeEpoch(), epoch);
+		check ( props.setValue(NSV::PROP_uuPROTOuu, val2) );
+		check(PropertyList::prototypeEpoch() != epoch);
+	}
+
+	// Lists larger than PropertyList::SmallSize are indexed. Deleted
+	// properties leave holes until half of them are, when the list is
+	// compacted.
+	{
+		vm.setSWFVersion(7);
+		PropertyList big(*obj);
+		const size_t count = 40;
+		check(count > PropertyList::SmallSize);
+
+		for (size_t i = 0; i < count; ++i) {
+			big.setValue(getURI(vm, "p" + std::to_string(i)), as_value(i));
+		}
+		check_equals(big.size(), count);
+
+		size_t missing = 0;
+		for (size_t i = 0; i < count; ++i) {
+			if (!getVal(big, getURI(vm, "p" + std::to_string(i)), ret, *obj) ||
+					!ret.strictly_equals(as_value(i))) {
+				++missing;
+			}
+		}
+		check_equals(missing, 0);
+		check (!getVal(big, getURI(vm, "P1"), ret, *obj) );
+
+		// Half of them deleted leaves holes.
+		for (size_t i = 0; i < count; i += 2) {
+			check(big.delProperty(getURI(vm, "p" + std::to_string(i))).second);
+		}
+		check_equals(big.size(), count / 2);
+
+		// One more compacts the list.
+		check(big.delProperty(getURI(vm, "p1")).second);
+		check_equals(big.size(), count / 2 - 1);
+
+		size_t wrong = 0;
+		for (size_t i = 0; i < count; ++i) {
+			const bool kept = i % 2 && i != 1;
+			const bool found =
+				getVal(big, getURI(vm, "p" + std::to_string(i)), ret, *obj);
+			if (found != kept || (found && !ret.strictly_equals(as_value(i)))) {
+				++wrong;
+			}
+		}
+		check_equals(wrong, 0);
+
+		// Creation order is kept.
+		std::vector<std::pair<std::uint32_t, ObjectURI> > keys;
+		big.orderedKeys(keys);
+		check_equals(keys.size(), count / 2 - 1);
+		check_equals(toString(vm, keys.front().second), "p3");
+		check_equals(toString(vm, keys.back().second), "p39");
+
+		// Properties added after compacting, or again, are found.
+		check ( big.setValue(getURI(vm, "p40"), val) );
+		check ( big.setValue(getURI(vm, "p0"), val2) );
+		check_equals(big.size(), count / 2 + 1);
+		check (getVal(big, getURI(vm, "p40"), ret, *obj) );
+		check_strictly_equals ( ret, val );
+		check (getVal(big, getURI(vm, "p0"), ret, *obj) );
+		check_strictly_equals ( ret, val2 );
+		check (getVal(big, getURI(vm, "p39"), ret, *obj) );
+		check_strictly_equals ( ret, as_value(39) );
+	}
+
+	// Properties differing only in case can be added in SWF7. Caseless
+	// lookups find the first in creation order, whether the list is
+	// scanned or indexed.
+	for (size_t count : { 3, 20 }) {
+		vm.setSWFVersion(7);
+		PropertyList mixed(*obj);
+		for (size_t i = 3; i < count; ++i) {
+			mixed.setValue(getURI(vm, "q" + std::to_string(i)), val);
+		}
+		check ( mixed.setValue(getURI(vm, "Abc"), val) );
+		check ( mixed.setValue(getURI(vm, "abc"), val2) );
+		check ( mixed.setValue(getURI(vm, "ABC"), val3) );
+		check_equals(mixed.size(), count);
+
+		vm.setSWFVersion(6);
+		check (getVal(mixed, getURI(vm, "aBC"), ret, *obj) );
+		check_strictly_equals ( ret, val );
+
+		// Deleting it leaves the next one first.
+		check(mixed.delProperty(getURI(vm, "ABC")).second);
+		check (getVal(mixed, getURI(vm, "aBC"), ret, *obj) );
+		check_strictly_equals ( ret, val2 );
+
+		vm.setSWFVersion(7);
+		check (!getVal(mixed, getURI(vm, "Abc"), ret, *obj) );
+		check (getVal(mixed, getURI(vm, "ABC"), ret, *obj) );
+		check_strictly_equals ( ret, val3 );
+	}
+	vm.setSWFVersion(5);
+
 	return 0;
 }
 
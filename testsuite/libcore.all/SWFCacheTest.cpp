@@ -0,0 +1,227 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "SWFCache.h"
+#include "IOChannel.h"
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <utime.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "check.h"
+
+using namespace gnash;
+
+namespace {
+
+/// A compressed SWF file; only its bytes matter to the cache.
+std::vector<std::uint8_t>
+compressed(std::uint8_t seed, size_t size)
+{
+    std::vector<std::uint8_t> swf(size);
+    const std::uint8_t header[] = { 'C', 'W', 'S', 8, 0, 0, 1, 0 };
+    std::copy(header, header + 8, swf.begin());
+    for (size_t i = 8; i < size; ++i) swf[i] = seed + i * 7;
+    return swf;
+}
+
+/// What it inflates to, as SWFCache::inflate() would leave it.
+std::vector<std::uint8_t>
+inflated(const std::vector<std::uint8_t>& swf, size_t size)
+{
+    std::vector<std::uint8_t> out(size);
+    std::copy(swf.begin(), swf.begin() + 8, out.begin());
+    for (size_t i = 8; i < size; ++i) out[i] = swf[8] ^ i;
+    return out;
+}
+
+/// The names of the files in a directory, sorted.
+std::vector<std::string>
+list(const std::string& dir)
+{
+    std::vector<std::string> names;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return names;
+    while (const struct dirent* entry = readdir(d)) {
+        const std::string name = entry->d_name;
+        if (name != "." && name != "..") names.push_back(name);
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+/// The names in after that aren't in before.
+std::string
+added(const std::vector<std::string>& before,
+        const std::vector<std::string>& after)
+{
+    for (const std::string& name : after) {
+        if (std::find(before.begin(), before.end(), name) == before.end()) {
+            return name;
+        }
+    }
+    return std::string();
+}
+
+bool
+exists(const std::string& file)
+{
+    struct stat st;
+    return !stat(file.c_str(), &st);
+}
+
+void
+setTime(const std::string& file, time_t t)
+{
+    struct utimbuf times;
+    times.actime = t;
+    times.modtime = t;
+    utime(file.c_str(), &times);
+}
+
+void
+writeFile(const std::string& file, size_t size)
+{
+    std::ofstream out(file.c_str(), std::ios::binary);
+    out << std::string(size, 'x');
+}
+
+/// Store a copy, and return the name of the file it is kept in.
+std::string
+store(const SWFCache& cache, const std::string& dir,
+        const std::vector<std::uint8_t>& swf, size_t size)
+{
+    const std::vector<std::string> before = list(dir);
+    check(cache.store(swf.data(), swf.size(), inflated(swf, size)));
+    return added(before, list(dir));
+}
+
+/// Whether the copy found is the stored file, marked uncompressed.
+bool
+found(const SWFCache& cache, const std::vector<std::uint8_t>& swf,
+        size_t size)
+{
+    std::unique_ptr<IOChannel> copy = cache.find(swf.data(), swf.size());
+    if (!copy) return false;
+
+    const std::uint8_t* data = copy->map();
+    if (!data || copy->size() != size) return false;
+
+    std::vector<std::uint8_t> expected = inflated(swf, size);
+    expected[0] = 'F';
+    for (size_t i = 0; i < 4; ++i) expected[4 + i] = size >> (8 * i);
+    return std::equal(expected.begin(), expected.end(), data);
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    char tmpl[] = "/tmp/SWFCacheTest.XXXXXX";
+    const char* made = mkdtemp(tmpl);
+    check(made);
+    if (!made) return EXIT_FAILURE;
+    const std::string dir(made);
+
+    const SWFCache disabled("", 0);
+    check(!disabled.enabled());
+
+    // Copies are found again, and only for the same file.
+    const SWFCache cache(dir, 0);
+    check(cache.enabled());
+    const std::vector<std::uint8_t> a = compressed(1, 500);
+    const std::string aName = store(cache, dir, a, 1000);
+    check(!aName.empty());
+    check(found(cache, a, 1000));
+    check(!found(cache, compressed(2, 500), 1000));
+    check(!found(cache, compressed(1, 501), 1000));
+
+    // A truncated copy is removed.
+    const std::string aFile = dir + "/" + aName;
+    check_equals(truncate(aFile.c_str(), 900), 0);
+    check(!found(cache, a, 1000));
+    check(!exists(aFile));
+
+    // So is one of another SWF version.
+    store(cache, dir, a, 1000);
+    {
+        std::fstream f(aFile.c_str(),
+                std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(3);
+        f.put(9);
+    }
+    check(!found(cache, a, 1000));
+    check(!exists(aFile));
+
+    // The least recently played copies go first when over the limit.
+    const SWFCache small(dir, 3500);
+    const std::vector<std::uint8_t> b = compressed(3, 500);
+    const std::vector<std::uint8_t> c = compressed(4, 500);
+    const std::vector<std::uint8_t> d = compressed(5, 500);
+    const time_t now = std::time(nullptr);
+    setTime(dir + "/" + store(small, dir, a, 1000), now - 300);
+    const std::string bFile = dir + "/" + store(small, dir, b, 1000);
+    setTime(bFile, now - 200);
+    setTime(dir + "/" + store(small, dir, c, 1000), now - 100);
+
+    // Files not made by the cache are neither counted nor removed, and
+    // those written to before renaming only when they are old.
+    const std::string foreign = dir + "/movie.swf";
+    writeFile(foreign, 5000);
+    const std::string stale = aFile + ".123.tmp";
+    writeFile(stale, 100);
+    setTime(stale, now - 7200);
+    const std::string writing = aFile + ".124.tmp";
+    writeFile(writing, 100);
+
+    // Playing a makes b the least recently played.
+    check(found(small, a, 1000));
+    store(small, dir, d, 1000);
+    check(found(small, a, 1000));
+    check(!exists(bFile));
+    check(found(small, c, 1000));
+    check(found(small, d, 1000));
+    check(exists(foreign));
+    check(!exists(stale));
+    check(exists(writing));
+
+    // Copies over the limit on their own aren't kept.
+    const SWFCache tiny(dir, 500);
+    check(!tiny.store(b.data(), b.size(), inflated(b, 1000)));
+
+    for (const std::string& name : list(dir)) {
+        std::remove((dir + "/" + name).c_str());
+    }
+    rmdir(dir.c_str());
+
+    return 0;
+}
@@ -0,0 +1,308 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "SWFStream.h"
+#include "IOChannel.h"
+#include "GnashException.h"
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+
+#include "check.h"
+
+using namespace gnash;
+
+namespace {
+
+/// Reads bytes from memory only through the IOChannel interface.
+class BufferChannel : public IOChannel
+{
+public:
+
+    explicit BufferChannel(const std::vector<std::uint8_t>& data)
+        :
+        _data(data),
+        _pos(0)
+    {}
+
+    std::streamsize read(void* dst, std::streamsize bytes) {
+        bytes = std::min<std::streamsize>(bytes, _data.size() - _pos);
+        std::copy(_data.begin() + _pos, _data.begin() + _pos + bytes,
+                static_cast<std::uint8_t*>(dst));
+        _pos += bytes;
+        return bytes;
+    }
+
+    std::streampos tell() const { return _pos; }
+
+    bool seek(std::streampos p) {
+        if (p > static_cast<std::streampos>(_data.size())) return false;
+        _pos = p;
+        return true;
+    }
+
+    void go_to_end() { _pos = _data.size(); }
+
+    bool eof() const { return _pos == _data.size(); }
+
+    bool bad() const { return false; }
+
+    size_t size() const { return _data.size(); }
+
+private:
+    const std::vector<std::uint8_t>& _data;
+    size_t _pos;
+};
+
+/// The same bytes read through an IOChannel and from memory.
+struct Streams
+{
+    explicit Streams(const std::vector<std::uint8_t>& data)
+        :
+        channel(data),
+        viaChannel(&channel),
+        inMemory(data.data(), data.size(), 0)
+    {}
+
+    BufferChannel channel;
+    SWFStream viaChannel;
+    SWFStream inMemory;
+};
+
+/// Reads the SWF encoding one bit at a time.
+class Reference
+{
+public:
+
+    explicit Reference(const std::vector<std::uint8_t>& data)
+        :
+        _data(data),
+        _bit(0)
+    {}
+
+    std::uint32_t bits(unsigned n) {
+        std::uint32_t v = 0;
+        for (unsigned i = 0; i < n; ++i, ++_bit) {
+            v = (v << 1) | ((_data[_bit / 8] >> (7 - _bit % 8)) & 1);
+        }
+        return v;
+    }
+
+    std::int32_t sbits(unsigned n) {
+        std::uint32_t v = bits(n);
+        if (n < 32 && (v & (1u << (n - 1)))) v |= ~0u << n;
+        return v;
+    }
+
+    /// An aligned little-endian value.
+    std::uint32_t le(unsigned bytes) {
+        _bit = (_bit + 7) / 8 * 8;
+        std::uint32_t v = 0;
+        for (unsigned i = 0; i < bytes; ++i) {
+            v |= static_cast<std::uint32_t>(_data[_bit / 8 + i]) << (8 * i);
+        }
+        _bit += 8 * bytes;
+        return v;
+    }
+
+    unsigned long tell() const { return (_bit + 7) / 8; }
+
+private:
+    const std::vector<std::uint8_t>& _data;
+    size_t _bit;
+};
+
+/// Whether calling f throws a ParserException.
+template<typename F>
+bool
+throws(F f)
+{
+    try {
+        f();
+    }
+    catch (const ParserException&) {
+        return true;
+    }
+    return false;
+}
+
+/// Whether both streams throw a ParserException for the same read.
+template<typename F>
+bool
+bothThrow(Streams& s, F f)
+{
+    return throws([&] { f(s.viaChannel); }) && throws([&] { f(s.inMemory); });
+}
+
+}
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+    std::vector<std::uint8_t> data(8192);
+    std::uint32_t seed = 12345;
+    for (std::uint8_t& b : data) {
+        seed = seed * 1103515245 + 12345;
+        b = seed >> 16;
+    }
+
+    // Every bit count from 1 to 32, starting anywhere in a byte, and
+    // mixed with aligned reads.
+    {
+        Streams s(data);
+        Reference ref(data);
+        size_t differences = 0;
+
+        for (size_t i = 0; i < 1000; ++i) {
+            seed = seed * 1103515245 + 12345;
+            const unsigned n = i % 32 + 1;
+            std::uint32_t expected, channel, memory;
+
+            switch ((seed >> 16) % 6) {
+                case 0:
+                    expected = ref.bits(n);
+                    channel = s.viaChannel.read_uint(n);
+                    memory = s.inMemory.read_uint(n);
+                    break;
+                case 1:
+                    expected = ref.sbits(n);
+                    channel = s.viaChannel.read_sint(n);
+                    memory = s.inMemory.read_sint(n);
+                    break;
+                case 2:
+                    expected = ref.bits(1);
+                    channel = s.viaChannel.read_bit();
+                    memory = s.inMemory.read_bit();
+                    break;
+                case 3:
+                    expected = ref.le(1);
+                    channel = s.viaChannel.read_u8();
+                    memory = s.inMemory.read_u8();
+                    break;
+                case 4:
+                    expected = ref.le(2);
+                    channel = s.viaChannel.read_u16();
+                    memory = s.inMemory.read_u16();
+                    break;
+                default:
+                    expected = ref.le(4);
+                    channel = s.viaChannel.read_u32();
+                    memory = s.inMemory.read_u32();
+                    break;
+            }
+
+            if (channel != expected || memory != expected ||
+                    s.viaChannel.tell() != ref.tell() ||
+                    s.inMemory.tell() != ref.tell()) {
+                if (!differences) {
+                    std::cout << "Read " << i << " gave " << channel << " and "
+                        << memory << " instead of " << expected << std::endl;
+                }
+                ++differences;
+            }
+        }
+        check_equals(differences, 0);
+    }
+
+    const std::vector<std::uint8_t> five(data.begin(), data.begin() + 5);
+
+    // Reading up to the last bit works.
+    {
+        Streams s(five);
+        Reference ref(five);
+        const std::uint32_t first = ref.bits(8);
+        const std::uint32_t last = ref.bits(32);
+        check_equals(s.viaChannel.read_uint(8), first);
+        check_equals(s.inMemory.read_uint(8), first);
+        check_equals(s.viaChannel.read_uint(32), last);
+        check_equals(s.inMemory.read_uint(32), last);
+    }
+
+    // Reading past it doesn't.
+    {
+        Streams s(five);
+        s.viaChannel.read_uint(9);
+        s.inMemory.read_uint(9);
+        check(bothThrow(s, [](SWFStream& in) { in.read_uint(32); }));
+    }
+    {
+        Streams s(five);
+        check(s.viaChannel.seek(1));
+        check(s.inMemory.seek(1));
+        s.viaChannel.read_bit();
+        s.inMemory.read_bit();
+        check(bothThrow(s, [](SWFStream& in) { in.read_sint(32); }));
+    }
+    {
+        Streams s(five);
+        check(s.viaChannel.seek(5));
+        check(s.inMemory.seek(5));
+        check(bothThrow(s, [](SWFStream& in) { in.read_bit(); }));
+    }
+    {
+        Streams s(five);
+        check(s.viaChannel.seek(5));
+        check(s.inMemory.seek(5));
+        check(bothThrow(s, [](SWFStream& in) { in.read_u8(); }));
+    }
+    {
+        Streams s(five);
+        check(s.viaChannel.seek(3));
+        check(s.inMemory.seek(3));
+        check(bothThrow(s, [](SWFStream& in) { in.read_u32(); }));
+    }
+    {
+        Streams s(five);
+        check(s.viaChannel.seek(4));
+        check(s.inMemory.seek(4));
+        check(bothThrow(s, [](SWFStream& in) { in.read_u16(); }));
+    }
+    {
+        Streams s(five);
+        check(!s.viaChannel.seek(6));
+        check(!s.inMemory.seek(6));
+    }
+
+    // Within a tag, the checks stop at its end.
+    {
+        std::vector<std::uint8_t> tag = { 0x02, 0x00, 0xab, 0xcd, 0xef };
+        Streams s(tag);
+        check_equals(s.viaChannel.open_tag(), 0);
+        check_equals(s.inMemory.open_tag(), 0);
+        check_equals(s.viaChannel.get_tag_end_position(), 4u);
+        check_equals(s.inMemory.get_tag_end_position(), 4u);
+        s.viaChannel.ensureBits(16);
+        s.inMemory.ensureBits(16);
+        check_equals(s.viaChannel.read_uint(3), 5u);
+        check_equals(s.inMemory.read_uint(3), 5u);
+        check(bothThrow(s, [](SWFStream& in) { in.ensureBits(14); }));
+        check(bothThrow(s, [](SWFStream& in) { in.ensureBytes(2); }));
+        s.viaChannel.close_tag();
+        s.inMemory.close_tag();
+        check_equals(s.viaChannel.read_u8(), 0xef);
+        check_equals(s.inMemory.read_u8(), 0xef);
+    }
+
+    return 0;
+}
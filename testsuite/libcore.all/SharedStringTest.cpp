@@ -0,0 +1,116 @@
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "SharedString.h"
+#include "as_value.h"
+
+#include <string>
+#include <sstream>
+
+#include "check.h"
+
+using namespace std;
+using namespace gnash;
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    SharedString empty;
+    check(empty.empty());
+    check_equals(empty.str(), "");
+    check(!SharedString(string()).isRope());
+
+    SharedString a(string("abc"));
+    check_equals(a.size(), 3);
+    check_equals(a + empty, a);
+    check_equals(empty + a, a);
+
+    // Short concatenations are joined at once.
+    SharedString ab = a + SharedString(string("def"));
+    check(!ab.isRope());
+    check_equals(ab.str(), "abcdef");
+
+    // Long ones are joined when first read.
+    const string big(300, 'x');
+    SharedString rope = SharedString(big) + a;
+    check(rope.isRope());
+    check_equals(rope.size(), 303);
+    check_equals(rope.str(), big + "abc");
+    check(!rope.isRope());
+
+    // Copies share the joined string.
+    SharedString left = SharedString(big) + SharedString(big);
+    SharedString copy = left;
+    check(copy.isRope());
+    check_equals(left.str(), big + big);
+    check(!copy.isRope());
+    check_equals(&copy.str(), &left.str());
+
+    // Operands are unchanged by concatenation.
+    SharedString both = left + rope;
+    check_equals(both.str(), big + big + big + "abc");
+    check_equals(left.str(), big + big);
+    check_equals(rope.str(), big + "abc");
+
+    check(SharedString(string("abc")) == a);
+    check(SharedString(string("abd")) != a);
+
+    // Build a long string a few characters at a time, as an ActionScript
+    // "s += x" loop does. Each step keeps the previous string alive.
+    ostringstream expected;
+    SharedString s;
+    SharedString prev;
+    for (size_t i = 0; i < 100000; ++i) {
+        ostringstream piece;
+        piece << i << ',';
+        expected << piece.str();
+        prev = s;
+        s = s + SharedString(piece.str());
+    }
+    check_equals(s.size(), expected.str().size());
+    check_equals(s.str(), expected.str());
+    check(prev.str() == expected.str().substr(0, prev.size()));
+
+    // A very deep rope must not overflow the stack when freed.
+    {
+        const SharedString piece(big);
+        SharedString deep = piece;
+        for (size_t i = 0; i < 200000; ++i) {
+            deep = deep + piece;
+        }
+        check_equals(deep.size(), 300 * 200001);
+    }
+
+    // as_value String values share their storage.
+    as_value v(left);
+    check(v.is_string());
+    check_equals(v.to_string(), big + big);
+    check_equals(&v.to_shared_string().str(), &left.str());
+
+    as_value w = v;
+    check(w.strictly_equals(v));
+    w.set_string(string("abc"));
+    check(!w.strictly_equals(v));
+    check(w.strictly_equals(as_value("abc")));
+
+    return 0;
+}
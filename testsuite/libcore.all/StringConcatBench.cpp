@@ -0,0 +1,114 @@
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+// Time building a string with repeated "s += x" additions, as string
+// values used to be concatenated (copying both operands) and as they
+// are now. Run with "make bench".
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "DummyMovieDefinition.h"
+#include "VM.h"
+#include "movie_root.h"
+#include "as_value.h"
+#include "ManualClock.h"
+#include "RunResources.h"
+#include "StreamProvider.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+
+using namespace std;
+using namespace gnash;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double
+elapsed(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+}
+
+void
+bench(VM& vm)
+{
+    const int version = vm.getSWFVersion();
+    const as_value piece("<item/>,");
+
+    cout << "String additions (ms)" << endl;
+    cout << setw(8) << "steps" << setw(10) << "length"
+         << setw(12) << "old" << setw(10) << "new" << endl;
+
+    const size_t counts[] = { 1000, 4000, 16000, 32000 };
+
+    for (size_t count : counts) {
+
+        as_value old("");
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            old = as_value(old.to_string(version) + piece.to_string(version));
+        }
+        const size_t length = old.to_string(version).size();
+        const double o = elapsed(start);
+
+        as_value s("");
+        start = Clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            newAdd(s, piece, vm);
+        }
+        // Reading the result joins it.
+        if (s.to_string(version).size() != length) {
+            cerr << "Unexpected result!" << endl;
+        }
+        const double n = elapsed(start);
+
+        cout << fixed << setprecision(1)
+             << setw(8) << count << setw(10) << length
+             << setw(12) << o << setw(10) << n << endl;
+    }
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    // We don't care about the base URL.
+    RunResources runResources;
+    const URL url("");
+    runResources.setStreamProvider(
+            std::shared_ptr<StreamProvider>(new StreamProvider(url, url)));
+
+    boost::intrusive_ptr<movie_definition> md(
+            new DummyMovieDefinition(runResources, 7));
+
+    ManualClock clock;
+
+    movie_root root(clock, runResources);
+    root.init(md.get(), MovieClip::MovieVariables());
+    bench(root.getVM());
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+//
+// Test that a cached bitmap dropped to make room for others is still drawn.
+// Build with:
+//	makeswf -v8 -o BitmapCacheTest.swf BitmapCacheTest.as
+// Run with:
+//	gnash BitmapCacheTest.swf
+//
+// A small cached clip sits in an unchanging parent over a background
+// that changes each frame, so the parent keeps its recorded drawing.
+// Each frame then adds a large cached clip; with a small bitmapCacheSize
+// in gnashrc these drop the small clip's image.
+//
+
+box = function(mc, x, y, w, h, color)
+{
+	mc.clear();
+	mc.beginFill(color);
+	mc.moveTo(x, y);
+	mc.lineTo(x + w, y);
+	mc.lineTo(x + w, y + h);
+	mc.lineTo(x, y + h);
+	mc.lineTo(x, y);
+	mc.endFill();
+};
+
+createEmptyMovieClip("bg", 1);
+box(bg, 0, 0, 100, 100, 0xFF0000);
+
+createEmptyMovieClip("p", 2);
+p.createEmptyMovieClip("a", 1);
+box(p.a, 40, 40, 20, 20, 0x00FF00);
+p.a.cacheAsBitmap = true;
+
+frames = 0;
+onEnterFrame = function()
+{
+	++frames;
+	box(bg, 0, 0, 100, 100, frames % 2 ? 0x0000FF : 0xFF0000);
+
+	var big = createEmptyMovieClip("big" + frames, 10 + frames);
+	box(big, 150, 50, 300, 300, 0xFFFF00);
+	big.cacheAsBitmap = true;
+};
+
+stop();
@@ -0,0 +1,76 @@
+/* 
+ *   Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012
+ *   Free Software Foundation, Inc.
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *
+ */ 
+
+#define INPUT_FILENAME "BitmapCacheTest.swf"
+
+#include "MovieTester.h"
+#include "MovieClip.h"
+#include "log.h"
+#include "rc.h"
+
+#include "check.h"
+#include <string>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+using namespace gnash;
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+	// A megabyte holds two of the large clips' images, so each new one
+	// drops the least recently drawn.
+	RcInitFile::getDefaultInstance().setBitmapCacheSize(1);
+
+	std::string filename = 
+		std::string(TGTDIR) + "/" + std::string(INPUT_FILENAME);
+	MovieTester tester(filename);
+
+	gnash::LogFile& dbglogfile = gnash::LogFile::getDefaultInstance();
+	dbglogfile.setVerbosity(1);
+
+	MovieClip* root = tester.getRootMovie();
+	assert(root);
+
+	if ( ! tester.canTestRendering() ) {
+		std::cout << "UNTESTED: bitmap caching (testing not possible "
+			"with this build)." << std::endl;
+		return EXIT_SUCCESS; // so testing doesn't abort
+	}
+
+	rgba green(0, 255, 0, 255);
+	rgba yellow(255, 255, 0, 255);
+
+	tester.advance();
+
+	for (int i = 0; i < 8; ++i) {
+		tester.advance();
+
+		// The background was drawn again, and the cached clip over it
+		// too, whether or not its image was dropped.
+		check_pixel(50, 50, 2, green, 2);
+		check_pixel(300, 200, 2, yellow, 2);
+	}
+
+	return 0;
+}
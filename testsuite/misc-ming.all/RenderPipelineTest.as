@@ -0,0 +1,67 @@
+//
+// A movie drawn the same whether frames are drawn while the next one
+// advances or at once.
+// Build with:
+//	makeswf -v8 -o RenderPipelineTest.swf RenderPipelineTest.as
+// Run with:
+//	gnash RenderPipelineTest.swf
+//
+// Everything changes each frame while the frame before is drawn: moving
+// shapes, text, a BitmapData drawn on by ActionScript, and clips with
+// filters whose images don't all fit in the cache at once.
+//
+
+box = function(mc, x, y, w, h, color)
+{
+	mc.beginFill(color);
+	mc.moveTo(x, y);
+	mc.lineTo(x + w, y);
+	mc.lineTo(x + w, y + h);
+	mc.lineTo(x, y + h);
+	mc.lineTo(x, y);
+	mc.endFill();
+};
+
+// A shape changed with the drawing API every frame.
+createEmptyMovieClip("drawn", 1);
+
+// Text
+createTextField("text", 2, 10, 400, 400, 60);
+text.text = "The quick brown fox jumps over the lazy dog.";
+text.setTextFormat(new TextFormat("_sans", 20, 0x004080));
+
+// A bitmap drawn on each frame.
+bd = new flash.display.BitmapData(100, 100, false, 0xFFFFFF);
+createEmptyMovieClip("bitmap", 3);
+bitmap.attachBitmap(bd, 1);
+bitmap._x = 500;
+bitmap._y = 20;
+
+// Clips with filters, each large enough that they don't all fit in a
+// bitmapCacheSize of 1 megabyte.
+for (i = 0; i < 4; ++i) {
+	mc = createEmptyMovieClip("filtered" + i, 10 + i);
+	box(mc, -140, -140, 280, 280, 0x208020 + i * 0x400000);
+	mc._x = 150 + i * 110;
+	mc._y = 200;
+	mc.filters = [ new flash.filters.GlowFilter(0xFF00FF, 100, 8, 8) ];
+}
+
+frame = 0;
+onEnterFrame = function()
+{
+	++frame;
+	drawn.clear();
+	box(drawn, 10 + frame * 5, 10, 60, 40, 0xFF0000 + frame * 0x10);
+
+	text._x += 4;
+
+	bd.fillRect(new flash.geom.Rectangle(frame * 7 % 90, frame * 3 % 90,
+		10, 10), 0x000000 + frame * 0x0F0F0F);
+
+	for (i = 0; i < 4; ++i) {
+		_root["filtered" + i]._rotation += 5 + i;
+	}
+};
+
+stop();
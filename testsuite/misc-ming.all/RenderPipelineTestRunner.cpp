@@ -0,0 +1,88 @@
+/* 
+ *   Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012
+ *   Free Software Foundation, Inc.
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *
+ */ 
+
+#define INPUT_FILENAME "RenderPipelineTest.swf"
+
+#include "MovieTester.h"
+#include "MovieClip.h"
+#include "log.h"
+#include "rc.h"
+
+#include "check.h"
+#include <string>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+using namespace gnash;
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+	std::string filename = 
+		std::string(TGTDIR) + "/" + std::string(INPUT_FILENAME);
+
+	// The settings are read when a MovieTester is made. The images of
+	// the filtered clips don't all fit, so some are dropped each frame.
+	RcInitFile& rc = RcInitFile::getDefaultInstance();
+	rc.setBitmapCacheSize(1);
+	rc.renderPipeline(true);
+	MovieTester pipelined(filename);
+	rc.renderPipeline(false);
+	MovieTester synchronous(filename);
+
+	gnash::LogFile& dbglogfile = gnash::LogFile::getDefaultInstance();
+	dbglogfile.setVerbosity(1);
+
+	if ( ! pipelined.canTestRendering() ||
+			! synchronous.canTestRendering() ) {
+		std::cout << "UNTESTED: render pipeline (testing not possible "
+			"with this build)." << std::endl;
+		return EXIT_SUCCESS; // so testing doesn't abort
+	}
+
+	// The first frame is recorded, but not drawn until asked.
+	pipelined.drawQueuedFrame();
+	check_equals(pipelined.differentPixels(synchronous), 0);
+
+	// Each frame is drawn while the next one advances, so the pipelined
+	// movie shows the frame the synchronous one showed before advancing.
+	for (int i = 0; i < 15; ++i) {
+		pipelined.advance();
+		check_equals(pipelined.differentPixels(synchronous), 0);
+		synchronous.advance();
+	}
+
+	pipelined.drawQueuedFrame();
+	check_equals(pipelined.differentPixels(synchronous), 0);
+
+	// A frame replaced before it is drawn is dropped, and the next one
+	// updates the regions of both.
+	pipelined.advance();
+	synchronous.advance();
+	pipelined.redraw();
+	synchronous.redraw();
+	pipelined.drawQueuedFrame();
+	check_equals(pipelined.differentPixels(synchronous), 0);
+
+	return 0;
+}
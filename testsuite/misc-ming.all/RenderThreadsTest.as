@@ -0,0 +1,100 @@
+//
+// A movie drawn the same with any number of renderThreads.
+// Build with:
+//	makeswf -v8 -o RenderThreadsTest.swf RenderThreadsTest.as
+// Run with:
+//	gnash RenderThreadsTest.swf
+//
+// Shapes, a gradient, text, a bitmap and a mask, all crossing the bands
+// the stage is split into, and moving a little each frame.
+//
+
+box = function(mc, x, y, w, h, color, alpha)
+{
+	mc.beginFill(color, alpha);
+	mc.moveTo(x, y);
+	mc.lineTo(x + w, y);
+	mc.lineTo(x + w, y + h);
+	mc.lineTo(x, y + h);
+	mc.lineTo(x, y);
+	mc.endFill();
+};
+
+// Shapes: an outlined star and translucent, curved strips.
+createEmptyMovieClip("shapes", 1);
+with (shapes) {
+	lineStyle(3, 0x000080, 100);
+	beginFill(0xFF8000, 100);
+	moveTo(100, 10);
+	for (i = 1; i <= 10; ++i) {
+		r = i % 2 ? 40 : 90;
+		a = Math.PI * i / 5 - Math.PI / 2;
+		lineTo(100 + r * Math.cos(a), 100 + r * Math.sin(a));
+	}
+	endFill();
+	lineStyle();
+}
+for (i = 0; i < 8; ++i) {
+	shapes.beginFill(0x00A000 + i * 0x20, 50);
+	shapes.moveTo(220 + i * 20, 0);
+	shapes.curveTo(400 + i * 10, 200, 220 + i * 20, 390);
+	shapes.lineTo(230 + i * 20, 390);
+	shapes.curveTo(410 + i * 10, 200, 230 + i * 20, 0);
+	shapes.endFill();
+}
+
+// Text
+createTextField("text", 2, 10, 200, 300, 150);
+text.multiline = true;
+text.wordWrap = true;
+text.text = "The quick brown fox jumps over the lazy dog. " +
+	"Pack my box with five dozen liquor jugs.";
+text.setTextFormat(new TextFormat("_sans", 24, 0x800080));
+
+// A bitmap, smoothed and rotated.
+bd = new flash.display.BitmapData(64, 64, true, 0);
+bd.noise(42, 0, 255, 15, false);
+bd.fillRect(new flash.geom.Rectangle(16, 16, 32, 32), 0x800000FF);
+createEmptyMovieClip("bitmap", 3);
+bitmap.attachBitmap(bd, 1, "auto", true);
+bitmap._x = 450;
+bitmap._y = 150;
+bitmap._xscale = bitmap._yscale = 250;
+bitmap._rotation = 20;
+
+// A round mask over a striped clip.
+createEmptyMovieClip("stripes", 4);
+for (i = 0; i < 20; ++i) {
+	box(stripes, 0, i * 20, 640, 10, i % 2 ? 0xFF0000 : 0x0000FF, 80);
+}
+createEmptyMovieClip("mask", 5);
+mask.beginFill(0);
+mask.moveTo(120, 0);
+mask.curveTo(240, 0, 240, 120);
+mask.curveTo(240, 240, 120, 240);
+mask.curveTo(0, 240, 0, 120);
+mask.curveTo(0, 0, 120, 0);
+mask.endFill();
+mask._x = 300;
+mask._y = 80;
+stripes.setMask(mask);
+
+// A radial gradient, over every band.
+createEmptyMovieClip("gradient", 6);
+gradient.beginGradientFill("radial", [ 0xFFFF00, 0x008080, 0x400040 ],
+	[ 100, 80, 60 ], [ 0, 128, 255 ],
+	{ matrixType: "box", x: 0, y: 0, w: 160, h: 400, r: 0 });
+box(gradient, 0, 0, 160, 400, 0, 100);
+gradient._x = 470;
+
+onEnterFrame = function()
+{
+	shapes._rotation += 7;
+	text._x += 3;
+	bitmap._rotation -= 11;
+	mask._x -= 13;
+	mask._y += 5;
+	gradient._x -= 9;
+};
+
+stop();
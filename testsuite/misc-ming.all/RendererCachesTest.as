@@ -0,0 +1,110 @@
+//
+// A movie drawn the same with and without the renderer's caches.
+// Build with:
+//	makeswf -v8 -o RendererCachesTest.swf RendererCachesTest.as
+// Run with:
+//	gnash RendererCachesTest.swf
+//
+// Shapes moving by whole and part pixels, text moving, scaled, rotated
+// and too large for the glyph cache, and a clip drawn again each frame
+// with the drawing API.
+//
+
+star = function(mc, x, y, color)
+{
+	mc.lineStyle(2, 0x000080, 100);
+	mc.beginFill(color, 100);
+	mc.moveTo(x, y - 60);
+	for (i = 1; i <= 10; ++i) {
+		r = i % 2 ? 25 : 60;
+		a = Math.PI * i / 5 - Math.PI / 2;
+		mc.lineTo(x + r * Math.cos(a), y + r * Math.sin(a));
+	}
+	mc.endFill();
+	mc.lineStyle();
+};
+
+// Shapes moving by whole pixels, by part of one, and by both.
+createEmptyMovieClip("whole", 1);
+star(whole, 70, 70, 0xFF8000);
+createEmptyMovieClip("part", 2);
+star(part, 70, 200, 0x00A000);
+createEmptyMovieClip("both", 3);
+star(both, 70, 330, 0x8000FF);
+both.beginGradientFill("linear", [ 0xFFFF00, 0x0000FF ], [ 100, 50 ],
+	[ 0, 255 ], { matrixType: "box", x: 120, y: 300, w: 80, h: 60, r: 0 });
+both.moveTo(120, 300);
+both.lineTo(200, 300);
+both.lineTo(200, 360);
+both.lineTo(120, 360);
+both.lineTo(120, 300);
+both.endFill();
+
+// Text, upright, scaled and rotated.
+format = new TextFormat("_sans", 18, 0x800000);
+createTextField("plain", 4, 250, 10, 360, 40);
+plain.text = "Sphinx of black quartz, judge my vow.";
+plain.setTextFormat(format);
+createTextField("scaled", 5, 250, 60, 360, 60);
+scaled.text = "How vexingly quick daft zebras jump!";
+scaled.setTextFormat(format);
+scaled._xscale = 130;
+scaled._yscale = 80;
+createTextField("rotated", 6, 300, 150, 360, 40);
+rotated.text = "The five boxing wizards jump quickly.";
+rotated.setTextFormat(format);
+rotated._rotation = 15;
+
+// Text growing a little each frame, moving by less than the glyph
+// cache's subpixel steps, and too large to be cached.
+createTextField("growing", 8, 20, 400, 300, 40);
+growing.text = "Jackdaws love my big sphinx of quartz.";
+growing.setTextFormat(format);
+createTextField("creeping", 9, 20, 440, 300, 40);
+creeping.text = "Crazy Fredrick bought many very exquisite opal jewels.";
+creeping.setTextFormat(format);
+createTextField("large", 10, 250, 200, 400, 200);
+large.text = "Wq";
+large.setTextFormat(new TextFormat("_serif", 160, 0x004000));
+
+// A clip drawn again in the same place each frame, in another shape
+// and color.
+createEmptyMovieClip("drawn", 7);
+drawn._x = 450;
+drawn._y = 330;
+redraw = function(frame)
+{
+	drawn.clear();
+	drawn.beginFill(frame % 2 ? 0x008080 : 0x808000, 100);
+	drawn.moveTo(-50, -50);
+	drawn.lineTo(50, -50);
+	if (frame % 2) drawn.lineTo(0, 50);
+	else drawn.curveTo(50, 50, 0, 50);
+	drawn.lineTo(-50, -50);
+	drawn.endFill();
+};
+frame = 0;
+redraw(frame);
+
+onEnterFrame = function()
+{
+	++frame;
+	whole._x += 3;
+	whole._y += 1;
+	part._x += 0.35;
+	part._y += 0.15;
+	both._x += 2.6;
+	both._y -= 0.8;
+	plain._x -= 0.3;
+	scaled._x += 1.45;
+	scaled._y += 0.1;
+	rotated._rotation += 5;
+	rotated._y += 0.5;
+	growing._xscale += 0.7;
+	growing._yscale += 0.4;
+	creeping._x += 0.1;
+	large._x -= 0.45;
+	redraw(frame);
+};
+
+stop();
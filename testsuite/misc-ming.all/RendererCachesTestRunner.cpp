@@ -0,0 +1,78 @@
+/* 
+ *   Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012
+ *   Free Software Foundation, Inc.
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *
+ */ 
+
+#define INPUT_FILENAME "RendererCachesTest.swf"
+
+#include "MovieTester.h"
+#include "MovieClip.h"
+#include "log.h"
+#include "rc.h"
+
+#include "check.h"
+#include <string>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+using namespace gnash;
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+	std::string filename = 
+		std::string(TGTDIR) + "/" + std::string(INPUT_FILENAME);
+
+	// The renderer is chosen when a MovieTester is made.
+	RcInitFile& rc = RcInitFile::getDefaultInstance();
+	rc.rendererCaches(true);
+	MovieTester cached(filename);
+	rc.rendererCaches(false);
+	MovieTester uncached(filename);
+	rc.rendererCaches(true);
+
+	gnash::LogFile& dbglogfile = gnash::LogFile::getDefaultInstance();
+	dbglogfile.setVerbosity(1);
+
+	if ( ! cached.canTestRendering() || ! uncached.canTestRendering() ) {
+		std::cout << "UNTESTED: renderer caches (testing not possible "
+			"with this build)." << std::endl;
+		return EXIT_SUCCESS; // so testing doesn't abort
+	}
+
+	check_equals(cached.differentPixels(uncached), 0);
+
+	// Each frame moves shapes and text to other subpixel positions,
+	// rotates text, and draws a clip again. Shapes and glyphs cached
+	// in earlier frames are drawn again from the cache.
+	for (int i = 0; i < 20; ++i) {
+		cached.advance();
+		uncached.advance();
+		check_equals(cached.differentPixels(uncached), 0);
+	}
+
+	// And the whole stage again.
+	cached.redraw();
+	uncached.redraw();
+	check_equals(cached.differentPixels(uncached), 0);
+
+	return 0;
+}
@@ -0,0 +1,49 @@
+//
+// A movie drawn the same whether unchanged clips are drawn again or
+// their recorded drawing is used.
+// Build with:
+//	makeswf -v8 -o RetainedCommandsTest.swf RetainedCommandsTest.as
+// Run with:
+//	gnash RetainedCommandsTest.swf
+//
+// An unchanging parent holds a child moving each frame, and another
+// unchanging clip is drawn with a filter and with cacheAsBitmap, so
+// that its drawing is an image made for the size of the stage.
+//
+
+box = function(mc, x, y, w, h, color)
+{
+	mc.beginFill(color);
+	mc.moveTo(x, y);
+	mc.lineTo(x + w, y);
+	mc.lineTo(x + w, y + h);
+	mc.lineTo(x, y + h);
+	mc.lineTo(x, y);
+	mc.endFill();
+};
+
+createEmptyMovieClip("parent", 1);
+box(parent, 10, 10, 300, 200, 0xC0C0FF);
+parent.createEmptyMovieClip("child", 1);
+box(parent.child, 0, 0, 40, 40, 0xFF0000);
+parent.child._x = 20;
+parent.child._y = 20;
+parent.createEmptyMovieClip("still", 2);
+box(parent.still, 200, 100, 80, 80, 0x008000);
+
+createEmptyMovieClip("cached", 2);
+cached.createEmptyMovieClip("inner", 1);
+box(cached.inner, 350, 50, 120, 120, 0x0000FF);
+cached.lineStyle(3, 0x000000);
+cached.moveTo(350, 250);
+cached.curveTo(420, 180, 490, 250);
+cached.filters = [ new flash.filters.DropShadowFilter(6, 45, 0, 80, 4, 4) ];
+cached.cacheAsBitmap = true;
+
+onEnterFrame = function()
+{
+	parent.child._x += 7;
+	parent.child._y += 3;
+};
+
+stop();
@@ -0,0 +1,90 @@
+/* 
+ *   Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012
+ *   Free Software Foundation, Inc.
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *
+ */ 
+
+#define INPUT_FILENAME "RetainedCommandsTest.swf"
+
+#include "MovieTester.h"
+#include "MovieClip.h"
+#include "log.h"
+#include "rc.h"
+
+#include "check.h"
+#include <string>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+using namespace gnash;
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+	std::string filename = 
+		std::string(TGTDIR) + "/" + std::string(INPUT_FILENAME);
+
+	// The setting is read when a MovieTester is made.
+	RcInitFile& rc = RcInitFile::getDefaultInstance();
+	rc.retainCommands(true);
+	MovieTester retained(filename);
+	rc.retainCommands(false);
+	MovieTester displayed(filename);
+	rc.retainCommands(true);
+
+	gnash::LogFile& dbglogfile = gnash::LogFile::getDefaultInstance();
+	dbglogfile.setVerbosity(1);
+
+	if ( ! retained.canTestRendering() || ! displayed.canTestRendering() ) {
+		std::cout << "UNTESTED: retained commands (testing not possible "
+			"with this build)." << std::endl;
+		return EXIT_SUCCESS; // so testing doesn't abort
+	}
+
+	check_equals(retained.differentPixels(displayed), 0);
+
+	// The child moves in its unchanged parent.
+	for (int i = 0; i < 10; ++i) {
+		retained.advance();
+		displayed.advance();
+		check_equals(retained.differentPixels(displayed), 0);
+	}
+
+	// The stage is resized, so the cached image is made again.
+	retained.resizeStage(320, 240);
+	displayed.resizeStage(320, 240);
+	retained.redraw();
+	displayed.redraw();
+	check_equals(retained.differentPixels(displayed), 0);
+
+	for (int i = 0; i < 3; ++i) {
+		retained.advance();
+		displayed.advance();
+		check_equals(retained.differentPixels(displayed), 0);
+	}
+
+	retained.resizeStage(800, 600);
+	displayed.resizeStage(800, 600);
+	retained.redraw();
+	displayed.redraw();
+	check_equals(retained.differentPixels(displayed), 0);
+
+	return 0;
+}
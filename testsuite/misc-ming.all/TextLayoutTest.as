@@ -0,0 +1,184 @@
+//
+// Text edited in the middle lays out as if it had been set at once.
+// Build with:
+//	makeswf -v8 -o TextLayoutTest.swf TextLayoutTest.as
+// Run with:
+//	gnash TextLayoutTest.swf
+//
+// Each pair of fields is drawn in the same place: 'edited' has its text
+// changed after a first layout, so only the lines from the change on are
+// laid out again; 'full' is given the final text at once.
+// TextLayoutTestRunner shows one field of each pair at a time and
+// compares the pixels.
+//
+
+#include "../actionscript.all/check.as"
+
+before = "The quick brown fox jumps over the lazy dog.\tPack my box " +
+	"with five dozen liquor jugs. How vexingly quick daft zebras " +
+	"jump!\nSphinx of black quartz, judge my vow. The five boxing " +
+	"wizards jump quickly.";
+
+// Fields are placed on a grid of three columns.
+pairs = 0;
+field = function(name, html)
+{
+	createTextField(name, getNextHighestDepth(), 10 + pairs % 3 * 210,
+		10 + Math.floor(pairs / 3) * 190, 200, 180);
+	var tf = _root[name];
+	tf.multiline = true;
+	tf.wordWrap = true;
+	tf.html = html;
+	return tf;
+};
+
+// Make the pair of fields 'editedName' and 'fullName'. Both are set up
+// by 'setup', unless 'setupFull' is given for the full one, and the
+// edited one is given 'first' and changed by 'edit'.
+pair = function(name, setup, first, edit, setupFull)
+{
+	var edited = field("edited" + name, false);
+	setup(edited);
+	edited.text = first;
+	edit(edited);
+
+	var full = field("full" + name, false);
+	var s = setupFull ? setupFull : setup;
+	s(full);
+	full.text = edited.text;
+
+	check_equals(edited.text, full.text);
+	check_equals(edited.textWidth, full.textWidth);
+	check_equals(edited.textHeight, full.textHeight);
+	check_equals(edited.maxscroll, full.maxscroll);
+	check_equals(edited.bottomScroll, full.bottomScroll);
+	++pairs;
+};
+
+plain = function(tf)
+{
+	tf.setNewTextFormat(new TextFormat("_sans", 14, 0x000000));
+};
+
+// Insertions, deletions and a change in the middle of a field formatted
+// with a larger font, margins, an indent and tab stops.
+formatted = function(tf)
+{
+	var format = new TextFormat("_sans", 18, 0x000080);
+	format.leftMargin = 10;
+	format.rightMargin = 5;
+	format.indent = 20;
+	format.tabStops = [ 40, 120, 200 ];
+	tf.setNewTextFormat(format);
+};
+pair("Format", formatted, before, function(tf) {
+	var at = before.indexOf("How");
+	tf.replaceText(at, at, " Waltz, bad nymph, for quick jigs vex.");
+	tf.replaceText(at + 10, at + 20, "");
+	tf.text = tf.text.substr(0, at) + "jumps" + tf.text.substr(at + 5);
+});
+
+// Removing the first word of a line, which lets the next word back onto
+// the line before. The long words don't fit at the end of a line, so
+// they start lines of their own.
+longWords = "The quick brown fox incomprehensibilities jumps over the " +
+	"lazy dog. Pack my box characteristically with five dozen liquor " +
+	"jugs counterrevolutionaries and a few more.";
+pair("Reflow", plain, longWords, function(tf) {
+	var words = [ "incomprehensibilities ", "characteristically ",
+		"counterrevolutionaries " ];
+	for (var i = 0; i < words.length; ++i) {
+		var at = tf.text.indexOf(words[i]);
+		tf.replaceText(at, at + words[i].length, "");
+	}
+});
+
+// The same for every word, checked without drawing them.
+reflowed = field("reflowedEdited", false);
+plain(reflowed);
+reflowedFull = field("reflowedFull", false);
+plain(reflowedFull);
+differences = 0;
+for (at = 0; at < longWords.length; at = end + 1) {
+	end = longWords.indexOf(" ", at);
+	if (end < 0) break;
+	reflowed.text = longWords;
+	reflowed.replaceText(at, end + 1, "");
+	reflowedFull.text = "";
+	reflowedFull.text = reflowed.text;
+	if (reflowed.textHeight != reflowedFull.textHeight ||
+			reflowed.textWidth != reflowedFull.textWidth ||
+			reflowed.maxscroll != reflowedFull.maxscroll) {
+		note("Different layout without '" + longWords.substring(at, end) + "'");
+		++differences;
+	}
+}
+check_equals(differences, 0);
+reflowed.removeTextField();
+reflowedFull.removeTextField();
+
+// Appending to the end, a little at a time as when typing.
+pair("Append", plain, "The quick brown fox", function(tf) {
+	var more = " jumps over the lazy dog. Pack my box with five dozen " +
+		"liquor jugs.\nHow vexingly quick daft zebras jump!";
+	for (var i = 0; i < more.length; i += 7) {
+		tf.text += more.substr(i, 7);
+	}
+});
+
+// Changing the leading, and then the text.
+leading = function(tf)
+{
+	var format = new TextFormat("_sans", 14, 0x006000);
+	format.leading = 8;
+	tf.setNewTextFormat(format);
+};
+pair("Leading", plain, before, function(tf) {
+	var format = new TextFormat();
+	format.leading = 8;
+	format.color = 0x006000;
+	tf.setTextFormat(format);
+	var at = before.indexOf("box");
+	tf.replaceText(at, at + 3, "crate");
+}, leading);
+
+// A field growing to fit its text.
+autoSized = function(tf)
+{
+	plain(tf);
+	tf.autoSize = "left";
+};
+pair("AutoSize", autoSized, before, function(tf) {
+	var at = before.indexOf("Sphinx");
+	tf.replaceText(at, at, "Five or six big jet planes zoomed quickly " +
+		"by the tower. ");
+	at = before.indexOf("lazy");
+	tf.replaceText(at, at + 4, "sleepy");
+});
+
+// A field with several formats.
+head = "<p align='left'><font face='_sans' size='14'>The quick brown " +
+	"fox <font color='#ff0000' size='22'>jumps over</font> the lazy " +
+	"dog. ";
+tail = "<b>Pack my box</b> with five dozen liquor jugs.</font></p>" +
+	"<p align='right'><font face='_serif' size='16'>Sphinx of black " +
+	"quartz, judge my vow.</font></p>";
+
+editedHtml = field("editedHtml", true);
+editedHtml.htmlText = head + tail;
+editedHtml.htmlText = head + "<i>How vexingly quick daft zebras jump!" +
+	"</i> " + tail;
+
+fullHtml = field("fullHtml", true);
+fullHtml.htmlText = editedHtml.htmlText;
+++pairs;
+
+check_equals(editedHtml.text, fullHtml.text);
+check_equals(editedHtml.textWidth, fullHtml.textWidth);
+check_equals(editedHtml.textHeight, fullHtml.textHeight);
+check_equals(editedHtml.maxscroll, fullHtml.maxscroll);
+check_equals(editedHtml.bottomScroll, fullHtml.bottomScroll);
+
+totals(31);
+
+stop();
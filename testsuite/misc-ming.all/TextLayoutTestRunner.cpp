@@ -0,0 +1,91 @@
+/*
+ *   Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012
+ *   Free Software Foundation, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *
+ */
+
+#define INPUT_FILENAME "TextLayoutTest.swf"
+
+#include "MovieTester.h"
+#include "MovieClip.h"
+#include "DisplayObject.h"
+#include "log.h"
+
+#include "check.h"
+#include <string>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+using namespace gnash;
+
+namespace {
+
+/// Show or hide a field of the test movie.
+void
+show(MovieTester& tester, const char* name, bool visible)
+{
+	MovieClip* root = tester.getRootMovie();
+	const DisplayObject* field = tester.findDisplayItemByName(*root, name);
+	check(field);
+	if (field) const_cast<DisplayObject*>(field)->set_visible(visible);
+}
+
+}
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+	std::string filename =
+		std::string(TGTDIR) + "/" + std::string(INPUT_FILENAME);
+
+	MovieTester edited(filename);
+	MovieTester fullLayout(filename);
+	MovieTester none(filename);
+
+	gnash::LogFile& dbglogfile = gnash::LogFile::getDefaultInstance();
+	dbglogfile.setVerbosity(1);
+
+	if ( ! edited.canTestRendering() || ! fullLayout.canTestRendering() ) {
+		std::cout << "UNTESTED: text layout (testing not possible "
+			"with this build)." << std::endl;
+		return EXIT_SUCCESS; // so testing doesn't abort
+	}
+
+	const char* pairs[] = { "Format", "Reflow", "Append", "Leading",
+		"AutoSize", "Html" };
+	for (const char* pair : pairs) {
+		const std::string edit = std::string("edited") + pair;
+		const std::string full = std::string("full") + pair;
+		show(edited, full.c_str(), false);
+		show(fullLayout, edit.c_str(), false);
+		show(none, edit.c_str(), false);
+		show(none, full.c_str(), false);
+	}
+
+	edited.redraw();
+	fullLayout.redraw();
+	none.redraw();
+
+	// The text is drawn, and the same either way.
+	check(edited.differentPixels(none) > 0);
+	check_equals(fullLayout.differentPixels(edited), 0);
+
+	return 0;
+}
@@ -0,0 +1,227 @@
+// swfcache.cpp: fill the SWF cache ahead of time, for Gnash.
+//
+//   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011, 2012
+//   Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+
+#ifdef ENABLE_NLS
+# include <clocale>
+#endif
+
+#include "SWFCache.h"
+#include "IOChannel.h"
+#include "tu_file.h"
+#include "log.h"
+#include "rc.h"
+
+extern "C"{
+
+#ifdef HAVE_GETOPT_H
+	#include <getopt.h>
+#endif
+#ifndef __GNUC__
+	extern char *optarg;
+	extern int   optopt;
+	extern int optind, getopt(int, char *const *, const char *);
+#endif
+}
+
+#ifdef BOOST_NO_EXCEPTIONS
+
+namespace boost
+{
+	void throw_exception(std::exception const & e)
+	{
+		std::abort();
+	}
+}
+#endif
+
+const char *SWFCACHE_VERSION = "1.0";
+
+using namespace gnash;
+
+namespace {
+gnash::LogFile& dbglogfile = gnash::LogFile::getDefaultInstance();
+gnash::RcInitFile& rcfile = gnash::RcInitFile::getDefaultInstance();
+}
+
+static void usage(const char *name);
+static bool cache(const SWFCache& swfCache, const std::string& file);
+
+int
+main(int argc, char *argv[])
+{
+    // Enable native language support, i.e. internationalization
+#ifdef ENABLE_NLS
+    setlocale (LC_ALL, "");
+    bindtextdomain (PACKAGE, LOCALEDIR);
+    textdomain (PACKAGE);
+#endif
+    int c;
+
+    // scan for the two main standard GNU options
+    for (c = 0; c < argc; c++) {
+      if (strcmp("--help", argv[c]) == 0) {
+        usage(argv[0]);
+        return EXIT_SUCCESS;
+      }
+      if (strcmp("--version", argv[c]) == 0) {
+        printf (_("Gnash swfcache version: %s, Gnash version: %s\n"),
+		   SWFCACHE_VERSION, VERSION);
+        return EXIT_SUCCESS;
+      }
+    }
+
+    std::string dir = rcfile.getSWFCacheDir();
+    unsigned long size = rcfile.getSWFCacheSize();
+
+    while ((c = getopt (argc, argv, ":hvd:s:")) != -1) {
+	switch (c) {
+	  case 'h':
+	      usage (argv[0]);
+	      return EXIT_SUCCESS;
+	  case 'v':
+	      dbglogfile.setVerbosity();
+	      log_debug (_("Verbose output turned on"));
+	      break;
+	  case 'd':
+              dir = optarg;
+	      break;
+	  case 's':
+              size = strtoul(optarg, NULL, 0);
+	      break;
+	  case ':':
+              fprintf(stderr, "Missing argument for switch ``%c''\n", optopt);
+	      return EXIT_FAILURE;
+	  case '?':
+	  default:
+              fprintf(stderr, "Unknown switch ``%c''\n", optopt);
+	      return EXIT_FAILURE;
+	}
+    }
+
+    std::vector<std::string> infiles;
+    while (optind < argc) {
+        infiles.push_back(argv[optind]);
+	    optind++;
+    }
+
+    if (infiles.empty()) {
+	    std::cerr << _("no input files") << std::endl;
+	    usage(argv[0]);
+	    return EXIT_FAILURE;
+    }
+
+    const SWFCache swfCache(dir, size * 1024 * 1024);
+    if (!swfCache.enabled()) {
+        std::cerr << _("No cache directory: use -d or set swfCacheDir "
+                "in gnashrc") << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    bool ok = true;
+    for (const std::string& file : infiles) {
+        if (!cache(swfCache, file)) ok = false;
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Keep the inflated copy of a SWF file in the cache.
+//
+/// Uncompressed files are skipped, as they are read directly anyway.
+static bool
+cache(const SWFCache& swfCache, const std::string& file)
+{
+    std::unique_ptr<IOChannel> in = makeFileChannel(file.c_str(), "rb");
+    if (!in) {
+        std::cerr << file << _(": could not open") << std::endl;
+        return false;
+    }
+
+    const std::uint8_t* swf = in->map();
+    const size_t size = swf ? in->size() : 0;
+    if (size < 8 || !((swf[0] == 'C' || swf[0] == 'F') && swf[1] == 'W' &&
+                swf[2] == 'S')) {
+        std::cerr << file << _(": not a SWF file") << std::endl;
+        return false;
+    }
+
+    if (swf[0] == 'F') {
+        std::cout << file << _(": not compressed, skipped") << std::endl;
+        return true;
+    }
+
+    if (swfCache.find(swf, size)) {
+        std::cout << file << _(": already cached") << std::endl;
+        return true;
+    }
+
+    std::vector<std::uint8_t> inflated;
+    if (!SWFCache::inflate(swf, size, inflated)) {
+        std::cerr << file << _(": compressed data is corrupt or truncated")
+            << std::endl;
+        return false;
+    }
+
+    if (!swfCache.store(swf, size, inflated)) {
+        std::cerr << file << _(": could not be cached") << std::endl;
+        return false;
+    }
+
+    std::cout << file << _(": cached") << std::endl;
+    return true;
+}
+
+static void
+usage(const char *name)
+{
+    printf(
+	_("swfcache -- fills the Gnash SWF cache ahead of time.\n"
+	"\n"
+	"usage: %s [options] <file>...\n"
+	"\n"
+	"Inflate the given compressed SWF files into the cache, so that\n"
+	"the player reads them from there the first time they are played.\n"
+	"\n"
+	"options:\n"
+	"\n"
+	"  --help(-h)  Print this info.\n"
+	"  --version   Print the version numbers.\n"
+	"  -v          Be verbose; i.e. print log messages to stdout\n"
+	"  -d <dir>    The cache directory (swfCacheDir in gnashrc by default)\n"
+	"  -s <MB>     The most disk space the cache takes, 0 for no limit\n"
+	"              (swfCacheSize in gnashrc by default)\n"
+	), name);
+}
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: t
+// End: